@@ -0,0 +1,184 @@
+#include "analysis.hpp"
+#include "pe.hpp"
+
+#define NMD_ASSEMBLY_NO_INCLUDES
+#include "nmd_assembly.h"
+
+namespace
+{
+	constexpr ULONG pool_tag    = 'snaA';
+	constexpr ULONG max_workers = 32;
+	constexpr LONG  chunk_size  = 16; // Entries claimed at once, keeps contention on the shard counters low
+
+	// A contiguous range of the exception table. Entries are claimed by bumping 'next', by the owner or by a thief
+	struct shard
+	{
+		volatile LONG next;
+		LONG          end;
+	};
+
+	struct work
+	{
+		uintptr_t                   base;
+		const RUNTIME_FUNCTION*     pfunctions;
+		analysis::function_summary* psummaries;
+		shard                       shards[ max_workers ];
+		ULONG                       shard_count;
+	};
+
+	struct worker_context
+	{
+		work* pwork;
+		ULONG index;
+	};
+
+	void analyze_function( const uintptr_t base, const RUNTIME_FUNCTION& entry, nmd_x86_instruction& instruction, analysis::function_summary& summary )
+	{
+		summary = { base + entry.BeginAddress, base + entry.EndAddress, 0, 0, true };
+
+		for ( auto address = summary.start; address < summary.end; address += instruction.length )
+		{
+			if ( !nmd_x86_decode_buffer( reinterpret_cast< const void* >( address ), summary.end - address, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_MINIMAL ) )
+			{
+				summary.decoded = false;
+				break;
+			}
+
+			summary.instruction_count++;
+
+			if ( instruction.opcode == 0xE8 && instruction.opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT )
+				summary.call_count++;
+		}
+	}
+
+	bool claim( shard& s, LONG& begin, LONG& end )
+	{
+		if ( s.next >= s.end )
+			return false;
+
+		begin = InterlockedExchangeAdd( &s.next, chunk_size );
+
+		if ( begin >= s.end )
+			return false;
+
+		end = ( s.end - begin < chunk_size ) ? s.end : begin + chunk_size;
+		return true;
+	}
+
+	// Drains the worker's own shard first, then steals from the others in order
+	void drain( work& w, const ULONG index )
+	{
+		// Thread-local decoder scratch area
+		nmd_x86_instruction instruction;
+
+		for ( ULONG i = 0; i < w.shard_count; i++ )
+		{
+			auto& s = w.shards[ ( index + i ) % w.shard_count ];
+
+			LONG begin, end;
+			while ( claim( s, begin, end ) )
+			{
+				for ( auto j = begin; j < end; j++ )
+					analyze_function( w.base, w.pfunctions[ j ], instruction, w.psummaries[ j ] );
+			}
+		}
+	}
+
+	void worker_routine( PVOID pcontext )
+	{
+		const auto* pworker = static_cast< worker_context* >( pcontext );
+
+		drain( *pworker->pwork, pworker->index );
+
+		PsTerminateSystemThread( STATUS_SUCCESS );
+	}
+}
+
+bool analysis::analyze_exception_table( const uintptr_t image_base, function_summary*& psummaries, size_t& count )
+{
+	psummaries = nullptr;
+	count      = 0;
+
+	const auto* pexception_dir = pe::get_data_directory( image_base, IMAGE_DIRECTORY_ENTRY_EXCEPTION );
+
+	if ( !pexception_dir || !pexception_dir->VirtualAddress )
+		return false;
+
+	const auto entry_count = static_cast< LONG >( pexception_dir->Size / sizeof( RUNTIME_FUNCTION ) );
+
+	if ( !entry_count )
+		return false;
+
+	auto* presults = static_cast< function_summary* >( ExAllocatePoolWithTag( NonPagedPoolNx, entry_count * sizeof( function_summary ), pool_tag ) );
+
+	if ( !presults )
+		return false;
+
+	auto* pwork = static_cast< work* >( ExAllocatePoolWithTag( NonPagedPoolNx, sizeof( work ), pool_tag ) );
+
+	if ( !pwork )
+	{
+		ExFreePoolWithTag( presults, pool_tag );
+		return false;
+	}
+
+	auto worker_count = KeQueryActiveProcessorCountEx( ALL_PROCESSOR_GROUPS );
+
+	if ( worker_count > max_workers )
+		worker_count = max_workers;
+
+	if ( worker_count > static_cast< ULONG >( entry_count ) )
+		worker_count = entry_count;
+
+	pwork->base        = image_base;
+	pwork->pfunctions  = reinterpret_cast< PRUNTIME_FUNCTION >( image_base + pexception_dir->VirtualAddress );
+	pwork->psummaries  = presults;
+	pwork->shard_count = worker_count;
+
+	// One shard per worker, of (almost) equal size
+	for ( ULONG i = 0; i < worker_count; i++ )
+	{
+		pwork->shards[ i ].next = static_cast< LONG >( static_cast< LONGLONG >( entry_count ) * i / worker_count );
+		pwork->shards[ i ].end  = static_cast< LONG >( static_cast< LONGLONG >( entry_count ) * ( i + 1 ) / worker_count );
+	}
+
+	worker_context contexts[ max_workers ] { };
+	HANDLE         thread_handles[ max_workers ] { };
+
+	// Kernel handles, so the threads don't show up in the handle table of whichever process called us
+	OBJECT_ATTRIBUTES thread_attributes;
+	InitializeObjectAttributes( &thread_attributes, nullptr, OBJ_KERNEL_HANDLE, nullptr, nullptr );
+
+	// The calling thread is worker 0. Shards of workers that failed to start are stolen by the others
+	for ( ULONG i = 1; i < worker_count; i++ )
+	{
+		contexts[ i ] = { pwork, i };
+
+		if ( !NT_SUCCESS( PsCreateSystemThread( &thread_handles[ i ], THREAD_ALL_ACCESS, &thread_attributes, nullptr, nullptr, worker_routine, &contexts[ i ] ) ) )
+			thread_handles[ i ] = nullptr;
+	}
+
+	drain( *pwork, 0 );
+
+	for ( ULONG i = 1; i < worker_count; i++ )
+	{
+		if ( !thread_handles[ i ] )
+			continue;
+
+		ZwWaitForSingleObject( thread_handles[ i ], FALSE, nullptr );
+		ZwClose( thread_handles[ i ] );
+	}
+
+	ExFreePoolWithTag( pwork, pool_tag );
+
+	psummaries = presults;
+	count      = entry_count;
+
+	return true;
+}
+
+void analysis::free_summaries( function_summary* psummaries )
+{
+	if ( psummaries )
+		ExFreePoolWithTag( psummaries, pool_tag );
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ntddk.h>
+
+namespace analysis
+{
+	struct function_summary
+	{
+		uintptr_t start;
+		uintptr_t end;
+		ULONG     instruction_count;
+		ULONG     call_count; // Direct calls
+		bool      decoded;    // Every instruction between start and end is valid
+	};
+
+	// Decodes every function of the image's exception table on all processors. Must be called at PASSIVE_LEVEL.
+	// On success 'psummaries' has one entry per RUNTIME_FUNCTION in the same (address) order, release it with free_summaries
+	bool analyze_exception_table ( uintptr_t image_base, function_summary*& psummaries, size_t& count );
+	void free_summaries          ( function_summary* psummaries );
+}
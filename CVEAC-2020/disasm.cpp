@@ -0,0 +1,380 @@
+#include "disasm.hpp"
+
+#define NMD_ASSEMBLY_NO_INCLUDES
+#include "nmd_assembly.h"
+
+namespace
+{
+	bool test_bit( const unsigned char* pbitmap, size_t index )
+	{
+		return pbitmap[ index >> 3 ] & ( 1 << ( index & 7 ) );
+	}
+
+	void set_bit( unsigned char* pbitmap, size_t index )
+	{
+		pbitmap[ index >> 3 ] |= static_cast< unsigned char >( 1 << ( index & 7 ) );
+	}
+
+	bool contains( const disasm::graph& g, uintptr_t address )
+	{
+		return address >= g.base && address - g.base < g.size;
+	}
+
+	bool decode( const disasm::graph& g, uintptr_t address, nmd_x86_instruction_lite& instruction )
+	{
+		return nmd_x86_decode_buffer_lite( reinterpret_cast< const void* >( address ), g.size - ( address - g.base ), &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_MINIMAL );
+	}
+
+	// int3 is used as padding between functions, any other interrupt returns to the next instruction
+	bool ends_block( const nmd_x86_instruction_lite& instruction )
+	{
+		switch ( instruction.flow )
+		{
+		case NMD_X86_FLOW_JCC:
+		case NMD_X86_FLOW_JMP_DIRECT:
+		case NMD_X86_FLOW_JMP_INDIRECT:
+		case NMD_X86_FLOW_RET:
+		case NMD_X86_FLOW_TRAP:
+			return true;
+		case NMD_X86_FLOW_INT:
+			return instruction.opcode == 0xCC && instruction.opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT;
+		default:
+			return false;
+		}
+	}
+
+	// Marks the target of a direct branch as the start of a block (and of a function for calls)
+	void mark_target( disasm::graph& g, const nmd_x86_instruction_lite& instruction, uintptr_t target )
+	{
+		if ( !contains( g, target ) )
+			return;
+
+		set_bit( g.pblock_starts, target - g.base );
+
+		if ( instruction.flow == NMD_X86_FLOW_CALL_DIRECT )
+			set_bit( g.pfunction_starts, target - g.base );
+	}
+
+	bool close_block( disasm::graph& g, uintptr_t start, uintptr_t end )
+	{
+		return g.blocks.push( { start, end } );
+	}
+
+	// Returns the index of the block that starts at 'address', or g.blocks.count if there is none
+	size_t find_block( const disasm::graph& g, uintptr_t address )
+	{
+		size_t low = 0, high = g.blocks.count;
+
+		while ( low < high )
+		{
+			const auto middle = low + ( high - low ) / 2;
+
+			if ( g.blocks.pdata[ middle ].start < address )
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		return ( low < g.blocks.count && g.blocks.pdata[ low ].start == address ) ? low : g.blocks.count;
+	}
+
+	// Returns the index of the first edge whose source block starts at 'address'
+	size_t find_first_edge( const disasm::graph& g, uintptr_t address )
+	{
+		size_t low = 0, high = g.edges.count;
+
+		while ( low < high )
+		{
+			const auto middle = low + ( high - low ) / 2;
+
+			if ( g.edges.pdata[ middle ].from < address )
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		return low;
+	}
+
+	// Splits the discovered instructions into basic blocks and edges with a single pass over the image
+	bool build_blocks( disasm::graph& g )
+	{
+		g.blocks.count = 0;
+		g.edges.count  = 0;
+
+		uintptr_t block_start = 0;
+		bool      block_open  = false;
+
+		for ( size_t offset = 0; offset < g.size; )
+		{
+			// Skip 8 bytes at a time through data and padding
+			if ( !( offset & 7 ) && !g.pinstruction_starts[ offset >> 3 ] )
+			{
+				if ( block_open && !close_block( g, block_start, g.base + offset ) )
+					return false;
+
+				block_open = false;
+				offset += 8;
+				continue;
+			}
+
+			const auto address = g.base + offset;
+
+			if ( !test_bit( g.pinstruction_starts, offset ) )
+			{
+				if ( block_open && !close_block( g, block_start, address ) )
+					return false;
+
+				block_open = false;
+				offset++;
+				continue;
+			}
+
+			nmd_x86_instruction_lite instruction;
+			if ( !decode( g, address, instruction ) )
+				return false;
+
+			// A branch target in the middle of a block splits it
+			if ( block_open && test_bit( g.pblock_starts, offset ) )
+			{
+				if ( !g.edges.push( { block_start, address, disasm::edge_type::fallthrough } ) || !close_block( g, block_start, address ) )
+					return false;
+
+				block_open = false;
+			}
+
+			if ( !block_open )
+			{
+				block_start = address;
+				block_open  = true;
+			}
+
+			const auto next   = address + instruction.length;
+			const auto target = address + instruction.relativeTarget;
+
+			if ( instruction.flow == NMD_X86_FLOW_JCC )
+			{
+				if ( !g.edges.push( { block_start, target, disasm::edge_type::branch } ) || !g.edges.push( { block_start, next, disasm::edge_type::fallthrough } ) )
+					return false;
+			}
+			else if ( instruction.flow == NMD_X86_FLOW_JMP_DIRECT )
+			{
+				if ( !g.edges.push( { block_start, target, disasm::edge_type::jump } ) )
+					return false;
+			}
+			else if ( instruction.flow == NMD_X86_FLOW_CALL_DIRECT )
+			{
+				if ( !g.edges.push( { block_start, target, disasm::edge_type::call } ) )
+					return false;
+			}
+
+			if ( ends_block( instruction ) )
+			{
+				if ( !close_block( g, block_start, next ) )
+					return false;
+
+				block_open = false;
+			}
+
+			// Instructions that overlap this one are not part of any block
+			offset += instruction.length;
+		}
+
+		return !block_open || close_block( g, block_start, g.base + g.size );
+	}
+
+	// Computes each function's end from the blocks reachable from its entry point without following calls
+	bool build_functions( disasm::graph& g )
+	{
+		g.functions.count = 0;
+
+		if ( !g.blocks.count )
+			return true;
+
+		// Stamp of the last function that visited each block, so the array never has to be cleared
+		auto* pstamps = static_cast< size_t* >( ExAllocatePoolWithTag( NonPagedPoolNx, g.blocks.count * sizeof( size_t ), disasm::pool_tag ) );
+
+		if ( !pstamps )
+			return false;
+
+		RtlZeroMemory( pstamps, g.blocks.count * sizeof( size_t ) );
+
+		bool success = true;
+
+		for ( size_t offset = 0; offset < g.size && success; offset++ )
+		{
+			if ( !test_bit( g.pfunction_starts, offset ) )
+				continue;
+
+			const auto entry = find_block( g, g.base + offset );
+
+			if ( entry == g.blocks.count )
+				continue;
+
+			const auto stamp = g.functions.count + 1;
+			uintptr_t  end   = g.blocks.pdata[ entry ].end;
+
+			// The queue holds block indices here
+			g.queue.count    = 0;
+			pstamps[ entry ] = stamp;
+			success          = g.queue.push( entry );
+
+			while ( success && g.queue.count )
+			{
+				const auto& block = g.blocks.pdata[ g.queue.pdata[ --g.queue.count ] ];
+
+				if ( block.end > end )
+					end = block.end;
+
+				for ( auto i = find_first_edge( g, block.start ); i < g.edges.count && g.edges.pdata[ i ].from == block.start; i++ )
+				{
+					if ( g.edges.pdata[ i ].type == disasm::edge_type::call )
+						continue;
+
+					const auto successor = find_block( g, g.edges.pdata[ i ].to );
+
+					if ( successor == g.blocks.count || pstamps[ successor ] == stamp )
+						continue;
+
+					pstamps[ successor ] = stamp;
+
+					if ( !g.queue.push( successor ) )
+					{
+						success = false;
+						break;
+					}
+				}
+			}
+
+			success = success && g.functions.push( { g.base + offset, end } );
+		}
+
+		g.queue.count = 0;
+		ExFreePoolWithTag( pstamps, disasm::pool_tag );
+
+		return success;
+	}
+}
+
+bool disasm::create( graph& g, const uintptr_t base, const size_t size )
+{
+	RtlZeroMemory( &g, sizeof( g ) );
+
+	if ( !base || !size )
+		return false;
+
+	const auto bitmap_size = ( size + 7 ) / 8;
+	auto*      pbitmaps    = static_cast< unsigned char* >( ExAllocatePoolWithTag( NonPagedPoolNx, bitmap_size * 3, pool_tag ) );
+
+	if ( !pbitmaps )
+		return false;
+
+	RtlZeroMemory( pbitmaps, bitmap_size * 3 );
+
+	g.base                = base;
+	g.size                = size;
+	g.pinstruction_starts = pbitmaps;
+	g.pblock_starts       = pbitmaps + bitmap_size;
+	g.pfunction_starts    = pbitmaps + bitmap_size * 2;
+
+	return true;
+}
+
+void disasm::destroy( graph& g )
+{
+	if ( g.pinstruction_starts )
+		ExFreePoolWithTag( g.pinstruction_starts, pool_tag );
+
+	g.queue.release();
+	g.blocks.release();
+	g.edges.release();
+	g.functions.release();
+
+	RtlZeroMemory( &g, sizeof( g ) );
+}
+
+// Queues a function entry point for recursive_descent
+bool disasm::add_entry_point( graph& g, const uintptr_t address )
+{
+	if ( !contains( g, address ) )
+		return false;
+
+	set_bit( g.pblock_starts, address - g.base );
+	set_bit( g.pfunction_starts, address - g.base );
+
+	return g.queue.push( address );
+}
+
+// Follows the control flow from every queued address. Each instruction is decoded once, no matter how many paths reach it
+bool disasm::recursive_descent( graph& g )
+{
+	while ( g.queue.count )
+	{
+		auto address = g.queue.pdata[ --g.queue.count ];
+
+		while ( contains( g, address ) && !test_bit( g.pinstruction_starts, address - g.base ) )
+		{
+			nmd_x86_instruction_lite instruction;
+			if ( !decode( g, address, instruction ) )
+				break;
+
+			set_bit( g.pinstruction_starts, address - g.base );
+
+			const auto next   = address + instruction.length;
+			const auto target = address + instruction.relativeTarget;
+
+			if ( instruction.flow == NMD_X86_FLOW_JCC || instruction.flow == NMD_X86_FLOW_JMP_DIRECT || instruction.flow == NMD_X86_FLOW_CALL_DIRECT )
+			{
+				mark_target( g, instruction, target );
+
+				if ( contains( g, target ) && !test_bit( g.pinstruction_starts, target - g.base ) && !g.queue.push( target ) )
+					return false;
+			}
+
+			if ( ends_block( instruction ) )
+			{
+				// The not-taken side of a conditional branch starts a new block
+				if ( instruction.flow == NMD_X86_FLOW_JCC )
+				{
+					if ( contains( g, next ) )
+						set_bit( g.pblock_starts, next - g.base );
+				}
+				else
+					break;
+			}
+
+			address = next;
+		}
+	}
+
+	return build_blocks( g ) && build_functions( g );
+}
+
+// Decodes every instruction in [start, end). Bytes that don't decode are skipped one at a time
+bool disasm::linear_sweep( graph& g, uintptr_t start, uintptr_t end )
+{
+	if ( !contains( g, start ) )
+		return false;
+
+	if ( end > g.base + g.size )
+		end = g.base + g.size;
+
+	for ( auto address = start; address < end; )
+	{
+		nmd_x86_instruction_lite instruction;
+		if ( !decode( g, address, instruction ) )
+		{
+			address++;
+			continue;
+		}
+
+		set_bit( g.pinstruction_starts, address - g.base );
+
+		if ( instruction.flow == NMD_X86_FLOW_JCC || instruction.flow == NMD_X86_FLOW_JMP_DIRECT || instruction.flow == NMD_X86_FLOW_CALL_DIRECT )
+			mark_target( g, instruction, address + instruction.relativeTarget );
+
+		address += instruction.length;
+	}
+
+	return build_blocks( g ) && build_functions( g );
+}
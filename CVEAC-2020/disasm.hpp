@@ -0,0 +1,104 @@
+#pragma once
+
+#include <ntddk.h>
+
+// Control flow recovery on top of the nmd decoder. Instructions are discovered with recursive descent from a set of
+// entry points and/or with a linear sweep over a range, then split into basic blocks, edges and functions
+namespace disasm
+{
+	constexpr ULONG pool_tag = 'msiD';
+
+	enum class edge_type : unsigned char
+	{
+		fallthrough, // Not-taken side of a conditional branch, or the next block when a block is split by a branch target
+		branch,      // Taken side of a conditional branch
+		jump,        // Direct unconditional jump
+		call         // Direct call. Doesn't end the block
+	};
+
+	struct basic_block
+	{
+		uintptr_t start;
+		uintptr_t end; // One past the last byte of the block's last instruction
+	};
+
+	struct edge
+	{
+		uintptr_t from; // Start of the source block
+		uintptr_t to;
+		edge_type type;
+	};
+
+	struct function
+	{
+		uintptr_t start;
+		uintptr_t end; // One past the end of the highest block reachable from 'start' without following calls
+	};
+
+	// Growable array backed by the non-paged pool
+	template < typename T >
+	struct pool_array
+	{
+		T*     pdata;
+		size_t count;
+		size_t capacity;
+
+		bool push( const T& value )
+		{
+			if ( count == capacity )
+			{
+				const auto new_capacity = capacity ? capacity * 2 : 64;
+				auto*      pnew_data    = static_cast< T* >( ExAllocatePoolWithTag( NonPagedPoolNx, new_capacity * sizeof( T ), pool_tag ) );
+
+				if ( !pnew_data )
+					return false;
+
+				if ( pdata )
+				{
+					RtlCopyMemory( pnew_data, pdata, count * sizeof( T ) );
+					ExFreePoolWithTag( pdata, pool_tag );
+				}
+
+				pdata    = pnew_data;
+				capacity = new_capacity;
+			}
+
+			pdata[ count++ ] = value;
+			return true;
+		}
+
+		void release()
+		{
+			if ( pdata )
+				ExFreePoolWithTag( pdata, pool_tag );
+
+			pdata    = nullptr;
+			count    = 0;
+			capacity = 0;
+		}
+	};
+
+	struct graph
+	{
+		uintptr_t base; // Runtime address of the first byte of the image
+		size_t    size;
+
+		// One bit per image byte
+		unsigned char* pinstruction_starts;
+		unsigned char* pblock_starts;
+		unsigned char* pfunction_starts;
+
+		pool_array< uintptr_t > queue;
+
+		// Filled by recursive_descent and linear_sweep, sorted by address
+		pool_array< basic_block > blocks;
+		pool_array< edge >        edges;
+		pool_array< function >    functions;
+	};
+
+	bool create            ( graph& g, uintptr_t base, size_t size );
+	void destroy           ( graph& g );
+	bool add_entry_point   ( graph& g, uintptr_t address );
+	bool recursive_descent ( graph& g );
+	bool linear_sweep      ( graph& g, uintptr_t start, uintptr_t end );
+}
@@ -161,35 +161,41 @@ bool eac::disable_integrity_check()
 	bool sec_count_check_found = false;
 
 	// Make use of a disassembler to find the correct place to patch
-	while ( nmd_x86_decode_buffer( reinterpret_cast< const void* >( integrity_check_addr ),
-		                       0x1000,
-		                       &instruction,
-		                       NMD_X86_MODE_64,
-		                       NMD_X86_DECODER_FLAGS_ALL ) )
+	while ( nmd_x86_decode_buffer_at( reinterpret_cast< const void* >( integrity_check_addr ),
+		                          0x1000,
+		                          &instruction,
+		                          NMD_X86_MODE_64,
+		                          NMD_X86_DECODER_FLAGS_ALL,
+		                          integrity_check_addr ) )
 	{
 		// Break on ret
-		if ( instruction.id == NMD_X86_INSTRUCTION_RET )
+		if ( instruction.flow == NMD_X86_FLOW_RET )
 			break;
 
 		else if ( !sec_count_check_found )
 		{
 			// Follow only JMP and JNE
-			if ( instruction.id == NMD_X86_INSTRUCTION_JNE || instruction.id == NMD_X86_INSTRUCTION_JMP )
-			     integrity_check_addr += static_cast< int32_t >( instruction.immediate ) + instruction.length;
+			if ( instruction.flow == NMD_X86_FLOW_JMP_DIRECT || instruction.id == NMD_X86_INSTRUCTION_JNE )
+			     integrity_check_addr = instruction.target;
 
 			else
 			{
 				if ( instruction.id == NMD_X86_INSTRUCTION_MOVZX )
 				{
 					// Format current instruction
-					nmd_x86_format_instruction( &instruction, instruction_string, 0, NMD_X86_FORMAT_FLAGS_HEX | 
-								    NMD_X86_FORMAT_FLAGS_POINTER_SIZE | 
-								    NMD_X86_FORMAT_FLAGS_COMMA_SPACES );
-
+					nmd_x86_token tokens[ 16 ];
+					const auto    token_count = nmd_x86_format_instruction_tokens( &instruction, instruction_string, 0, NMD_X86_FORMAT_FLAGS_HEX | 
+												  NMD_X86_FORMAT_FLAGS_POINTER_SIZE | 
+												  NMD_X86_FORMAT_FLAGS_COMMA_SPACES, tokens, 16 );
 
 					// movzx xxx, word ptr [yyy+6]
-					if ( strstr( instruction_string, "+6]" ) )
-						sec_count_check_found = true;
+					for ( size_t i = 2; i < token_count; i++ )
+					{
+						if ( tokens[ i ].type == NMD_X86_TOKEN_TYPE_MEMORY_END &&
+						     tokens[ i - 1 ].type == NMD_X86_TOKEN_TYPE_IMMEDIATE && tokens[ i - 1 ].length == 1 && instruction_string[ tokens[ i - 1 ].offset ] == '6' &&
+						     tokens[ i - 2 ].type == NMD_X86_TOKEN_TYPE_OPERATOR && instruction_string[ tokens[ i - 2 ].offset ] == '+' )
+							sec_count_check_found = true;
+					}
 				}
 
 				// Go to next instruction
@@ -201,8 +207,8 @@ bool eac::disable_integrity_check()
 		else
 		{
 			// Follow only JMP and JE
-			if ( instruction.id == NMD_X86_INSTRUCTION_JE || instruction.id == NMD_X86_INSTRUCTION_JMP )
-			     integrity_check_addr += static_cast< int32_t >( instruction.immediate ) + instruction.length;
+			if ( instruction.flow == NMD_X86_FLOW_JMP_DIRECT || instruction.id == NMD_X86_INSTRUCTION_JE )
+			     integrity_check_addr = instruction.target;
 
 			else
 			{
@@ -29,6 +29,34 @@ Interfaces(i.e the functions you call from your application):
      - count          [in/out/opt] A pointer to a variable that on input is the maximum number of instructions that can be parsed(or zero for unlimited instructions), and on output is the number of instructions parsed. This parameter may be zero.
     size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uint64_t runtimeAddress, NMD_X86_MODE mode, size_t* const count);
 
+    Assembles instructions that may refer to labels. Returns the number of bytes written to the buffer on success, zero otherwise.
+    Lines are separated like in nmd_x86_assemble(), a line may start with a label definition(e.g. 'loop: dec ecx' or 'end:'). The targets of 'jmp',
+    'jcc' and 'call' can be labels defined anywhere in the string. Branches start with a rel8 displacement and are relaxed to rel32 only when the
+    target is out of range, until the layout does not change.
+    Parameters:
+     - string          [in]      A pointer to a string that represents one or more instructions in assembly language.
+     - buffer          [out]     A pointer to a buffer that receives the encoded instructions.
+     - bufferSize      [in]      The size of the buffer in bytes.
+     - runtimeAddress  [in]      The runtime address of the first instruction.
+     - mode            [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+     - labels          [out]     A pointer to an array of 'maxLabels' elements that receives the labels and their final addresses.
+     - maxLabels       [in]      The number of elements of 'labels'.
+     - numLabels       [out/opt] A pointer to a variable that receives the number of labels. This parameter may be zero.
+     - layout          [out]     A pointer to an array of 'maxInstructions' elements that receives the offset and length of each instruction. It is also used as working memory.
+     - maxInstructions [in]      The number of elements of 'layout'.
+     - numInstructions [out/opt] A pointer to a variable that receives the number of instructions. This parameter may be zero.
+    size_t nmd_x86_assemble_with_labels(const char* string, void* buffer, size_t bufferSize, uint64_t runtimeAddress, NMD_X86_MODE mode, nmd_x86_label* labels, size_t maxLabels, size_t* numLabels, nmd_x86_instruction_layout* layout, size_t maxInstructions, size_t* numInstructions);
+
+    Encodes an instruction from its fields. Returns the number of bytes written to the buffer on success, zero otherwise.
+    The following variables are read: 'mode', 'encoding', 'prefixes', 'segmentOverride', 'simdPrefix', 'repeatPrefix', 'hasRex', 'opcodeMap', 'opcode',
+    'vex', 'evex', 'hasModrm', 'modrm', 'sib', 'displacement', 'immMask' and 'immediate'. Every other variable(e.g. 'id', 'operands' and 'buffer') is ignored.
+    The presence of the SIB byte and the size of the displacement follow from 'modrm', so they stay consistent when 'modrm' is modified.
+    Parameters:
+     - instruction [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction, usually filled by nmd_x86_decode_buffer() and then modified.
+     - buffer      [out] A pointer to a buffer that receives the encoded instruction.
+     - bufferSize  [in]  The size of the buffer in bytes.
+    size_t nmd_x86_encode_instruction(const nmd_x86_instruction* instruction, void* buffer, size_t bufferSize);
+
  - The disassembler is composed of a decoder and a formatter represented by these two functions respectively:
 	- Decodes an instruction. Returns true if the instruction is valid, false otherwise.
       Parameters:
@@ -39,28 +67,116 @@ Interfaces(i.e the functions you call from your application):
        - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
       bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags);
 
+	- Decodes an instruction located at 'runtimeAddress' and fills 'target' with the absolute target of direct branches. Returns true if the instruction is valid, false otherwise.
+      Parameters:
+       - buffer         [in]  A pointer to a buffer containing an encoded instruction.
+       - bufferSize     [in]  The size of the buffer in bytes.
+       - instruction    [out] A pointer to a variable of type 'nmd_x86_instruction' that receives information about the instruction.
+       - mode           [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+       - flags          [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+       - runtimeAddress [in]  The instruction's runtime address.
+      bool nmd_x86_decode_buffer_at(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress);
+
+	- Decodes consecutive instructions. Returns the number of instructions decoded. Decoding stops after 'maxCount' instructions, at the end of the buffer or at the first invalid instruction.
+      Parameters:
+       - buffer         [in]      A pointer to a buffer containing one or more encoded instructions.
+       - bufferSize     [in]      The size of the buffer in bytes.
+       - runtimeAddress [in]      The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS', in which case 'target' is not filled.
+       - instructions   [out]     A pointer to an array of at least 'maxCount' elements of type 'nmd_x86_instruction' that receives the decoded instructions.
+       - maxCount       [in]      The maximum number of instructions to decode.
+       - mode           [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+       - flags          [in]      A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+       - numBytes       [out/opt] A pointer to a variable that receives the number of bytes decoded. This parameter may be zero.
+      size_t nmd_x86_decode_buffer_batch(const void* buffer, size_t bufferSize, uint64_t runtimeAddress, nmd_x86_instruction* instructions, size_t maxCount, NMD_X86_MODE mode, uint32_t flags, size_t* numBytes);
+
+	- Decodes an instruction into a compact 16 byte record. Returns true if the instruction is valid, false otherwise.
+      Parameters:
+       - buffer      [in]  A pointer to a buffer containing an encoded instruction.
+       - bufferSize  [in]  The size of the buffer in bytes.
+       - instruction [out] A pointer to a variable of type 'nmd_x86_instruction_lite' that receives information about the instruction.
+       - mode        [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+       - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. Only the validity check, instruction id, VEX, EVEX and 3DNow! features are used.
+      bool nmd_x86_decode_buffer_lite(const void* buffer, size_t bufferSize, nmd_x86_instruction_lite* instruction, NMD_X86_MODE mode, uint32_t flags);
+
     - Formats an instruction. This function may cause a crash if you modify 'instruction' manually.
       Parameters:
        - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
-       - buffer         [out] A pointer to buffer that receives the string. The buffer's recommended size is 128 bytes.
+       - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
        - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
        - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
       void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char buffer[], uint64_t runtimeAddress, uint32_t formatFlags);
 
- - The emulator is represented by the following function:
-    Emulates x86 code according to the state of the cpu. You MUST initialize the following variables before calling this
-    function: 'cpu->mode', 'cpu->physicalMemory', 'cpu->physicalMemorySize', 'cpu->virtualAddress' and 'cpu->rip'.
-    You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a short description of each variable:
-     - 'cpu->mode': The emulator's operating architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
-     - 'cpu->physicalMemory': A pointer to a buffer used as the emulator's memory.
-     - 'cpu->physicalMemorySize': The size of the 'physicalMemory' buffer in bytes.
-     - 'cpu->virtualAddress': The starting address of the emulator's virtual address space.
-     - 'cpu->rip': The virtual address where emulation starts.
-     - 'cpu->rsp': The virtual address of the bottom of the stack.
-    Parameters:
-     - cpu      [in] A pointer to a variable of type 'nmd_x86_cpu' that holds the state of the cpu.
-     - maxCount [in] The maximum number of instructions that can be executed, or zero for unlimited instructions.
-    bool nmd_x86_emulate(nmd_x86_cpu* cpu, size_t maxCount);
+    - Formats an instruction like nmd_x86_format_instruction() and splits the string into tokens, so the text does not have to be parsed again.
+      Returns the number of tokens. Tokens that do not fit in 'tokens' are dropped.
+      Parameters:
+       - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
+       - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
+       - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+       - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+       - tokens         [out] A pointer to an array of 'maxTokens' tokens that receives the tokens in the order they appear in the string.
+       - maxTokens      [in]  The number of elements of 'tokens'.
+      size_t nmd_x86_format_instruction_tokens(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_token* tokens, size_t maxTokens);
+
+    - Formats consecutive instructions as a listing, one instruction per line. Returns the number of lines formatted, not counting the lines of a call to 'flush' that returned false.
+      Parameters:
+       - instructions   [in]     A pointer to an array of 'count' decoded instructions(e.g. filled by nmd_x86_decode_buffer_batch()). Formatting stops at the first invalid instruction, since the runtime addresses of the instructions after it are unknown.
+       - count          [in]     The number of instructions.
+       - buffer         [out]    A pointer to a buffer that receives the lines.
+       - bufferSize     [in]     The size of the buffer in bytes. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' + 1 bytes.
+       - runtimeAddress [in]     The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+       - formatFlags    [in]     A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instructions. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+       - flush          [in/opt] A callback that receives the text in 'buffer' whenever the next line does not fit and once at the end, then 'buffer' is reused.
+                                 Formatting stops if it returns false. If this parameter is zero, formatting stops when 'buffer' is full and 'buffer' holds the null-terminated listing.
+       - userData       [in/opt] A pointer passed to 'flush'.
+      size_t nmd_x86_format_buffer(const nmd_x86_instruction* instructions, size_t count, char* buffer, size_t bufferSize, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_format_flush_callback flush, void* userData);
+
+ - The emulator is represented by the following functions:
+    - Emulates x86 code according to the state of the cpu. You MUST initialize the following variables before calling this
+      function: 'cpu->mode', 'cpu->rip' and either 'cpu->physicalMemory', 'cpu->physicalMemorySize' and 'cpu->virtualAddress' or 'cpu->pages' and 'cpu->numPages'.
+      You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a short description of each variable:
+       - 'cpu->mode': The emulator's operating architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+       - 'cpu->physicalMemory': A pointer to a buffer used as the emulator's memory.
+       - 'cpu->physicalMemorySize': The size of the 'physicalMemory' buffer in bytes.
+       - 'cpu->virtualAddress': The starting address of the emulator's virtual address space.
+       - 'cpu->rip': The virtual address where emulation starts.
+       - 'cpu->rsp': The virtual address of the bottom of the stack.
+       - 'cpu->blockCache' and 'cpu->blockCacheSize': An optional zero-initialized array of blocks and its number of elements. If present, each basic block
+         is decoded once and then executed from the cache for as long as its bytes in memory do not change. A write to the block being executed ends it
+         after the instruction that wrote to it, so the following instructions are decoded again. Keep the array between calls to reuse it.
+       - 'cpu->pages' and 'cpu->numPages': An optional zero-initialized array of pages and its number of elements that replaces 'physicalMemory'. The
+         address space is then sparse: map the ranges the code may access with nmd_x86_emulator_map() and copy the code with nmd_x86_emulator_write().
+         A page takes an element of the array when it is first accessed.
+      Instructions the emulator doesn't implement yet raise 'NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION' and stop emulation, like instructions that cannot be decoded.
+      Parameters:
+       - cpu      [in] A pointer to a variable of type 'nmd_x86_cpu' that holds the state of the cpu.
+       - maxCount [in] The maximum number of instructions that can be executed, or zero for unlimited instructions.
+      bool nmd_x86_emulate(nmd_x86_cpu* cpu, size_t maxCount);
+
+    - Maps a range of the emulator's virtual address space to 'cpu->pages'. A page of the range takes an element of 'cpu->pages' only when it is first accessed.
+      Mapping a range again changes its permissions. Overlapping and adjacent ranges with the same permissions are merged into one region. Returns true on success,
+      false if 'cpu->pages' is null or empty or the mapping would need more than 'NMD_X86_EMULATOR_MAX_REGIONS' regions.
+      Parameters:
+       - cpu         [in] A pointer to a variable of type 'nmd_x86_cpu' whose 'pages' and 'numPages' are initialized.
+       - address     [in] The virtual address of the range. It is rounded down to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+       - size        [in] The size of the range in bytes. It is rounded up to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+       - permissions [in] A mask of 'NMD_X86_EMULATOR_PAGE_XXX' that specifies how the emulated code may access the range.
+      bool nmd_x86_emulator_map(nmd_x86_cpu* cpu, uint64_t address, uint64_t size, uint8_t permissions);
+
+    - Copies a buffer to the emulator's memory regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+      Parameters:
+       - cpu     [in] A pointer to a variable of type 'nmd_x86_cpu'.
+       - address [in] The virtual address where the bytes are copied to.
+       - buffer  [in] A pointer to the bytes to copy.
+       - size    [in] The number of bytes to copy.
+      bool nmd_x86_emulator_write(nmd_x86_cpu* cpu, uint64_t address, const void* buffer, size_t size);
+
+    - Copies the emulator's memory to a buffer regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+      Parameters:
+       - cpu     [in]  A pointer to a variable of type 'nmd_x86_cpu'.
+       - address [in]  The virtual address where the bytes are copied from.
+       - buffer  [out] A pointer to a buffer that receives the bytes.
+       - size    [in]  The number of bytes to copy.
+      bool nmd_x86_emulator_read(nmd_x86_cpu* cpu, uint64_t address, void* buffer, size_t size);
 
  - The length disassembler is represented by the following function:
     Returns the length of the instruction if it is valid, zero otherwise.
@@ -72,16 +188,19 @@ Interfaces(i.e the functions you call from your application):
 
 Enabling and disabling features of the decoder:
 To dynamically choose which features are used by the decoder, use the 'flags' parameter of nmd_x86_decode_buffer(). The less features specified in the mask, the
-faster the decoder runs. By default all features are available, some can be completely disabled at compile time(thus reducing code size and increasing code speed) by defining
+faster the decoder runs. To choose them statically for a single call site, define a specialized decoder with the 'NMD_X86_DEFINE_DECODER' macro(see its
+declaration), which removes every check on the architecture mode and flags at compile time. By default all features are available, some can be completely disabled at compile time(thus reducing code size and increasing code speed) by defining
 the following macros(in the same place the macro 'NMD_ASSEMBLY_IMPLEMENTATION' is defined):
  - 'NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK': the decoder does not check if the instruction is invalid.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID': the decoder does not fill the 'id' variable.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS': the decoder does not fill the 'cpuFlags' variable.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS': the decoder does not fill the 'numOperands' and 'operands' variable.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_GROUP': the decoder does not fill the 'group' variable.
+ - 'NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS': the decoder does not fill the 'regsRead' and 'regsWritten' variables.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_VEX': the decoder does not support VEX instructions.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_EVEX': the decoder does not support EVEX instructions.
  - 'NMD_ASSEMBLY_DISABLE_DECODER_3DNOW': the decoder does not support 3DNow! instructions.
+ - 'NMD_ASSEMBLY_DISABLE_SSE2': the decoder and the length disassembler do not use SSE2 to parse prefixes. SSE2 is only used if the compiler targets it and 'NMD_ASSEMBLY_NO_INCLUDES' is not defined.
 
 Enabling and disabling features of the formatter:
 To dynamically choose which features are used by the formatter, use the 'formatFlags' parameter of nmd_x86_format_instruction(). The less features specified in the mask, the
@@ -101,8 +220,13 @@ Enabling and disabling feature of the length disassembler:
 Use the following macros to disable features at compile-time:
  - 'NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK': the length disassembler does not check if the instruction is invalid.
  - 'NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX': the length disassembler does not support VEX instructions.
+ - 'NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_EVEX': the length disassembler does not support EVEX instructions.
  - 'NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_3DNOW': the length disassembler does not support 3DNow! instructions.
 
+Enabling and disabling features of the emulator:
+Use the following macros to disable features at compile-time:
+ - 'NMD_ASSEMBLY_DISABLE_COMPUTED_GOTO': the emulator dispatches instructions with a switch statement. Computed goto('&&label') is only used if the compiler supports it(GCC and Clang).
+
 Conventions:
  - Every identifier uses snake case.
  - Enums and macros are uppercase, every other identifier is lowercase.
@@ -111,7 +235,7 @@ Conventions:
 
 TODO:
  Short-Term
-  - implement instruction set extensions to the decoder : VEX, EVEX, MVEX, 3DNOW, XOP.
+  - implement instruction set extensions to the decoder : MVEX, XOP.
   - Implement x86 assembler and emulator.
  Long-Term
   - Add support for other architectures(ARM, MIPS and PowerPC ?).
@@ -137,7 +261,11 @@ Contributors(This may not be a complete list):
 #ifndef NMD_ASSEMBLY_H
 #define NMD_ASSEMBLY_H
 
-#define NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH 128
+/*
+The size of a buffer that holds any formatted instruction, including the null terminator. The longest lines are EVEX instructions
+with their bytes, three segment prefixes, a {k}{z} mask, a long mnemonic and a broadcast memory operand, which take about 140 characters.
+*/
+#define NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH 256
 
 #ifdef NMD_ASSEMBLY_NO_INCLUDES
 
@@ -193,9 +321,25 @@ typedef unsigned long long uint64_t;
 #define NMD_X86_FORMATTER_NUM_PADDING_BYTES 10
 #endif /* NMD_X86_FORMATTER_NUM_PADDING_BYTES */
 
+/* The maximum number of instructions in a basic block of the emulator's block cache. */
+#ifndef NMD_X86_EMULATOR_BLOCK_LENGTH
+#define NMD_X86_EMULATOR_BLOCK_LENGTH 16
+#endif /* NMD_X86_EMULATOR_BLOCK_LENGTH */
+
+/* The number of entries of the emulator's translation lookaside buffer, which caches recently accessed pages of 'cpu->pages'. */
+#ifndef NMD_X86_EMULATOR_TLB_SIZE
+#define NMD_X86_EMULATOR_TLB_SIZE 16
+#endif /* NMD_X86_EMULATOR_TLB_SIZE */
+
+/* The maximum number of regions that can be mapped with nmd_x86_emulator_map(). */
+#ifndef NMD_X86_EMULATOR_MAX_REGIONS
+#define NMD_X86_EMULATOR_MAX_REGIONS 16
+#endif /* NMD_X86_EMULATOR_MAX_REGIONS */
+
 #define NMD_X86_INVALID_RUNTIME_ADDRESS -1
 #define NMD_X86_MAXIMUM_INSTRUCTION_LENGTH 15
 #define NMD_X86_MAXIMUM_NUM_OPERANDS 4
+#define NMD_X86_EMULATOR_PAGE_SIZE 4096
 
 /* These flags specify how the formatter should work. */
 enum NMD_X86_FORMATTER_FLAGS
@@ -231,11 +375,12 @@ enum NMD_X86_DECODER_FLAGS
 	NMD_X86_DECODER_FLAGS_VEX            = (1 << 5), /* The decoder parses VEX instructions. */
 	NMD_X86_DECODER_FLAGS_EVEX           = (1 << 6), /* The decoder parses EVEX instructions. */
 	NMD_X86_DECODER_FLAGS_3DNOW          = (1 << 7), /* The decoder parses 3DNow! instructions. */
+	NMD_X86_DECODER_FLAGS_REGISTERS      = (1 << 8), /* The decoder fills the 'regsRead' and 'regsWritten' variables. Implies 'NMD_X86_DECODER_FLAGS_CPU_FLAGS'. */
 
 	/* These are not actual features, but rather masks of features. */
 	NMD_X86_DECODER_FLAGS_NONE    = 0,
 	NMD_X86_DECODER_FLAGS_MINIMAL = (NMD_X86_DECODER_FLAGS_VALIDITY_CHECK | NMD_X86_DECODER_FLAGS_VEX | NMD_X86_DECODER_FLAGS_EVEX), /* Mask that specifies minimal features to provide acurate results in any environment. */
-	NMD_X86_DECODER_FLAGS_ALL     = (1 << 8) - 1, /* Mask that specifies all features. */
+	NMD_X86_DECODER_FLAGS_ALL     = (1 << 9) - 1, /* Mask that specifies all features. */
 };
 
 enum NMD_X86_PREFIXES
@@ -330,6 +475,7 @@ enum NMD_X86_ENCODING
 	/* NMD_X86_ENCODING_MVEX,     MVEX used by Intel's "Xeon Phi" ISA. */
 };
 
+/* The fields of a VEX prefix as they are encoded, that is, 'R', 'X', 'B' and 'vvvv' are inverted. */
 typedef struct nmd_x86_vex
 {
 	bool R : 1;
@@ -343,6 +489,26 @@ typedef struct nmd_x86_vex
 	uint8_t vex[3]; /* The full vex prefix. vex[0] is either C4h(3-byte VEX) or C5h(2-byte VEX).*/
 } nmd_x86_vex;
 
+/* The fields of an EVEX prefix as they are encoded, that is, 'R', 'X', 'B', 'R1', 'V1' and 'vvvv' are inverted. */
+typedef struct nmd_x86_evex
+{
+	bool R : 1;
+	bool X : 1;
+	bool B : 1;
+	bool R1 : 1;        /* R'. Extends the ModR/M.reg field to 32 registers. */
+	bool W : 1;
+	bool z : 1;         /* Zeroing-masking if set, merging-masking otherwise. */
+	bool b : 1;         /* Broadcast for memory operands, embedded rounding or SAE for register operands. */
+	bool V1 : 1;        /* V'. Extends the 'vvvv' field(and the VSIB index) to 32 registers. */
+	uint8_t mmm : 3;
+	uint8_t pp : 2;
+	uint8_t LL : 2;     /* L'L. The vector length, or the rounding control when 'b' is set and there's no memory operand. */
+	uint8_t aaa : 3;    /* The opmask register. */
+	uint8_t vvvv : 4;
+	uint8_t disp8Scale; /* The factor an 8-bit displacement is multiplied by(disp8*N compression). */
+	uint8_t evex[4];    /* The full evex prefix. evex[0] is 62h. */
+} nmd_x86_evex;
+
 typedef enum NMD_X86_REG
 {
 	NMD_X86_REG_NONE = 0,
@@ -375,11 +541,11 @@ typedef enum NMD_X86_REG
 	NMD_X86_REG_EDI,
 
 	NMD_X86_REG_RAX,
-	NMD_X86_REG_RBX,
 	NMD_X86_REG_RCX,
 	NMD_X86_REG_RDX,
-	NMD_X86_REG_RBP,
+	NMD_X86_REG_RBX,
 	NMD_X86_REG_RSP,
+	NMD_X86_REG_RBP,
 	NMD_X86_REG_RSI,
 	NMD_X86_REG_RDI,
 
@@ -578,6 +744,40 @@ typedef enum NMD_X86_REG
 	NMD_X86_REG_ZMM31,
 } NMD_X86_REG;
 
+/*
+Bits of 'regsRead' and 'regsWritten'. General-purpose registers are numbered as in the encoding and cover every width of the register,
+e.g. 'NMD_X86_REGISTER_MASK_RAX' stands for 'al', 'ah', 'ax', 'eax' and 'rax'.
+*/
+enum NMD_X86_REGISTER_MASK
+{
+	NMD_X86_REGISTER_MASK_RAX   = (1 << 0),
+	NMD_X86_REGISTER_MASK_RCX   = (1 << 1),
+	NMD_X86_REGISTER_MASK_RDX   = (1 << 2),
+	NMD_X86_REGISTER_MASK_RBX   = (1 << 3),
+	NMD_X86_REGISTER_MASK_RSP   = (1 << 4),
+	NMD_X86_REGISTER_MASK_RBP   = (1 << 5),
+	NMD_X86_REGISTER_MASK_RSI   = (1 << 6),
+	NMD_X86_REGISTER_MASK_RDI   = (1 << 7),
+	NMD_X86_REGISTER_MASK_R8    = (1 << 8),
+	NMD_X86_REGISTER_MASK_R9    = (1 << 9),
+	NMD_X86_REGISTER_MASK_R10   = (1 << 10),
+	NMD_X86_REGISTER_MASK_R11   = (1 << 11),
+	NMD_X86_REGISTER_MASK_R12   = (1 << 12),
+	NMD_X86_REGISTER_MASK_R13   = (1 << 13),
+	NMD_X86_REGISTER_MASK_R14   = (1 << 14),
+	NMD_X86_REGISTER_MASK_R15   = (1 << 15),
+	NMD_X86_REGISTER_MASK_RIP   = (1 << 16),
+	NMD_X86_REGISTER_MASK_FLAGS = (1 << 17),
+	NMD_X86_REGISTER_MASK_ES    = (1 << 18),
+	NMD_X86_REGISTER_MASK_CS    = (1 << 19),
+	NMD_X86_REGISTER_MASK_SS    = (1 << 20),
+	NMD_X86_REGISTER_MASK_DS    = (1 << 21),
+	NMD_X86_REGISTER_MASK_FS    = (1 << 22),
+	NMD_X86_REGISTER_MASK_GS    = (1 << 23),
+
+	NMD_X86_REGISTER_MASK_GPRS  = (1 << 16) - 1, /* Mask of the sixteen general-purpose registers. */
+};
+
 enum NMD_GROUP {
 	NMD_GROUP_NONE = 0, /* The instruction is not part of any group. */
 
@@ -2208,6 +2408,137 @@ enum NMD_X86_INSTRUCTION
 	NMD_X86_INSTRUCTION_UD0,
 	NMD_X86_INSTRUCTION_ENDBR32,
 	NMD_X86_INSTRUCTION_ENDBR64,
+
+	/* AVX-512 and opmask instructions. */
+	NMD_X86_INSTRUCTION_KADDB,
+	NMD_X86_INSTRUCTION_KADDD,
+	NMD_X86_INSTRUCTION_KADDQ,
+	NMD_X86_INSTRUCTION_KADDW,
+	NMD_X86_INSTRUCTION_KTESTB,
+	NMD_X86_INSTRUCTION_KTESTD,
+	NMD_X86_INSTRUCTION_KTESTQ,
+	NMD_X86_INSTRUCTION_KTESTW,
+	NMD_X86_INSTRUCTION_KUNPCKDQ,
+	NMD_X86_INSTRUCTION_KUNPCKWD,
+	NMD_X86_INSTRUCTION_VBROADCASTF32X2,
+	NMD_X86_INSTRUCTION_VBROADCASTF32X4,
+	NMD_X86_INSTRUCTION_VBROADCASTF32X8,
+	NMD_X86_INSTRUCTION_VBROADCASTF64X2,
+	NMD_X86_INSTRUCTION_VBROADCASTF64X4,
+	NMD_X86_INSTRUCTION_VBROADCASTI128,
+	NMD_X86_INSTRUCTION_VBROADCASTI32X2,
+	NMD_X86_INSTRUCTION_VBROADCASTI32X8,
+	NMD_X86_INSTRUCTION_VBROADCASTI64X2,
+	NMD_X86_INSTRUCTION_VCVTPD2QQ,
+	NMD_X86_INSTRUCTION_VCVTPD2UQQ,
+	NMD_X86_INSTRUCTION_VCVTPS2QQ,
+	NMD_X86_INSTRUCTION_VCVTPS2UQQ,
+	NMD_X86_INSTRUCTION_VCVTQQ2PD,
+	NMD_X86_INSTRUCTION_VCVTQQ2PS,
+	NMD_X86_INSTRUCTION_VCVTTPD2QQ,
+	NMD_X86_INSTRUCTION_VCVTTPD2UQQ,
+	NMD_X86_INSTRUCTION_VCVTTPS2QQ,
+	NMD_X86_INSTRUCTION_VCVTTPS2UQQ,
+	NMD_X86_INSTRUCTION_VCVTUQQ2PD,
+	NMD_X86_INSTRUCTION_VCVTUQQ2PS,
+	NMD_X86_INSTRUCTION_VDBPSADBW,
+	NMD_X86_INSTRUCTION_VEXTRACTF32X8,
+	NMD_X86_INSTRUCTION_VEXTRACTF64X2,
+	NMD_X86_INSTRUCTION_VEXTRACTI32X8,
+	NMD_X86_INSTRUCTION_VEXTRACTI64X2,
+	NMD_X86_INSTRUCTION_VFIXUPIMMPD,
+	NMD_X86_INSTRUCTION_VFIXUPIMMPS,
+	NMD_X86_INSTRUCTION_VFIXUPIMMSD,
+	NMD_X86_INSTRUCTION_VFIXUPIMMSS,
+	NMD_X86_INSTRUCTION_VFPCLASSPD,
+	NMD_X86_INSTRUCTION_VFPCLASSPS,
+	NMD_X86_INSTRUCTION_VFPCLASSSD,
+	NMD_X86_INSTRUCTION_VFPCLASSSS,
+	NMD_X86_INSTRUCTION_VGETEXPPD,
+	NMD_X86_INSTRUCTION_VGETEXPPS,
+	NMD_X86_INSTRUCTION_VGETEXPSD,
+	NMD_X86_INSTRUCTION_VGETEXPSS,
+	NMD_X86_INSTRUCTION_VGETMANTPD,
+	NMD_X86_INSTRUCTION_VGETMANTPS,
+	NMD_X86_INSTRUCTION_VGETMANTSD,
+	NMD_X86_INSTRUCTION_VGETMANTSS,
+	NMD_X86_INSTRUCTION_VGF2P8AFFINEINVQB,
+	NMD_X86_INSTRUCTION_VGF2P8AFFINEQB,
+	NMD_X86_INSTRUCTION_VGF2P8MULB,
+	NMD_X86_INSTRUCTION_VPCOMPRESSB,
+	NMD_X86_INSTRUCTION_VPCOMPRESSW,
+	NMD_X86_INSTRUCTION_VPDPBUSD,
+	NMD_X86_INSTRUCTION_VPDPBUSDS,
+	NMD_X86_INSTRUCTION_VPDPWSSD,
+	NMD_X86_INSTRUCTION_VPDPWSSDS,
+	NMD_X86_INSTRUCTION_VPERMB,
+	NMD_X86_INSTRUCTION_VPERMI2B,
+	NMD_X86_INSTRUCTION_VPERMI2W,
+	NMD_X86_INSTRUCTION_VPERMT2B,
+	NMD_X86_INSTRUCTION_VPERMT2W,
+	NMD_X86_INSTRUCTION_VPERMW,
+	NMD_X86_INSTRUCTION_VPEXPANDB,
+	NMD_X86_INSTRUCTION_VPEXPANDW,
+	NMD_X86_INSTRUCTION_VPMADD52HUQ,
+	NMD_X86_INSTRUCTION_VPMADD52LUQ,
+	NMD_X86_INSTRUCTION_VPMOVB2M,
+	NMD_X86_INSTRUCTION_VPMOVD2M,
+	NMD_X86_INSTRUCTION_VPMOVQ2M,
+	NMD_X86_INSTRUCTION_VPMOVSWB,
+	NMD_X86_INSTRUCTION_VPMOVUSWB,
+	NMD_X86_INSTRUCTION_VPMOVW2M,
+	NMD_X86_INSTRUCTION_VPMOVWB,
+	NMD_X86_INSTRUCTION_VPMULTISHIFTQB,
+	NMD_X86_INSTRUCTION_VPOPCNTB,
+	NMD_X86_INSTRUCTION_VPOPCNTD,
+	NMD_X86_INSTRUCTION_VPOPCNTQ,
+	NMD_X86_INSTRUCTION_VPOPCNTW,
+	NMD_X86_INSTRUCTION_VPROLD,
+	NMD_X86_INSTRUCTION_VPROLQ,
+	NMD_X86_INSTRUCTION_VPROLVD,
+	NMD_X86_INSTRUCTION_VPROLVQ,
+	NMD_X86_INSTRUCTION_VPRORD,
+	NMD_X86_INSTRUCTION_VPRORQ,
+	NMD_X86_INSTRUCTION_VPRORVD,
+	NMD_X86_INSTRUCTION_VPRORVQ,
+	NMD_X86_INSTRUCTION_VPSHLDD,
+	NMD_X86_INSTRUCTION_VPSHLDQ,
+	NMD_X86_INSTRUCTION_VPSHLDVD,
+	NMD_X86_INSTRUCTION_VPSHLDVQ,
+	NMD_X86_INSTRUCTION_VPSHLDVW,
+	NMD_X86_INSTRUCTION_VPSHLDW,
+	NMD_X86_INSTRUCTION_VPSHRDD,
+	NMD_X86_INSTRUCTION_VPSHRDQ,
+	NMD_X86_INSTRUCTION_VPSHRDVD,
+	NMD_X86_INSTRUCTION_VPSHRDVQ,
+	NMD_X86_INSTRUCTION_VPSHRDVW,
+	NMD_X86_INSTRUCTION_VPSHRDW,
+	NMD_X86_INSTRUCTION_VPSHUFBITQMB,
+	NMD_X86_INSTRUCTION_VPSLLVW,
+	NMD_X86_INSTRUCTION_VPSRAVW,
+	NMD_X86_INSTRUCTION_VPSRLVW,
+	NMD_X86_INSTRUCTION_VPTERNLOGD,
+	NMD_X86_INSTRUCTION_VPTERNLOGQ,
+	NMD_X86_INSTRUCTION_VPTESTMB,
+	NMD_X86_INSTRUCTION_VPTESTMW,
+	NMD_X86_INSTRUCTION_VPTESTNMB,
+	NMD_X86_INSTRUCTION_VPTESTNMW,
+	NMD_X86_INSTRUCTION_VRANGEPD,
+	NMD_X86_INSTRUCTION_VRANGEPS,
+	NMD_X86_INSTRUCTION_VRANGESD,
+	NMD_X86_INSTRUCTION_VRANGESS,
+	NMD_X86_INSTRUCTION_VREDUCEPD,
+	NMD_X86_INSTRUCTION_VREDUCEPS,
+	NMD_X86_INSTRUCTION_VREDUCESD,
+	NMD_X86_INSTRUCTION_VREDUCESS,
+	NMD_X86_INSTRUCTION_VSCALEFPD,
+	NMD_X86_INSTRUCTION_VSCALEFPS,
+	NMD_X86_INSTRUCTION_VSCALEFSD,
+	NMD_X86_INSTRUCTION_VSCALEFSS,
+	NMD_X86_INSTRUCTION_VSHUFF32X4,
+	NMD_X86_INSTRUCTION_VSHUFF64X2,
+	NMD_X86_INSTRUCTION_VSHUFI32X4,
+	NMD_X86_INSTRUCTION_VSHUFI64X2,
 };
 
 enum NMD_X86_OPERAND_TYPE
@@ -2342,6 +2673,20 @@ enum NMD_X86_FPU_FLAGS
 	NMD_X86_FPU_FLAGS_C3 = (1 << 14)
 };
 
+/* How an instruction transfers control. Far jumps and calls are reported as indirect because their target is not relative to the instruction. */
+enum NMD_X86_FLOW
+{
+	NMD_X86_FLOW_FALLTHROUGH = 0, /* Execution continues at the next instruction. */
+	NMD_X86_FLOW_JCC,             /* Conditional relative jump(jcc, loopcc, jcxz). */
+	NMD_X86_FLOW_JMP_DIRECT,      /* Relative jump. */
+	NMD_X86_FLOW_JMP_INDIRECT,    /* Jump through a register or memory operand, or far jump. */
+	NMD_X86_FLOW_CALL_DIRECT,     /* Relative call. */
+	NMD_X86_FLOW_CALL_INDIRECT,   /* Call through a register or memory operand, or far call. */
+	NMD_X86_FLOW_RET,             /* ret, retf, iret, sysret and sysexit. */
+	NMD_X86_FLOW_INT,             /* int, int1, int3, into, syscall and sysenter. */
+	NMD_X86_FLOW_TRAP             /* hlt, ud0, ud1 and ud2. */
+};
+
 typedef struct nmd_x86_instruction
 {
 	bool valid : 1;                                        /* If true, the instruction is valid. */
@@ -2355,7 +2700,7 @@ typedef struct nmd_x86_instruction
 	uint8_t opcode;                                        /* Opcode byte. */
 	uint8_t opcodeSize;                                    /* The opcode's size in bytes. */
 	uint16_t id;                                           /* The instruction's identifier. A member of 'NMD_X86_INSTRUCTION'. */
-	uint16_t prefixes;                                     /* A mask of prefixes. See 'NMD_X86_PREFIXES'. */
+	uint16_t prefixes;                                     /* A mask of prefixes. See 'NMD_X86_PREFIXES'. In 64-bit mode the REX bits also reflect the R, X, B and W bits of a VEX or EVEX prefix. */
 	uint8_t numPrefixes;                                   /* Number of prefixes. */
 	uint8_t numOperands;                                   /* The number of operands. */
 	uint8_t group;                                         /* The instruction's group(e.g. jmp, prvileged...). A member of 'NMD_X86_GROUP'. */
@@ -2370,16 +2715,79 @@ typedef struct nmd_x86_instruction
 	uint8_t opcodeMap;                                     /* The instruction's opcode map. A member of 'NMD_X86_OPCODE_MAP'. */
 	uint8_t encoding;                                      /* The instruction's encoding. A member of 'NMD_X86_INSTRUCTION_ENCODING'. */
 	nmd_x86_vex vex;                                        /* VEX prefix. */
+	nmd_x86_evex evex;                                      /* EVEX prefix. */
 	nmd_x86_cpu_flags modifiedFlags;                         /* Cpu flags modified by the instruction. */
 	nmd_x86_cpu_flags testedFlags;                           /* Cpu flags tested by the instruction. */
 	nmd_x86_cpu_flags setFlags;                              /* Cpu flags set by the instruction. */
 	nmd_x86_cpu_flags clearedFlags;                          /* Cpu flags cleared by the instruction. */
 	nmd_x86_cpu_flags undefinedFlags;                        /* Cpu flags whose state is undefined. */
+	uint32_t regsRead;                                     /* Registers read by the instruction, explicitly or implicitly. A mask of 'NMD_X86_REGISTER_MASK'. */
+	uint32_t regsWritten;                                  /* Registers written by the instruction, explicitly or implicitly. A mask of 'NMD_X86_REGISTER_MASK'. */
 	uint8_t rex;                                           /* REX prefix. */
 	uint8_t segmentOverride;                               /* The segment override prefix closest to the opcode. A member of 'NMD_X86_PREFIXES'. */
+	uint8_t flow;                                          /* How the instruction transfers control. A member of 'NMD_X86_FLOW'. */
+	int32_t relativeTarget;                                /* The branch target relative to the start of the instruction. Only valid if 'flow' is 'NMD_X86_FLOW_JCC', 'NMD_X86_FLOW_JMP_DIRECT' or 'NMD_X86_FLOW_CALL_DIRECT'. */
+	uint64_t target;                                       /* The absolute branch target. Only filled by nmd_x86_decode_buffer_at(), under the same conditions as 'relativeTarget'. */
 	uint16_t simdPrefix;                                   /* Either one of these prefixes that is the closest to the opcode: NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE, NMD_X86_PREFIXES_LOCK, NMD_X86_PREFIXES_REPEAT_NOT_ZERO, NMD_X86_PREFIXES_REPEAT, or NMD_X86_PREFIXES_NONE. The prefixes are specified as members of the 'NMD_X86_PREFIXES' enum. */
 } nmd_x86_instruction;
 
+/* A 16 byte summary of an instruction for callers that store a large number of decoded instructions. */
+typedef struct nmd_x86_instruction_lite
+{
+	uint16_t id;            /* The instruction's identifier. A member of 'NMD_X86_INSTRUCTION'. */
+	uint16_t prefixes;      /* A mask of prefixes. See 'NMD_X86_PREFIXES'. */
+	uint8_t length;         /* The instruction's length in bytes. */
+	uint8_t opcode;         /* Opcode byte. */
+	uint8_t opcodeMap;      /* The instruction's opcode map. A member of 'NMD_X86_OPCODE_MAP'. */
+	uint8_t flow;           /* How the instruction transfers control. A member of 'NMD_X86_FLOW'. */
+	uint8_t encoding;       /* The instruction's encoding. A member of 'NMD_X86_INSTRUCTION_ENCODING'. */
+	uint8_t numPrefixes;    /* Number of prefixes. */
+	nmd_x86_modrm modrm;    /* The Mod/RM byte, or zero if the instruction does not have one. */
+	uint8_t reserved;
+	int32_t relativeTarget; /* The branch target relative to the start of the instruction. Only valid if 'flow' is 'NMD_X86_FLOW_JCC', 'NMD_X86_FLOW_JMP_DIRECT' or 'NMD_X86_FLOW_CALL_DIRECT'. */
+} nmd_x86_instruction_lite;
+
+/* The kind of a piece of formatted text. See nmd_x86_format_instruction_tokens(). */
+enum NMD_X86_TOKEN_TYPE
+{
+	NMD_X86_TOKEN_TYPE_NONE = 0,
+	NMD_X86_TOKEN_TYPE_BYTES,        /* The instruction's bytes(NMD_X86_FORMAT_FLAGS_BYTES). */
+	NMD_X86_TOKEN_TYPE_PREFIX,       /* e.g. 'lock', 'rep', 'bnd'. */
+	NMD_X86_TOKEN_TYPE_MNEMONIC,
+	NMD_X86_TOKEN_TYPE_REGISTER,     /* e.g. 'eax', 'st(1)', '%eax'. */
+	NMD_X86_TOKEN_TYPE_IMMEDIATE,    /* Any number: immediates, displacements, scales and branch targets. Includes the '$' of AT&T syntax. */
+	NMD_X86_TOKEN_TYPE_MEMORY_BEGIN, /* '[', or '(' in AT&T syntax. */
+	NMD_X86_TOKEN_TYPE_MEMORY_END,   /* ']', or ')' in AT&T syntax. */
+	NMD_X86_TOKEN_TYPE_SEPARATOR,    /* The ',' between two operands. */
+	NMD_X86_TOKEN_TYPE_OPERATOR,     /* '+', '-', '*', ':', the ',' inside an AT&T memory operand and the parenthesis around signed number hints. */
+	NMD_X86_TOKEN_TYPE_KEYWORD       /* 'ptr', pointer sizes(e.g. 'dword') and 'far'. */
+};
+
+/* A label defined in the source of nmd_x86_assemble_with_labels(), e.g. 'loop:'. */
+typedef struct nmd_x86_label
+{
+	const char* name;        /* A pointer to the label's name in the source string. It is not null-terminated. */
+	size_t nameLength;       /* The length of the name in characters. */
+	size_t instructionIndex; /* The index of the instruction that follows the label. */
+	uint64_t address;        /* The label's runtime address in the final layout. */
+} nmd_x86_label;
+
+/* The position of an instruction assembled by nmd_x86_assemble_with_labels(). */
+typedef struct nmd_x86_instruction_layout
+{
+	uint32_t offset; /* The instruction's offset from the start of the buffer. */
+	uint8_t length;  /* The instruction's length in bytes. */
+	bool relaxed;    /* If true, the instruction is a branch whose rel8 displacement was relaxed to rel32. */
+} nmd_x86_instruction_layout;
+
+/* A piece of a formatted instruction string. Whitespace is not part of any token. */
+typedef struct nmd_x86_token
+{
+	uint8_t type;   /* A member of 'NMD_X86_TOKEN_TYPE'. */
+	uint8_t offset; /* The offset of the token's first character in the string. */
+	uint8_t length; /* The token's length in characters. */
+} nmd_x86_token;
+
 typedef enum NMD_X86_EMULATOR_EXCEPTION
 {
 	NMD_X86_EMULATOR_EXCEPTION_NONE = 0,
@@ -2389,9 +2797,21 @@ typedef enum NMD_X86_EMULATOR_EXCEPTION
 	NMD_X86_EMULATOR_EXCEPTION_GENERAL_PROTECTION,
 	NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION,
 	NMD_X86_EMULATOR_EXCEPTION_BAD_MEMORY,
-	NMD_X86_EMULATOR_EXCEPTION_STEP
+	NMD_X86_EMULATOR_EXCEPTION_STEP,
+	NMD_X86_EMULATOR_EXCEPTION_DIVIDE, /* #DE generated by div and idiv */
+	NMD_X86_EMULATOR_EXCEPTION_INTERRUPT /* Generated by int n, the vector is 'instruction->immediate' */
 } NMD_X86_EMULATOR_EXCEPTION;
 
+/* Specifies how the emulated code may access a page of the emulator's memory. */
+enum NMD_X86_EMULATOR_PAGE
+{
+	NMD_X86_EMULATOR_PAGE_READ    = (1 << 0),
+	NMD_X86_EMULATOR_PAGE_WRITE   = (1 << 1),
+	NMD_X86_EMULATOR_PAGE_EXECUTE = (1 << 2),
+
+	NMD_X86_EMULATOR_PAGE_ALL = NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE | NMD_X86_EMULATOR_PAGE_EXECUTE
+};
+
 typedef union nmd_x86_register
 {
 	int8_t  h8;
@@ -2408,6 +2828,42 @@ typedef union nmd_x86_register_512
 	uint64_t zmm0[8];
 } nmd_x86_register_512;
 
+/* A basic block decoded by the emulator. See 'blockCache' in 'nmd_x86_cpu'. */
+typedef struct nmd_x86_emulator_block
+{
+	uint64_t address;        /* The virtual address of the first instruction. */
+	uint16_t numBytes;       /* The size of the block in bytes. */
+	uint8_t numInstructions; /* The number of instructions, or zero if the block is empty. */
+	nmd_x86_instruction instructions[NMD_X86_EMULATOR_BLOCK_LENGTH];
+} nmd_x86_emulator_block;
+
+/* A page of the emulator's memory. See 'pages' in 'nmd_x86_cpu'. */
+typedef struct nmd_x86_emulator_page
+{
+	uint64_t address;    /* The virtual address of the page, a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'. */
+	bool present;        /* If true, the page is in use, false otherwise. */
+	uint8_t permissions; /* A mask of 'NMD_X86_EMULATOR_PAGE_XXX'. */
+	uint8_t data[NMD_X86_EMULATOR_PAGE_SIZE];
+} nmd_x86_emulator_page;
+
+/* A range of virtual addresses mapped by nmd_x86_emulator_map(). */
+typedef struct nmd_x86_emulator_region
+{
+	uint64_t address;    /* The virtual address of the range, a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'. */
+	uint64_t size;       /* The size of the range in bytes, a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'. */
+	uint8_t permissions; /* A mask of 'NMD_X86_EMULATOR_PAGE_XXX'. */
+} nmd_x86_emulator_region;
+
+/* The last instruction that modified the arithmetic flags. See 'lazyFlags' in 'nmd_x86_cpu'. */
+typedef struct nmd_x86_lazy_flags
+{
+	uint64_t dst;      /* The destination operand before the operation. */
+	uint64_t src;      /* The source operand, or the preserved carry flag for inc and dec. */
+	uint64_t result;   /* The result of the operation. */
+	uint8_t operation; /* The kind of operation, or zero if 'flags' is up to date. */
+	uint8_t size;      /* The size of the operands in bytes. */
+} nmd_x86_lazy_flags;
+
 typedef struct nmd_x86_cpu
 {
 	bool running; /* If true, the emulator is running, false otherwise. */
@@ -2423,12 +2879,34 @@ typedef struct nmd_x86_cpu
 
 	void* userdata;
 
+	nmd_x86_emulator_block* blockCache; /* Optional. A pointer to a zero-initialized array of 'blockCacheSize' blocks that keeps decoded basic blocks between executions. */
+	size_t blockCacheSize; /* The number of elements of 'blockCache'. */
+
+	nmd_x86_emulator_page* pages; /* Optional. A pointer to a zero-initialized array of 'numPages' pages. If present, it replaces 'physicalMemory' with a sparse address space, see nmd_x86_emulator_map(). */
+	size_t numPages; /* The number of elements of 'pages'. */
+
+	nmd_x86_emulator_region regions[NMD_X86_EMULATOR_MAX_REGIONS]; /* Internal. The regions mapped by nmd_x86_emulator_map(). */
+	size_t numRegions; /* Internal. The number of elements of 'regions' in use. */
+
+	nmd_x86_emulator_page* tlb[NMD_X86_EMULATOR_TLB_SIZE]; /* Internal. Recently accessed pages, indexed by page number. */
+
+	uint64_t crossPageBuffer[8]; /* Internal. Holds an operand that straddles two pages while an instruction executes. */
+	uint64_t crossPageAddress; /* Internal. The virtual address of the operand in 'crossPageBuffer'. */
+	uint8_t crossPageSize; /* Internal. The size of the operand in 'crossPageBuffer' in bytes, or zero if there is none. */
+	bool crossPageWrite; /* Internal. If true, 'crossPageBuffer' is copied back to memory after the instruction executes. */
+
+	uint64_t blockStart; /* Internal. The virtual address of the first byte of the block being executed. */
+	uint64_t blockEnd; /* Internal. The virtual address after the last byte of the block being executed. */
+	bool blockModified; /* Internal. Set when a write overlaps [blockStart, blockEnd), which ends the block after the instruction that wrote to it. */
+
 	size_t count; /* Internal counter used by the emulator.*/
 
 	uint64_t rip; /* The address of the next instruction to be executed(emulated). */
 
 	nmd_x86_cpu_flags flags;
 
+	nmd_x86_lazy_flags lazyFlags; /* Internal state used by the emulator to compute CF, PF, AF, ZF, SF and OF in 'flags' only when they are read. */
+
 	nmd_x86_register rax;
 	nmd_x86_register rcx;
 	nmd_x86_register rdx;
@@ -2518,6 +2996,38 @@ Parameters:
 */
 size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uint64_t runtimeAddress, NMD_X86_MODE mode, size_t* count);
 
+/*
+Assembles instructions that may refer to labels. Returns the number of bytes written to the buffer on success, zero otherwise.
+Lines are separated like in nmd_x86_assemble(), a line may start with a label definition(e.g. 'loop: dec ecx' or 'end:'). The targets of 'jmp',
+'jcc' and 'call' can be labels defined anywhere in the string. Branches start with a rel8 displacement and are relaxed to rel32 only when the
+target is out of range, until the layout does not change.
+Parameters:
+ - string          [in]      A pointer to a string that represents one or more instructions in assembly language.
+ - buffer          [out]     A pointer to a buffer that receives the encoded instructions.
+ - bufferSize      [in]      The size of the buffer in bytes.
+ - runtimeAddress  [in]      The runtime address of the first instruction.
+ - mode            [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - labels          [out]     A pointer to an array of 'maxLabels' elements that receives the labels and their final addresses.
+ - maxLabels       [in]      The number of elements of 'labels'.
+ - numLabels       [out/opt] A pointer to a variable that receives the number of labels. This parameter may be zero.
+ - layout          [out]     A pointer to an array of 'maxInstructions' elements that receives the offset and length of each instruction. It is also used as working memory.
+ - maxInstructions [in]      The number of elements of 'layout'.
+ - numInstructions [out/opt] A pointer to a variable that receives the number of instructions. This parameter may be zero.
+*/
+size_t nmd_x86_assemble_with_labels(const char* string, void* buffer, size_t bufferSize, uint64_t runtimeAddress, NMD_X86_MODE mode, nmd_x86_label* labels, size_t maxLabels, size_t* numLabels, nmd_x86_instruction_layout* layout, size_t maxInstructions, size_t* numInstructions);
+
+/*
+Encodes an instruction from its fields. Returns the number of bytes written to the buffer on success, zero otherwise.
+The following variables are read: 'mode', 'encoding', 'prefixes', 'segmentOverride', 'simdPrefix', 'repeatPrefix', 'hasRex', 'opcodeMap', 'opcode',
+'vex', 'evex', 'hasModrm', 'modrm', 'sib', 'displacement', 'immMask' and 'immediate'. Every other variable(e.g. 'id', 'operands' and 'buffer') is ignored.
+The presence of the SIB byte and the size of the displacement follow from 'modrm', so they stay consistent when 'modrm' is modified.
+Parameters:
+ - instruction [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction, usually filled by nmd_x86_decode_buffer() and then modified.
+ - buffer      [out] A pointer to a buffer that receives the encoded instruction.
+ - bufferSize  [in]  The size of the buffer in bytes.
+*/
+size_t nmd_x86_encode_instruction(const nmd_x86_instruction* instruction, void* buffer, size_t bufferSize);
+
 /*
 Decodes an instruction. Returns true if the instruction is valid, false otherwise.
 Parameters:
@@ -2529,19 +3039,99 @@ Parameters:
 */
 bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags);
 
+/*
+Decodes an instruction located at 'runtimeAddress' and fills 'target' with the absolute target of direct branches. Returns true if the instruction is valid, false otherwise.
+Parameters:
+ - buffer         [in]  A pointer to a buffer containing an encoded instruction.
+ - bufferSize     [in]  The buffer's size in bytes.
+ - instruction    [out] A pointer to a variable of type 'nmd_x86_instruction' that receives information about the instruction.
+ - mode           [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags          [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+ - runtimeAddress [in]  The instruction's runtime address.
+*/
+bool nmd_x86_decode_buffer_at(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress);
+
+/*
+Declares and defines a decoder specialized for a single architecture mode and mask of decoder flags. The generated function behaves like
+nmd_x86_decode_buffer() called with 'mode' and 'flags', which must be constant expressions so that every check that depends on them is
+removed at compile time. Use NMD_X86_DEFINE_DECODER() in the source file that defines 'NMD_ASSEMBLY_IMPLEMENTATION' and NMD_X86_DECLARE_DECODER()
+wherever else the function is called. Example:
+ NMD_X86_DEFINE_DECODER(decode_minimal64, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_VALIDITY_CHECK | NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
+The generated function's signature is:
+ bool name(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction);
+*/
+#define NMD_X86_DECLARE_DECODER(name) bool name(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction)
+#define NMD_X86_DEFINE_DECODER(name, mode, flags) NMD_X86_DECLARE_DECODER(name) { return _nmd_decode_buffer(buffer, bufferSize, instruction, mode, flags, (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS); }
+
+/*
+Decodes consecutive instructions. Returns the number of instructions decoded. Decoding stops after 'maxCount' instructions, at the end of the buffer or at the first invalid instruction.
+Parameters:
+ - buffer         [in]      A pointer to a buffer containing one or more encoded instructions.
+ - bufferSize     [in]      The buffer's size in bytes.
+ - runtimeAddress [in]      The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS', in which case 'target' is not filled.
+ - instructions   [out]     A pointer to an array of at least 'maxCount' elements of type 'nmd_x86_instruction' that receives the decoded instructions.
+ - maxCount       [in]      The maximum number of instructions to decode.
+ - mode           [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags          [in]      A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+ - numBytes       [out/opt] A pointer to a variable that receives the number of bytes decoded, i.e. the offset where decoding stopped. This parameter may be zero.
+*/
+size_t nmd_x86_decode_buffer_batch(const void* buffer, size_t bufferSize, uint64_t runtimeAddress, nmd_x86_instruction* instructions, size_t maxCount, NMD_X86_MODE mode, uint32_t flags, size_t* numBytes);
+
+/*
+Decodes an instruction into a compact 16 byte record. Returns true if the instruction is valid, false otherwise.
+Parameters:
+ - buffer      [in]  A pointer to a buffer containing an encoded instruction.
+ - bufferSize  [in]  The buffer's size in bytes.
+ - instruction [out] A pointer to a variable of type 'nmd_x86_instruction_lite' that receives information about the instruction.
+ - mode        [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. Only the validity check, instruction id, VEX, EVEX and 3DNow! features are used.
+*/
+bool nmd_x86_decode_buffer_lite(const void* buffer, size_t bufferSize, nmd_x86_instruction_lite* instruction, NMD_X86_MODE mode, uint32_t flags);
+
 /*
 Formats an instruction. This function may cause a crash if you modify 'instruction' manually.
 Parameters:
  - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
- - buffer         [out] A pointer to buffer that receives the string. The buffer's recommended size is 128 bytes.
+ - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
  - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
  - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
 */
 void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags);
 
+/*
+Formats an instruction like nmd_x86_format_instruction() and splits the string into tokens, so the text does not have to be parsed again.
+Returns the number of tokens. Tokens that do not fit in 'tokens' are dropped.
+Parameters:
+ - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
+ - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
+ - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+ - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+ - tokens         [out] A pointer to an array of 'maxTokens' tokens that receives the tokens in the order they appear in the string.
+ - maxTokens      [in]  The number of elements of 'tokens'.
+*/
+size_t nmd_x86_format_instruction_tokens(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_token* tokens, size_t maxTokens);
+
+/* Receives 'length' characters of formatted text from nmd_x86_format_buffer(). Returns true to continue formatting, false to stop. */
+typedef bool(*nmd_x86_format_flush_callback)(const char* text, size_t length, void* userData);
+
+/*
+Formats consecutive instructions as a listing, one instruction per line. Returns the number of lines formatted, not counting the lines of a call to 'flush' that returned false.
+Parameters:
+ - instructions   [in]     A pointer to an array of 'count' decoded instructions(e.g. filled by nmd_x86_decode_buffer_batch()). Formatting stops at the first invalid instruction, since the runtime addresses of the instructions after it are unknown.
+ - count          [in]     The number of instructions.
+ - buffer         [out]    A pointer to a buffer that receives the lines.
+ - bufferSize     [in]     The size of the buffer in bytes. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' + 1 bytes.
+ - runtimeAddress [in]     The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+ - formatFlags    [in]     A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instructions. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+ - flush          [in/opt] A callback that receives the text in 'buffer' whenever the next line does not fit and once at the end, then 'buffer' is reused.
+                           Formatting stops if it returns false. If this parameter is zero, formatting stops when 'buffer' is full and 'buffer' holds the null-terminated listing.
+ - userData       [in/opt] A pointer passed to 'flush'.
+*/
+size_t nmd_x86_format_buffer(const nmd_x86_instruction* instructions, size_t count, char* buffer, size_t bufferSize, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_format_flush_callback flush, void* userData);
+
 /*
 Emulates x86 code according to the cpu's state. You MUST initialize the following variables before calling this
-function: 'cpu->mode', 'cpu->physicalMemory', 'cpu->physicalMemorySize', 'cpu->virtualAddress' and 'cpu->rip'.
+function: 'cpu->mode', 'cpu->rip' and either 'cpu->physicalMemory', 'cpu->physicalMemorySize' and 'cpu->virtualAddress' or 'cpu->pages' and 'cpu->numPages'.
 You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a short description of each variable:
  - 'cpu->mode': The emulator's operating architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
  - 'cpu->physicalMemory': A pointer to a buffer used as the emulator's memory.
@@ -2549,12 +3139,51 @@ You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a sho
  - 'cpu->virtualAddress': The starting address of the emulator's virtual address space.
  - 'cpu->rip': The virtual address where emulation starts.
  - 'cpu->rsp': The virtual address of the bottom of the stack.
+ - 'cpu->blockCache' and 'cpu->blockCacheSize': An optional zero-initialized array of blocks and its number of elements. If present, each basic block
+   is decoded once and then executed from the cache for as long as its bytes in memory do not change. A write to the block being executed ends it
+   after the instruction that wrote to it, so the following instructions are decoded again. Keep the array between calls to reuse it.
+ - 'cpu->pages' and 'cpu->numPages': An optional zero-initialized array of pages and its number of elements that replaces 'physicalMemory'. The
+   address space is then sparse: map the ranges the code may access with nmd_x86_emulator_map() and copy the code with nmd_x86_emulator_write().
+   A page takes an element of the array when it is first accessed.
+Instructions the emulator doesn't implement yet raise 'NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION' and stop emulation, like instructions that cannot be decoded.
 Parameters:
  - cpu      [in] A pointer to a variable of type 'nmd_x86_cpu' that holds the state of the cpu.
  - maxCount [in] The maximum number of instructions that can be executed, or zero for unlimited instructions.
 */
 bool nmd_x86_emulate(nmd_x86_cpu* cpu, size_t maxCount);
 
+/*
+Maps a range of the emulator's virtual address space to 'cpu->pages'. A page of the range takes an element of 'cpu->pages' only when it is first accessed.
+Mapping a range again changes its permissions. Overlapping and adjacent ranges with the same permissions are merged into one region. Returns true on success,
+false if 'cpu->pages' is null or empty or the mapping would need more than 'NMD_X86_EMULATOR_MAX_REGIONS' regions.
+Parameters:
+ - cpu         [in] A pointer to a variable of type 'nmd_x86_cpu' whose 'pages' and 'numPages' are initialized.
+ - address     [in] The virtual address of the range. It is rounded down to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+ - size        [in] The size of the range in bytes. It is rounded up to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+ - permissions [in] A mask of 'NMD_X86_EMULATOR_PAGE_XXX' that specifies how the emulated code may access the range.
+*/
+bool nmd_x86_emulator_map(nmd_x86_cpu* cpu, uint64_t address, uint64_t size, uint8_t permissions);
+
+/*
+Copies a buffer to the emulator's memory regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+Parameters:
+ - cpu     [in] A pointer to a variable of type 'nmd_x86_cpu'.
+ - address [in] The virtual address where the bytes are copied to.
+ - buffer  [in] A pointer to the bytes to copy.
+ - size    [in] The number of bytes to copy.
+*/
+bool nmd_x86_emulator_write(nmd_x86_cpu* cpu, uint64_t address, const void* buffer, size_t size);
+
+/*
+Copies the emulator's memory to a buffer regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+Parameters:
+ - cpu     [in]  A pointer to a variable of type 'nmd_x86_cpu'.
+ - address [in]  The virtual address where the bytes are copied from.
+ - buffer  [out] A pointer to a buffer that receives the bytes.
+ - size    [in]  The number of bytes to copy.
+*/
+bool nmd_x86_emulator_read(nmd_x86_cpu* cpu, uint64_t address, void* buffer, size_t size);
+
 /*
 Returns the instruction's length if it's valid, zero otherwise.
 Parameters:
@@ -2569,6 +3198,24 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 
 #ifdef NMD_ASSEMBLY_IMPLEMENTATION
 
+/* The decoder and the length disassembler find the end of the prefixes with SSE2 when the target supports it. */
+#if !defined(NMD_ASSEMBLY_NO_INCLUDES) && !defined(NMD_ASSEMBLY_DISABLE_SSE2) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define _NMD_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif /* _MSC_VER */
+#endif
+
+/* Forces a function to be inlined so that constant arguments are propagated into its body. */
+#if defined(_MSC_VER)
+#define _NMD_FORCEINLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define _NMD_FORCEINLINE __attribute__((always_inline)) __inline__
+#else
+#define _NMD_FORCEINLINE
+#endif
+
 /* Four high-order bits of an opcode to index a row of the opcode table */
 #define NMD_R(b) ((b) >> 4)
 
@@ -2582,6 +3229,15 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 #define _NMD_TOLOWER(c) (_NMD_IS_UPPERCASE(c) ? c + 0x20 : c)
 #define _NMD_IS_DECIMAL_NUMBER(c) (c >= '0' && c <= '9')
 
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+#define _NMD_IS_ATT_SYNTAX(si) ((si)->formatFlags & NMD_X86_FORMAT_FLAGS_ATT_SYNTAX)
+#else
+#define _NMD_IS_ATT_SYNTAX(si) false
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+
+/* The most commas between the operands of an instruction. Embedded rounding is an operand of its own in AT&T syntax(e.g. 'vcmpps $0,{sae},%zmm2,%zmm1,%k1'). */
+#define _NMD_MAX_OPERAND_SEPARATORS 4
+
 const char* const _nmd_reg8[] = { "al", "cl", "dl", "bl", "ah", "ch", "dh", "bh" };
 const char* const _nmd_reg8_x64[] = { "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil" };
 const char* const _nmd_reg16[] = { "ax", "cx", "dx", "bx", "sp", "bp", "si", "di" };
@@ -2605,7 +3261,7 @@ const char* const _nmd_opcodeExtensionsGrp7[] = { "sgdt", "sidt", "lgdt", "lidt"
 const char* const _nmd_opcodeExtensionsGrp7reg0[] = { "enclv", "vmcall", "vmlaunch", "vmresume", "vmxoff", "pconfig" };
 const char* const _nmd_opcodeExtensionsGrp7reg1[] = { "monitor", "mwait", "clac", "stac", 0, 0, 0, "encls" };
 const char* const _nmd_opcodeExtensionsGrp7reg2[] = { "xgetbv", "xsetbv", 0, 0, "vmfunc", "xend", "xtest", "enclu" };
-const char* const _nmd_opcodeExtensionsGrp7reg3[] = { "vmrun ", "vmmcall", "vmload ", "vmsave", "stgi", "clgi", "skinit eax", "invlpga " };
+const char* const _nmd_opcodeExtensionsGrp7reg3[] = { "vmrun ", "vmmcall", "vmload ", "vmsave", "stgi", "clgi", "skinit ", "invlpga " };
 const char* const _nmd_opcodeExtensionsGrp7reg7[] = { "swapgs", "rdtscp", "monitorx", "mwaitx", "clzero ", "rdpru" };
 
 const char* const _nmd_escapeOpcodesD8[] = { "add", "mul", "com", "comp", "sub", "subr", "div", "divr" };
@@ -2617,52 +3273,1150 @@ const char* const _nmd_escapeOpcodesDD[] = { "ld", "isttp", "st", "stp", "rstor"
 const char* const _nmd_escapeOpcodesDF[] = { "ild", "isttp", "ist", "istp", "bld", "ild", "bstp", "istp" };
 const char* const* _nmd_escapeOpcodes[] = { _nmd_escapeOpcodesD8, _nmd_escapeOpcodesD9, _nmd_escapeOpcodesDA_DE, _nmd_escapeOpcodesDB, _nmd_escapeOpcodesDC, _nmd_escapeOpcodesDD, _nmd_escapeOpcodesDA_DE, _nmd_escapeOpcodesDF };
 
-const uint8_t _nmd_op1modrm[] = { 0xFF, 0x63, 0x69, 0x6B, 0xC0, 0xC1, 0xC6, 0xC7, 0xD0, 0xD1, 0xD2, 0xD3, 0xF6, 0xF7, 0xFE };
-const uint8_t _nmd_op1imm8[] = { 0x6A, 0x6B, 0x80, 0x82, 0x83, 0xA8, 0xC0, 0xC1, 0xC6, 0xCD, 0xD4, 0xD5, 0xEB };
-const uint8_t _nmd_op1imm32[] = { 0xE8, 0xE9, 0x68, 0x81, 0x69, 0xA9, 0xC7 };
-const uint8_t _nmd_invalid2op[] = { 0x04, 0x0a, 0x0c, 0x7a, 0x7b, 0x36, 0x39 };
+/*
+Opcode properties shared by the decoder and the length disassembler. Each entry of '_nmd_op1Properties'(one byte opcode map) and
+'_nmd_op2Properties'(0F opcode map) is a combination of an immediate class(bits 0-3), '_NMD_PROPERTY_MODRM', and either a prefix
+class(bits 5-7, one byte opcode map) or '_NMD_PROPERTY_INVALID'(0F opcode map). Operands that depend on prefixes or on the
+Mod/RM byte are resolved by _nmd_get_immediate_size(). The 0F38 and 0F3A opcode maps don't need a table: every opcode has a
+Mod/RM byte and every 0F3A opcode has an imm8.
+*/
+enum _NMD_IMM_CLASS
+{
+	_NMD_IMM_NONE = 0,
+	_NMD_IMM_8,     /* imm8. */
+	_NMD_IMM_16,    /* imm16. */
+	_NMD_IMM_Z,     /* imm16 or imm32 depending on the operand size. */
+	_NMD_IMM_V,     /* imm16, imm32 or imm64 depending on the operand size. */
+	_NMD_IMM_MOFFS, /* moffs16, moffs32 or moffs64 depending on the address size. */
+	_NMD_IMM_FAR,   /* ptr16:16 or ptr16:32. Invalid in 64-bit mode. */
+	_NMD_IMM_16_8,  /* imm16 followed by imm8. */
+	_NMD_IMM_GRP3   /* Group 3(F6h,F7h): test has an immediate, the other instructions don't. */
+};
+
+enum _NMD_PREFIX_CLASS
+{
+	_NMD_PREFIX_NONE = 0,
+	_NMD_PREFIX_SEGMENT,
+	_NMD_PREFIX_OPERAND_SIZE,
+	_NMD_PREFIX_ADDRESS_SIZE,
+	_NMD_PREFIX_LOCK,
+	_NMD_PREFIX_REPEAT_NOT_ZERO,
+	_NMD_PREFIX_REPEAT,
+	_NMD_PREFIX_REX /* Only a prefix in 64-bit mode. */
+};
+
+#define _NMD_PROPERTY_MODRM (1 << 4)
+#define _NMD_PROPERTY_INVALID (1 << 5)
+#define _NMD_GET_IMM_CLASS(properties) ((properties) & 0xf)
+#define _NMD_GET_PREFIX_CLASS(properties) ((properties) >> 5)
+
+const uint8_t _nmd_op1Properties[256] = {
+	/* 0 */ 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x00, 0x00,
+	/* 1 */ 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x00, 0x00,
+	/* 2 */ 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x20, 0x00, 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x20, 0x00,
+	/* 3 */ 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x20, 0x00, 0x10, 0x10, 0x10, 0x10, 0x01, 0x03, 0x20, 0x00,
+	/* 4 */ 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0,
+	/* 5 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* 6 */ 0x00, 0x00, 0x00, 0x10, 0x20, 0x20, 0x40, 0x60, 0x03, 0x13, 0x01, 0x11, 0x00, 0x00, 0x00, 0x00,
+	/* 7 */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	/* 8 */ 0x11, 0x13, 0x11, 0x11, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 9 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* A */ 0x05, 0x05, 0x05, 0x05, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* B */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	/* C */ 0x11, 0x11, 0x02, 0x00, 0x00, 0x00, 0x11, 0x13, 0x07, 0x00, 0x02, 0x00, 0x00, 0x01, 0x00, 0x00,
+	/* D */ 0x10, 0x10, 0x10, 0x10, 0x01, 0x01, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* E */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00,
+	/* F */ 0x80, 0x00, 0xa0, 0xc0, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10
+};
+const uint8_t _nmd_op2Properties[256] = {
+	/* 0 */ 0x10, 0x10, 0x10, 0x10, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x20, 0x10, 0x00, 0x00,
+	/* 1 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 2 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 3 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* 4 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 5 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 6 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* 7 */ 0x11, 0x11, 0x11, 0x11, 0x10, 0x10, 0x10, 0x00, 0x10, 0x10, 0x30, 0x30, 0x10, 0x10, 0x10, 0x10,
+	/* 8 */ 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+	/* 9 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* A */ 0x00, 0x00, 0x00, 0x10, 0x11, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x10, 0x11, 0x10, 0x10, 0x10,
+	/* B */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x11, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* C */ 0x10, 0x10, 0x11, 0x10, 0x11, 0x11, 0x11, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	/* D */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* E */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	/* F */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+};
+
 const uint8_t _nmd_twoOpcodes[] = { 0xb0, 0xb1, 0xb3, 0xbb, 0xc0, 0xc1 };
 const uint8_t _nmd_valid3DNowOpcodes[] = { 0x0c, 0x0d, 0x1c, 0x1d, 0x8a, 0x8e, 0x90, 0x94, 0x96, 0x97, 0x9a, 0x9e, 0xa0, 0xa4, 0xa6, 0xa7, 0xaa, 0xae, 0xb0, 0xb4, 0xb6, 0xb7, 0xbb, 0xbf };
 
-bool _nmd_findByte(const uint8_t* arr, const size_t N, const uint8_t x)
+bool _nmd_vex_has_imm8(uint8_t opcodeMap, uint8_t op)
 {
-	size_t i = 0;
-	for (; i < N; i++)
+	if (opcodeMap == NMD_X86_OPCODE_MAP_0F3A)
+		return true;
+
+	return opcodeMap == NMD_X86_OPCODE_MAP_0F && ((op >= 0x70 && op <= 0x73) || op == 0xc2 || (op >= 0xc4 && op <= 0xc6));
+}
+
+#define _NMD_AVX_VEX     (1 << 0)  /* Defined for VEX. */
+#define _NMD_AVX_EVEX    (1 << 1)  /* Defined for EVEX. */
+#define _NMD_AVX_W0      (1 << 2)  /* Requires W=0. */
+#define _NMD_AVX_W1      (1 << 3)  /* Requires W=1. */
+#define _NMD_AVX_REG     (1 << 4)  /* Requires a register operand(mod=11b). */
+#define _NMD_AVX_MEM     (1 << 5)  /* Requires a memory operand(mod!=11b). */
+#define _NMD_AVX_L0      (1 << 6)  /* Requires L=0. */
+#define _NMD_AVX_L1      (1 << 7)  /* Requires L=1. */
+#define _NMD_AVX_ER      (1 << 8)  /* Supports embedded rounding(EVEX.b with a register operand). */
+#define _NMD_AVX_SAE     (1 << 9)  /* Supports suppress-all-exceptions(EVEX.b with a register operand). */
+#define _NMD_AVX_VVVV    (1 << 10) /* An operand is encoded in 'vvvv'. Otherwise 'vvvv' must be 1111b. */
+#define _NMD_AVX_VSIB    (1 << 11) /* Uses VSIB addressing, where EVEX.V' extends the index register. */
+#define _NMD_AVX_EVEX_W0 (1 << 12) /* Requires W=0 if EVEX encoded. */
+#define _NMD_AVX_EVEX_W1 (1 << 13) /* Requires W=1 if EVEX encoded. */
+#define _NMD_AVX_BCST    (1 << 14) /* Supports broadcast(EVEX.b with a memory operand). */
+#define _NMD_AVX_L12     (1 << 15) /* Requires EVEX.L'L=1 or EVEX.L'L=2(no 128-bit form). */
+#define _NMD_AVX_L2      (1 << 16) /* Requires EVEX.L'L=2(512-bit form only). */
+#define _NMD_AVX_RW      (1 << 17) /* The first operand is read as well as written(e.g. 'vfmadd231ps', 'vpermt2d'). */
+#define _NMD_AVX_RO      (1 << 18) /* The first operand is only read(e.g. 'vcomiss', 'vptest'). */
+
+typedef struct
+{
+	uint8_t opcode;
+	uint8_t pp; /* 0=none, 1=66h, 2=F3h, 3=F2h. */
+	uint8_t reg; /* The required ModR/M.reg field, or 8 if any. */
+	uint32_t flags; /* A mask of '_NMD_AVX_XXX'. */
+	const char* mnemonic;
+	const char* operands;
+	uint16_t id; /* A member of 'NMD_X86_INSTRUCTION'. */
+} _nmd_avx_entry;
+
+/*
+The VEX and EVEX instructions of the 0F, 0F38 and 0F3A maps, sorted by opcode. Within an opcode the first entry whose 'pp',
+'reg' and 'flags' match the instruction describes it. Shared by the decoder, which uses it to check validity and to fill 'id' and
+'operands', the length disassembler and the formatter. 'operands' is a comma-separated list of operand descriptors:
+ - Vector registers: 'V'(ModR/M.reg), 'H'(vvvv), 'W'(ModR/M.rm or memory), 'L'(bits [7,4] of the immediate) and 'S'(VSIB memory).
+   An optional suffix selects the size: none(the vector length), 'x'(xmm), 'y'(ymm), 'h'(half), 'q'(quarter), 'o'(eighth) or 'd'(8
+   bytes in memory if the vector length is 16, the vector length otherwise).
+ - Opmask registers: 'K'(ModR/M.reg), 'J'(vvvv) and 'k'(ModR/M.rm or memory).
+ - General-purpose registers: 'G'(ModR/M.reg), 'B'(vvvv) and 'E'(ModR/M.rm or memory). 64-bit if W is set in 64-bit mode, 32-bit
+   otherwise or if the suffix is 'd'.
+ - 'I': the 8-bit immediate.
+A trailing '1', '2', '4' or '8' is the size of the memory operand in bytes, 's' means 8 if W is set and 4 otherwise.
+*/
+const _nmd_avx_entry _nmd_avxOpcodes0F[] = {
+	{ 0x10, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovups", "V,W", NMD_X86_INSTRUCTION_VMOVUPS },
+	{ 0x10, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1, "vmovupd", "V,W", NMD_X86_INSTRUCTION_VMOVUPD },
+	{ 0x10, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W0, "vmovss", "Vx,Wx4", NMD_X86_INSTRUCTION_VMOVSS },
+	{ 0x10, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovss", "Vx,Hx,Wx", NMD_X86_INSTRUCTION_VMOVSS },
+	{ 0x10, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W1, "vmovsd", "Vx,Wx8", NMD_X86_INSTRUCTION_VMOVSD },
+	{ 0x10, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmovsd", "Vx,Hx,Wx", NMD_X86_INSTRUCTION_VMOVSD },
+	{ 0x11, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovups", "W,V", NMD_X86_INSTRUCTION_VMOVUPS },
+	{ 0x11, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1, "vmovupd", "W,V", NMD_X86_INSTRUCTION_VMOVUPD },
+	{ 0x11, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W0, "vmovss", "Wx4,Vx", NMD_X86_INSTRUCTION_VMOVSS },
+	{ 0x11, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovss", "Wx,Hx,Vx", NMD_X86_INSTRUCTION_VMOVSS },
+	{ 0x11, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W1, "vmovsd", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVSD },
+	{ 0x11, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmovsd", "Wx,Hx,Vx", NMD_X86_INSTRUCTION_VMOVSD },
+	{ 0x12, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovhlps", "Vx,Hx,Wx", NMD_X86_INSTRUCTION_VMOVHLPS },
+	{ 0x12, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovlps", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMOVLPS },
+	{ 0x12, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmovlpd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMOVLPD },
+	{ 0x12, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovsldup", "V,W", NMD_X86_INSTRUCTION_VMOVSLDUP },
+	{ 0x12, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1, "vmovddup", "V,Wd", NMD_X86_INSTRUCTION_VMOVDDUP },
+	{ 0x13, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_EVEX_W0, "vmovlps", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVLPS },
+	{ 0x13, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_EVEX_W1, "vmovlpd", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVLPD },
+	{ 0x14, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vunpcklps", "V,H,W", NMD_X86_INSTRUCTION_VUNPCKLPS },
+	{ 0x14, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vunpcklpd", "V,H,W", NMD_X86_INSTRUCTION_VUNPCKLPD },
+	{ 0x15, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vunpckhps", "V,H,W", NMD_X86_INSTRUCTION_VUNPCKHPS },
+	{ 0x15, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vunpckhpd", "V,H,W", NMD_X86_INSTRUCTION_VUNPCKHPD },
+	{ 0x16, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovlhps", "Vx,Hx,Wx", NMD_X86_INSTRUCTION_VMOVLHPS },
+	{ 0x16, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmovhps", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMOVHPS },
+	{ 0x16, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmovhpd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMOVHPD },
+	{ 0x16, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovshdup", "V,W", NMD_X86_INSTRUCTION_VMOVSHDUP },
+	{ 0x17, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_EVEX_W0, "vmovhps", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVHPS },
+	{ 0x17, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_L0 | _NMD_AVX_EVEX_W1, "vmovhpd", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVHPD },
+	{ 0x28, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovaps", "V,W", NMD_X86_INSTRUCTION_VMOVAPS },
+	{ 0x28, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1, "vmovapd", "V,W", NMD_X86_INSTRUCTION_VMOVAPD },
+	{ 0x29, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vmovaps", "W,V", NMD_X86_INSTRUCTION_VMOVAPS },
+	{ 0x29, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1, "vmovapd", "W,V", NMD_X86_INSTRUCTION_VMOVAPD },
+	{ 0x2a, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV, "vcvtsi2ss", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTSI2SS },
+	{ 0x2a, 3, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vcvtsi2sd", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTSI2SD },
+	{ 0x2a, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vcvtsi2sd", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTSI2SD },
+	{ 0x2a, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV, "vcvtsi2sd", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTSI2SD },
+	{ 0x2b, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W0, "vmovntps", "W,V", NMD_X86_INSTRUCTION_VMOVNTPS },
+	{ 0x2b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W1, "vmovntpd", "W,V", NMD_X86_INSTRUCTION_VMOVNTPD },
+	{ 0x2c, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE, "vcvttss2si", "G,Wx4", NMD_X86_INSTRUCTION_VCVTTSS2SI },
+	{ 0x2c, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE, "vcvttsd2si", "G,Wx8", NMD_X86_INSTRUCTION_VCVTTSD2SI },
+	{ 0x2d, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER, "vcvtss2si", "G,Wx4", NMD_X86_INSTRUCTION_VCVTSS2SI },
+	{ 0x2d, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER, "vcvtsd2si", "G,Wx8", NMD_X86_INSTRUCTION_VCVTSD2SI },
+	{ 0x2e, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W0 | _NMD_AVX_RO, "vucomiss", "Vx,Wx4", NMD_X86_INSTRUCTION_VUCOMISS },
+	{ 0x2e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W1 | _NMD_AVX_RO, "vucomisd", "Vx,Wx8", NMD_X86_INSTRUCTION_VUCOMISD },
+	{ 0x2f, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W0 | _NMD_AVX_RO, "vcomiss", "Vx,Wx4", NMD_X86_INSTRUCTION_VCOMISS },
+	{ 0x2f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W1 | _NMD_AVX_RO, "vcomisd", "Vx,Wx8", NMD_X86_INSTRUCTION_VCOMISD },
+	{ 0x41, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandw", "K,J,k", NMD_X86_INSTRUCTION_KANDW },
+	{ 0x41, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandq", "K,J,k", NMD_X86_INSTRUCTION_KANDQ },
+	{ 0x41, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandb", "K,J,k", NMD_X86_INSTRUCTION_KANDB },
+	{ 0x41, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandd", "K,J,k", NMD_X86_INSTRUCTION_KANDD },
+	{ 0x42, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandnw", "K,J,k", NMD_X86_INSTRUCTION_KANDNW },
+	{ 0x42, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandnq", "K,J,k", NMD_X86_INSTRUCTION_KANDNQ },
+	{ 0x42, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandnb", "K,J,k", NMD_X86_INSTRUCTION_KANDNB },
+	{ 0x42, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kandnd", "K,J,k", NMD_X86_INSTRUCTION_KANDND },
+	{ 0x44, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "knotw", "K,k", NMD_X86_INSTRUCTION_KNOTW },
+	{ 0x44, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "knotq", "K,k", NMD_X86_INSTRUCTION_KNOTQ },
+	{ 0x44, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "knotb", "K,k", NMD_X86_INSTRUCTION_KNOTB },
+	{ 0x44, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "knotd", "K,k", NMD_X86_INSTRUCTION_KNOTD },
+	{ 0x45, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "korw", "K,J,k", NMD_X86_INSTRUCTION_KORW },
+	{ 0x45, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "korq", "K,J,k", NMD_X86_INSTRUCTION_KORQ },
+	{ 0x45, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "korb", "K,J,k", NMD_X86_INSTRUCTION_KORB },
+	{ 0x45, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kord", "K,J,k", NMD_X86_INSTRUCTION_KORD },
+	{ 0x46, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxnorw", "K,J,k", NMD_X86_INSTRUCTION_KXNORW },
+	{ 0x46, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxnorq", "K,J,k", NMD_X86_INSTRUCTION_KXNORQ },
+	{ 0x46, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxnorb", "K,J,k", NMD_X86_INSTRUCTION_KXNORB },
+	{ 0x46, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxnord", "K,J,k", NMD_X86_INSTRUCTION_KXNORD },
+	{ 0x47, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxorw", "K,J,k", NMD_X86_INSTRUCTION_KXORW },
+	{ 0x47, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxorq", "K,J,k", NMD_X86_INSTRUCTION_KXORQ },
+	{ 0x47, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxorb", "K,J,k", NMD_X86_INSTRUCTION_KXORB },
+	{ 0x47, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kxord", "K,J,k", NMD_X86_INSTRUCTION_KXORD },
+	{ 0x4a, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kaddw", "K,J,k", NMD_X86_INSTRUCTION_KADDW },
+	{ 0x4a, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kaddq", "K,J,k", NMD_X86_INSTRUCTION_KADDQ },
+	{ 0x4a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kaddb", "K,J,k", NMD_X86_INSTRUCTION_KADDB },
+	{ 0x4a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kaddd", "K,J,k", NMD_X86_INSTRUCTION_KADDD },
+	{ 0x4b, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kunpckwd", "K,J,k", NMD_X86_INSTRUCTION_KUNPCKWD },
+	{ 0x4b, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kunpckdq", "K,J,k", NMD_X86_INSTRUCTION_KUNPCKDQ },
+	{ 0x4b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L1 | _NMD_AVX_VVVV, "kunpckbw", "K,J,k", NMD_X86_INSTRUCTION_KUNPCKBW },
+	{ 0x50, 0, 8, _NMD_AVX_VEX | _NMD_AVX_REG, "vmovmskps", "G,W", NMD_X86_INSTRUCTION_VMOVMSKPS },
+	{ 0x50, 1, 8, _NMD_AVX_VEX | _NMD_AVX_REG, "vmovmskpd", "G,W", NMD_X86_INSTRUCTION_VMOVMSKPD },
+	{ 0x51, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vsqrtps", "V,W", NMD_X86_INSTRUCTION_VSQRTPS },
+	{ 0x51, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vsqrtpd", "V,W", NMD_X86_INSTRUCTION_VSQRTPD },
+	{ 0x51, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vsqrtss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VSQRTSS },
+	{ 0x51, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vsqrtsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VSQRTSD },
+	{ 0x52, 0, 8, _NMD_AVX_VEX, "vrsqrtps", "V,W", NMD_X86_INSTRUCTION_VRSQRTPS },
+	{ 0x52, 2, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vrsqrtss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VRSQRTSS },
+	{ 0x53, 0, 8, _NMD_AVX_VEX, "vrcpps", "V,W", NMD_X86_INSTRUCTION_VRCPPS },
+	{ 0x53, 2, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vrcpss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VRCPSS },
+	{ 0x54, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vandps", "V,H,W", NMD_X86_INSTRUCTION_VANDPS },
+	{ 0x54, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vandpd", "V,H,W", NMD_X86_INSTRUCTION_VANDPD },
+	{ 0x55, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vandnps", "V,H,W", NMD_X86_INSTRUCTION_VANDNPS },
+	{ 0x55, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vandnpd", "V,H,W", NMD_X86_INSTRUCTION_VANDNPD },
+	{ 0x56, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vorps", "V,H,W", NMD_X86_INSTRUCTION_VORPS },
+	{ 0x56, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vorpd", "V,H,W", NMD_X86_INSTRUCTION_VORPD },
+	{ 0x57, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vxorps", "V,H,W", NMD_X86_INSTRUCTION_VXORPS },
+	{ 0x57, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vxorpd", "V,H,W", NMD_X86_INSTRUCTION_VXORPD },
+	{ 0x58, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vaddps", "V,H,W", NMD_X86_INSTRUCTION_VADDPS },
+	{ 0x58, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vaddpd", "V,H,W", NMD_X86_INSTRUCTION_VADDPD },
+	{ 0x58, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vaddss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VADDSS },
+	{ 0x58, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vaddsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VADDSD },
+	{ 0x59, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vmulps", "V,H,W", NMD_X86_INSTRUCTION_VMULPS },
+	{ 0x59, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vmulpd", "V,H,W", NMD_X86_INSTRUCTION_VMULPD },
+	{ 0x59, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmulss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VMULSS },
+	{ 0x59, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmulsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMULSD },
+	{ 0x5a, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vcvtps2pd", "V,Wh", NMD_X86_INSTRUCTION_VCVTPS2PD },
+	{ 0x5a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vcvtpd2ps", "Vh,W", NMD_X86_INSTRUCTION_VCVTPD2PS },
+	{ 0x5a, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vcvtss2sd", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VCVTSS2SD },
+	{ 0x5a, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vcvtsd2ss", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VCVTSD2SS },
+	{ 0x5b, 0, 8, _NMD_AVX_VEX | _NMD_AVX_ER, "vcvtdq2ps", "V,W", NMD_X86_INSTRUCTION_VCVTDQ2PS },
+	{ 0x5b, 0, 8, _NMD_AVX_VEX | _NMD_AVX_ER, "vcvtdq2ps", "V,W", NMD_X86_INSTRUCTION_VCVTDQ2PS },
+	{ 0x5b, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtdq2ps", "V,W", NMD_X86_INSTRUCTION_VCVTDQ2PS },
+	{ 0x5b, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtqq2ps", "Vh,W", NMD_X86_INSTRUCTION_VCVTQQ2PS },
+	{ 0x5b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vcvtps2dq", "V,W", NMD_X86_INSTRUCTION_VCVTPS2DQ },
+	{ 0x5b, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vcvttps2dq", "V,W", NMD_X86_INSTRUCTION_VCVTTPS2DQ },
+	{ 0x5c, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vsubps", "V,H,W", NMD_X86_INSTRUCTION_VSUBPS },
+	{ 0x5c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vsubpd", "V,H,W", NMD_X86_INSTRUCTION_VSUBPD },
+	{ 0x5c, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vsubss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VSUBSS },
+	{ 0x5c, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vsubsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VSUBSD },
+	{ 0x5d, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vminps", "V,H,W", NMD_X86_INSTRUCTION_VMINPS },
+	{ 0x5d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vminpd", "V,H,W", NMD_X86_INSTRUCTION_VMINPD },
+	{ 0x5d, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vminss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VMINSS },
+	{ 0x5d, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vminsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMINSD },
+	{ 0x5e, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vdivps", "V,H,W", NMD_X86_INSTRUCTION_VDIVPS },
+	{ 0x5e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vdivpd", "V,H,W", NMD_X86_INSTRUCTION_VDIVPD },
+	{ 0x5e, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vdivss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VDIVSS },
+	{ 0x5e, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vdivsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VDIVSD },
+	{ 0x5f, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vmaxps", "V,H,W", NMD_X86_INSTRUCTION_VMAXPS },
+	{ 0x5f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vmaxpd", "V,H,W", NMD_X86_INSTRUCTION_VMAXPD },
+	{ 0x5f, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vmaxss", "Vx,Hx,Wx4", NMD_X86_INSTRUCTION_VMAXSS },
+	{ 0x5f, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vmaxsd", "Vx,Hx,Wx8", NMD_X86_INSTRUCTION_VMAXSD },
+	{ 0x60, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpunpcklbw", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKLBW },
+	{ 0x61, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpunpcklwd", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKLWD },
+	{ 0x62, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpunpckldq", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKLDQ },
+	{ 0x63, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpacksswb", "V,H,W", NMD_X86_INSTRUCTION_VPACKSSWB },
+	{ 0x64, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpgtb", "V,H,W", NMD_X86_INSTRUCTION_VPCMPGTB },
+	{ 0x64, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpcmpgtb", "K,H,W", NMD_X86_INSTRUCTION_VPCMPGTB },
+	{ 0x65, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpgtw", "V,H,W", NMD_X86_INSTRUCTION_VPCMPGTW },
+	{ 0x65, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpcmpgtw", "K,H,W", NMD_X86_INSTRUCTION_VPCMPGTW },
+	{ 0x66, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpgtd", "V,H,W", NMD_X86_INSTRUCTION_VPCMPGTD },
+	{ 0x66, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpcmpgtd", "K,H,W", NMD_X86_INSTRUCTION_VPCMPGTD },
+	{ 0x67, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpackuswb", "V,H,W", NMD_X86_INSTRUCTION_VPACKUSWB },
+	{ 0x68, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpunpckhbw", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKHBW },
+	{ 0x69, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpunpckhwd", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKHWD },
+	{ 0x6a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpunpckhdq", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKHDQ },
+	{ 0x6b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpackssdw", "V,H,W", NMD_X86_INSTRUCTION_VPACKSSDW },
+	{ 0x6c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpunpcklqdq", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKLQDQ },
+	{ 0x6d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpunpckhqdq", "V,H,W", NMD_X86_INSTRUCTION_VPUNPCKHQDQ },
+	{ 0x6e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L0, "vmovd", "Vx,E", NMD_X86_INSTRUCTION_VMOVD },
+	{ 0x6e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L0, "vmovq", "Vx,E", NMD_X86_INSTRUCTION_VMOVQ },
+	{ 0x6f, 1, 8, _NMD_AVX_VEX, "vmovdqa", "V,W", NMD_X86_INSTRUCTION_VMOVDQA },
+	{ 0x6f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqa32", "V,W", NMD_X86_INSTRUCTION_VMOVDQA32 },
+	{ 0x6f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqa64", "V,W", NMD_X86_INSTRUCTION_VMOVDQA64 },
+	{ 0x6f, 2, 8, _NMD_AVX_VEX, "vmovdqu", "V,W", NMD_X86_INSTRUCTION_VMOVDQU },
+	{ 0x6f, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqu32", "V,W", NMD_X86_INSTRUCTION_VMOVDQU32 },
+	{ 0x6f, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqu64", "V,W", NMD_X86_INSTRUCTION_VMOVDQU64 },
+	{ 0x6f, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqu8", "V,W", NMD_X86_INSTRUCTION_VMOVDQU8 },
+	{ 0x6f, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqu16", "V,W", NMD_X86_INSTRUCTION_VMOVDQU16 },
+	{ 0x70, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpshufd", "V,W,I", NMD_X86_INSTRUCTION_VPSHUFD },
+	{ 0x70, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpshufhw", "V,W,I", NMD_X86_INSTRUCTION_VPSHUFHW },
+	{ 0x70, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpshuflw", "V,W,I", NMD_X86_INSTRUCTION_VPSHUFLW },
+	{ 0x71, 1, 2, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsrlw", "H,W,I", NMD_X86_INSTRUCTION_VPSRLW },
+	{ 0x71, 1, 2, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsrlw", "H,W,I", NMD_X86_INSTRUCTION_VPSRLW },
+	{ 0x71, 1, 4, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsraw", "H,W,I", NMD_X86_INSTRUCTION_VPSRAW },
+	{ 0x71, 1, 4, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsraw", "H,W,I", NMD_X86_INSTRUCTION_VPSRAW },
+	{ 0x71, 1, 6, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsllw", "H,W,I", NMD_X86_INSTRUCTION_VPSLLW },
+	{ 0x71, 1, 6, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsllw", "H,W,I", NMD_X86_INSTRUCTION_VPSLLW },
+	{ 0x72, 1, 0, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprord", "H,W,I", NMD_X86_INSTRUCTION_VPRORD },
+	{ 0x72, 1, 0, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprorq", "H,W,I", NMD_X86_INSTRUCTION_VPRORQ },
+	{ 0x72, 1, 1, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprold", "H,W,I", NMD_X86_INSTRUCTION_VPROLD },
+	{ 0x72, 1, 1, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprolq", "H,W,I", NMD_X86_INSTRUCTION_VPROLQ },
+	{ 0x72, 1, 2, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsrld", "H,W,I", NMD_X86_INSTRUCTION_VPSRLD },
+	{ 0x72, 1, 2, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpsrld", "H,W,I", NMD_X86_INSTRUCTION_VPSRLD },
+	{ 0x72, 1, 4, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsrad", "H,W,I", NMD_X86_INSTRUCTION_VPSRAD },
+	{ 0x72, 1, 4, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsrad", "H,W,I", NMD_X86_INSTRUCTION_VPSRAD },
+	{ 0x72, 1, 4, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsraq", "H,W,I", NMD_X86_INSTRUCTION_VPSRAQ },
+	{ 0x72, 1, 6, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpslld", "H,W,I", NMD_X86_INSTRUCTION_VPSLLD },
+	{ 0x72, 1, 6, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpslld", "H,W,I", NMD_X86_INSTRUCTION_VPSLLD },
+	{ 0x73, 1, 2, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsrlq", "H,W,I", NMD_X86_INSTRUCTION_VPSRLQ },
+	{ 0x73, 1, 2, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpsrlq", "H,W,I", NMD_X86_INSTRUCTION_VPSRLQ },
+	{ 0x73, 1, 3, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsrldq", "H,W,I", NMD_X86_INSTRUCTION_VPSRLDQ },
+	{ 0x73, 1, 3, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsrldq", "H,W,I", NMD_X86_INSTRUCTION_VPSRLDQ },
+	{ 0x73, 1, 6, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpsllq", "H,W,I", NMD_X86_INSTRUCTION_VPSLLQ },
+	{ 0x73, 1, 6, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpsllq", "H,W,I", NMD_X86_INSTRUCTION_VPSLLQ },
+	{ 0x73, 1, 7, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_VVVV, "vpslldq", "H,W,I", NMD_X86_INSTRUCTION_VPSLLDQ },
+	{ 0x73, 1, 7, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpslldq", "H,W,I", NMD_X86_INSTRUCTION_VPSLLDQ },
+	{ 0x74, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpeqb", "V,H,W", NMD_X86_INSTRUCTION_VPCMPEQB },
+	{ 0x74, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpcmpeqb", "K,H,W", NMD_X86_INSTRUCTION_VPCMPEQB },
+	{ 0x75, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpeqw", "V,H,W", NMD_X86_INSTRUCTION_VPCMPEQW },
+	{ 0x75, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpcmpeqw", "K,H,W", NMD_X86_INSTRUCTION_VPCMPEQW },
+	{ 0x76, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpeqd", "V,H,W", NMD_X86_INSTRUCTION_VPCMPEQD },
+	{ 0x76, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpcmpeqd", "K,H,W", NMD_X86_INSTRUCTION_VPCMPEQD },
+	{ 0x77, 0, 8, _NMD_AVX_VEX | _NMD_AVX_L0, "vzeroupper", "", NMD_X86_INSTRUCTION_VZEROUPPER },
+	{ 0x77, 0, 8, _NMD_AVX_VEX | _NMD_AVX_L1, "vzeroall", "", NMD_X86_INSTRUCTION_VZEROALL },
+	{ 0x78, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttps2udq", "V,W", NMD_X86_INSTRUCTION_VCVTTPS2UDQ },
+	{ 0x78, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttpd2udq", "Vh,W", NMD_X86_INSTRUCTION_VCVTTPD2UDQ },
+	{ 0x78, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttps2uqq", "V,Wh", NMD_X86_INSTRUCTION_VCVTTPS2UQQ },
+	{ 0x78, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttpd2uqq", "V,W", NMD_X86_INSTRUCTION_VCVTTPD2UQQ },
+	{ 0x78, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE, "vcvttss2usi", "G,Wx4", NMD_X86_INSTRUCTION_VCVTTSS2USI },
+	{ 0x78, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE, "vcvttsd2usi", "G,Wx8", NMD_X86_INSTRUCTION_VCVTTSD2USI },
+	{ 0x79, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtps2udq", "V,W", NMD_X86_INSTRUCTION_VCVTPS2UDQ },
+	{ 0x79, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtpd2udq", "Vh,W", NMD_X86_INSTRUCTION_VCVTPD2UDQ },
+	{ 0x79, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtps2uqq", "V,Wh", NMD_X86_INSTRUCTION_VCVTPS2UQQ },
+	{ 0x79, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtpd2uqq", "V,W", NMD_X86_INSTRUCTION_VCVTPD2UQQ },
+	{ 0x79, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_ER, "vcvtss2usi", "G,Wx4", NMD_X86_INSTRUCTION_VCVTSS2USI },
+	{ 0x79, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_ER, "vcvtsd2usi", "G,Wx8", NMD_X86_INSTRUCTION_VCVTSD2USI },
+	{ 0x7a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttps2qq", "V,Wh", NMD_X86_INSTRUCTION_VCVTTPS2QQ },
+	{ 0x7a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vcvttpd2qq", "V,W", NMD_X86_INSTRUCTION_VCVTTPD2QQ },
+	{ 0x7a, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vcvtudq2pd", "V,Wh", NMD_X86_INSTRUCTION_VCVTUDQ2PD },
+	{ 0x7a, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtuqq2pd", "V,W", NMD_X86_INSTRUCTION_VCVTUQQ2PD },
+	{ 0x7a, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtudq2ps", "V,W", NMD_X86_INSTRUCTION_VCVTUDQ2PS },
+	{ 0x7a, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtuqq2ps", "Vh,W", NMD_X86_INSTRUCTION_VCVTUQQ2PS },
+	{ 0x7b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtps2qq", "V,Wh", NMD_X86_INSTRUCTION_VCVTPS2QQ },
+	{ 0x7b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtpd2qq", "V,W", NMD_X86_INSTRUCTION_VCVTPD2QQ },
+	{ 0x7b, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_VVVV, "vcvtusi2ss", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTUSI2SS },
+	{ 0x7b, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vcvtusi2sd", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTUSI2SD },
+	{ 0x7b, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV, "vcvtusi2sd", "Vx,Hx,E", NMD_X86_INSTRUCTION_VCVTUSI2SD },
+	{ 0x7c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vhaddpd", "V,H,W", NMD_X86_INSTRUCTION_VHADDPD },
+	{ 0x7c, 3, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vhaddps", "V,H,W", NMD_X86_INSTRUCTION_VHADDPS },
+	{ 0x7d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vhsubpd", "V,H,W", NMD_X86_INSTRUCTION_VHSUBPD },
+	{ 0x7d, 3, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vhsubps", "V,H,W", NMD_X86_INSTRUCTION_VHSUBPS },
+	{ 0x7e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L0, "vmovd", "E,Vx", NMD_X86_INSTRUCTION_VMOVD },
+	{ 0x7e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L0, "vmovq", "E,Vx", NMD_X86_INSTRUCTION_VMOVQ },
+	{ 0x7e, 2, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0 | _NMD_AVX_EVEX_W1, "vmovq", "Vx,Wx8", NMD_X86_INSTRUCTION_VMOVQ },
+	{ 0x7f, 1, 8, _NMD_AVX_VEX, "vmovdqa", "W,V", NMD_X86_INSTRUCTION_VMOVDQA },
+	{ 0x7f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqa32", "W,V", NMD_X86_INSTRUCTION_VMOVDQA32 },
+	{ 0x7f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqa64", "W,V", NMD_X86_INSTRUCTION_VMOVDQA64 },
+	{ 0x7f, 2, 8, _NMD_AVX_VEX, "vmovdqu", "W,V", NMD_X86_INSTRUCTION_VMOVDQU },
+	{ 0x7f, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqu32", "W,V", NMD_X86_INSTRUCTION_VMOVDQU32 },
+	{ 0x7f, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqu64", "W,V", NMD_X86_INSTRUCTION_VMOVDQU64 },
+	{ 0x7f, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vmovdqu8", "W,V", NMD_X86_INSTRUCTION_VMOVDQU8 },
+	{ 0x7f, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vmovdqu16", "W,V", NMD_X86_INSTRUCTION_VMOVDQU16 },
+	{ 0x90, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L0, "kmovw", "K,k2", NMD_X86_INSTRUCTION_KMOVW },
+	{ 0x90, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_L0, "kmovq", "K,k8", NMD_X86_INSTRUCTION_KMOVQ },
+	{ 0x90, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L0, "kmovb", "K,k1", NMD_X86_INSTRUCTION_KMOVB },
+	{ 0x90, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_L0, "kmovd", "K,k4", NMD_X86_INSTRUCTION_KMOVD },
+	{ 0x91, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L0, "kmovw", "k2,K", NMD_X86_INSTRUCTION_KMOVW },
+	{ 0x91, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L0, "kmovq", "k8,K", NMD_X86_INSTRUCTION_KMOVQ },
+	{ 0x91, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L0, "kmovb", "k1,K", NMD_X86_INSTRUCTION_KMOVB },
+	{ 0x91, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L0, "kmovd", "k4,K", NMD_X86_INSTRUCTION_KMOVD },
+	{ 0x92, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovw", "K,Ed", NMD_X86_INSTRUCTION_KMOVW },
+	{ 0x92, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovb", "K,Ed", NMD_X86_INSTRUCTION_KMOVB },
+	{ 0x92, 3, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovd", "K,Ed", NMD_X86_INSTRUCTION_KMOVD },
+	{ 0x92, 3, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovq", "K,E", NMD_X86_INSTRUCTION_KMOVQ },
+	{ 0x93, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovw", "Gd,k", NMD_X86_INSTRUCTION_KMOVW },
+	{ 0x93, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovb", "Gd,k", NMD_X86_INSTRUCTION_KMOVB },
+	{ 0x93, 3, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovd", "Gd,k", NMD_X86_INSTRUCTION_KMOVD },
+	{ 0x93, 3, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kmovq", "G,k", NMD_X86_INSTRUCTION_KMOVQ },
+	{ 0x98, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "kortestw", "K,k", NMD_X86_INSTRUCTION_KORTESTW },
+	{ 0x98, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "kortestq", "K,k", NMD_X86_INSTRUCTION_KORTESTQ },
+	{ 0x98, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "kortestb", "K,k", NMD_X86_INSTRUCTION_KORTESTB },
+	{ 0x98, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "kortestd", "K,k", NMD_X86_INSTRUCTION_KORTESTD },
+	{ 0x99, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "ktestw", "K,k", NMD_X86_INSTRUCTION_KTESTW },
+	{ 0x99, 0, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "ktestq", "K,k", NMD_X86_INSTRUCTION_KTESTQ },
+	{ 0x99, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "ktestb", "K,k", NMD_X86_INSTRUCTION_KTESTB },
+	{ 0x99, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "ktestd", "K,k", NMD_X86_INSTRUCTION_KTESTD },
+	{ 0xc2, 0, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vcmpps", "V,H,W,I", NMD_X86_INSTRUCTION_VCMPPS },
+	{ 0xc2, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vcmppd", "V,H,W,I", NMD_X86_INSTRUCTION_VCMPPD },
+	{ 0xc2, 2, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vcmpss", "Vx,Hx,Wx4,I", NMD_X86_INSTRUCTION_VCMPSS },
+	{ 0xc2, 3, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vcmpsd", "Vx,Hx,Wx8,I", NMD_X86_INSTRUCTION_VCMPSD },
+	{ 0xc2, 0, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vcmpps", "K,H,W,I", NMD_X86_INSTRUCTION_VCMPPS },
+	{ 0xc2, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vcmppd", "K,H,W,I", NMD_X86_INSTRUCTION_VCMPPD },
+	{ 0xc2, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vcmpss", "K,Hx,Wx4,I", NMD_X86_INSTRUCTION_VCMPSS },
+	{ 0xc2, 3, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vcmpsd", "K,Hx,Wx8,I", NMD_X86_INSTRUCTION_VCMPSD },
+	{ 0xc4, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "vpinsrw", "Vx,Hx,Ed2,I", NMD_X86_INSTRUCTION_VPINSRW },
+	{ 0xc5, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_L0, "vpextrw", "Gd,Wx,I", NMD_X86_INSTRUCTION_VPEXTRW },
+	{ 0xc6, 0, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vshufps", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFPS },
+	{ 0xc6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vshufpd", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFPD },
+	{ 0xd0, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vaddsubpd", "V,H,W", NMD_X86_INSTRUCTION_VADDSUBPD },
+	{ 0xd0, 3, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vaddsubps", "V,H,W", NMD_X86_INSTRUCTION_VADDSUBPS },
+	{ 0xd1, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsrlw", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRLW },
+	{ 0xd2, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vpsrld", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRLD },
+	{ 0xd3, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vpsrlq", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRLQ },
+	{ 0xd4, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpaddq", "V,H,W", NMD_X86_INSTRUCTION_VPADDQ },
+	{ 0xd5, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmullw", "V,H,W", NMD_X86_INSTRUCTION_VPMULLW },
+	{ 0xd6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0 | _NMD_AVX_EVEX_W1, "vmovq", "Wx8,Vx", NMD_X86_INSTRUCTION_VMOVQ },
+	{ 0xd7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_REG, "vpmovmskb", "Gd,W", NMD_X86_INSTRUCTION_VPMOVMSKB },
+	{ 0xd8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubusb", "V,H,W", NMD_X86_INSTRUCTION_VPSUBUSB },
+	{ 0xd9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubusw", "V,H,W", NMD_X86_INSTRUCTION_VPSUBUSW },
+	{ 0xda, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpminub", "V,H,W", NMD_X86_INSTRUCTION_VPMINUB },
+	{ 0xdb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpand", "V,H,W", NMD_X86_INSTRUCTION_VPAND },
+	{ 0xdb, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpandd", "V,H,W", NMD_X86_INSTRUCTION_VPANDD },
+	{ 0xdb, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpandq", "V,H,W", NMD_X86_INSTRUCTION_VPANDQ },
+	{ 0xdc, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddusb", "V,H,W", NMD_X86_INSTRUCTION_VPADDUSB },
+	{ 0xdd, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddusw", "V,H,W", NMD_X86_INSTRUCTION_VPADDUSW },
+	{ 0xde, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaxub", "V,H,W", NMD_X86_INSTRUCTION_VPMAXUB },
+	{ 0xdf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpandn", "V,H,W", NMD_X86_INSTRUCTION_VPANDN },
+	{ 0xdf, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpandnd", "V,H,W", NMD_X86_INSTRUCTION_VPANDND },
+	{ 0xdf, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpandnq", "V,H,W", NMD_X86_INSTRUCTION_VPANDNQ },
+	{ 0xe0, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpavgb", "V,H,W", NMD_X86_INSTRUCTION_VPAVGB },
+	{ 0xe1, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsraw", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRAW },
+	{ 0xe2, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpsrad", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRAD },
+	{ 0xe2, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpsrad", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRAD },
+	{ 0xe2, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpsraq", "V,H,Wx", NMD_X86_INSTRUCTION_VPSRAQ },
+	{ 0xe3, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpavgw", "V,H,W", NMD_X86_INSTRUCTION_VPAVGW },
+	{ 0xe4, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmulhuw", "V,H,W", NMD_X86_INSTRUCTION_VPMULHUW },
+	{ 0xe5, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmulhw", "V,H,W", NMD_X86_INSTRUCTION_VPMULHW },
+	{ 0xe6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vcvttpd2dq", "Vh,W", NMD_X86_INSTRUCTION_VCVTTPD2DQ },
+	{ 0xe6, 2, 8, _NMD_AVX_VEX, "vcvtdq2pd", "V,Wh", NMD_X86_INSTRUCTION_VCVTDQ2PD },
+	{ 0xe6, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vcvtdq2pd", "V,Wh", NMD_X86_INSTRUCTION_VCVTDQ2PD },
+	{ 0xe6, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_BCST, "vcvtqq2pd", "V,W", NMD_X86_INSTRUCTION_VCVTQQ2PD },
+	{ 0xe6, 3, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_ER | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vcvtpd2dq", "Vh,W", NMD_X86_INSTRUCTION_VCVTPD2DQ },
+	{ 0xe7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W0, "vmovntdq", "W,V", NMD_X86_INSTRUCTION_VMOVNTDQ },
+	{ 0xe8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubsb", "V,H,W", NMD_X86_INSTRUCTION_VPSUBSB },
+	{ 0xe9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubsw", "V,H,W", NMD_X86_INSTRUCTION_VPSUBSW },
+	{ 0xea, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpminsw", "V,H,W", NMD_X86_INSTRUCTION_VPMINSW },
+	{ 0xeb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpor", "V,H,W", NMD_X86_INSTRUCTION_VPOR },
+	{ 0xeb, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpord", "V,H,W", NMD_X86_INSTRUCTION_VPORD },
+	{ 0xeb, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vporq", "V,H,W", NMD_X86_INSTRUCTION_VPORQ },
+	{ 0xec, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddsb", "V,H,W", NMD_X86_INSTRUCTION_VPADDSB },
+	{ 0xed, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddsw", "V,H,W", NMD_X86_INSTRUCTION_VPADDSW },
+	{ 0xee, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaxsw", "V,H,W", NMD_X86_INSTRUCTION_VPMAXSW },
+	{ 0xef, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpxor", "V,H,W", NMD_X86_INSTRUCTION_VPXOR },
+	{ 0xef, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpxord", "V,H,W", NMD_X86_INSTRUCTION_VPXORD },
+	{ 0xef, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpxorq", "V,H,W", NMD_X86_INSTRUCTION_VPXORQ },
+	{ 0xf0, 3, 8, _NMD_AVX_VEX | _NMD_AVX_MEM, "vlddqu", "V,W", NMD_X86_INSTRUCTION_VLDDQU },
+	{ 0xf1, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsllw", "V,H,Wx", NMD_X86_INSTRUCTION_VPSLLW },
+	{ 0xf2, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vpslld", "V,H,Wx", NMD_X86_INSTRUCTION_VPSLLD },
+	{ 0xf3, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vpsllq", "V,H,Wx", NMD_X86_INSTRUCTION_VPSLLQ },
+	{ 0xf4, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpmuludq", "V,H,W", NMD_X86_INSTRUCTION_VPMULUDQ },
+	{ 0xf5, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaddwd", "V,H,W", NMD_X86_INSTRUCTION_VPMADDWD },
+	{ 0xf6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsadbw", "V,H,W", NMD_X86_INSTRUCTION_VPSADBW },
+	{ 0xf7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_REG | _NMD_AVX_L0 | _NMD_AVX_RO, "vmaskmovdqu", "Vx,Wx", NMD_X86_INSTRUCTION_VMASKMOVDQU },
+	{ 0xf8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubb", "V,H,W", NMD_X86_INSTRUCTION_VPSUBB },
+	{ 0xf9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpsubw", "V,H,W", NMD_X86_INSTRUCTION_VPSUBW },
+	{ 0xfa, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpsubd", "V,H,W", NMD_X86_INSTRUCTION_VPSUBD },
+	{ 0xfb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpsubq", "V,H,W", NMD_X86_INSTRUCTION_VPSUBQ },
+	{ 0xfc, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddb", "V,H,W", NMD_X86_INSTRUCTION_VPADDB },
+	{ 0xfd, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpaddw", "V,H,W", NMD_X86_INSTRUCTION_VPADDW },
+	{ 0xfe, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpaddd", "V,H,W", NMD_X86_INSTRUCTION_VPADDD }
+};
+const _nmd_avx_entry _nmd_avxOpcodes0F38[] = {
+	{ 0x00, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpshufb", "V,H,W", NMD_X86_INSTRUCTION_VPSHUFB },
+	{ 0x01, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphaddw", "V,H,W", NMD_X86_INSTRUCTION_VPHADDW },
+	{ 0x02, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphaddd", "V,H,W", NMD_X86_INSTRUCTION_VPHADDD },
+	{ 0x03, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphaddsw", "V,H,W", NMD_X86_INSTRUCTION_VPHADDSW },
+	{ 0x04, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaddubsw", "V,H,W", NMD_X86_INSTRUCTION_VPMADDUBSW },
+	{ 0x05, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphsubw", "V,H,W", NMD_X86_INSTRUCTION_VPHSUBW },
+	{ 0x06, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphsubd", "V,H,W", NMD_X86_INSTRUCTION_VPHSUBD },
+	{ 0x07, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vphsubsw", "V,H,W", NMD_X86_INSTRUCTION_VPHSUBSW },
+	{ 0x08, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpsignb", "V,H,W", NMD_X86_INSTRUCTION_VPSIGNB },
+	{ 0x09, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpsignw", "V,H,W", NMD_X86_INSTRUCTION_VPSIGNW },
+	{ 0x0a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpsignd", "V,H,W", NMD_X86_INSTRUCTION_VPSIGND },
+	{ 0x0b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmulhrsw", "V,H,W", NMD_X86_INSTRUCTION_VPMULHRSW },
+	{ 0x0c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpermilps", "V,H,W", NMD_X86_INSTRUCTION_VPERMILPS },
+	{ 0x0c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpermilps", "V,H,W", NMD_X86_INSTRUCTION_VPERMILPS },
+	{ 0x0d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpermilpd", "V,H,W", NMD_X86_INSTRUCTION_VPERMILPD },
+	{ 0x0d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpermilpd", "V,H,W", NMD_X86_INSTRUCTION_VPERMILPD },
+	{ 0x0e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_RO, "vtestps", "V,W", NMD_X86_INSTRUCTION_VTESTPS },
+	{ 0x0f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_RO, "vtestpd", "V,W", NMD_X86_INSTRUCTION_VTESTPD },
+	{ 0x10, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpsrlvw", "V,H,W", NMD_X86_INSTRUCTION_VPSRLVW },
+	{ 0x10, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovuswb", "Wh,V", NMD_X86_INSTRUCTION_VPMOVUSWB },
+	{ 0x11, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpsravw", "V,H,W", NMD_X86_INSTRUCTION_VPSRAVW },
+	{ 0x11, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovusdb", "Wq,V", NMD_X86_INSTRUCTION_VPMOVUSDB },
+	{ 0x12, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpsllvw", "V,H,W", NMD_X86_INSTRUCTION_VPSLLVW },
+	{ 0x12, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovusqb", "Wo,V", NMD_X86_INSTRUCTION_VPMOVUSQB },
+	{ 0x13, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE, "vcvtph2ps", "V,Wh", NMD_X86_INSTRUCTION_VCVTPH2PS },
+	{ 0x13, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovusdw", "Wh,V", NMD_X86_INSTRUCTION_VPMOVUSDW },
+	{ 0x14, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprorvd", "V,H,W", NMD_X86_INSTRUCTION_VPRORVD },
+	{ 0x14, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprorvq", "V,H,W", NMD_X86_INSTRUCTION_VPRORVQ },
+	{ 0x14, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovusqw", "Wq,V", NMD_X86_INSTRUCTION_VPMOVUSQW },
+	{ 0x15, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprolvd", "V,H,W", NMD_X86_INSTRUCTION_VPROLVD },
+	{ 0x15, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vprolvq", "V,H,W", NMD_X86_INSTRUCTION_VPROLVQ },
+	{ 0x15, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovusqd", "Wh,V", NMD_X86_INSTRUCTION_VPMOVUSQD },
+	{ 0x16, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vpermps", "V,H,W", NMD_X86_INSTRUCTION_VPERMPS },
+	{ 0x16, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermps", "V,H,W", NMD_X86_INSTRUCTION_VPERMPS },
+	{ 0x16, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermpd", "V,H,W", NMD_X86_INSTRUCTION_VPERMPD },
+	{ 0x17, 1, 8, _NMD_AVX_VEX | _NMD_AVX_RO, "vptest", "V,W", NMD_X86_INSTRUCTION_VPTEST },
+	{ 0x18, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0, "vbroadcastss", "V,Wx4", NMD_X86_INSTRUCTION_VBROADCASTSS },
+	{ 0x19, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1, "vbroadcastsd", "V,Wx8", NMD_X86_INSTRUCTION_VBROADCASTSD },
+	{ 0x19, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L12, "vbroadcastf32x2", "V,Wx8", NMD_X86_INSTRUCTION_VBROADCASTF32X2 },
+	{ 0x19, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L12, "vbroadcastsd", "V,Wx8", NMD_X86_INSTRUCTION_VBROADCASTSD },
+	{ 0x1a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM, "vbroadcastf128", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTF128 },
+	{ 0x1a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L12, "vbroadcastf32x4", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTF32X4 },
+	{ 0x1a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L12, "vbroadcastf64x2", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTF64X2 },
+	{ 0x1b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L2, "vbroadcastf32x8", "V,Wy", NMD_X86_INSTRUCTION_VBROADCASTF32X8 },
+	{ 0x1b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L2, "vbroadcastf64x4", "V,Wy", NMD_X86_INSTRUCTION_VBROADCASTF64X4 },
+	{ 0x1c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpabsb", "V,W", NMD_X86_INSTRUCTION_VPABSB },
+	{ 0x1d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpabsw", "V,W", NMD_X86_INSTRUCTION_VPABSW },
+	{ 0x1e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpabsd", "V,W", NMD_X86_INSTRUCTION_VPABSD },
+	{ 0x1f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpabsq", "V,W", NMD_X86_INSTRUCTION_VPABSQ },
+	{ 0x20, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovsxbw", "V,Wh", NMD_X86_INSTRUCTION_VPMOVSXBW },
+	{ 0x20, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovswb", "Wh,V", NMD_X86_INSTRUCTION_VPMOVSWB },
+	{ 0x21, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovsxbd", "V,Wq", NMD_X86_INSTRUCTION_VPMOVSXBD },
+	{ 0x21, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsdb", "Wq,V", NMD_X86_INSTRUCTION_VPMOVSDB },
+	{ 0x22, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovsxbq", "V,Wo", NMD_X86_INSTRUCTION_VPMOVSXBQ },
+	{ 0x22, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsqb", "Wo,V", NMD_X86_INSTRUCTION_VPMOVSQB },
+	{ 0x23, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovsxwd", "V,Wh", NMD_X86_INSTRUCTION_VPMOVSXWD },
+	{ 0x23, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsdw", "Wh,V", NMD_X86_INSTRUCTION_VPMOVSDW },
+	{ 0x24, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovsxwq", "V,Wq", NMD_X86_INSTRUCTION_VPMOVSXWQ },
+	{ 0x24, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsqw", "Wq,V", NMD_X86_INSTRUCTION_VPMOVSQW },
+	{ 0x25, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsxdq", "V,Wh", NMD_X86_INSTRUCTION_VPMOVSXDQ },
+	{ 0x25, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovsqd", "Wh,V", NMD_X86_INSTRUCTION_VPMOVSQD },
+	{ 0x26, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vptestmb", "K,H,W", NMD_X86_INSTRUCTION_VPTESTMB },
+	{ 0x26, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vptestmw", "K,H,W", NMD_X86_INSTRUCTION_VPTESTMW },
+	{ 0x26, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vptestnmb", "K,H,W", NMD_X86_INSTRUCTION_VPTESTNMB },
+	{ 0x26, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vptestnmw", "K,H,W", NMD_X86_INSTRUCTION_VPTESTNMW },
+	{ 0x27, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vptestmd", "K,H,W", NMD_X86_INSTRUCTION_VPTESTMD },
+	{ 0x27, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vptestmq", "K,H,W", NMD_X86_INSTRUCTION_VPTESTMQ },
+	{ 0x27, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vptestnmd", "K,H,W", NMD_X86_INSTRUCTION_VPTESTNMD },
+	{ 0x27, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vptestnmq", "K,H,W", NMD_X86_INSTRUCTION_VPTESTNMQ },
+	{ 0x28, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpmuldq", "V,H,W", NMD_X86_INSTRUCTION_VPMULDQ },
+	{ 0x28, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpmovm2b", "V,k", NMD_X86_INSTRUCTION_VPMOVM2B },
+	{ 0x28, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpmovm2w", "V,k", NMD_X86_INSTRUCTION_VPMOVM2W },
+	{ 0x29, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpeqq", "V,H,W", NMD_X86_INSTRUCTION_VPCMPEQQ },
+	{ 0x29, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpcmpeqq", "K,H,W", NMD_X86_INSTRUCTION_VPCMPEQQ },
+	{ 0x29, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpmovb2m", "K,W", NMD_X86_INSTRUCTION_VPMOVB2M },
+	{ 0x29, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpmovw2m", "K,W", NMD_X86_INSTRUCTION_VPMOVW2M },
+	{ 0x2a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_MEM | _NMD_AVX_EVEX_W0, "vmovntdqa", "V,W", NMD_X86_INSTRUCTION_VMOVNTDQA },
+	{ 0x2a, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpbroadcastmb2q", "V,k", NMD_X86_INSTRUCTION_VPBROADCASTMB2Q },
+	{ 0x2b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vpackusdw", "V,H,W", NMD_X86_INSTRUCTION_VPACKUSDW },
+	{ 0x2c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vmaskmovps", "V,H,W", NMD_X86_INSTRUCTION_VMASKMOVPS },
+	{ 0x2c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vscalefps", "V,H,W", NMD_X86_INSTRUCTION_VSCALEFPS },
+	{ 0x2c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vscalefpd", "V,H,W", NMD_X86_INSTRUCTION_VSCALEFPD },
+	{ 0x2d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vmaskmovpd", "V,H,W", NMD_X86_INSTRUCTION_VMASKMOVPD },
+	{ 0x2d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV, "vscalefss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VSCALEFSS },
+	{ 0x2d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV, "vscalefsd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VSCALEFSD },
+	{ 0x2e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vmaskmovps", "W,H,V", NMD_X86_INSTRUCTION_VMASKMOVPS },
+	{ 0x2f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vmaskmovpd", "W,H,V", NMD_X86_INSTRUCTION_VMASKMOVPD },
+	{ 0x30, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovzxbw", "V,Wh", NMD_X86_INSTRUCTION_VPMOVZXBW },
+	{ 0x30, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovwb", "Wh,V", NMD_X86_INSTRUCTION_VPMOVWB },
+	{ 0x31, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovzxbd", "V,Wq", NMD_X86_INSTRUCTION_VPMOVZXBD },
+	{ 0x31, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovdb", "Wq,V", NMD_X86_INSTRUCTION_VPMOVDB },
+	{ 0x32, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovzxbq", "V,Wo", NMD_X86_INSTRUCTION_VPMOVZXBQ },
+	{ 0x32, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovqb", "Wo,V", NMD_X86_INSTRUCTION_VPMOVQB },
+	{ 0x33, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovzxwd", "V,Wh", NMD_X86_INSTRUCTION_VPMOVZXWD },
+	{ 0x33, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovdw", "Wh,V", NMD_X86_INSTRUCTION_VPMOVDW },
+	{ 0x34, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX, "vpmovzxwq", "V,Wq", NMD_X86_INSTRUCTION_VPMOVZXWQ },
+	{ 0x34, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovqw", "Wq,V", NMD_X86_INSTRUCTION_VPMOVQW },
+	{ 0x35, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovzxdq", "V,Wh", NMD_X86_INSTRUCTION_VPMOVZXDQ },
+	{ 0x35, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_EVEX_W0, "vpmovqd", "Wh,V", NMD_X86_INSTRUCTION_VPMOVQD },
+	{ 0x36, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vpermd", "V,H,W", NMD_X86_INSTRUCTION_VPERMD },
+	{ 0x36, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermd", "V,H,W", NMD_X86_INSTRUCTION_VPERMD },
+	{ 0x36, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermq", "V,H,W", NMD_X86_INSTRUCTION_VPERMQ },
+	{ 0x37, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpcmpgtq", "V,H,W", NMD_X86_INSTRUCTION_VPCMPGTQ },
+	{ 0x37, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vpcmpgtq", "K,H,W", NMD_X86_INSTRUCTION_VPCMPGTQ },
+	{ 0x38, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpminsb", "V,H,W", NMD_X86_INSTRUCTION_VPMINSB },
+	{ 0x38, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpmovm2d", "V,k", NMD_X86_INSTRUCTION_VPMOVM2D },
+	{ 0x38, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpmovm2q", "V,k", NMD_X86_INSTRUCTION_VPMOVM2Q },
+	{ 0x39, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpminsd", "V,H,W", NMD_X86_INSTRUCTION_VPMINSD },
+	{ 0x39, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpminsd", "V,H,W", NMD_X86_INSTRUCTION_VPMINSD },
+	{ 0x39, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpminsq", "V,H,W", NMD_X86_INSTRUCTION_VPMINSQ },
+	{ 0x39, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpmovd2m", "K,W", NMD_X86_INSTRUCTION_VPMOVD2M },
+	{ 0x39, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpmovq2m", "K,W", NMD_X86_INSTRUCTION_VPMOVQ2M },
+	{ 0x3a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpminuw", "V,H,W", NMD_X86_INSTRUCTION_VPMINUW },
+	{ 0x3a, 2, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpbroadcastmw2d", "V,k", NMD_X86_INSTRUCTION_VPBROADCASTMW2D },
+	{ 0x3b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpminud", "V,H,W", NMD_X86_INSTRUCTION_VPMINUD },
+	{ 0x3b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpminud", "V,H,W", NMD_X86_INSTRUCTION_VPMINUD },
+	{ 0x3b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpminuq", "V,H,W", NMD_X86_INSTRUCTION_VPMINUQ },
+	{ 0x3c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaxsb", "V,H,W", NMD_X86_INSTRUCTION_VPMAXSB },
+	{ 0x3d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpmaxsd", "V,H,W", NMD_X86_INSTRUCTION_VPMAXSD },
+	{ 0x3d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmaxsd", "V,H,W", NMD_X86_INSTRUCTION_VPMAXSD },
+	{ 0x3d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmaxsq", "V,H,W", NMD_X86_INSTRUCTION_VPMAXSQ },
+	{ 0x3e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpmaxuw", "V,H,W", NMD_X86_INSTRUCTION_VPMAXUW },
+	{ 0x3f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpmaxud", "V,H,W", NMD_X86_INSTRUCTION_VPMAXUD },
+	{ 0x3f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmaxud", "V,H,W", NMD_X86_INSTRUCTION_VPMAXUD },
+	{ 0x3f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmaxuq", "V,H,W", NMD_X86_INSTRUCTION_VPMAXUQ },
+	{ 0x40, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpmulld", "V,H,W", NMD_X86_INSTRUCTION_VPMULLD },
+	{ 0x40, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmulld", "V,H,W", NMD_X86_INSTRUCTION_VPMULLD },
+	{ 0x40, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmullq", "V,H,W", NMD_X86_INSTRUCTION_VPMULLQ },
+	{ 0x41, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0, "vphminposuw", "Vx,Wx", NMD_X86_INSTRUCTION_VPHMINPOSUW },
+	{ 0x42, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vgetexpps", "V,W", NMD_X86_INSTRUCTION_VGETEXPPS },
+	{ 0x42, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vgetexppd", "V,W", NMD_X86_INSTRUCTION_VGETEXPPD },
+	{ 0x43, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vgetexpss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VGETEXPSS },
+	{ 0x43, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vgetexpsd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VGETEXPSD },
+	{ 0x44, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vplzcntd", "V,W", NMD_X86_INSTRUCTION_VPLZCNTD },
+	{ 0x44, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vplzcntq", "V,W", NMD_X86_INSTRUCTION_VPLZCNTQ },
+	{ 0x45, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsrlvd", "V,H,W", NMD_X86_INSTRUCTION_VPSRLVD },
+	{ 0x45, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsrlvq", "V,H,W", NMD_X86_INSTRUCTION_VPSRLVQ },
+	{ 0x46, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpsravd", "V,H,W", NMD_X86_INSTRUCTION_VPSRAVD },
+	{ 0x46, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsravd", "V,H,W", NMD_X86_INSTRUCTION_VPSRAVD },
+	{ 0x46, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsravq", "V,H,W", NMD_X86_INSTRUCTION_VPSRAVQ },
+	{ 0x47, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsllvd", "V,H,W", NMD_X86_INSTRUCTION_VPSLLVD },
+	{ 0x47, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpsllvq", "V,H,W", NMD_X86_INSTRUCTION_VPSLLVQ },
+	{ 0x4c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vrcp14ps", "V,W", NMD_X86_INSTRUCTION_VRCP14PS },
+	{ 0x4c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vrcp14pd", "V,W", NMD_X86_INSTRUCTION_VRCP14PD },
+	{ 0x4d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vrcp14ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VRCP14SS },
+	{ 0x4d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vrcp14sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VRCP14SD },
+	{ 0x4e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vrsqrt14ps", "V,W", NMD_X86_INSTRUCTION_VRSQRT14PS },
+	{ 0x4e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vrsqrt14pd", "V,W", NMD_X86_INSTRUCTION_VRSQRT14PD },
+	{ 0x4f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vrsqrt14ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VRSQRT14SS },
+	{ 0x4f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vrsqrt14sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VRSQRT14SD },
+	{ 0x50, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpdpbusd", "V,H,W", NMD_X86_INSTRUCTION_VPDPBUSD },
+	{ 0x51, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpdpbusds", "V,H,W", NMD_X86_INSTRUCTION_VPDPBUSDS },
+	{ 0x52, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpdpwssd", "V,H,W", NMD_X86_INSTRUCTION_VPDPWSSD },
+	{ 0x53, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpdpwssds", "V,H,W", NMD_X86_INSTRUCTION_VPDPWSSDS },
+	{ 0x54, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vpopcntb", "V,W", NMD_X86_INSTRUCTION_VPOPCNTB },
+	{ 0x54, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpopcntw", "V,W", NMD_X86_INSTRUCTION_VPOPCNTW },
+	{ 0x55, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vpopcntd", "V,W", NMD_X86_INSTRUCTION_VPOPCNTD },
+	{ 0x55, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vpopcntq", "V,W", NMD_X86_INSTRUCTION_VPOPCNTQ },
+	{ 0x58, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0, "vpbroadcastd", "V,Wx4", NMD_X86_INSTRUCTION_VPBROADCASTD },
+	{ 0x59, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0, "vpbroadcastq", "V,Wx8", NMD_X86_INSTRUCTION_VPBROADCASTQ },
+	{ 0x59, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vbroadcasti32x2", "V,Wx8", NMD_X86_INSTRUCTION_VBROADCASTI32X2 },
+	{ 0x59, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpbroadcastq", "V,Wx8", NMD_X86_INSTRUCTION_VPBROADCASTQ },
+	{ 0x5a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM, "vbroadcasti128", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTI128 },
+	{ 0x5a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L12, "vbroadcasti32x4", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTI32X4 },
+	{ 0x5a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L12, "vbroadcasti64x2", "V,Wx", NMD_X86_INSTRUCTION_VBROADCASTI64X2 },
+	{ 0x5b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_L2, "vbroadcasti32x8", "V,Wy", NMD_X86_INSTRUCTION_VBROADCASTI32X8 },
+	{ 0x5b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_L2, "vbroadcasti64x4", "V,Wy", NMD_X86_INSTRUCTION_VBROADCASTI64X4 },
+	{ 0x62, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vpexpandb", "V,W", NMD_X86_INSTRUCTION_VPEXPANDB },
+	{ 0x62, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpexpandw", "V,W", NMD_X86_INSTRUCTION_VPEXPANDW },
+	{ 0x63, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vpcompressb", "W,V", NMD_X86_INSTRUCTION_VPCOMPRESSB },
+	{ 0x63, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpcompressw", "W,V", NMD_X86_INSTRUCTION_VPCOMPRESSW },
+	{ 0x64, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpblendmd", "V,H,W", NMD_X86_INSTRUCTION_VPBLENDMD },
+	{ 0x64, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpblendmq", "V,H,W", NMD_X86_INSTRUCTION_VPBLENDMQ },
+	{ 0x65, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vblendmps", "V,H,W", NMD_X86_INSTRUCTION_VBLENDMPS },
+	{ 0x65, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vblendmpd", "V,H,W", NMD_X86_INSTRUCTION_VBLENDMPD },
+	{ 0x66, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpblendmb", "V,H,W", NMD_X86_INSTRUCTION_VPBLENDMB },
+	{ 0x66, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpblendmw", "V,H,W", NMD_X86_INSTRUCTION_VPBLENDMW },
+	{ 0x70, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpshldvw", "V,H,W", NMD_X86_INSTRUCTION_VPSHLDVW },
+	{ 0x71, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpshldvd", "V,H,W", NMD_X86_INSTRUCTION_VPSHLDVD },
+	{ 0x71, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpshldvq", "V,H,W", NMD_X86_INSTRUCTION_VPSHLDVQ },
+	{ 0x72, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpshrdvw", "V,H,W", NMD_X86_INSTRUCTION_VPSHRDVW },
+	{ 0x73, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpshrdvd", "V,H,W", NMD_X86_INSTRUCTION_VPSHRDVD },
+	{ 0x73, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpshrdvq", "V,H,W", NMD_X86_INSTRUCTION_VPSHRDVQ },
+	{ 0x75, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpermi2b", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2B },
+	{ 0x75, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpermi2w", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2W },
+	{ 0x76, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermi2d", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2D },
+	{ 0x76, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermi2q", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2Q },
+	{ 0x77, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermi2ps", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2PS },
+	{ 0x77, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermi2pd", "V,H,W", NMD_X86_INSTRUCTION_VPERMI2PD },
+	{ 0x78, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0, "vpbroadcastb", "V,Wx1", NMD_X86_INSTRUCTION_VPBROADCASTB },
+	{ 0x79, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0, "vpbroadcastw", "V,Wx2", NMD_X86_INSTRUCTION_VPBROADCASTW },
+	{ 0x7a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_EVEX_W0, "vpbroadcastb", "V,Ed", NMD_X86_INSTRUCTION_VPBROADCASTB },
+	{ 0x7b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_REG | _NMD_AVX_EVEX_W0, "vpbroadcastw", "V,Ed", NMD_X86_INSTRUCTION_VPBROADCASTW },
+	{ 0x7c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_REG, "vpbroadcastd", "V,Ed", NMD_X86_INSTRUCTION_VPBROADCASTD },
+	{ 0x7c, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_REG, "vpbroadcastq", "V,E", NMD_X86_INSTRUCTION_VPBROADCASTQ },
+	{ 0x7d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpermt2b", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2B },
+	{ 0x7d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_RW, "vpermt2w", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2W },
+	{ 0x7e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermt2d", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2D },
+	{ 0x7e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermt2q", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2Q },
+	{ 0x7f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermt2ps", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2PS },
+	{ 0x7f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpermt2pd", "V,H,W", NMD_X86_INSTRUCTION_VPERMT2PD },
+	{ 0x83, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpmultishiftqb", "V,H,W", NMD_X86_INSTRUCTION_VPMULTISHIFTQB },
+	{ 0x88, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vexpandps", "V,W", NMD_X86_INSTRUCTION_VEXPANDPS },
+	{ 0x88, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vexpandpd", "V,W", NMD_X86_INSTRUCTION_VEXPANDPD },
+	{ 0x89, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vpexpandd", "V,W", NMD_X86_INSTRUCTION_VPEXPANDD },
+	{ 0x89, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpexpandq", "V,W", NMD_X86_INSTRUCTION_VPEXPANDQ },
+	{ 0x8a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vcompressps", "W,V", NMD_X86_INSTRUCTION_VCOMPRESSPS },
+	{ 0x8a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vcompresspd", "W,V", NMD_X86_INSTRUCTION_VCOMPRESSPD },
+	{ 0x8b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vpcompressd", "W,V", NMD_X86_INSTRUCTION_VPCOMPRESSD },
+	{ 0x8b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vpcompressq", "W,V", NMD_X86_INSTRUCTION_VPCOMPRESSQ },
+	{ 0x8c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vpmaskmovd", "V,H,W", NMD_X86_INSTRUCTION_VPMASKMOVD },
+	{ 0x8c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vpmaskmovq", "V,H,W", NMD_X86_INSTRUCTION_VPMASKMOVQ },
+	{ 0x8d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpermb", "V,H,W", NMD_X86_INSTRUCTION_VPERMB },
+	{ 0x8d, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpermw", "V,H,W", NMD_X86_INSTRUCTION_VPERMW },
+	{ 0x8e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vpmaskmovd", "W,H,V", NMD_X86_INSTRUCTION_VPMASKMOVD },
+	{ 0x8e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV, "vpmaskmovq", "W,H,V", NMD_X86_INSTRUCTION_VPMASKMOVQ },
+	{ 0x8f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpshufbitqmb", "K,H,W", NMD_X86_INSTRUCTION_VPSHUFBITQMB },
+	{ 0x90, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherdd", "V,S,H", NMD_X86_INSTRUCTION_VPGATHERDD },
+	{ 0x90, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherdq", "V,Sh,H", NMD_X86_INSTRUCTION_VPGATHERDQ },
+	{ 0x90, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherdd", "V,S", NMD_X86_INSTRUCTION_VPGATHERDD },
+	{ 0x90, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherdq", "V,Sh", NMD_X86_INSTRUCTION_VPGATHERDQ },
+	{ 0x91, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherqd", "Vh,S,Hh", NMD_X86_INSTRUCTION_VPGATHERQD },
+	{ 0x91, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherqq", "V,S,H", NMD_X86_INSTRUCTION_VPGATHERQQ },
+	{ 0x91, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherqd", "Vh,S", NMD_X86_INSTRUCTION_VPGATHERQD },
+	{ 0x91, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vpgatherqq", "V,S", NMD_X86_INSTRUCTION_VPGATHERQQ },
+	{ 0x92, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherdps", "V,S,H", NMD_X86_INSTRUCTION_VGATHERDPS },
+	{ 0x92, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherdpd", "V,Sh,H", NMD_X86_INSTRUCTION_VGATHERDPD },
+	{ 0x92, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherdps", "V,S", NMD_X86_INSTRUCTION_VGATHERDPS },
+	{ 0x92, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherdpd", "V,Sh", NMD_X86_INSTRUCTION_VGATHERDPD },
+	{ 0x93, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherqps", "Vh,S,Hh", NMD_X86_INSTRUCTION_VGATHERQPS },
+	{ 0x93, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VVVV | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherqpd", "V,S,H", NMD_X86_INSTRUCTION_VGATHERQPD },
+	{ 0x93, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherqps", "Vh,S", NMD_X86_INSTRUCTION_VGATHERQPS },
+	{ 0x93, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB | _NMD_AVX_RW, "vgatherqpd", "V,S", NMD_X86_INSTRUCTION_VGATHERQPD },
+	{ 0x96, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub132ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB132PS },
+	{ 0x96, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub132pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB132PD },
+	{ 0x97, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd132ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD132PS },
+	{ 0x97, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd132pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD132PD },
+	{ 0x98, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd132ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADD132PS },
+	{ 0x98, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd132pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADD132PD },
+	{ 0x99, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd132ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD132SS },
+	{ 0x99, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd132sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD132SD },
+	{ 0x9a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub132ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB132PS },
+	{ 0x9a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub132pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB132PD },
+	{ 0x9b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub132ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB132SS },
+	{ 0x9b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub132sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB132SD },
+	{ 0x9c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd132ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD132PS },
+	{ 0x9c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd132pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD132PD },
+	{ 0x9d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd132ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD132SS },
+	{ 0x9d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd132sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD132SD },
+	{ 0x9e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub132ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB132PS },
+	{ 0x9e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub132pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB132PD },
+	{ 0x9f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub132ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB132SS },
+	{ 0x9f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub132sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB132SD },
+	{ 0xa0, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vpscatterdd", "S,V", NMD_X86_INSTRUCTION_VPSCATTERDD },
+	{ 0xa0, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vpscatterdq", "Sh,V", NMD_X86_INSTRUCTION_VPSCATTERDQ },
+	{ 0xa1, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vpscatterqd", "S,Vh", NMD_X86_INSTRUCTION_VPSCATTERQD },
+	{ 0xa1, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vpscatterqq", "S,V", NMD_X86_INSTRUCTION_VPSCATTERQQ },
+	{ 0xa2, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vscatterdps", "S,V", NMD_X86_INSTRUCTION_VSCATTERDPS },
+	{ 0xa2, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vscatterdpd", "Sh,V", NMD_X86_INSTRUCTION_VSCATTERDPD },
+	{ 0xa3, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vscatterqps", "S,Vh", NMD_X86_INSTRUCTION_VSCATTERQPS },
+	{ 0xa3, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_MEM | _NMD_AVX_VSIB, "vscatterqpd", "S,V", NMD_X86_INSTRUCTION_VSCATTERQPD },
+	{ 0xa6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub213ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB213PS },
+	{ 0xa6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub213pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB213PD },
+	{ 0xa7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd213ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD213PS },
+	{ 0xa7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd213pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD213PD },
+	{ 0xa8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd213ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADD213PS },
+	{ 0xa8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd213pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADD213PD },
+	{ 0xa9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd213ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD213SS },
+	{ 0xa9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd213sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD213SD },
+	{ 0xaa, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub213ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB213PS },
+	{ 0xaa, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub213pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB213PD },
+	{ 0xab, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub213ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB213SS },
+	{ 0xab, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub213sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB213SD },
+	{ 0xac, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd213ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD213PS },
+	{ 0xac, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd213pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD213PD },
+	{ 0xad, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd213ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD213SS },
+	{ 0xad, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd213sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD213SD },
+	{ 0xae, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub213ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB213PS },
+	{ 0xae, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub213pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB213PD },
+	{ 0xaf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub213ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB213SS },
+	{ 0xaf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub213sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB213SD },
+	{ 0xb4, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpmadd52luq", "V,H,W", NMD_X86_INSTRUCTION_VPMADD52LUQ },
+	{ 0xb5, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpmadd52huq", "V,H,W", NMD_X86_INSTRUCTION_VPMADD52HUQ },
+	{ 0xb6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub231ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB231PS },
+	{ 0xb6, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmaddsub231pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADDSUB231PD },
+	{ 0xb7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd231ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD231PS },
+	{ 0xb7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsubadd231pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUBADD231PD },
+	{ 0xb8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd231ps", "V,H,W", NMD_X86_INSTRUCTION_VFMADD231PS },
+	{ 0xb8, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmadd231pd", "V,H,W", NMD_X86_INSTRUCTION_VFMADD231PD },
+	{ 0xb9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd231ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD231SS },
+	{ 0xb9, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmadd231sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMADD231SD },
+	{ 0xba, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub231ps", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB231PS },
+	{ 0xba, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfmsub231pd", "V,H,W", NMD_X86_INSTRUCTION_VFMSUB231PD },
+	{ 0xbb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub231ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB231SS },
+	{ 0xbb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfmsub231sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFMSUB231SD },
+	{ 0xbc, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd231ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD231PS },
+	{ 0xbc, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmadd231pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMADD231PD },
+	{ 0xbd, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd231ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD231SS },
+	{ 0xbd, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmadd231sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMADD231SD },
+	{ 0xbe, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub231ps", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB231PS },
+	{ 0xbe, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfnmsub231pd", "V,H,W", NMD_X86_INSTRUCTION_VFNMSUB231PD },
+	{ 0xbf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub231ss", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB231SS },
+	{ 0xbf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_ER | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfnmsub231sd", "Vx,Hx,Wxs", NMD_X86_INSTRUCTION_VFNMSUB231SD },
+	{ 0xc4, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vpconflictd", "V,W", NMD_X86_INSTRUCTION_VPCONFLICTD },
+	{ 0xc4, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vpconflictq", "V,W", NMD_X86_INSTRUCTION_VPCONFLICTQ },
+	{ 0xcf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vgf2p8mulb", "V,H,W", NMD_X86_INSTRUCTION_VGF2P8MULB },
+	{ 0xdb, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0, "vaesimc", "Vx,Wx", NMD_X86_INSTRUCTION_VAESIMC },
+	{ 0xdc, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vaesenc", "V,H,W", NMD_X86_INSTRUCTION_VAESENC },
+	{ 0xdd, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vaesenclast", "V,H,W", NMD_X86_INSTRUCTION_VAESENCLAST },
+	{ 0xde, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vaesdec", "V,H,W", NMD_X86_INSTRUCTION_VAESDEC },
+	{ 0xdf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vaesdeclast", "V,H,W", NMD_X86_INSTRUCTION_VAESDECLAST },
+	{ 0xf2, 0, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "andn", "G,B,E", NMD_X86_INSTRUCTION_ANDN },
+	{ 0xf3, 0, 1, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "blsr", "B,E", NMD_X86_INSTRUCTION_BLSR },
+	{ 0xf3, 0, 2, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "blsmsk", "B,E", NMD_X86_INSTRUCTION_BLSMSK },
+	{ 0xf3, 0, 3, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "blsi", "B,E", NMD_X86_INSTRUCTION_BLSI },
+	{ 0xf5, 0, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "bzhi", "G,E,B", NMD_X86_INSTRUCTION_BZHI },
+	{ 0xf5, 2, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "pext", "G,B,E", NMD_X86_INSTRUCTION_PEXT },
+	{ 0xf5, 3, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "pdep", "G,B,E", NMD_X86_INSTRUCTION_PDEP },
+	{ 0xf6, 3, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "mulx", "G,B,E", NMD_X86_INSTRUCTION_MULX },
+	{ 0xf7, 0, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "bextr", "G,E,B", NMD_X86_INSTRUCTION_BEXTR },
+	{ 0xf7, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "shlx", "G,E,B", NMD_X86_INSTRUCTION_SHLX },
+	{ 0xf7, 2, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "sarx", "G,E,B", NMD_X86_INSTRUCTION_SARX },
+	{ 0xf7, 3, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "shrx", "G,E,B", NMD_X86_INSTRUCTION_SHRX }
+};
+const _nmd_avx_entry _nmd_avxOpcodes0F3A[] = {
+	{ 0x00, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_L1, "vpermq", "V,W,I", NMD_X86_INSTRUCTION_VPERMQ },
+	{ 0x00, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermq", "V,W,I", NMD_X86_INSTRUCTION_VPERMQ },
+	{ 0x01, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_L1, "vpermpd", "V,W,I", NMD_X86_INSTRUCTION_VPERMPD },
+	{ 0x01, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST | _NMD_AVX_L12, "vpermpd", "V,W,I", NMD_X86_INSTRUCTION_VPERMPD },
+	{ 0x02, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpblendd", "V,H,W,I", NMD_X86_INSTRUCTION_VPBLENDD },
+	{ 0x03, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "valignd", "V,H,W,I", NMD_X86_INSTRUCTION_VALIGND },
+	{ 0x03, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "valignq", "V,H,W,I", NMD_X86_INSTRUCTION_VALIGNQ },
+	{ 0x04, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vpermilps", "V,W,I", NMD_X86_INSTRUCTION_VPERMILPS },
+	{ 0x05, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0, "vpermilpd", "V,W,I", NMD_X86_INSTRUCTION_VPERMILPD },
+	{ 0x05, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vpermilpd", "V,W,I", NMD_X86_INSTRUCTION_VPERMILPD },
+	{ 0x06, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vperm2f128", "V,H,W,I", NMD_X86_INSTRUCTION_VPERM2F128 },
+	{ 0x08, 1, 8, _NMD_AVX_VEX, "vroundps", "V,W,I", NMD_X86_INSTRUCTION_VROUNDPS },
+	{ 0x08, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W0 | _NMD_AVX_BCST, "vrndscaleps", "V,W,I", NMD_X86_INSTRUCTION_VRNDSCALEPS },
+	{ 0x09, 1, 8, _NMD_AVX_VEX, "vroundpd", "V,W,I", NMD_X86_INSTRUCTION_VROUNDPD },
+	{ 0x09, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_EVEX_W1 | _NMD_AVX_BCST, "vrndscalepd", "V,W,I", NMD_X86_INSTRUCTION_VRNDSCALEPD },
+	{ 0x0a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vroundss", "Vx,Hx,Wx4,I", NMD_X86_INSTRUCTION_VROUNDSS },
+	{ 0x0a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vrndscaless", "Vx,Hx,Wx4,I", NMD_X86_INSTRUCTION_VRNDSCALESS },
+	{ 0x0b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vroundsd", "Vx,Hx,Wx8,I", NMD_X86_INSTRUCTION_VROUNDSD },
+	{ 0x0b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W1, "vrndscalesd", "Vx,Hx,Wx8,I", NMD_X86_INSTRUCTION_VRNDSCALESD },
+	{ 0x0c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vblendps", "V,H,W,I", NMD_X86_INSTRUCTION_VBLENDPS },
+	{ 0x0d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vblendpd", "V,H,W,I", NMD_X86_INSTRUCTION_VBLENDPD },
+	{ 0x0e, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vpblendw", "V,H,W,I", NMD_X86_INSTRUCTION_VPBLENDW },
+	{ 0x0f, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpalignr", "V,H,W,I", NMD_X86_INSTRUCTION_VPALIGNR },
+	{ 0x14, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0, "vpextrb", "Ed1,Vx,I", NMD_X86_INSTRUCTION_VPEXTRB },
+	{ 0x15, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0, "vpextrw", "Ed2,Vx,I", NMD_X86_INSTRUCTION_VPEXTRW },
+	{ 0x16, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L0, "vpextrd", "E,Vx,I", NMD_X86_INSTRUCTION_VPEXTRD },
+	{ 0x16, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L0, "vpextrq", "E,Vx,I", NMD_X86_INSTRUCTION_VPEXTRQ },
+	{ 0x17, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0, "vextractps", "Ed4,Vx,I", NMD_X86_INSTRUCTION_VEXTRACTPS },
+	{ 0x18, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vinsertf128", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTF128 },
+	{ 0x18, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_L12, "vinsertf32x4", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTF32X4 },
+	{ 0x18, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_L12, "vinsertf64x2", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTF64X2 },
+	{ 0x19, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1, "vextractf128", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTF128 },
+	{ 0x19, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L12, "vextractf32x4", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTF32X4 },
+	{ 0x19, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L12, "vextractf64x2", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTF64X2 },
+	{ 0x1a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_L2, "vinsertf32x8", "V,H,Wy,I", NMD_X86_INSTRUCTION_VINSERTF32X8 },
+	{ 0x1a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_L2, "vinsertf64x4", "V,H,Wy,I", NMD_X86_INSTRUCTION_VINSERTF64X4 },
+	{ 0x1b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L2, "vextractf32x8", "Wy,V,I", NMD_X86_INSTRUCTION_VEXTRACTF32X8 },
+	{ 0x1b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L2, "vextractf64x4", "Wy,V,I", NMD_X86_INSTRUCTION_VEXTRACTF64X4 },
+	{ 0x1d, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE, "vcvtps2ph", "Wh,V,I", NMD_X86_INSTRUCTION_VCVTPS2PH },
+	{ 0x1e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpcmpud", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPUD },
+	{ 0x1e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpcmpuq", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPUQ },
+	{ 0x1f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpcmpd", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPD },
+	{ 0x1f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpcmpq", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPQ },
+	{ 0x20, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "vpinsrb", "Vx,Hx,Ed1,I", NMD_X86_INSTRUCTION_VPINSRB },
+	{ 0x21, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_L0 | _NMD_AVX_VVVV | _NMD_AVX_EVEX_W0, "vinsertps", "Vx,Hx,Wx4,I", NMD_X86_INSTRUCTION_VINSERTPS },
+	{ 0x22, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L0 | _NMD_AVX_VVVV, "vpinsrd", "Vx,Hx,E,I", NMD_X86_INSTRUCTION_VPINSRD },
+	{ 0x22, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L0 | _NMD_AVX_VVVV, "vpinsrq", "Vx,Hx,E,I", NMD_X86_INSTRUCTION_VPINSRQ },
+	{ 0x23, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vshuff32x4", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFF32X4 },
+	{ 0x23, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vshuff64x2", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFF64X2 },
+	{ 0x25, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpternlogd", "V,H,W,I", NMD_X86_INSTRUCTION_VPTERNLOGD },
+	{ 0x25, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vpternlogq", "V,H,W,I", NMD_X86_INSTRUCTION_VPTERNLOGQ },
+	{ 0x26, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vgetmantps", "V,W,I", NMD_X86_INSTRUCTION_VGETMANTPS },
+	{ 0x26, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vgetmantpd", "V,W,I", NMD_X86_INSTRUCTION_VGETMANTPD },
+	{ 0x27, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vgetmantss", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VGETMANTSS },
+	{ 0x27, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vgetmantsd", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VGETMANTSD },
+	{ 0x30, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftrb", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTRB },
+	{ 0x30, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftrw", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTRW },
+	{ 0x31, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftrd", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTRD },
+	{ 0x31, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftrq", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTRQ },
+	{ 0x32, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftlb", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTLB },
+	{ 0x32, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftlw", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTLW },
+	{ 0x33, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftld", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTLD },
+	{ 0x33, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W1 | _NMD_AVX_REG | _NMD_AVX_L0, "kshiftlq", "K,k,I", NMD_X86_INSTRUCTION_KSHIFTLQ },
+	{ 0x38, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vinserti128", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTI128 },
+	{ 0x38, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_L12, "vinserti32x4", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTI32X4 },
+	{ 0x38, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_L12, "vinserti64x2", "V,H,Wx,I", NMD_X86_INSTRUCTION_VINSERTI64X2 },
+	{ 0x39, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1, "vextracti128", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTI128 },
+	{ 0x39, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L12, "vextracti32x4", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTI32X4 },
+	{ 0x39, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L12, "vextracti64x2", "Wx,V,I", NMD_X86_INSTRUCTION_VEXTRACTI64X2 },
+	{ 0x3a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_L2, "vinserti32x8", "V,H,Wy,I", NMD_X86_INSTRUCTION_VINSERTI32X8 },
+	{ 0x3a, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_L2, "vinserti64x4", "V,H,Wy,I", NMD_X86_INSTRUCTION_VINSERTI64X4 },
+	{ 0x3b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_L2, "vextracti32x8", "Wy,V,I", NMD_X86_INSTRUCTION_VEXTRACTI32X8 },
+	{ 0x3b, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_L2, "vextracti64x4", "Wy,V,I", NMD_X86_INSTRUCTION_VEXTRACTI64X4 },
+	{ 0x3e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpcmpub", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPUB },
+	{ 0x3e, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpcmpuw", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPUW },
+	{ 0x3f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpcmpb", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPB },
+	{ 0x3f, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpcmpw", "K,H,W,I", NMD_X86_INSTRUCTION_VPCMPW },
+	{ 0x40, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vdpps", "V,H,W,I", NMD_X86_INSTRUCTION_VDPPS },
+	{ 0x41, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_VVVV, "vdppd", "V,H,W,I", NMD_X86_INSTRUCTION_VDPPD },
+	{ 0x42, 1, 8, _NMD_AVX_VEX | _NMD_AVX_VVVV, "vmpsadbw", "V,H,W,I", NMD_X86_INSTRUCTION_VMPSADBW },
+	{ 0x42, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vdbpsadbw", "V,H,W,I", NMD_X86_INSTRUCTION_VDBPSADBW },
+	{ 0x43, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vshufi32x4", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFI32X4 },
+	{ 0x43, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_L12, "vshufi64x2", "V,H,W,I", NMD_X86_INSTRUCTION_VSHUFI64X2 },
+	{ 0x44, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_VVVV, "vpclmulqdq", "V,H,W,I", NMD_X86_INSTRUCTION_VPCLMULQDQ },
+	{ 0x46, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_L1 | _NMD_AVX_VVVV, "vperm2i128", "V,H,W,I", NMD_X86_INSTRUCTION_VPERM2I128 },
+	{ 0x4a, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vblendvps", "V,H,W,L", NMD_X86_INSTRUCTION_VBLENDVPS },
+	{ 0x4b, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vblendvpd", "V,H,W,L", NMD_X86_INSTRUCTION_VBLENDVPD },
+	{ 0x4c, 1, 8, _NMD_AVX_VEX | _NMD_AVX_W0 | _NMD_AVX_VVVV, "vpblendvb", "V,H,W,L", NMD_X86_INSTRUCTION_VPBLENDVB },
+	{ 0x50, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vrangeps", "V,H,W,I", NMD_X86_INSTRUCTION_VRANGEPS },
+	{ 0x50, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vrangepd", "V,H,W,I", NMD_X86_INSTRUCTION_VRANGEPD },
+	{ 0x51, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vrangess", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VRANGESS },
+	{ 0x51, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vrangesd", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VRANGESD },
+	{ 0x54, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfixupimmps", "V,H,W,I", NMD_X86_INSTRUCTION_VFIXUPIMMPS },
+	{ 0x54, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_BCST | _NMD_AVX_RW, "vfixupimmpd", "V,H,W,I", NMD_X86_INSTRUCTION_VFIXUPIMMPD },
+	{ 0x55, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfixupimmss", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VFIXUPIMMSS },
+	{ 0x55, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV | _NMD_AVX_RW, "vfixupimmsd", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VFIXUPIMMSD },
+	{ 0x56, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vreduceps", "V,W,I", NMD_X86_INSTRUCTION_VREDUCEPS },
+	{ 0x56, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_BCST, "vreducepd", "V,W,I", NMD_X86_INSTRUCTION_VREDUCEPD },
+	{ 0x57, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vreducess", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VREDUCESS },
+	{ 0x57, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_SAE | _NMD_AVX_VVVV, "vreducesd", "Vx,Hx,Wxs,I", NMD_X86_INSTRUCTION_VREDUCESD },
+	{ 0x60, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_RO, "vpcmpestrm", "Vx,Wx,I", NMD_X86_INSTRUCTION_VPCMPESTRM },
+	{ 0x61, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_RO, "vpcmpestri", "Vx,Wx,I", NMD_X86_INSTRUCTION_VPCMPESTRI },
+	{ 0x62, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_RO, "vpcmpistrm", "Vx,Wx,I", NMD_X86_INSTRUCTION_VPCMPISTRM },
+	{ 0x63, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0 | _NMD_AVX_RO, "vpcmpistri", "Vx,Wx,I", NMD_X86_INSTRUCTION_VPCMPISTRI },
+	{ 0x66, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_BCST, "vfpclassps", "K,W,I", NMD_X86_INSTRUCTION_VFPCLASSPS },
+	{ 0x66, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_BCST, "vfpclasspd", "K,W,I", NMD_X86_INSTRUCTION_VFPCLASSPD },
+	{ 0x67, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0, "vfpclassss", "K,Wxs,I", NMD_X86_INSTRUCTION_VFPCLASSSS },
+	{ 0x67, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1, "vfpclasssd", "K,Wxs,I", NMD_X86_INSTRUCTION_VFPCLASSSD },
+	{ 0x70, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpshldw", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHLDW },
+	{ 0x71, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpshldd", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHLDD },
+	{ 0x71, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpshldq", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHLDQ },
+	{ 0x72, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV, "vpshrdw", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHRDW },
+	{ 0x73, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W0 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpshrdd", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHRDD },
+	{ 0x73, 1, 8, _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vpshrdq", "V,H,W,I", NMD_X86_INSTRUCTION_VPSHRDQ },
+	{ 0xce, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vgf2p8affineqb", "V,H,W,I", NMD_X86_INSTRUCTION_VGF2P8AFFINEQB },
+	{ 0xcf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_EVEX | _NMD_AVX_W1 | _NMD_AVX_VVVV | _NMD_AVX_BCST, "vgf2p8affineinvqb", "V,H,W,I", NMD_X86_INSTRUCTION_VGF2P8AFFINEINVQB },
+	{ 0xdf, 1, 8, _NMD_AVX_VEX | _NMD_AVX_L0, "vaeskeygenassist", "Vx,Wx,I", NMD_X86_INSTRUCTION_VAESKEYGENASSIST },
+	{ 0xf0, 3, 8, _NMD_AVX_VEX | _NMD_AVX_L0, "rorx", "G,E,I", NMD_X86_INSTRUCTION_RORX }
+};
+
+/* The index of the first entry of each opcode in the table of each map, followed by the number of entries in the table. Must be kept in sync with the tables. */
+const uint16_t _nmd_avxOpcodeIndex[3][257] = {
+	/* 0F */
 	{
-		if (arr[i] == x)
+		/* 00 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		/* 10 */ 0, 6, 12, 17, 19, 21, 23, 27, 29, 29, 29, 29, 29, 29, 29, 29,
+		/* 20 */ 29, 29, 29, 29, 29, 29, 29, 29, 29, 31, 33, 37, 39, 41, 43, 45,
+		/* 30 */ 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47, 47,
+		/* 40 */ 47, 47, 51, 55, 55, 59, 63, 67, 71, 71, 71, 75, 78, 78, 78, 78,
+		/* 50 */ 78, 80, 84, 86, 88, 90, 92, 94, 96, 100, 104, 108, 114, 118, 122, 126,
+		/* 60 */ 130, 131, 132, 133, 134, 136, 138, 140, 141, 142, 143, 144, 145, 146, 147, 149,
+		/* 70 */ 157, 160, 166, 177, 185, 187, 189, 191, 193, 199, 205, 211, 216, 218, 220, 223,
+		/* 80 */ 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231,
+		/* 90 */ 231, 235, 239, 243, 247, 247, 247, 247, 247, 251, 255, 255, 255, 255, 255, 255,
+		/* A0 */ 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		/* B0 */ 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+		/* C0 */ 255, 255, 255, 263, 263, 264, 265, 267, 267, 267, 267, 267, 267, 267, 267, 267,
+		/* D0 */ 267, 269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, 282, 283, 284, 285,
+		/* E0 */ 288, 289, 290, 293, 294, 295, 296, 301, 302, 303, 304, 305, 308, 309, 310, 311,
+		/* F0 */ 314, 315, 316, 317, 318, 319, 320, 321, 322, 323, 324, 325, 326, 327, 328, 329,
+		/* -- */ 329
+	},
+	/* 0F38 */
+	{
+		/* 00 */ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 16, 17,
+		/* 10 */ 18, 20, 22, 24, 26, 29, 32, 35, 36, 37, 40, 43, 45, 46, 47, 48,
+		/* 20 */ 49, 51, 53, 55, 57, 59, 61, 65, 69, 72, 76, 78, 79, 82, 85, 86,
+		/* 30 */ 87, 89, 91, 93, 95, 97, 99, 102, 104, 107, 112, 114, 117, 118, 121, 122,
+		/* 40 */ 125, 128, 129, 131, 133, 135, 137, 140, 142, 142, 142, 142, 142, 144, 146, 148,
+		/* 50 */ 150, 151, 152, 153, 154, 156, 158, 158, 158, 159, 162, 165, 167, 167, 167, 167,
+		/* 60 */ 167, 167, 167, 169, 171, 173, 175, 177, 177, 177, 177, 177, 177, 177, 177, 177,
+		/* 70 */ 177, 178, 180, 181, 183, 183, 185, 187, 189, 190, 191, 192, 193, 195, 197, 199,
+		/* 80 */ 201, 201, 201, 201, 202, 202, 202, 202, 202, 204, 206, 208, 210, 212, 214, 216,
+		/* 90 */ 217, 221, 225, 229, 233, 233, 233, 235, 237, 239, 241, 243, 245, 247, 249, 251,
+		/* A0 */ 253, 255, 257, 259, 261, 261, 261, 263, 265, 267, 269, 271, 273, 275, 277, 279,
+		/* B0 */ 281, 281, 281, 281, 281, 282, 283, 285, 287, 289, 291, 293, 295, 297, 299, 301,
+		/* C0 */ 303, 303, 303, 303, 303, 305, 305, 305, 305, 305, 305, 305, 305, 305, 305, 305,
+		/* D0 */ 306, 306, 306, 306, 306, 306, 306, 306, 306, 306, 306, 306, 307, 308, 309, 310,
+		/* E0 */ 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311, 311,
+		/* F0 */ 311, 311, 311, 312, 315, 315, 318, 319, 323, 323, 323, 323, 323, 323, 323, 323,
+		/* -- */ 323
+	},
+	/* 0F3A */
+	{
+		/* 00 */ 0, 2, 4, 5, 7, 8, 10, 11, 11, 13, 15, 17, 19, 20, 21, 22,
+		/* 10 */ 23, 23, 23, 23, 23, 24, 25, 27, 28, 31, 34, 36, 38, 38, 39, 41,
+		/* 20 */ 43, 44, 45, 47, 49, 49, 51, 53, 55, 55, 55, 55, 55, 55, 55, 55,
+		/* 30 */ 55, 57, 59, 61, 63, 63, 63, 63, 63, 66, 69, 71, 73, 73, 73, 75,
+		/* 40 */ 77, 78, 79, 81, 83, 84, 84, 85, 85, 85, 85, 86, 87, 88, 88, 88,
+		/* 50 */ 88, 90, 92, 92, 92, 94, 96, 98, 100, 100, 100, 100, 100, 100, 100, 100,
+		/* 60 */ 100, 101, 102, 103, 104, 104, 104, 106, 108, 108, 108, 108, 108, 108, 108, 108,
+		/* 70 */ 108, 109, 111, 112, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+		/* 80 */ 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+		/* 90 */ 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+		/* A0 */ 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+		/* B0 */ 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+		/* C0 */ 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 115,
+		/* D0 */ 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+		/* E0 */ 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117,
+		/* F0 */ 117, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118,
+		/* -- */ 118
+	}
+};
+
+/* Returns the byte of the VEX or EVEX prefix at 'prefix' that holds the W, vvvv and pp fields(and L for VEX). */
+uint8_t _nmd_get_avx_wvvvvpp(const uint8_t* prefix)
+{
+	/* The two byte VEX form implies W=0 and has R where the other forms have W. */
+	return prefix[0] == 0xc5 ? (uint8_t)(prefix[1] & 0b01111111) : prefix[2];
+}
+
+/* Returns true if W selects the size of a general-purpose register operand of 'operands'. */
+bool _nmd_is_avx_gpr_size_selected_by_w(const char* operands)
+{
+	for (; *operands; operands++)
+	{
+		if ((*operands == 'G' || *operands == 'E' || *operands == 'B') && operands[1] != 'd')
 			return true;
-	}; 
-	
+	}
+
 	return false;
 }
 
-/* Returns a pointer to the first occurrence of 'c' in 's', or a null pointer if 'c' is not present. */
-const char* _nmd_strchr(const char* s, char c)
+/*
+Returns the entry of the VEX or EVEX instruction whose prefix('C4h', 'C5h' or '62h') is at 'prefix', or zero if there's none.
+Outside of 64-bit mode W doesn't select a 64-bit general-purpose register, so instructions that use it for that take their W=0 form.
+*/
+const _nmd_avx_entry* _nmd_find_avx_entry(const uint8_t* prefix, uint8_t op, nmd_x86_modrm modrm, NMD_X86_MODE mode)
 {
-	for (; *s; s++)
+	const bool isEvex = prefix[0] == 0x62;
+	const uint8_t wvvvvpp = _nmd_get_avx_wvvvvpp(prefix);
+	const uint8_t map = (uint8_t)(prefix[0] == 0xc5 ? 1 : prefix[1] & (isEvex ? 0b00000111 : 0b00011111));
+	const uint8_t pp = (uint8_t)(wvvvvpp & 0b11);
+	const bool W = (wvvvvpp & 0b10000000) == 0b10000000;
+	const uint8_t L = (uint8_t)(isEvex ? (prefix[3] >> 5) & 0b11 : (wvvvvpp >> 2) & 1);
+
+	const _nmd_avx_entry* entries;
+	if (map == 1)
+		entries = _nmd_avxOpcodes0F;
+	else if (map == 2)
+		entries = _nmd_avxOpcodes0F38;
+	else if (map == 3)
+		entries = _nmd_avxOpcodes0F3A;
+	else
+		return 0;
+
+	size_t i = _nmd_avxOpcodeIndex[map - 1][op];
+	const size_t end = _nmd_avxOpcodeIndex[map - 1][op + 1];
+	const uint32_t requiredEncoding = isEvex ? _NMD_AVX_EVEX : _NMD_AVX_VEX;
+	const uint32_t requiresW0 = isEvex ? (_NMD_AVX_W0 | _NMD_AVX_EVEX_W0) : _NMD_AVX_W0;
+	const uint32_t requiresW1 = isEvex ? (_NMD_AVX_W1 | _NMD_AVX_EVEX_W1) : _NMD_AVX_W1;
+	for (; i < end; i++)
 	{
-		if (*s == c)
-			return s;
+		const _nmd_avx_entry* const entry = entries + i;
+		if (entry->pp != pp || !(entry->flags & requiredEncoding) || (entry->reg != 8 && entry->reg != modrm.fields.reg))
+			continue;
+
+		if (((entry->flags & requiresW0 && W) || (entry->flags & requiresW1 && !W)) && (mode == NMD_X86_MODE_64 || !_nmd_is_avx_gpr_size_selected_by_w(entry->operands)))
+			continue;
+
+		if ((entry->flags & _NMD_AVX_REG && modrm.fields.mod != 0b11) || (entry->flags & _NMD_AVX_MEM && modrm.fields.mod == 0b11) ||
+			(entry->flags & _NMD_AVX_L0 && L != 0) || (entry->flags & _NMD_AVX_L1 && L != 1) ||
+			(entry->flags & _NMD_AVX_L12 && L != 1 && L != 2) || (entry->flags & _NMD_AVX_L2 && L != 2))
+			continue;
+
+		return entry;
 	}
 
 	return 0;
 }
 
-/* Returns a pointer to the last occurrence of 'c' in 's', or a null pointer if 'c' is not present. */
-const char* _nmd_reverse_strchr(const char* s, char c)
+/*
+Returns true if the fields of the VEX or EVEX instruction whose prefix is at 'prefix' that are not described by 'entry' have valid
+values, that is, the ones that don't encode an operand and the register extensions of opmask and general-purpose registers.
+*/
+bool _nmd_is_avx_instruction_valid(const _nmd_avx_entry* entry, const uint8_t* prefix, nmd_x86_modrm modrm, NMD_X86_MODE mode)
 {
-	const char* end = s;
-	while (*end)
-		end++;
+	/* The fields as encoded, that is, the register extensions and 'vvvv' are inverted. */
+	const bool isEvex = prefix[0] == 0x62;
+	const uint8_t vvvv = (uint8_t)((_nmd_get_avx_wvvvvpp(prefix) >> 3) & 0b1111);
+	const bool R = (prefix[1] & 0b10000000) == 0b10000000;
+	const bool X = prefix[0] == 0xc5 || (prefix[1] & 0b01000000) == 0b01000000;
+	const bool B = prefix[0] == 0xc5 || (prefix[1] & 0b00100000) == 0b00100000;
+	const bool R1 = !isEvex || (prefix[1] & 0b00010000) == 0b00010000;
+	const bool V1 = !isEvex || (prefix[3] & 0b00001000) == 0b00001000;
+	const bool b = isEvex && (prefix[3] & 0b00010000) == 0b00010000;
+	const bool z = isEvex && (prefix[3] & 0b10000000) == 0b10000000;
+	const bool isRegister = modrm.fields.mod == 0b11;
+
+	/* 'vvvv' and V' must be 1111b and 1 if they don't encode an operand. V' also extends the index register of VSIB. */
+	if (!(entry->flags & _NMD_AVX_VVVV) && (vvvv != 0b1111 || !(V1 || entry->flags & _NMD_AVX_VSIB)))
+		return false;
+
+	/* Outside of 64-bit mode V' can't extend a register encoded in 'vvvv' and must be 1. */
+	if (mode != NMD_X86_MODE_64 && entry->flags & _NMD_AVX_VVVV && !V1)
+		return false;
+
+	/* VSIB addressing requires a SIB byte. */
+	if (entry->flags & _NMD_AVX_VSIB && (isRegister || modrm.fields.rm != 0b100))
+		return false;
+
+	/* EVEX.b selects broadcast if there's a memory operand, embedded rounding or SAE otherwise. */
+	if (b && !(entry->flags & (isRegister ? (_NMD_AVX_ER | _NMD_AVX_SAE) : _NMD_AVX_BCST)))
+		return false;
 
-	for (; end > s; end--)
+	/* Zeroing-masking requires an opmask other than k0 and is not available if the destination is in memory. */
+	if (z && (!(prefix[3] & 0b00000111) || (!isRegister && (entry->operands[0] == 'W' || entry->operands[0] == 'S' || entry->operands[0] == 'E' || entry->operands[0] == 'k'))))
+		return false;
+
+	/* There are eight opmask registers and sixteen general-purpose registers. Only the extension bits can select others. */
+	if (mode == NMD_X86_MODE_64 && (!R || !R1 || !B || !X || !V1 || !(vvvv & 0b1000)))
 	{
-		if (*end == c)
-			return end;
+		const char* descriptor = entry->operands;
+		for (; *descriptor; descriptor++)
+		{
+			if (descriptor != entry->operands && descriptor[-1] != ',')
+				continue;
+
+			switch (*descriptor)
+			{
+			case 'K': if (!R || !R1) return false; break;
+			case 'G': if (!R1) return false; break;
+			case 'J': if (!(vvvv & 0b1000) || !V1) return false; break;
+			case 'B': if (!V1) return false; break;
+			case 'k': if (isRegister && (!B || (isEvex && !X))) return false; break;
+			case 'E': if (isRegister && isEvex && !X) return false; break;
+			}
+		}
 	}
 
-	return 0;
+	return true;
+}
+
+bool _nmd_findByte(const uint8_t* arr, const size_t N, const uint8_t x)
+{
+	size_t i = 0;
+	for (; i < N; i++)
+	{
+		if (arr[i] == x)
+			return true;
+	}; 
+	
+	return false;
+}
+
+#ifdef _NMD_SSE2
+/*
+Returns the number of consecutive legacy prefixes(and REX prefixes in 64-bit mode) at the start of 'b' by classifying
+16 bytes at once. 'b' must point to at least 16 readable bytes. The result may exceed 'NMD_X86_MAXIMUM_INSTRUCTION_LENGTH'.
+*/
+size_t _nmd_sse2_count_prefixes(const uint8_t* b, NMD_X86_MODE mode)
+{
+	const __m128i bytes = _mm_loadu_si128((const __m128i*)b);
+
+	__m128i prefixes = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)0xf0)), _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)0xf2)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)0xf3)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x2e)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x36)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x3e)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x26)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x64)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x65)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x66)));
+	prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x67)));
+	if (mode == NMD_X86_MODE_64) /* [40,4f] */
+		prefixes = _mm_or_si128(prefixes, _mm_cmpeq_epi8(_mm_and_si128(bytes, _mm_set1_epi8((char)0xf0)), _mm_set1_epi8(0x40)));
+
+	/* Bit 16 is always set, so the index of the first non-prefix byte is at most 16. */
+	const uint32_t nonPrefixes = ~(uint32_t)_mm_movemask_epi8(prefixes);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, nonPrefixes);
+	return index;
+#else
+	return (size_t)__builtin_ctz(nonPrefixes);
+#endif /* _MSC_VER */
 }
+#endif /* _NMD_SSE2 */
 
 /* Returns a pointer to the first occurrence of 's2' in 's', or a null pointer if 's2' is not present. */
 const char* _nmd_strstr(const char* s, const char* s2)
@@ -2706,52 +4460,6 @@ const char* _nmd_strstr_ex(const char* s, const char* s2, const char** s3_opt)
 	return 0;
 }
 
-/* Inserts 'c' at 's'. */
-void _nmd_insert_char(const char* s, char c)
-{
-	char* end = (char*)s;
-	while (*end)
-		end++;
-
-	*(end + 1) = '\0';
-
-	for (; end > s; end--)
-		*end = *(end - 1);
-
-	*end = c;
-}
-
-/* Returns true if there is only a number between 's1' and 's2', false otherwise. */
-bool _nmd_is_number(const char* s1, const char* s2)
-{
-	const char* s = s1;
-	for (; s < s2; s++)
-	{
-		if (!(*s >= '0' && *s <= '9') && !(*s >= 'a' && *s <= 'f') && !(*s >= 'A' && *s <= 'F'))
-		{
-			if ((s == s1 + 1 && *s1 == '0' && (*s == 'x' || *s == 'X')) || (s == s2 - 1 && (*s == 'h' || *s == 'H')))
-				continue;
-
-			return false;
-		}
-	}
-
-	return true;
-}
-
-/* Returns a pointer to the first occurence of a number between 's1' and 's2', zero otherwise. */
-const char* _nmd_find_number(const char* s1, const char* s2)
-{
-	const char* s = s1;
-	for (; s < s2; s++)
-	{
-		if ((*s >= '0' && *s <= '9') || (*s >= 'a' && *s <= 'f') || (*s >= 'A' && *s <= 'F'))
-			return s;
-	}
-
-	return 0;
-}
-
 /* Returns true if s1 matches s2 exactly. */
 bool _nmd_strcmp(const char* s1, const char* s2)
 {
@@ -2779,6 +4487,10 @@ typedef struct _nmd_assemble_info
 	uint8_t* b; /* buffer */
 	NMD_X86_MODE mode;
 	uint64_t runtimeAddress;
+	const nmd_x86_label* labels; /* Labels branches may refer to, zero for nmd_x86_assemble(). */
+	size_t numLabels;
+	bool labelsResolved; /* If false, every label resolves to the instruction's own address. */
+	bool nearBranch; /* in: the branch must use a rel32 displacement. out: set if the branch uses a rel32 displacement. */
 } _nmd_assemble_info;
 
 enum _NMD_NUMBER_BASE
@@ -2789,14 +4501,14 @@ enum _NMD_NUMBER_BASE
 	_NMD_NUMBER_BASE_BINARY = 2
 };
 
-size_t _nmd_assemble_reg(_nmd_assemble_info* ai, uint8_t baseByte)
+size_t _nmd_assemble_reg(_nmd_assemble_info* ai, const char* s, uint8_t baseByte)
 {
 	uint8_t i = 0;
 	if (ai->mode == NMD_X86_MODE_64)
 	{
 		for (i = 0; i < _NMD_NUM_ELEMENTS(_nmd_reg64); i++)
 		{
-			if (_nmd_strcmp(ai->s, _nmd_reg64[i]))
+			if (_nmd_strcmp(s, _nmd_reg64[i]))
 			{
 				ai->b[0] = baseByte + i;
 				return 1;
@@ -2805,7 +4517,7 @@ size_t _nmd_assemble_reg(_nmd_assemble_info* ai, uint8_t baseByte)
 
 		for (i = 0; i < _NMD_NUM_ELEMENTS(_nmd_regrx); i++)
 		{
-			if (_nmd_strcmp(ai->s, _nmd_regrx[i]))
+			if (_nmd_strcmp(s, _nmd_regrx[i]))
 			{
 				ai->b[0] = 0x41;
 				ai->b[1] = baseByte + i;
@@ -2817,7 +4529,7 @@ size_t _nmd_assemble_reg(_nmd_assemble_info* ai, uint8_t baseByte)
 	{
 		for (i = 0; i < _NMD_NUM_ELEMENTS(_nmd_reg32); i++)
 		{
-			if (_nmd_strcmp(ai->s, _nmd_reg32[i]))
+			if (_nmd_strcmp(s, _nmd_reg32[i]))
 			{
 				ai->b[0] = baseByte + i;
 				return 1;
@@ -2827,7 +4539,7 @@ size_t _nmd_assemble_reg(_nmd_assemble_info* ai, uint8_t baseByte)
 
 	for (i = 0; i < _NMD_NUM_ELEMENTS(_nmd_reg16); i++)
 	{
-		if (_nmd_strcmp(ai->s, _nmd_reg16[i]))
+		if (_nmd_strcmp(s, _nmd_reg16[i]))
 		{
 			ai->b[0] = 0x66;
 			ai->b[1] = baseByte + i;
@@ -3186,491 +4898,590 @@ bool _nmd_parse_memory_operand(const char** string, nmd_x86_memory_operand* oper
 	return true;
 }
 
-size_t _nmd_assemble_single(_nmd_assemble_info* ai)
+#define _NMD_MODES_ALL (NMD_X86_MODE_16 | NMD_X86_MODE_32 | NMD_X86_MODE_64)
+#define _NMD_MODES_LEGACY (NMD_X86_MODE_16 | NMD_X86_MODE_32)
+#define _NMD_MODES_32_64 (NMD_X86_MODE_32 | NMD_X86_MODE_64)
+
+enum _NMD_FORM_TYPE
 {
-	size_t i = 0;
+	_NMD_FORM_TYPE_BYTES = 0, /* The instruction is encoded as 'bytes'. */
+	_NMD_FORM_TYPE_PREFIX,    /* A prefix keyword. 'bytes[0]' is the prefix. */
+	_NMD_FORM_TYPE_JCC,       /* 'bytes[0]' is the condition code. */
+	_NMD_FORM_TYPE_JMP,
+	_NMD_FORM_TYPE_CALL,
+	_NMD_FORM_TYPE_INC_DEC,   /* 'bytes[0]' is the modrm.reg extension. */
+	_NMD_FORM_TYPE_PUSH,
+	_NMD_FORM_TYPE_POP,
+	_NMD_FORM_TYPE_EMIT
+};
 
-	/* Parse prefixes */
-	bool lockPrefix = false, repeatPrefix = false, repeatZeroPrefix = false, repeatNotZeroPrefix = false;
-	if (_nmd_strstr(ai->s, "lock ") == ai->s)
-		lockPrefix = true, ai->s += 5;
-	else if (_nmd_strstr(ai->s, "rep ") == ai->s)
-		repeatPrefix = true, ai->s += 4;
-	else if (_nmd_strstr(ai->s, "repe ") == ai->s || _nmd_strstr(ai->s, "repz ") == ai->s)
-		repeatZeroPrefix = true, ai->s += 5;
-	else if (_nmd_strstr(ai->s, "repne ") == ai->s || _nmd_strstr(ai->s, "repnz ") == ai->s)
-		repeatNotZeroPrefix = true, ai->s += 6;
-	
-	if (_nmd_strstr(ai->s, "xacquire ") == ai->s)
-	{
+/* An instruction form accepted by the assembler. */
+typedef struct _nmd_assembler_form
+{
+	const char* mnemonic;
+	const char* operands; /* The exact operands(e.g. "", "far", "r8,rax"), or zero if they are parsed by the form's handler. */
+	uint8_t type;         /* A member of '_NMD_FORM_TYPE'. */
+	uint8_t modes;        /* A mask of the modes where the form is valid. */
+	uint8_t length;       /* The number of bytes of a '_NMD_FORM_TYPE_BYTES' form. */
+	uint8_t bytes[3];
+} _nmd_assembler_form;
+
+/*
+Sorted by mnemonic so it can be binary searched. Forms of the same mnemonic are tried in order, forms with exact
+operands must come before the form whose handler parses the operands.
+*/
+const _nmd_assembler_form _nmd_assemblerForms[] = {
+	{ "aaa",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x37 } },
+	{ "aas",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x3f } },
+	{ "call",     0,         _NMD_FORM_TYPE_CALL,      _NMD_MODES_ALL,    0, { 0 } },
+	{ "cbw",      "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x98 } },
+	{ "cbw",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  2, { 0x66, 0x98 } },
+	{ "cdq",      "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x99 } },
+	{ "cdq",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  1, { 0x99 } },
+	{ "cdqe",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x48, 0x98 } },
+	{ "cld",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xfc } },
+	{ "cli",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xfa } },
+	{ "clts",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x06 } },
+	{ "cmc",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xf5 } },
+	{ "cpuid",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xa2 } },
+	{ "cqo",      "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x48, 0x99 } },
+	{ "cwd",      "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x99 } },
+	{ "cwd",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  2, { 0x66, 0x99 } },
+	{ "cwde",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x98 } },
+	{ "cwde",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  1, { 0x98 } },
+	{ "daa",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x27 } },
+	{ "das",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x2f } },
+	{ "dec",      0,         _NMD_FORM_TYPE_INC_DEC,   _NMD_MODES_ALL,    0, { 0x01 } },
+	{ "emit",     0,         _NMD_FORM_TYPE_EMIT,      _NMD_MODES_ALL,    0, { 0 } },
+	{ "emms",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x77 } },
+	{ "femms",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x0e } },
+	{ "fwait",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x9b } },
+	{ "getsec",   "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x37 } },
+	{ "hlt",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xf4 } },
+	{ "inc",      0,         _NMD_FORM_TYPE_INC_DEC,   _NMD_MODES_ALL,    0, { 0x00 } },
+	{ "int1",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xf1 } },
+	{ "int3",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xcc } },
+	{ "into",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xce } },
+	{ "invd",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x08 } },
+	{ "iret",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0xcf } },
+	{ "iret",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  2, { 0x66, 0xcf } },
+	{ "iretd",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0xcf } },
+	{ "iretd",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  1, { 0xcf } },
+	{ "iretq",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x48, 0xcf } },
+	{ "ja",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x07 } },
+	{ "jae",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x03 } },
+	{ "jb",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x02 } },
+	{ "jbe",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x06 } },
+	{ "jc",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x02 } },
+	{ "je",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x04 } },
+	{ "jg",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0f } },
+	{ "jge",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0d } },
+	{ "jl",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0c } },
+	{ "jle",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0e } },
+	{ "jmp",      0,         _NMD_FORM_TYPE_JMP,       _NMD_MODES_ALL,    0, { 0 } },
+	{ "jna",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x06 } },
+	{ "jnae",     0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x02 } },
+	{ "jnb",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x03 } },
+	{ "jnbe",     0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x07 } },
+	{ "jnc",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x03 } },
+	{ "jne",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x05 } },
+	{ "jng",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0e } },
+	{ "jnge",     0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0c } },
+	{ "jnl",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0d } },
+	{ "jnle",     0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0f } },
+	{ "jno",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x01 } },
+	{ "jnp",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0b } },
+	{ "jns",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x09 } },
+	{ "jnz",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x05 } },
+	{ "jo",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x00 } },
+	{ "jp",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0a } },
+	{ "jpe",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0a } },
+	{ "jpo",      0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x0b } },
+	{ "js",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x08 } },
+	{ "jz",       0,         _NMD_FORM_TYPE_JCC,       _NMD_MODES_ALL,    0, { 0x04 } },
+	{ "lahf",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x9f } },
+	{ "leave",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xc9 } },
+	{ "lock",     0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf0 } },
+	{ "nop",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x90 } },
+	{ "pause",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0xf3, 0x90 } },
+	{ "pop",      "es",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x07 } },
+	{ "pop",      "ss",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x17 } },
+	{ "pop",      "ds",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x1f } },
+	{ "pop",      "fs",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xa1 } },
+	{ "pop",      "gs",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xa9 } },
+	{ "pop",      0,         _NMD_FORM_TYPE_POP,       _NMD_MODES_ALL,    0, { 0 } },
+	{ "popa",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x61 } },
+	{ "popa",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   2, { 0x66, 0x61 } },
+	{ "popad",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x61 } },
+	{ "popad",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   1, { 0x61 } },
+	{ "popf",     "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x9d } },
+	{ "popf",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  2, { 0x66, 0x9d } },
+	{ "popfd",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x9d } },
+	{ "popfd",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   1, { 0x9d } },
+	{ "popfq",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   1, { 0x9d } },
+	{ "push",     "es",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x06 } },
+	{ "push",     "ss",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x16 } },
+	{ "push",     "ds",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x1e } },
+	{ "push",     "cs",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x0e } },
+	{ "push",     "fs",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xa0 } },
+	{ "push",     "gs",      _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xa8 } },
+	{ "push",     0,         _NMD_FORM_TYPE_PUSH,      _NMD_MODES_ALL,    0, { 0 } },
+	{ "pusha",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x60 } },
+	{ "pusha",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   2, { 0x66, 0x60 } },
+	{ "pushad",   "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x60 } },
+	{ "pushad",   "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   1, { 0x60 } },
+	{ "pushf",    "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   1, { 0x9c } },
+	{ "pushf",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_32_64,  2, { 0x66, 0x9c } },
+	{ "pushfd",   "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_16,   2, { 0x66, 0x9c } },
+	{ "pushfd",   "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_32,   1, { 0x9c } },
+	{ "pushfq",   "",        _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   1, { 0x9c } },
+	{ "rdmsr",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x32 } },
+	{ "rdpmc",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x33 } },
+	{ "rdtsc",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x31 } },
+	{ "rep",      0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf3 } },
+	{ "repe",     0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf3 } },
+	{ "repne",    0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf2 } },
+	{ "repnz",    0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf2 } },
+	{ "repz",     0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf3 } },
+	{ "ret",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xc3 } },
+	{ "ret",      "far",     _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xcb } },
+	{ "retf",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xcb } },
+	{ "rsm",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0xaa } },
+	{ "sahf",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0x9e } },
+	{ "salc",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xd6 } },
+	{ "slc",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xf8 } },
+	{ "stc",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xf9 } },
+	{ "std",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xfd } },
+	{ "sti",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xfb } },
+	{ "syscall",  "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x05 } },
+	{ "sysenter", "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x34 } },
+	{ "sysexit",  "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x35 } },
+	{ "sysret",   "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x07 } },
+	{ "ud2",      "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x0b } },
+	{ "wbinvd",   "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x09 } },
+	{ "wrmsr",    "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    2, { 0x0f, 0x30 } },
+	{ "xacquire", 0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf2 } },
+	{ "xchg",     "r8,rax",  _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x49, 0x90 } },
+	{ "xchg",     "rax,r8",  _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x49, 0x90 } },
+	{ "xchg",     "r8d,eax", _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x41, 0x90 } },
+	{ "xchg",     "eax,r8d", _NMD_FORM_TYPE_BYTES,     NMD_X86_MODE_64,   2, { 0x41, 0x90 } },
+	{ "xlat",     "",        _NMD_FORM_TYPE_BYTES,     _NMD_MODES_ALL,    1, { 0xd7 } },
+	{ "xrelease", 0,         _NMD_FORM_TYPE_PREFIX,    _NMD_MODES_ALL,    0, { 0xf3 } }
+};
 
+/* Compares the mnemonic at 's', which ends at a ' '(space) or at the null character, to 'mnemonic'. */
+int _nmd_compare_mnemonic(const char* s, const char* mnemonic)
+{
+	for (; *s != ' ' && *s != '\0'; s++, mnemonic++)
+	{
+		if (*s != *mnemonic)
+			return *s < *mnemonic ? -1 : 1;
 	}
-	else if (_nmd_strstr(ai->s, "xrelease ") == ai->s)
+
+	return *mnemonic ? -1 : 0;
+}
+
+/*
+Returns the first form of the mnemonic at 's', or zero if the mnemonic is not supported.
+'operands' receives a pointer to the operands, or to the null character if there are none.
+*/
+const _nmd_assembler_form* _nmd_find_form(const char* s, const char** operands)
+{
+	size_t low = 0, high = _NMD_NUM_ELEMENTS(_nmd_assemblerForms);
+	while (low < high)
 	{
+		const size_t middle = low + (high - low) / 2;
+		if (_nmd_compare_mnemonic(s, _nmd_assemblerForms[middle].mnemonic) > 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if (low == _NMD_NUM_ELEMENTS(_nmd_assemblerForms) || _nmd_compare_mnemonic(s, _nmd_assemblerForms[low].mnemonic) != 0)
+		return 0;
+
+	while (*s != ' ' && *s != '\0')
+		s++;
+
+	*operands = *s == ' ' ? s + 1 : s;
+	return &_nmd_assemblerForms[low];
+}
 
+/* Returns true if the label's name is 's', which is lowercase. */
+bool _nmd_label_equals(const nmd_x86_label* label, const char* s)
+{
+	size_t i = 0;
+	for (; i < label->nameLength; i++)
+	{
+		if (_NMD_TOLOWER(label->name[i]) != s[i])
+			return false;
 	}
 
-	/* Parse opcodes */
-	if (ai->mode == NMD_X86_MODE_64) /* Only x86-64. */
+	return s[i] == '\0';
+}
+
+/* Parses the target of a relative branch, which is either an address or a label. */
+bool _nmd_parse_branch_target(const _nmd_assemble_info* ai, const char* operands, uint64_t* target)
+{
+	if (_NMD_IS_DECIMAL_NUMBER(operands[0]) || operands[0] == '-')
 	{
-		if (_nmd_strcmp(ai->s, "xchg r8,rax") || _nmd_strcmp(ai->s, "xchg rax,r8"))
-		{
-			ai->b[0] = 0x49;
-			ai->b[1] = 0x90;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "xchg r8d,eax") || _nmd_strcmp(ai->s, "xchg eax,r8d"))
-		{
-			ai->b[0] = 0x41;
-			ai->b[1] = 0x90;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "pushfq"))
-		{
-			ai->b[0] = 0x9c;
-			return 1;
-		}
-		else if (_nmd_strcmp(ai->s, "popfq"))
-		{
-			ai->b[0] = 0x9d;
-			return 1;
-		}
-		else if (_nmd_strcmp(ai->s, "iretq"))
-		{
-			ai->b[0] = 0x48;
-			ai->b[1] = 0xcf;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "cdqe"))
-		{
-			ai->b[0] = 0x48;
-			ai->b[1] = 0x98;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "cqo"))
-		{
-			ai->b[0] = 0x48;
-			ai->b[1] = 0x99;
-			return 2;
-		}
+		int64_t num;
+		size_t numDigits;
+		if (!_nmd_parse_number(operands, &num, &numDigits) || operands[numDigits] != '\0')
+			return false;
+
+		*target = (uint64_t)num;
+		return true;
 	}
-	else /* x86-16 / x86-32 */
+
+	size_t i = 0;
+	for (; i < ai->numLabels; i++)
 	{
-		if (_nmd_strcmp(ai->s, "pushad"))
-		{
-			ai->b[0] = 0x60;
-			return 1;
-		}
-		else if (_nmd_strcmp(ai->s, "pusha"))
-		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0x60;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "popad"))
-		{
-			ai->b[0] = 0x61;
-			return 1;
-		}
-		else if (_nmd_strcmp(ai->s, "popa"))
-		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0x62;
-			return 2;
-		}
-		else if (_nmd_strcmp(ai->s, "pushfd"))
-		{
-			if (ai->mode == NMD_X86_MODE_16)
-			{
-				ai->b[0] = 0x66;
-				ai->b[1] = 0x9c;
-				return 2;
-			}
-			else
-			{
-				ai->b[0] = 0x9c;
-				return 1;
-			}
-		}
-		else if (_nmd_strcmp(ai->s, "popfd"))
+		if (_nmd_label_equals(ai->labels + i, operands))
 		{
-			if (ai->mode == NMD_X86_MODE_16)
-			{
-				ai->b[0] = 0x66;
-				ai->b[1] = 0x9d;
-				return 2;
-			}
-			else
-			{
-				ai->b[0] = 0x9d;
-				return 1;
-			}
+			*target = ai->labelsResolved ? ai->labels[i].address : ai->runtimeAddress;
+			return true;
 		}
 	}
 
-	typedef struct NMD_StringBytePair { const char* s; uint8_t b; } NMD_StringBytePair;
-
-	const NMD_StringBytePair op1SingleByte[] = {
-		{ "int3",    0xcc },
-		{ "nop",     0x90 },
-		{ "ret",     0xc3 },
-		{ "retf",    0xcb },
-		{ "ret far", 0xcb },
-		{ "leave",   0xc9 },
-		{ "int1",    0xf1 },
-		{ "push es", 0x06 },
-		{ "push ss", 0x16 },
-		{ "push ds", 0x1e },
-		{ "push cs", 0x0e },
-		{ "pop es",  0x07 },
-		{ "pop ss",  0x17 },
-		{ "pop ds",  0x1f },
-		{ "daa",     0x27 },
-		{ "aaa",     0x37 },
-		{ "das",     0x2f },
-		{ "aas",     0x3f },
-		{ "xlat",    0xd7 },
-		{ "fwait",   0x9b },
-		{ "hlt",     0xf4 },
-		{ "cmc",     0xf5 },
-		{ "sahf",    0x9e },
-		{ "lahf",    0x9f },
-		{ "into",    0xce },
-		{ "cwde",    0x98 },
-		{ "cdq",     0x99 },
-		{ "salc",    0xd6 },
-		{ "slc",     0xf8 },
-		{ "stc",     0xf9 },
-		{ "cli",     0xfa },
-		{ "sti",     0xfb },
-		{ "cld",     0xfc },
-		{ "std",     0xfd },
-	};
-	for (i = 0; i < _NMD_NUM_ELEMENTS(op1SingleByte); i++)
-	{
-		if (_nmd_strcmp(ai->s, op1SingleByte[i].s))
-		{
-			ai->b[0] = op1SingleByte[i].b;
-			return 1;
-		}
-	}
+	return false;
+}
 
-	const NMD_StringBytePair op2SingleByte[] = {
-		{ "syscall",  0x05 },
-		{ "clts",     0x06 },
-		{ "sysret",   0x07 },
-		{ "invd",     0x08 },
-		{ "wbinvd",   0x09 },
-		{ "ud2",      0x0b },
-		{ "femms",    0x0e },
-		{ "wrmsr",    0x30 },
-		{ "rdtsc",    0x31 },
-		{ "rdmsr",    0x32 },
-		{ "rdpmc",    0x33 },
-		{ "sysenter", 0x34 },
-		{ "sysexit",  0x35 },
-		{ "getsec",   0x37 },
-		{ "emms",     0x77 },
-		{ "push fs",  0xa0 },
-		{ "pop fs",   0xa1 },
-		{ "cpuid",    0xa2 },
-		{ "push gs",  0xa8 },
-		{ "pop gs",   0xa9 },
-		{ "rsm",      0xaa }
-	};
-	for (i = 0; i < _NMD_NUM_ELEMENTS(op2SingleByte); i++)
-	{
-		if (_nmd_strcmp(ai->s, op2SingleByte[i].s))
-		{
-			ai->b[0] = 0x0f;
-			ai->b[1] = op2SingleByte[i].b;
-			return 2;
-		}
-	}
-	
-	if (ai->s[0] == 'j')
+/* Writes 'value' to 'b' in little-endian byte order. 'b' may be unaligned. */
+void _nmd_encode_int32(uint8_t* b, int32_t value)
+{
+	const uint32_t u = (uint32_t)value;
+	b[0] = (uint8_t)u;
+	b[1] = (uint8_t)(u >> 8);
+	b[2] = (uint8_t)(u >> 16);
+	b[3] = (uint8_t)(u >> 24);
+}
+
+/* Assembles jmp or jcc. The rel8 form is used unless the target is out of range or 'ai->nearBranch' is set. jcc's rel32 form is escaped by 0Fh. */
+size_t _nmd_assemble_branch(_nmd_assemble_info* ai, const char* operands, uint8_t shortOpcode, uint8_t nearOpcode, bool escaped)
+{
+	uint64_t target;
+	if (!_nmd_parse_branch_target(ai, operands, &target))
+		return 0;
+
+	const int64_t delta = (int64_t)(target - ai->runtimeAddress);
+	if (!ai->nearBranch && delta >= -(1 << 7) + 2 && delta <= (1 << 7) - 1 + 2)
 	{
-		const char* s = 0;
-		for (i = 0; i < _NMD_NUM_ELEMENTS(_nmd_conditionSuffixes); i++)
-		{
-			if (_nmd_strstr_ex(ai->s + 1, _nmd_conditionSuffixes[i], &s) == ai->s + 1)
-			{
-				if (s[0] != ' ')
-					return 0;
+		ai->b[0] = shortOpcode;
+		ai->b[1] = (uint8_t)(delta - 2);
+		return 2;
+	}
 
+	const size_t length = escaped ? 6 : 5;
+	if (delta < -((int64_t)1 << 31) + (int64_t)length || delta > ((int64_t)1 << 31) - 1 + (int64_t)length)
+		return 0;
 
-				int64_t num;
-				size_t numDigits;
-				if (!_nmd_parse_number(s + 1, &num, &numDigits))
-					return 0;
+	if (escaped)
+		ai->b[0] = 0x0f;
+	ai->b[length - 5] = nearOpcode;
+	_nmd_encode_int32(ai->b + length - 4, (int32_t)(delta - (int64_t)length));
 
-				const int64_t delta = num - ai->runtimeAddress;
-				if (delta >= -(1 << 7) + 2 && delta <= (1 << 7) - 1 + 2)
-				{
-					ai->b[0] = 0x70 + (uint8_t)i;
-					*(int8_t*)(ai->b + 1) = (int8_t)(delta - 2);
-					return 2;
-				}
-				else if (delta >= -(1 << 31) + 6 && delta <= ((size_t)(1) << 31) - 1 + 6)
-				{
-					ai->b[0] = 0x0f;
-					ai->b[1] = 0x80 + (uint8_t)i;
-					*(int32_t*)(ai->b + 2) = (int32_t)(delta - 6);
-					return 6;
-				}
-				else
-					return 0;
-			}
-		}
-	}
-	else if (_nmd_strstr(ai->s, "inc ") == ai->s || _nmd_strstr(ai->s, "dec ") == ai->s)
+	ai->nearBranch = true;
+	return length;
+}
+
+size_t _nmd_assemble_call(_nmd_assemble_info* ai, const char* operands)
+{
+	uint64_t target;
+	if (!_nmd_parse_branch_target(ai, operands, &target))
+		return 0;
+
+	const int64_t delta = (int64_t)(target - ai->runtimeAddress);
+	if (delta < -((int64_t)1 << 31) + 5 || delta > ((int64_t)1 << 31) - 1 + 5)
+		return 0;
+
+	ai->b[0] = 0xe8;
+	_nmd_encode_int32(ai->b + 1, (int32_t)(delta - 5));
+	return 5;
+}
+
+/* 'reg' is the modrm.reg extension: zero for inc, one for dec. */
+size_t _nmd_assemble_inc_dec(_nmd_assemble_info* ai, const char* operands, uint8_t reg)
+{
+	const char* tmp = operands;
+	nmd_x86_memory_operand memoryOperand;
+	size_t size;
+	if (_nmd_parse_memory_operand(&tmp, &memoryOperand, &size))
 	{
-		const char* tmp = ai->s + 4;
-		nmd_x86_memory_operand memoryOperand;
-		size_t size;
-		if (_nmd_parse_memory_operand(&tmp, &memoryOperand, &size))
+		size_t offset = 0;
+		if (memoryOperand.segment && memoryOperand.segment != ((memoryOperand.base == NMD_X86_REG_ESP || memoryOperand.index == NMD_X86_REG_ESP) ? NMD_X86_REG_SS : NMD_X86_REG_DS))
+			ai->b[offset++] = _nmd_encode_segment_reg((NMD_X86_REG)memoryOperand.segment);
+
+		/* The operand size prefix selects the size that is not the mode's default, REX.W(which must come right before the opcode) selects a qword. */
+		if ((size == 2 && ai->mode != NMD_X86_MODE_16) || (size == 4 && ai->mode == NMD_X86_MODE_16))
+			ai->b[offset++] = 0x66;
+		else if (size == 8)
 		{
-			size_t offset = 0;
-			if (memoryOperand.segment && memoryOperand.segment != ((memoryOperand.base == NMD_X86_REG_ESP || memoryOperand.index == NMD_X86_REG_ESP) ? NMD_X86_REG_SS : NMD_X86_REG_DS))
-				ai->b[offset++] = _nmd_encode_segment_reg((NMD_X86_REG)memoryOperand.segment);
+			if (ai->mode != NMD_X86_MODE_64)
+				return 0;
+			ai->b[offset++] = 0x48;
+		}
 
-			ai->b[offset++] = size == 1 ? 0xfe : 0xff;
+		ai->b[offset++] = size == 1 ? 0xfe : 0xff;
 
-			nmd_x86_modrm modrm;
-			modrm.fields.reg = ai->s[0] == 'i' ? 0 : 8;
-			modrm.fields.mod = 0;
+		nmd_x86_modrm modrm;
+		modrm.fields.reg = reg;
+		modrm.fields.mod = 0;
 
-			if (memoryOperand.index != NMD_X86_REG_NONE && memoryOperand.base != NMD_X86_REG_NONE)
-			{
-				modrm.fields.rm = 0b100;
-				nmd_x86_sib sib;
-				sib.fields.scale = (uint8_t)_nmd_get_bit_index(memoryOperand.scale);
-				sib.fields.base = memoryOperand.base - NMD_X86_REG_EAX;
-				sib.fields.index = memoryOperand.index - NMD_X86_REG_EAX;
+		if (memoryOperand.index != NMD_X86_REG_NONE && memoryOperand.base != NMD_X86_REG_NONE)
+		{
+			modrm.fields.rm = 0b100;
+			nmd_x86_sib sib;
+			sib.fields.scale = (uint8_t)_nmd_get_bit_index(memoryOperand.scale);
+			sib.fields.base = memoryOperand.base - NMD_X86_REG_EAX;
+			sib.fields.index = memoryOperand.index - NMD_X86_REG_EAX;
 
-				const size_t nextOffset = offset;
-				if (memoryOperand.disp != 0)
+			const size_t nextOffset = offset;
+			if (memoryOperand.disp != 0)
+			{
+				if (memoryOperand.disp >= -128 && memoryOperand.disp <= 127)
 				{
-					if (memoryOperand.disp >= -128 && memoryOperand.disp <= 127)
-					{
-						modrm.fields.mod = 1;
-						*(int8_t*)(ai->b + offset + 2) = (int8_t)memoryOperand.disp;
-						offset++;
-					}
-					else
-					{
-						modrm.fields.mod = 2;
-						*(int32_t*)(ai->b + offset + 2) = (int32_t)memoryOperand.disp;
-						offset += 4;
-					}
+					modrm.fields.mod = 1;
+					*(int8_t*)(ai->b + offset + 2) = (int8_t)memoryOperand.disp;
+					offset++;
 				}
-
-				ai->b[nextOffset] = modrm.modrm;
-				ai->b[nextOffset + 1] = sib.sib;
-				offset += 2;
-
-				return offset;
-			}
-			else if (memoryOperand.base != NMD_X86_REG_NONE)
-			{
-				modrm.fields.rm = memoryOperand.base - NMD_X86_REG_EAX;
-				const size_t nextOffset = offset;
-				if (memoryOperand.disp != 0)
+				else
 				{
-					if (memoryOperand.disp >= -128 && memoryOperand.disp <= 127)
-					{
-						modrm.fields.mod = 1;
-						*(int8_t*)(ai->b + offset + 1) = (int8_t)memoryOperand.disp;
-						offset++;
-					}
-					else
-					{
-						modrm.fields.mod = 2;
-						*(int32_t*)(ai->b + offset + 1) = (int32_t)memoryOperand.disp;
-						offset += 4;
-					}
+					modrm.fields.mod = 2;
+					*(int32_t*)(ai->b + offset + 2) = (int32_t)memoryOperand.disp;
+					offset += 4;
 				}
-				ai->b[nextOffset] = modrm.modrm;
-				offset++;
-			}
-			else
-			{
-				modrm.fields.rm = 0b101;
-				ai->b[offset++] = modrm.modrm;
-				*(int32_t*)(ai->b + offset) = (int32_t)memoryOperand.disp;
-				offset += 4;
 			}
 
+			ai->b[nextOffset] = modrm.modrm;
+			ai->b[nextOffset + 1] = sib.sib;
+			offset += 2;
+
 			return offset;
 		}
-
-		size_t numPrefixes, index;
-		size = _nmd_append_prefix_by_reg_size(ai->b, ai->s + 4, &numPrefixes, &index);
-		if (size > 0)
+		else if (memoryOperand.base != NMD_X86_REG_NONE)
 		{
-			if (ai->mode == NMD_X86_MODE_64)
+			modrm.fields.rm = memoryOperand.base - NMD_X86_REG_EAX;
+			const size_t nextOffset = offset;
+			if (memoryOperand.disp != 0)
 			{
-				ai->b[numPrefixes + 0] = size == 1 ? 0xfe : 0xff;
-				ai->b[numPrefixes + 1] = 0xc0 + (ai->s[0] == 'i' ? 0 : 8) + (uint8_t)index;
-				return numPrefixes + 2;
-			}
-			else
-			{
-				if (size == 1)
+				if (memoryOperand.disp >= -128 && memoryOperand.disp <= 127)
 				{
-					ai->b[0] = 0xfe;
-					ai->b[1] = 0xc0 + (ai->s[0] == 'i' ? 0 : 8) + (uint8_t)index;
-					return 2;
+					modrm.fields.mod = 1;
+					*(int8_t*)(ai->b + offset + 1) = (int8_t)memoryOperand.disp;
+					offset++;
 				}
 				else
 				{
-					ai->b[numPrefixes + 0] = (ai->s[0] == 'i' ? 0x40 : 0x48) + (uint8_t)index;
-					return numPrefixes + 1;
+					modrm.fields.mod = 2;
+					*(int32_t*)(ai->b + offset + 1) = (int32_t)memoryOperand.disp;
+					offset += 4;
 				}
 			}
+			ai->b[nextOffset] = modrm.modrm;
+			offset++;
 		}
+		else
+		{
+			modrm.fields.rm = 0b101;
+			ai->b[offset++] = modrm.modrm;
+			*(int32_t*)(ai->b + offset) = (int32_t)memoryOperand.disp;
+			offset += 4;
+		}
+
+		return offset;
 	}
-	else if (_nmd_strstr(ai->s, "push ") == ai->s)
+
+	size_t numPrefixes, index;
+	size = _nmd_append_prefix_by_reg_size(ai->b, operands, &numPrefixes, &index);
+	if (size > 0)
 	{
-		size_t numDigits = 0;
-		int64_t num = 0;
-		if (_nmd_parse_number(ai->s + 5, &num, &numDigits))
+		if (ai->mode == NMD_X86_MODE_64)
 		{
-			if (*(ai->s + numDigits) != '\0' || !(num >= -(1 << 31) && num <= ((int64_t)1 << 31) - 1))
-				return 0;
-
-			if (num >= -(1 << 7) && num <= (1 << 7) - 1)
+			ai->b[numPrefixes + 0] = size == 1 ? 0xfe : 0xff;
+			ai->b[numPrefixes + 1] = 0xc0 + reg * 8 + (uint8_t)index;
+			return numPrefixes + 2;
+		}
+		else
+		{
+			if (size == 1)
 			{
-				ai->b[0] = 0x6a;
-				*(int8_t*)(ai->b + 1) = (int8_t)num;
+				ai->b[0] = 0xfe;
+				ai->b[1] = 0xc0 + reg * 8 + (uint8_t)index;
 				return 2;
 			}
 			else
 			{
-				ai->b[0] = 0x68;
-				*(int32_t*)(ai->b + 1) = (int32_t)num;
-				return 5;
+				ai->b[numPrefixes + 0] = 0x40 + reg * 8 + (uint8_t)index;
+				return numPrefixes + 1;
 			}
 		}
-
-		size_t n = _nmd_assemble_reg(ai, 0x50);
-		if (n > 0)
-			return n;
-
-	}
-	else if (_nmd_strstr(ai->s, "pop ") == ai->s)
-	{
-		ai->s += 3;
-		return _nmd_assemble_reg(ai, 0x58);
 	}
-	else if (_nmd_strstr(ai->s, "emit ") == ai->s)
-	{
-		int64_t num = 0;
-		size_t numDigits = 0;
-		size_t offset = 5;
-		while (_nmd_parse_number(ai->s + offset, &num, &numDigits))
-		{
-			if (num < 0 || num > 0xff)
-				return 0;
 
-			ai->b[i++] = (uint8_t)num;
+	return 0;
+}
 
-			offset += numDigits;
-			if (ai->s[offset] == ' ')
-				offset++;
-		}
-		return i;
-	}
-	else if (_nmd_strcmp(ai->s, "pushf"))
+size_t _nmd_assemble_push(_nmd_assemble_info* ai, const char* operands)
+{
+	size_t numDigits = 0;
+	int64_t num = 0;
+	if ((_NMD_IS_DECIMAL_NUMBER(operands[0]) || operands[0] == '-') && _nmd_parse_number(operands, &num, &numDigits))
 	{
-		if (ai->mode == NMD_X86_MODE_16)
-		{
-			ai->b[0] = 0x9c;
-			return 1;
-		}
-		else
+		if (operands[numDigits] != '\0' || !(num >= -((int64_t)1 << 31) && num <= ((int64_t)1 << 31) - 1))
+			return 0;
+
+		if (num >= -(1 << 7) && num <= (1 << 7) - 1)
 		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0x9c;
+			ai->b[0] = 0x6a;
+			*(int8_t*)(ai->b + 1) = (int8_t)num;
 			return 2;
 		}
-	}
-	else if (_nmd_strcmp(ai->s, "popf"))
-	{
-		if (ai->mode == NMD_X86_MODE_16)
-		{
-			ai->b[0] = 0x9d;
-			return 1;
-		}
 		else
 		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0x9d;
-			return 2;
+			ai->b[0] = 0x68;
+			*(int32_t*)(ai->b + 1) = (int32_t)num;
+			return 5;
 		}
 	}
-	else if (_nmd_strcmp(ai->s, "pause"))
-	{
-		ai->b[0] = 0xf3;
-		ai->b[1] = 0x90;
-		return 2;
-	}
-	else if (_nmd_strcmp(ai->s, "iret"))
+
+	return _nmd_assemble_reg(ai, operands, 0x50);
+}
+
+/* Emits the bytes listed in 'operands', separated by spaces. */
+size_t _nmd_assemble_emit(_nmd_assemble_info* ai, const char* operands)
+{
+	size_t i = 0;
+	while (*operands)
 	{
-		if (ai->mode == NMD_X86_MODE_16)
-		{
-			ai->b[0] = 0xcf;
-			return 1;
-		}
-		else
-		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0xcf;
-			return 2;
-		}
+		int64_t num = 0;
+		size_t numDigits = 0;
+		if (!_nmd_parse_number(operands, &num, &numDigits) || num < 0 || num > 0xff || i == NMD_X86_MAXIMUM_INSTRUCTION_LENGTH)
+			return 0;
+
+		ai->b[i++] = (uint8_t)num;
+
+		operands += numDigits;
+		if (*operands == ' ')
+			operands++;
 	}
-	else if (_nmd_strcmp(ai->s, "iretd"))
+
+	return i;
+}
+
+/* Tries every form of the mnemonic of 'form', starting at 'form'. */
+size_t _nmd_assemble_form(_nmd_assemble_info* ai, const _nmd_assembler_form* form, const char* operands)
+{
+	const char* const mnemonic = form->mnemonic;
+	for (; form < _nmd_assemblerForms + _NMD_NUM_ELEMENTS(_nmd_assemblerForms) && _nmd_strcmp(form->mnemonic, mnemonic); form++)
 	{
-		if (ai->mode == NMD_X86_MODE_16)
+		if (!(form->modes & ai->mode))
+			continue;
+
+		if (form->operands)
 		{
-			ai->b[0] = 0x66;
-			ai->b[1] = 0xcf;
-			return 2;
+			if (!_nmd_strcmp(operands, form->operands))
+				continue;
+
+			size_t i = 0;
+			for (; i < form->length; i++)
+				ai->b[i] = form->bytes[i];
+
+			return form->length;
 		}
-		else
+
+		switch (form->type)
 		{
-			ai->b[0] = 0xcf;
-			return 1;
+		case _NMD_FORM_TYPE_JCC: return _nmd_assemble_branch(ai, operands, 0x70 + form->bytes[0], 0x80 + form->bytes[0], true);
+		case _NMD_FORM_TYPE_JMP: return _nmd_assemble_branch(ai, operands, 0xeb, 0xe9, false);
+		case _NMD_FORM_TYPE_CALL: return _nmd_assemble_call(ai, operands);
+		case _NMD_FORM_TYPE_INC_DEC: return _nmd_assemble_inc_dec(ai, operands, form->bytes[0]);
+		case _NMD_FORM_TYPE_PUSH: return _nmd_assemble_push(ai, operands);
+		case _NMD_FORM_TYPE_POP: return _nmd_assemble_reg(ai, operands, 0x58);
+		case _NMD_FORM_TYPE_EMIT: return _nmd_assemble_emit(ai, operands);
+		default: return 0;
 		}
 	}
-	else if (_nmd_strcmp(ai->s, "cbw"))
-	{
-		ai->b[0] = 0x66;
-		ai->b[1] = 0x98;
-		return 2;
-	}
-	else if (_nmd_strcmp(ai->s, "cwd"))
-	{
-		ai->b[0] = 0x66;
-		ai->b[1] = 0x99;
-		return 2;
-	}
-	else if (_nmd_strcmp(ai->s, "pushf"))
-	{
-		ai->b[0] = 0x66;
-		ai->b[1] = 0x9c;
-		return 2;
-	}
-	else if (_nmd_strcmp(ai->s, "popf"))
-	{
-		ai->b[0] = 0x66;
-		ai->b[1] = 0x9d;
-		return 2;
-	}
-	
+
 	return 0;
 }
 
+size_t _nmd_assemble_single(_nmd_assemble_info* ai)
+{
+	const char* operands = 0;
+	const _nmd_assembler_form* form = _nmd_find_form(ai->s, &operands);
+
+	/* Prefixes are looked up like mnemonics, the instruction follows them. */
+	uint8_t* const buffer = ai->b;
+	size_t numPrefixes = 0;
+	for (; form && form->type == _NMD_FORM_TYPE_PREFIX; form = _nmd_find_form(operands, &operands))
+	{
+		if (numPrefixes == 4)
+			return 0;
+
+		buffer[numPrefixes++] = form->bytes[0];
+	}
+
+	/* 'emit' may write up to 'NMD_X86_MAXIMUM_INSTRUCTION_LENGTH' bytes, so it cannot be prefixed. */
+	if (!form || (numPrefixes && form->type == _NMD_FORM_TYPE_EMIT))
+		return 0;
+
+	ai->b = buffer + numPrefixes;
+	const size_t numBytes = _nmd_assemble_form(ai, form, operands);
+	ai->b = buffer;
+
+	return numBytes ? numPrefixes + numBytes : 0;
+}
+
+/*
+Copies the instruction at '*string' to 'parsedString' converting it to lowercase and removing unwanted spaces, then moves '*string' past the
+instruction separator(';' or '\n'). 'parsedString' must be 128 bytes long. Returns false if the instruction is too long.
+*/
+bool _nmd_parse_line(const char** string, char* parsedString)
+{
+	const char* s = *string;
+	size_t length = 0;
+	bool allowSpace = false;
+	for (; *s; s++)
+	{
+		char c = *s;
+		if (c == ';' || c == '\n')
+			break;
+		else if (c == ' ' && !allowSpace)
+			continue;
+
+		if (length >= 127)
+			return false;
+
+		c = _NMD_TOLOWER(c);
+		parsedString[length++] = c;
+
+		/* A single space is kept between two words(e.g. 'push eax'). */
+		allowSpace = false;
+		if (_NMD_IS_LOWERCASE(c) || _NMD_IS_DECIMAL_NUMBER(c))
+		{
+			const char* next = s + 1;
+			while (*next == ' ')
+				next++;
+
+			const char nextChar = (char)_NMD_TOLOWER(*next);
+			allowSpace = next != s + 1 && (_NMD_IS_LOWERCASE(nextChar) || _NMD_IS_DECIMAL_NUMBER(nextChar) || nextChar == '_' || nextChar == '.');
+		}
+	}
+
+	if (*s != '\0')
+		s++;
+
+	/* If the last character is a ' '(space), remove it. */
+	if (length > 0 && parsedString[length - 1] == ' ')
+		length--;
+
+	/* After all of the string manipulation, place the null character. */
+	parsedString[length] = '\0';
+
+	*string = s;
+	return true;
+}
+
 /*
 Assembles an instruction from a string. Returns the number of bytes written to the buffer on success, zero otherwise. Instructions can be separated using either the ';' or '\n' character.
 Parameters:
@@ -3695,6 +5506,9 @@ size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uin
 	ai.mode = mode;
 	ai.runtimeAddress = runtimeAddress;
 	ai.b = tempBuffer;
+	ai.labels = 0;
+	ai.numLabels = 0;
+	ai.labelsResolved = false;
 
 	size_t numInstructions = 0;
 	const size_t numMaxInstructions = (count && *count != 0) ? *count : (size_t)(-1);
@@ -3703,35 +5517,10 @@ size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uin
 	{
 		remainingSize = bufferEnd - b;
 
-		/* Copy 'string' to 'buffer' converting it to lowercase and removing unwanted spaces. If the instruction separator character ';' and '\n' is found, stop. */
-		size_t length = 0;
-		bool allowSpace = false;
-		for (; *string; string++)
-		{
-			char c = *string;
-			if (c == ';' || c == '\n')
-				break;
-			else if (c == ' ' && !allowSpace)
-				continue;
-
-			if (length >= 128)
-				return 0;
-
-			c = _NMD_TOLOWER(c);
-			parsedString[length++] = c;
-			allowSpace = (_NMD_IS_LOWERCASE(c) || _NMD_IS_DECIMAL_NUMBER(c)) && (_NMD_IS_LOWERCASE(string[2]) || _NMD_IS_DECIMAL_NUMBER(string[2]));
-		}
-
-		if (*string != '\0')
-			string++;
-
-		/* If the last character is a ' '(space), remove it. */
-		if (length > 0 && parsedString[length - 1] == ' ')
-			length--;
-
-		/* After all of the string manipulation, place the null character. */
-		parsedString[length] = '\0';
+		if (!_nmd_parse_line(&string, parsedString))
+			return 0;
 
+		ai.nearBranch = false;
 		const size_t numBytes = _nmd_assemble_single(&ai);
 		if (numBytes == 0 || numBytes > remainingSize)
 			return 0;
@@ -3742,6 +5531,7 @@ size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uin
 			b[i] = tempBuffer[i];
 
 		b += numBytes;
+		ai.runtimeAddress += numBytes;
 
 		numInstructions++;
 	}
@@ -3752,6 +5542,349 @@ size_t nmd_x86_assemble(const char* string, void* buffer, size_t bufferSize, uin
 	return (size_t)(b - (uint8_t*)buffer);
 }
 
+/* Returns the length of the label definition at the start of 's'(e.g. 'loop:'), including the ':' character, or zero if there is none. */
+size_t _nmd_get_label_definition_length(const char* s)
+{
+	size_t i = 0;
+	while (_NMD_IS_LOWERCASE(s[i]) || _NMD_IS_DECIMAL_NUMBER(s[i]) || s[i] == '_' || s[i] == '.')
+		i++;
+
+	return i > 0 && s[i] == ':' && !_NMD_IS_DECIMAL_NUMBER(s[0]) ? i + 1 : 0;
+}
+
+/*
+Assembles instructions that may refer to labels. Returns the number of bytes written to the buffer on success, zero otherwise.
+Lines are separated like in nmd_x86_assemble(), a line may start with a label definition(e.g. 'loop: dec ecx' or 'end:'). The targets of 'jmp',
+'jcc' and 'call' can be labels defined anywhere in the string. Branches start with a rel8 displacement and are relaxed to rel32 only when the
+target is out of range, until the layout does not change.
+Parameters:
+ - string          [in]      A pointer to a string that represents one or more instructions in assembly language.
+ - buffer          [out]     A pointer to a buffer that receives the encoded instructions.
+ - bufferSize      [in]      The size of the buffer in bytes.
+ - runtimeAddress  [in]      The runtime address of the first instruction.
+ - mode            [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - labels          [out]     A pointer to an array of 'maxLabels' elements that receives the labels and their final addresses.
+ - maxLabels       [in]      The number of elements of 'labels'.
+ - numLabels       [out/opt] A pointer to a variable that receives the number of labels. This parameter may be zero.
+ - layout          [out]     A pointer to an array of 'maxInstructions' elements that receives the offset and length of each instruction. It is also used as working memory.
+ - maxInstructions [in]      The number of elements of 'layout'.
+ - numInstructions [out/opt] A pointer to a variable that receives the number of instructions. This parameter may be zero.
+*/
+size_t nmd_x86_assemble_with_labels(const char* string, void* buffer, size_t bufferSize, uint64_t runtimeAddress, NMD_X86_MODE mode, nmd_x86_label* labels, size_t maxLabels, size_t* numLabels, nmd_x86_instruction_layout* layout, size_t maxInstructions, size_t* numInstructions)
+{
+	char parsedString[128];
+	uint8_t tempBuffer[NMD_X86_MAXIMUM_INSTRUCTION_LENGTH];
+
+	/* Collect the labels and count the instructions. The names are taken from the source string, which keeps their case. */
+	size_t labelCount = 0, instructionCount = 0;
+	const char* s = string;
+	while (*s)
+	{
+		const char* const line = s;
+		if (!_nmd_parse_line(&s, parsedString))
+			return 0;
+
+		const size_t labelLength = _nmd_get_label_definition_length(parsedString);
+		if (labelLength)
+		{
+			if (labelCount == maxLabels)
+				return 0;
+
+			nmd_x86_label* const label = labels + labelCount;
+			label->name = line;
+			while (*label->name == ' ')
+				label->name++;
+			label->nameLength = labelLength - 1;
+			label->instructionIndex = instructionCount;
+			label->address = runtimeAddress;
+
+			/* Labels must be unique. */
+			parsedString[labelLength - 1] = '\0';
+			size_t i = 0;
+			for (; i < labelCount; i++)
+			{
+				if (_nmd_label_equals(labels + i, parsedString))
+					return 0;
+			}
+
+			labelCount++;
+		}
+
+		if (parsedString[labelLength] != '\0')
+		{
+			if (instructionCount == maxInstructions)
+				return 0;
+
+			layout[instructionCount].offset = 0;
+			layout[instructionCount].length = 0;
+			layout[instructionCount].relaxed = false;
+			instructionCount++;
+		}
+	}
+
+	_nmd_assemble_info ai;
+	ai.s = parsedString;
+	ai.mode = mode;
+	ai.b = tempBuffer;
+	ai.labels = labels;
+	ai.numLabels = labelCount;
+	ai.labelsResolved = false;
+
+	/*
+	Lay out the instructions until no length changes. The first pass resolves every label to the branch itself, so every branch starts with
+	a rel8 displacement. Later passes use the addresses of the previous pass. A branch that needed a rel32 displacement keeps it, so lengths
+	never decrease and the passes terminate. The pass in which nothing changes used the final addresses, so its output is the result.
+	*/
+	size_t size = 0;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		size_t i = 0;
+		for (; i < labelCount; i++)
+			labels[i].address = runtimeAddress + (labels[i].instructionIndex < instructionCount ? layout[labels[i].instructionIndex].offset : size);
+
+		size_t index = 0;
+		size_t offset = 0;
+		for (s = string; *s; )
+		{
+			if (!_nmd_parse_line(&s, parsedString))
+				return 0;
+
+			ai.s = parsedString + _nmd_get_label_definition_length(parsedString);
+			if (*ai.s == '\0')
+				continue;
+
+			/* The lines are the ones counted by the first pass, so there can be no more instructions than layout records. */
+			if (index == instructionCount)
+				return 0;
+
+			ai.runtimeAddress = runtimeAddress + offset;
+			ai.nearBranch = layout[index].relaxed;
+			const size_t numBytes = _nmd_assemble_single(&ai);
+			if (numBytes == 0)
+				return 0;
+
+			if (layout[index].offset != offset || layout[index].length != numBytes || layout[index].relaxed != ai.nearBranch)
+				changed = true;
+
+			layout[index].offset = (uint32_t)offset;
+			layout[index].length = (uint8_t)numBytes;
+			layout[index].relaxed = ai.nearBranch;
+
+			if (offset + numBytes <= bufferSize)
+			{
+				for (i = 0; i < numBytes; i++)
+					((uint8_t*)buffer)[offset + i] = tempBuffer[i];
+			}
+
+			offset += numBytes;
+			index++;
+		}
+
+		if (!ai.labelsResolved)
+			ai.labelsResolved = true, changed = true;
+
+		size = offset;
+	}
+
+	if (size > bufferSize)
+		return 0;
+
+	if (numLabels)
+		*numLabels = labelCount;
+
+	if (numInstructions)
+		*numInstructions = instructionCount;
+
+	return size;
+}
+
+/* Returns the size in bytes of the displacement that follows the ModR/M byte, following the same rules as _nmd_decode_modrm(). 'hasSIB' receives whether an SIB byte is present. */
+size_t _nmd_get_displacement_size(const nmd_x86_instruction* instruction, bool* hasSIB)
+{
+	const nmd_x86_modrm modrm = instruction->modrm;
+	const bool addressPrefix = (bool)(instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE);
+
+	*hasSIB = false;
+
+	if (modrm.fields.mod == 0b11)
+		return 0;
+
+	if (instruction->mode == NMD_X86_MODE_16 || (addressPrefix && instruction->mode == NMD_X86_MODE_32))
+	{
+		if ((modrm.fields.mod == 0b00 && modrm.fields.rm == 0b110) || modrm.fields.mod == 0b10)
+			return 2;
+		return modrm.fields.mod == 0b01 ? 1 : 0;
+	}
+
+	*hasSIB = modrm.fields.rm == 0b100;
+
+	if (modrm.fields.mod == 0b01)
+		return 1;
+	else if (modrm.fields.mod == 0b10 || modrm.fields.rm == 0b101 || (*hasSIB && instruction->sib.fields.base == 0b101))
+		return 4;
+	else
+		return 0;
+}
+
+const uint8_t _nmd_segmentPrefixes[] = { 0x26, 0x2e, 0x36, 0x3e, 0x64, 0x65 }; /* ES, CS, SS, DS, FS and GS, in the order of 'NMD_X86_PREFIXES'. */
+
+/* Appends the legacy prefix of 'prefix'(a single member of 'NMD_X86_PREFIXES') if it is in 'prefixes' and is not 'last', which is appended by the caller. */
+void _nmd_encode_prefix(uint8_t** b, uint16_t prefixes, uint16_t last, uint16_t prefix, uint8_t byte)
+{
+	if (prefixes & prefix && prefix != last)
+		*(*b)++ = byte;
+}
+
+/*
+Encodes an instruction from its fields. Returns the number of bytes written to the buffer on success, zero otherwise.
+The following variables are read: 'mode', 'encoding', 'prefixes', 'segmentOverride', 'simdPrefix', 'repeatPrefix', 'hasRex', 'opcodeMap', 'opcode',
+'vex', 'evex', 'hasModrm', 'modrm', 'sib', 'displacement', 'immMask' and 'immediate'. Every other variable(e.g. 'id', 'operands' and 'buffer') is ignored.
+The presence of the SIB byte and the size of the displacement follow from 'modrm', so they stay consistent when 'modrm' is modified.
+Parameters:
+ - instruction [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction, usually filled by nmd_x86_decode_buffer() and then modified.
+ - buffer      [out] A pointer to a buffer that receives the encoded instruction.
+ - bufferSize  [in]  The size of the buffer in bytes.
+*/
+size_t nmd_x86_encode_instruction(const nmd_x86_instruction* instruction, void* buffer, size_t bufferSize)
+{
+	/* Large enough for every prefix at once, the result is checked against the maximum instruction length at the end. */
+	uint8_t bytes[32];
+	uint8_t* b = bytes;
+
+	const uint16_t prefixes = instruction->prefixes;
+	const uint16_t rexPrefixes = NMD_X86_PREFIXES_REX_W | NMD_X86_PREFIXES_REX_R | NMD_X86_PREFIXES_REX_X | NMD_X86_PREFIXES_REX_B;
+
+	if (instruction->mode != NMD_X86_MODE_16 && instruction->mode != NMD_X86_MODE_32 && instruction->mode != NMD_X86_MODE_64)
+		return 0;
+
+	if (instruction->encoding != NMD_X86_ENCODING_LEGACY && instruction->encoding != NMD_X86_ENCODING_3DNOW && instruction->encoding != NMD_X86_ENCODING_VEX && instruction->encoding != NMD_X86_ENCODING_EVEX)
+		return 0;
+
+	/* The REX bits of a VEX or EVEX instruction mirror its prefix's bits, which are taken from 'vex' or 'evex' instead. */
+	if (prefixes & rexPrefixes && instruction->mode != NMD_X86_MODE_64)
+		return 0;
+
+	/* Segment overrides, the one that takes effect goes last. */
+	size_t i = 0;
+	for (; i < sizeof(_nmd_segmentPrefixes); i++)
+		_nmd_encode_prefix(&b, prefixes, instruction->segmentOverride, (uint16_t)(NMD_X86_PREFIXES_ES_SEGMENT_OVERRIDE << i), _nmd_segmentPrefixes[i]);
+	if (prefixes & instruction->segmentOverride)
+		*b++ = _nmd_segmentPrefixes[_nmd_get_bit_index(instruction->segmentOverride)];
+
+	if (prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE)
+		*b++ = 0x67;
+
+	/* 'simdPrefix' is the closest of these four to the opcode and 'repeatPrefix' tells whether F3h comes after F2h. */
+	_nmd_encode_prefix(&b, prefixes, instruction->simdPrefix, NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE, 0x66);
+	_nmd_encode_prefix(&b, prefixes, instruction->simdPrefix, NMD_X86_PREFIXES_LOCK, 0xf0);
+	_nmd_encode_prefix(&b, prefixes, instruction->simdPrefix, instruction->repeatPrefix ? NMD_X86_PREFIXES_REPEAT_NOT_ZERO : NMD_X86_PREFIXES_REPEAT, instruction->repeatPrefix ? 0xf2 : 0xf3);
+	_nmd_encode_prefix(&b, prefixes, instruction->simdPrefix, instruction->repeatPrefix ? NMD_X86_PREFIXES_REPEAT : NMD_X86_PREFIXES_REPEAT_NOT_ZERO, instruction->repeatPrefix ? 0xf3 : 0xf2);
+	if (prefixes & instruction->simdPrefix)
+	{
+		switch (instruction->simdPrefix)
+		{
+		case NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE: *b++ = 0x66; break;
+		case NMD_X86_PREFIXES_LOCK: *b++ = 0xf0; break;
+		case NMD_X86_PREFIXES_REPEAT_NOT_ZERO: *b++ = 0xf2; break;
+		case NMD_X86_PREFIXES_REPEAT: *b++ = 0xf3; break;
+		default: return 0;
+		}
+	}
+
+	if (instruction->encoding == NMD_X86_ENCODING_VEX)
+	{
+		const nmd_x86_vex* vex = &instruction->vex;
+
+		/* The two byte form is used when the decoded instruction used it, or when the fields it cannot express have their default values. */
+		if (vex->vex[0] == 0xc5 || (vex->vex[0] != 0xc4 && vex->X && vex->B && !vex->W && vex->m_mmmm == 0b00001))
+		{
+			*b++ = 0xc5;
+			*b++ = (uint8_t)((vex->R ? 0b10000000 : 0) | (vex->vvvv << 3) | (vex->L ? 0b00000100 : 0) | vex->pp);
+		}
+		else
+		{
+			*b++ = 0xc4;
+			*b++ = (uint8_t)((vex->R ? 0b10000000 : 0) | (vex->X ? 0b01000000 : 0) | (vex->B ? 0b00100000 : 0) | vex->m_mmmm);
+			*b++ = (uint8_t)((vex->W ? 0b10000000 : 0) | (vex->vvvv << 3) | (vex->L ? 0b00000100 : 0) | vex->pp);
+		}
+
+		*b++ = instruction->opcode;
+	}
+	else if (instruction->encoding == NMD_X86_ENCODING_EVEX)
+	{
+		const nmd_x86_evex* evex = &instruction->evex;
+
+		*b++ = 0x62;
+		*b++ = (uint8_t)((evex->R ? 0b10000000 : 0) | (evex->X ? 0b01000000 : 0) | (evex->B ? 0b00100000 : 0) | (evex->R1 ? 0b00010000 : 0) | evex->mmm);
+		*b++ = (uint8_t)((evex->W ? 0b10000000 : 0) | (evex->vvvv << 3) | 0b00000100 | evex->pp);
+		*b++ = (uint8_t)((evex->z ? 0b10000000 : 0) | (evex->LL << 5) | (evex->b ? 0b00010000 : 0) | (evex->V1 ? 0b00001000 : 0) | evex->aaa);
+		*b++ = instruction->opcode;
+	}
+	else
+	{
+		if (instruction->mode == NMD_X86_MODE_64 && (instruction->hasRex || prefixes & rexPrefixes))
+		{
+			*b++ = (uint8_t)(0x40 |
+				(prefixes & NMD_X86_PREFIXES_REX_W ? 0b1000 : 0) |
+				(prefixes & NMD_X86_PREFIXES_REX_R ? 0b0100 : 0) |
+				(prefixes & NMD_X86_PREFIXES_REX_X ? 0b0010 : 0) |
+				(prefixes & NMD_X86_PREFIXES_REX_B ? 0b0001 : 0));
+		}
+
+		if (instruction->encoding == NMD_X86_ENCODING_3DNOW)
+		{
+			/* The real opcode is the immediate byte. */
+			*b++ = 0x0f;
+			*b++ = 0x0f;
+		}
+		else
+		{
+			switch (instruction->opcodeMap)
+			{
+			case NMD_X86_OPCODE_MAP_DEFAULT: break;
+			case NMD_X86_OPCODE_MAP_0F: *b++ = 0x0f; break;
+			case NMD_X86_OPCODE_MAP_0F38: *b++ = 0x0f, *b++ = 0x38; break;
+			case NMD_X86_OPCODE_MAP_0F3A: *b++ = 0x0f, *b++ = 0x3a; break;
+			default: return 0;
+			}
+
+			*b++ = instruction->opcode;
+		}
+	}
+
+	if (instruction->hasModrm)
+	{
+		bool hasSIB;
+		const size_t dispSize = _nmd_get_displacement_size(instruction, &hasSIB);
+
+		*b++ = instruction->modrm.modrm;
+
+		if (hasSIB)
+			*b++ = instruction->sib.sib;
+
+		for (i = 0; i < dispSize; i++)
+			*b++ = (uint8_t)(instruction->displacement >> (i * 8));
+	}
+
+	if (instruction->immMask > sizeof(instruction->immediate))
+		return 0;
+
+	for (i = 0; i < (size_t)instruction->immMask; i++)
+		*b++ = (uint8_t)(instruction->immediate >> (i * 8));
+
+	const size_t length = (size_t)(b - bytes);
+	if (length > NMD_X86_MAXIMUM_INSTRUCTION_LENGTH || length > bufferSize)
+		return 0;
+
+	for (i = 0; i < length; i++)
+		((uint8_t*)buffer)[i] = bytes[i];
+
+	return length;
+}
+
 void _nmd_decode_operand_segment_reg(const nmd_x86_instruction* instruction, nmd_x86_operand* operand)
 {
 	if (instruction->segmentOverride)
@@ -3942,6 +6075,32 @@ void _nmd_decode_conditional_flag(nmd_x86_instruction* instruction, const uint8_
 	}
 }
 
+/*
+Returns the size in bytes of the immediate described by the immediate class in 'properties', or -1 if the instruction is invalid.
+'op' and 'modrm' are only used by group 3(F6h,F7h).
+*/
+int _nmd_get_immediate_size(uint8_t properties, uint8_t op, nmd_x86_modrm modrm, NMD_X86_MODE mode, bool operandPrefix, bool addressPrefix, bool rexW)
+{
+	const bool operandSize16 = (mode == NMD_X86_MODE_16) != operandPrefix;
+
+	switch (_NMD_GET_IMM_CLASS(properties))
+	{
+	case _NMD_IMM_8: return 1;
+	case _NMD_IMM_16: return 2;
+	case _NMD_IMM_Z: return operandSize16 ? 2 : 4;
+	case _NMD_IMM_V: return rexW ? 8 : (operandSize16 ? 2 : 4);
+	case _NMD_IMM_MOFFS: return mode == NMD_X86_MODE_64 ? (addressPrefix ? 4 : 8) : ((mode == NMD_X86_MODE_16) != addressPrefix ? 2 : 4);
+	case _NMD_IMM_FAR: return mode == NMD_X86_MODE_64 ? -1 : (operandSize16 ? 4 : 6);
+	case _NMD_IMM_16_8: return 3;
+	case _NMD_IMM_GRP3:
+		if (op == 0xf6)
+			return modrm.fields.reg <= 0b001 ? 1 : 0;
+		else
+			return modrm.fields.reg <= 0b001 ? (operandSize16 ? 2 : 4) : 0;
+	default: return 0;
+	}
+}
+
 /* 'remaningSize' in the context of this function is the number of bytes the instruction takes not counting prefixes and opcode. */
 bool _nmd_decode_modrm(const uint8_t** b, nmd_x86_instruction* const instruction, const size_t remainingSize)
 {
@@ -4006,425 +6165,1459 @@ bool _nmd_decode_modrm(const uint8_t** b, nmd_x86_instruction* const instruction
 }
 
 
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_EVEX
 /*
-Decodes an instruction. Returns true if the instruction is valid, false otherwise.
-Parameters:
- - buffer      [in]  A pointer to a buffer containing an encoded instruction.
- - bufferSize  [in]  The size of the buffer in bytes.
- - instruction [out] A pointer to a variable of type 'nmd_x86_instruction' that receives information about the instruction.
- - mode        [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
- - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+Returns the factor an EVEX instruction's 8-bit displacement is multiplied by(disp8*N compression). The factor depends on the
+tuple type(Intel SDM, Volume 2, 2.7.5): full vector operands scale by the vector length(or by the element size when broadcasting),
+half, quarter and eighth vector operands by that fraction of it, and scalar or fixed-size operands by their size.
 */
-bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags)
+uint8_t _nmd_get_evex_disp8_scale(const nmd_x86_instruction* instruction)
 {
-	if (bufferSize == 0)
-		return false;
+	const nmd_x86_evex* const evex = &instruction->evex;
+	const uint8_t op = instruction->opcode;
+	const uint8_t vectorLength = (uint8_t)(16 << evex->LL);
+	const uint8_t element = (uint8_t)(evex->W ? 8 : 4);
+	const uint8_t full = evex->b ? element : vectorLength;
+	const uint8_t half = (uint8_t)(evex->b ? 4 : vectorLength / 2);
 
-	/* Clear 'instruction'. */
-	size_t i = 0;
-	for (; i < sizeof(nmd_x86_instruction); i++)
-		((uint8_t*)(instruction))[i] = 0x00;
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+	{
+		if (op == 0x13 || op == 0x17 || op == 0xd6 || (op == 0x7e && evex->pp == 0b10) || ((op == 0x12 || op == 0x16) && evex->pp < 0b10)) /* movlps,movhps,movlpd,movhpd,movq */
+			return 8;
+		else if (op == 0x12 && evex->pp == 0b11) /* movddup */
+			return vectorLength == 16 ? 8 : vectorLength;
+		else if ((op == 0x2c || op == 0x2d || op == 0x78 || op == 0x79) && evex->pp >= 0b10) /* cvt(t)ss2(u)si,cvt(t)sd2(u)si */
+			return (uint8_t)(evex->pp == 0b10 ? 4 : 8);
+		else if ((op == 0x5a && evex->pp == 0) || (op >= 0x78 && op <= 0x7b && evex->pp == 0b01) || ((op == 0x7a || op == 0xe6) && evex->pp == 0b10)) /* Conversions from dwords or singles to qwords or doubles. */
+			return evex->W ? full : half;
+		else if (((op == 0x10 || op == 0x11 || op == 0x2a || op == 0x51 || op == 0x7b || op == 0xc2 || (op >= 0x58 && op <= 0x5f)) && evex->pp >= 0b10) || op == 0x2e || op == 0x2f || op == 0x6e || op == 0x7e)
+			return element;
+		else if (op == 0xc4) /* pinsrw */
+			return 2;
+		else if ((op >= 0xd1 && op <= 0xd3) || op == 0xe1 || op == 0xe2 || (op >= 0xf1 && op <= 0xf3)) /* Shifts by a count in a xmm register. */
+			return 16;
+	}
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+	{
+		/* pmovsx,pmovzx and the down conversions(pmovwb,pmovdb...). */
+		if (((op >= 0x20 && op <= 0x25) || (op >= 0x30 && op <= 0x35)) || (op >= 0x10 && op <= 0x15 && evex->pp == 0b10) || (op == 0x13 && evex->pp == 0b01))
+		{
+			const uint8_t fractions[] = { 2, 4, 8, 2, 4, 2 };
+			return (uint8_t)(vectorLength / fractions[op & 0xf]);
+		}
+		else if (op == 0x18 || op == 0x58)
+			return 4;
+		else if (op == 0x19 || op == 0x59)
+			return 8;
+		else if (op == 0x1a || op == 0x5a)
+			return 16;
+		else if (op == 0x1b || op == 0x5b)
+			return 32;
+		else if (op == 0x78 || op == 0x79)
+			return (uint8_t)(op == 0x78 ? 1 : 2);
+		else if (op == 0x62 || op == 0x63) /* pexpandb,pexpandw,pcompressb,pcompressw */
+			return (uint8_t)(evex->W ? 2 : 1);
+		/* Scalar instructions, including the scalar fma forms, and the element-wise expand, compress, gather and scatter instructions. */
+		else if (op == 0x2d || op == 0x43 || op == 0x4d || op == 0x4f || (op >= 0x88 && op <= 0x8b) || (op >= 0x90 && op <= 0x93) || (op >= 0xa0 && op <= 0xa3) || (NMD_R(op) >= 9 && NMD_R(op) <= 0xb && NMD_C(op) >= 9 && op % 2 == 1))
+			return element;
+	}
+	else /* 0F3A */
+	{
+		if (op == 0x14 || op == 0x20)
+			return 1;
+		else if (op == 0x15)
+			return 2;
+		else if (op == 0x17 || op == 0x21)
+			return 4;
+		else if (op == 0x18 || op == 0x19 || op == 0x38 || op == 0x39)
+			return 16;
+		else if (op == 0x1a || op == 0x1b || op == 0x3a || op == 0x3b)
+			return 32;
+		else if (op == 0x1d) /* cvtps2ph */
+			return (uint8_t)(vectorLength / 2);
+		else if (op == 0x0a || op == 0x0b || op == 0x16 || op == 0x22 || op == 0x27 || op == 0x51 || op == 0x55 || op == 0x57 || op == 0x67)
+			return element;
+	}
 
-	instruction->mode = (uint8_t)mode;
+	return full;
+}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_EVEX */
 
-	const uint8_t* b = (const uint8_t*)(buffer);
+#if !defined(NMD_ASSEMBLY_DISABLE_DECODER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_EVEX)
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS
+/* Returns the general-purpose register encoded as 'index'(0-15). */
+uint8_t _nmd_get_avx_gpr(size_t index, bool is64)
+{
+	if (index < 8)
+		return (uint8_t)((is64 ? NMD_X86_REG_RAX : NMD_X86_REG_EAX) + index);
+	else
+		return (uint8_t)((is64 ? NMD_X86_REG_R8 : NMD_X86_REG_R8D) + (index - 8));
+}
 
-	/* Parse legacy prefixes & REX prefixes. */
-	i = 0;
-	const size_t numMaxBytes = bufferSize < NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ? bufferSize : NMD_X86_MAXIMUM_INSTRUCTION_LENGTH;
-	for (; i < numMaxBytes; i++, b++)
+/*
+Fills the operands of the VEX or EVEX instruction described by 'entry' the same way the formatter reads its descriptors. 'imm8' is
+the immediate, which is not stored in 'instruction' yet. Immediate operands are left with a size of zero so that they are filled
+with the rest of the instruction's immediate.
+*/
+void _nmd_decode_avx_operands(nmd_x86_instruction* instruction, const _nmd_avx_entry* entry, uint8_t imm8)
+{
+	const bool isEvex = instruction->encoding == NMD_X86_ENCODING_EVEX;
+	const bool is64 = instruction->mode == NMD_X86_MODE_64;
+	const bool W = isEvex ? instruction->evex.W : instruction->vex.W;
+	const uint8_t L = isEvex ? instruction->evex.LL : instruction->vex.L;
+	const bool isRegister = instruction->modrm.fields.mod == 0b11;
+	const bool hasRounding = isEvex && instruction->evex.b && isRegister && entry->flags & (_NMD_AVX_ER | _NMD_AVX_SAE);
+	const size_t vectorLength = hasRounding || L > 2 ? 64 : (size_t)16 << L;
+
+	/* The register indices. 'R', 'X', 'B', 'R1', 'V1' and 'vvvv' are stored inverted. */
+	uint8_t reg = instruction->modrm.fields.reg, rm = instruction->modrm.fields.rm, vvvv;
+	if (isEvex)
 	{
-		switch (*b)
+		vvvv = (uint8_t)(15 - instruction->evex.vvvv);
+		if (is64)
 		{
-		case 0xF0: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_LOCK)); continue;
-		case 0xF2: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_REPEAT_NOT_ZERO)), instruction->repeatPrefix = false; continue;
-		case 0xF3: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_REPEAT)), instruction->repeatPrefix = true; continue;
-		case 0x2E: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_CS_SEGMENT_OVERRIDE)); continue;
-		case 0x36: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_SS_SEGMENT_OVERRIDE)); continue;
-		case 0x3E: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_DS_SEGMENT_OVERRIDE)); continue;
-		case 0x26: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_ES_SEGMENT_OVERRIDE)); continue;
-		case 0x64: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_FS_SEGMENT_OVERRIDE)); continue;
-		case 0x65: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_GS_SEGMENT_OVERRIDE)); continue;
-		case 0x66: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)), instruction->operandSize64 = false; continue;
-		case 0x67: instruction->prefixes = (instruction->prefixes | NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE); continue;
-		default:
-			if ((mode == NMD_X86_MODE_64) && NMD_R(*b) == 4) /* 0x40 */
+			reg |= (uint8_t)((instruction->evex.R ? 0 : 8) | (instruction->evex.R1 ? 0 : 16));
+			rm |= (uint8_t)((instruction->evex.B ? 0 : 8) | (instruction->evex.X || !isRegister ? 0 : 16));
+			vvvv |= (uint8_t)(instruction->evex.V1 ? 0 : 16);
+		}
+	}
+	else
+	{
+		vvvv = (uint8_t)(15 - instruction->vex.vvvv);
+		if (is64)
+		{
+			reg |= (uint8_t)(instruction->vex.R ? 0 : 8);
+			rm |= (uint8_t)(instruction->vex.B ? 0 : 8);
+		}
+	}
+	if (!is64)
+		vvvv &= 0b111;
+
+	const char* descriptor = entry->operands;
+	size_t i = 0;
+	for (; *descriptor && i < NMD_X86_MAXIMUM_NUM_OPERANDS; i++)
+	{
+		nmd_x86_operand* const operand = &instruction->operands[i];
+		const char kind = *descriptor++;
+		char suffix = 0;
+		if (*descriptor >= 'a' && *descriptor <= 'z' && *descriptor != 's')
+			suffix = *descriptor++;
+		while (*descriptor && *descriptor != ',')
+			descriptor++;
+		if (*descriptor == ',')
+			descriptor++;
+
+		size_t size = vectorLength;
+		switch (suffix)
+		{
+		case 'x': size = 16; break;
+		case 'y': size = 32; break;
+		case 'h': size = vectorLength / 2; break;
+		case 'q': size = vectorLength / 4; break;
+		case 'o': size = vectorLength / 8; break;
+		}
+		const uint8_t vectorBase = (uint8_t)(size <= 16 ? NMD_X86_REG_XMM0 : (size == 32 ? NMD_X86_REG_YMM0 : NMD_X86_REG_ZMM0));
+		const bool isGpr64 = is64 && W && suffix != 'd';
+
+		operand->type = NMD_X86_OPERAND_TYPE_REGISTER;
+		operand->size = 1;
+		switch (kind)
+		{
+		case 'V': operand->fields.reg = (uint8_t)(vectorBase + reg); break;
+		case 'H': operand->fields.reg = (uint8_t)(vectorBase + vvvv); break;
+		case 'L': operand->fields.reg = (uint8_t)(vectorBase + ((imm8 >> 4) & (is64 ? 0b1111 : 0b111))); break;
+		case 'K': operand->fields.reg = (uint8_t)(NMD_X86_REG_K0 + (reg & 0b111)); break;
+		case 'J': operand->fields.reg = (uint8_t)(NMD_X86_REG_K0 + (vvvv & 0b111)); break;
+		case 'G': operand->fields.reg = _nmd_get_avx_gpr(reg & 0b1111, isGpr64); break;
+		case 'B': operand->fields.reg = _nmd_get_avx_gpr(vvvv & 0b1111, isGpr64); break;
+		case 'I': operand->type = NMD_X86_OPERAND_TYPE_IMMEDIATE, operand->size = 0; break;
+		default: /* 'W', 'k', 'E' and 'S' */
+			if (isRegister && kind != 'S')
+				operand->fields.reg = (uint8_t)(kind == 'W' ? vectorBase + rm : (kind == 'k' ? NMD_X86_REG_K0 + (rm & 0b111) : _nmd_get_avx_gpr(rm & 0b1111, isGpr64)));
+			else
 			{
-				instruction->hasRex = true;
-				instruction->rex = *b;
-				instruction->prefixes = (instruction->prefixes & ~(NMD_X86_PREFIXES_REX_B | NMD_X86_PREFIXES_REX_X | NMD_X86_PREFIXES_REX_R | NMD_X86_PREFIXES_REX_W));
+				_nmd_decode_modrm_upper32(instruction, operand);
 
-				if (*b & 0b0001) /* Bit position 0. */
-					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_B;
-				if (*b & 0b0010) /* Bit position 1. */
-					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_X;
-				if (*b & 0b0100) /* Bit position 2. */
-					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_R;
-				if (*b & 0b1000) /* Bit position 3. */
+				/* The 8-bit displacement of EVEX instructions is scaled by 'disp8Scale'(disp8*N compression). */
+				if (isEvex && instruction->dispMask == NMD_X86_DISP8)
+					operand->fields.mem.disp = (int64_t)(int8_t)instruction->displacement * instruction->evex.disp8Scale;
+
+				/* The index of VSIB is a vector register, EVEX.V' extends it. */
+				if (kind == 'S')
 				{
-					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_W;
-					instruction->operandSize64 = true;
+					uint8_t index = instruction->sib.fields.index;
+					if (is64)
+						index |= (uint8_t)((instruction->prefixes & NMD_X86_PREFIXES_REX_X ? 8 : 0) | (isEvex && !instruction->evex.V1 ? 16 : 0));
+					operand->fields.mem.index = (uint8_t)(vectorBase + index);
+					operand->fields.mem.scale = (uint8_t)(1 << instruction->sib.fields.scale);
 				}
-
-				continue;
 			}
+			break;
 		}
 
-		break;
+		/* Gathers clear the mask register, the only other read operand written. */
+		operand->action = (uint8_t)(kind == 'H' && entry->flags & _NMD_AVX_VSIB ? NMD_X86_OPERAND_ACTION_READ_WRITE : NMD_X86_OPERAND_ACTION_READ);
 	}
+	instruction->numOperands = (uint8_t)i;
 
-	instruction->numPrefixes = (uint8_t)((ptrdiff_t)(b)-(ptrdiff_t)(buffer));
+	/* Merge-masking keeps the elements of a register destination that are masked off, so they are read. */
+	if (i > 0 && !(entry->flags & _NMD_AVX_RO))
+	{
+		const bool isMerged = isEvex && instruction->evex.aaa && !instruction->evex.z && instruction->operands[0].type == NMD_X86_OPERAND_TYPE_REGISTER && instruction->operands[0].fields.reg >= NMD_X86_REG_XMM0;
+		instruction->operands[0].action = (uint8_t)(entry->flags & _NMD_AVX_RW || isMerged ? NMD_X86_OPERAND_ACTION_READ_WRITE : NMD_X86_OPERAND_ACTION_WRITE);
+	}
+}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
 
-	const size_t remainingValidBytes = (NMD_X86_MAXIMUM_INSTRUCTION_LENGTH - instruction->numPrefixes);
-	if (remainingValidBytes == 0)
-		return false;
+/*
+Decodes the opcode, Mod/RM byte and immediate that follow a VEX or EVEX prefix. 'b' points to the prefix's last byte, 'remainingSize'
+is the number of bytes left after it and 'map' is the prefix's opcode map field.
+*/
+bool _nmd_decode_vex_evex_opcode(const uint8_t** b, nmd_x86_instruction* const instruction, size_t remainingSize, uint8_t map, uint32_t flags)
+{
+	(void)flags;
 
-	const size_t remainingBufferSize = bufferSize - instruction->numPrefixes;
-	if (remainingBufferSize == 0)
+	/* Only the 0F, 0F38 and 0F3A maps are defined. */
+	if (remainingSize < 1 || map < 1 || map > 3)
 		return false;
 
-	const size_t remainingSize = remainingValidBytes < remainingBufferSize ? remainingValidBytes : remainingBufferSize;
-
-	/* Assume NMD_X86_INSTRUCTION_ENCODING_LEGACY. */
-	instruction->encoding = NMD_X86_ENCODING_LEGACY;
+	const uint8_t* const opcode = ++*b;
+	instruction->opcode = *opcode;
+	instruction->opcodeMap = (uint8_t)(NMD_X86_OPCODE_MAP_0F + (map - 1));
+	const uint8_t op = instruction->opcode;
 
-	/* Opcode byte. This variable is used because it's easier to write 'op' than 'instruction->opcode'. */
-	uint8_t op = 0;
+	/* Every instruction has a Mod/RM byte except 'vzeroupper' and 'vzeroall'. */
+	if (!(instruction->encoding == NMD_X86_ENCODING_VEX && instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F && op == 0x77))
+	{
+		if (!_nmd_decode_modrm(b, instruction, remainingSize - 1))
+			return false;
+	}
 
-	/* Parse opcode. */
-	if (*b == 0x0F) /* 2 or 3 byte opcode. */
+	if (_nmd_vex_has_imm8(instruction->opcodeMap, op))
 	{
-		if (remainingSize < 2)
+		if ((size_t)(*b - opcode) + 2 > remainingSize)
 			return false;
+		instruction->immMask = NMD_X86_IMM8;
+	}
 
-		b++;
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_EVEX
+	if (instruction->encoding == NMD_X86_ENCODING_EVEX)
+		instruction->evex.disp8Scale = (uint8_t)(instruction->dispMask == NMD_X86_DISP8 ? _nmd_get_evex_disp8_scale(instruction) : 1);
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_EVEX */
 
-		if (*b == 0x38 || *b == 0x3A) /* 3 byte opcode. */
+#if !defined(NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS)
+	if (flags & (NMD_X86_DECODER_FLAGS_VALIDITY_CHECK | NMD_X86_DECODER_FLAGS_INSTRUCTION_ID | NMD_X86_DECODER_FLAGS_OPERANDS))
+	{
+		const uint8_t* const prefix = instruction->encoding == NMD_X86_ENCODING_EVEX ? instruction->evex.evex : instruction->vex.vex;
+		const _nmd_avx_entry* const entry = _nmd_find_avx_entry(prefix, op, instruction->modrm, (NMD_X86_MODE)instruction->mode);
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+		if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
 		{
-			if (remainingSize < 4)
+			if (!entry || !_nmd_is_avx_instruction_valid(entry, prefix, instruction->modrm, (NMD_X86_MODE)instruction->mode))
 				return false;
 
-			instruction->opcodeMap = (uint8_t)(*b == 0x38 ? NMD_X86_OPCODE_MAP_0F38 : NMD_X86_OPCODE_MAP_0F3A);
-			instruction->opcodeSize = 3;
-			instruction->opcode = *++b;
-
-			op = instruction->opcode;
-
-			if (!_nmd_decode_modrm(&b, instruction, remainingSize - 3))
+			/* L'L = 11b is reserved unless it encodes a rounding mode. */
+			if (instruction->encoding == NMD_X86_ENCODING_EVEX && instruction->evex.LL == 0b11 && !(instruction->evex.b && instruction->modrm.fields.mod == 0b11))
 				return false;
-
-			const nmd_x86_modrm modrm = instruction->modrm;
-			if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
-			{
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
-				if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
-				{
-					/* Check if the instruction is invalid. */
-					if (op == 0x36)
-					{
-						return false;
-					}
-					else if (op <= 0xb || (op >= 0x1c && op <= 0x1e))
-					{
-						if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT || instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-							return false;
-					}
-					else if (op >= 0xc8 && op <= 0xcd)
-					{
-						if (instruction->simdPrefix)
-							return false;
-					}
-					else if (op == 0x10 || op == 0x14 || op == 0x15 || op == 0x17 || (op >= 0x20 && op <= 0x25) || op == 0x28 || op == 0x29 || op == 0x2b || NMD_R(op) == 3 || op == 0x40 || op == 0x41 || op == 0xcf || (op >= 0xdb && op <= 0xdf))
-					{
-						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-							return false;
-					}
-					else if (op == 0x2a || (op >= 0x80 && op <= 0x82))
-					{
-						if (modrm.fields.mod == 0b11 || instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-							return false;
-					}
-					else if (op == 0xf0 || op == 0xf1)
-					{
-						if (modrm.fields.mod == 0b11 && (instruction->simdPrefix == NMD_X86_PREFIXES_NONE || instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE))
-							return false;
-						else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
-							return false;
-					}
-					else if (op == 0xf5 || op == 0xf8)
-					{
-						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || modrm.fields.mod == 0b11)
-							return false;
-					}
-					else if (op == 0xf6)
-					{
-						if (instruction->simdPrefix == NMD_X86_PREFIXES_NONE && modrm.fields.mod == 0b11)
-							return false;
-						else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-							return false;
-					}
-					else if (op == 0xf9)
-					{
-						if (instruction->simdPrefix != NMD_X86_PREFIXES_NONE || modrm.fields.mod == 0b11)
-							return false;
-					}
-					else
-						return false;
-				}
+		}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
 
+		if (entry)
+		{
 #ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
-				if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
-				{
-					if (NMD_R(op) == 0x00)
-						instruction->id = NMD_X86_INSTRUCTION_PSHUFB + op;
-					else if (op >= 0x1c && op <= 0x1e)
-						instruction->id = NMD_X86_INSTRUCTION_PABSB + (op - 0x1c);
-					else if (NMD_R(op) == 2)
-						instruction->id = NMD_X86_INSTRUCTION_PMOVSXBW + NMD_C(op);
-					else if (NMD_R(op) == 3)
-						instruction->id = NMD_X86_INSTRUCTION_PMOVZXBW + NMD_C(op);
-					else if (NMD_R(op) == 8)
-						instruction->id = NMD_X86_INSTRUCTION_INVEPT + NMD_C(op);
-					else if (NMD_R(op) == 0xc)
-						instruction->id = NMD_X86_INSTRUCTION_SHA1NEXTE + (NMD_C(op) - 8);
-					else if (NMD_R(op) == 0xd)
-						instruction->id = NMD_X86_INSTRUCTION_AESIMC + (NMD_C(op) - 0xb);
-					else
-					{
-						switch (op)
-						{
-						case 0x10: instruction->id = NMD_X86_INSTRUCTION_PBLENDVB; break;
-						case 0x14: instruction->id = NMD_X86_INSTRUCTION_BLENDVPS; break;
-						case 0x15: instruction->id = NMD_X86_INSTRUCTION_BLENDVPD; break;
-						case 0x17: instruction->id = NMD_X86_INSTRUCTION_PTEST; break;
-						case 0x40: instruction->id = NMD_X86_INSTRUCTION_PMULLD; break;
-						case 0x41: instruction->id = NMD_X86_INSTRUCTION_PHMINPOSUW; break;
-						case 0xf0: case 0xf1: instruction->id = (uint16_t)((instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->simdPrefix == 0x00) ? NMD_X86_INSTRUCTION_MOVBE : NMD_X86_INSTRUCTION_CRC32); break;
-						case 0xf6: instruction->id = (uint16_t)(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_INSTRUCTION_ADCX : NMD_X86_INSTRUCTION_ADOX); break;
-						}
-					}
-				}
+			if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
+				instruction->id = entry->id;
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID */
-				
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS
-				if (flags & NMD_X86_DECODER_FLAGS_CPU_FLAGS)
-				{
-					if (op == 0x80 || op == 0x81) /* invept,invvpid */
-					{
-						instruction->modifiedFlags.eflags = NMD_X86_EFLAGS_CF | NMD_X86_EFLAGS_ZF;
-						instruction->clearedFlags.eflags = NMD_X86_EFLAGS_PF | NMD_X86_EFLAGS_AF | NMD_X86_EFLAGS_SF | NMD_X86_EFLAGS_OF;
-					}
-					else if (op == 0xf6)
-					{
-						if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) /* adcx */
-							instruction->modifiedFlags.eflags = instruction->testedFlags.eflags = NMD_X86_EFLAGS_CF;
-						if (instruction->prefixes & NMD_X86_PREFIXES_REPEAT) /* adox */
-							instruction->modifiedFlags.eflags = instruction->testedFlags.eflags = NMD_X86_EFLAGS_OF;
-					}
-				}
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS */
 
 #ifndef NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS
-				if (flags & NMD_X86_DECODER_FLAGS_OPERANDS)
-				{
-					instruction->numOperands = 2;
-					instruction->operands[0].action = NMD_X86_OPERAND_ACTION_READ_WRITE;
-					instruction->operands[1].action = NMD_X86_OPERAND_ACTION_READ;
+			if (flags & NMD_X86_DECODER_FLAGS_OPERANDS)
+				_nmd_decode_avx_operands(instruction, entry, instruction->immMask ? (*b)[1] : 0);
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
+		}
+	}
+#endif /* !defined(NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS) */
 
-					if (NMD_R(op) == 0 || (op >= 0x1c && op <= 0x1e))
-					{
-						_nmd_decode_operand_Pq(instruction, &instruction->operands[0]);
-						_nmd_decode_operand_Qq(instruction, &instruction->operands[1]);
-					}
-					else if (NMD_R(op) == 8)
-					{
-						_nmd_decode_operand_Gy(instruction, &instruction->operands[0]);
-						_nmd_decode_modrm_upper32(instruction, &instruction->operands[1]);
-					}
-					else if (NMD_R(op) >= 1 && NMD_R(op) <= 0xe)
-					{
-						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
-						_nmd_decode_operand_Wdq(instruction, &instruction->operands[1]);
-					}
-					else if (op == 0xf6)
-					{
-						_nmd_decode_operand_Gy(instruction, &instruction->operands[!instruction->simdPrefix ? 1 : 0]);
-						_nmd_decode_operand_Ey(instruction, &instruction->operands[!instruction->simdPrefix ? 0 : 1]);
-					}
-					else if (op == 0xf0 || op == 0xf1)
-					{
-						if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO || (instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)) == (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT_NOT_ZERO))
-						{
-							_nmd_decode_operand_Gd(instruction, &instruction->operands[0]);
-							if (op == 0xf0)
-								_nmd_decode_operand_Eb(instruction, &instruction->operands[1]);
-							else if (instruction->prefixes == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-								_nmd_decode_operand_Ey(instruction, &instruction->operands[1]);
-							else
-								_nmd_decode_operand_Ew(instruction, &instruction->operands[1]);
-						}
-						else
-						{
-							if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-								_nmd_decode_operand_Gw(instruction, &instruction->operands[op == 0xf0 ? 0 : 1]);
-							else
-								_nmd_decode_operand_Gy(instruction, &instruction->operands[op == 0xf0 ? 0 : 1]);
+	return true;
+}
+#endif /* !defined(NMD_ASSEMBLY_DISABLE_DECODER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_DECODER_EVEX) */
 
-							_nmd_decode_memory_operand(instruction, &instruction->operands[op == 0xf0 ? 1 : 0], (uint8_t)(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_REG_AX : (instruction->operandSize64 ? NMD_X86_REG_RAX : NMD_X86_REG_EAX)));
-						}
-					}
-				}
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
-			}
-			else /* 0x3a */
-			{
-				if (remainingSize < 5)
-					return false;
+/* Clears 'count' consecutive instructions eight bytes at a time. */
+static void _nmd_clear_instructions(nmd_x86_instruction* instructions, size_t count)
+{
+	const size_t size = count * sizeof(nmd_x86_instruction);
+	size_t i = 0;
+	for (; i < size / sizeof(uint64_t); i++)
+		((uint64_t*)(instructions))[i] = 0;
 
-				instruction->immMask = NMD_X86_IMM8;
+	for (i *= sizeof(uint64_t); i < size; i++)
+		((uint8_t*)(instructions))[i] = 0x00;
+}
 
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
-				if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
-				{
-					/* Check if the instruction is invalid. */
-					if ((op >= 0x8 && op <= 0xe) || (op >= 0x14 && op <= 0x17) || (op >= 0x20 && op <= 0x22) || (op >= 0x40 && op <= 0x42) || op == 0x44 || (op >= 0x60 && op <= 0x63) || op == 0xdf || op == 0xce || op == 0xcf)
-					{
-						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-							return false;
-					}
-					else if (op == 0x0f || op == 0xcc)
-					{
-						if (instruction->simdPrefix)
-							return false;
-					}
-					else
-						return false;
-				}
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+/* Returns 'flags' with the decoder flags it implies. */
+static uint32_t _nmd_get_implied_decoder_flags(uint32_t flags)
+{
+#if !defined(NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS) && !defined(NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS)
+	/* Whether the flags register is read or written is derived from the cpu flags. */
+	if (flags & NMD_X86_DECODER_FLAGS_REGISTERS)
+		flags |= NMD_X86_DECODER_FLAGS_CPU_FLAGS;
+#endif
 
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
-				if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
-				{
-					if (NMD_R(op) == 0)
-						instruction->id = NMD_X86_INSTRUCTION_ROUNDPS + (op - 8);
-					else if (NMD_R(op) == 4)
-						instruction->id = NMD_X86_INSTRUCTION_DPPS + NMD_C(op);
-					else if (NMD_R(op) == 6)
-						instruction->id = NMD_X86_INSTRUCTION_PCMPESTRM + NMD_C(op);
-					else
-					{
-						switch (op)
-						{
-						case 0x14: instruction->id = NMD_X86_INSTRUCTION_PEXTRB; break;
-						case 0x15: instruction->id = NMD_X86_INSTRUCTION_PEXTRW; break;
-						case 0x16: instruction->id = (uint16_t)(instruction->prefixes & NMD_X86_PREFIXES_REX_W ? NMD_X86_INSTRUCTION_PEXTRQ : NMD_X86_INSTRUCTION_PEXTRD); break;
-						case 0x17: instruction->id = NMD_X86_INSTRUCTION_EXTRACTPS; break;
-						case 0x20: instruction->id = NMD_X86_INSTRUCTION_PINSRB; break;
-						case 0x21: instruction->id = NMD_X86_INSTRUCTION_INSERTPS; break;
-						case 0x22: instruction->id = (uint16_t)(instruction->prefixes & NMD_X86_PREFIXES_REX_W ? NMD_X86_INSTRUCTION_PINSRQ : NMD_X86_INSTRUCTION_PINSRD); break;
-						case 0xcc: instruction->id = NMD_X86_INSTRUCTION_SHA1RNDS4; break;
-						case 0xdf: instruction->id = NMD_X86_INSTRUCTION_AESKEYGENASSIST; break;
-						}
-					}
-				}
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID */
+	return flags;
+}
 
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS
-				if (flags & NMD_X86_DECODER_FLAGS_OPERANDS)
-				{
-					instruction->numOperands = 3;
-					instruction->operands[0].action = NMD_X86_OPERAND_ACTION_READ_WRITE;
-					instruction->operands[1].action = instruction->operands[2].action = NMD_X86_OPERAND_ACTION_READ;
-					instruction->operands[2].type = NMD_X86_OPERAND_TYPE_IMMEDIATE;
+/* Returns how 'instruction' transfers control. A member of 'NMD_X86_FLOW'. */
+uint8_t _nmd_get_flow(const nmd_x86_instruction* instruction)
+{
+	const uint8_t op = instruction->opcode;
 
-					if (op == 0x0f && !instruction->simdPrefix)
-					{
-						_nmd_decode_operand_Pq(instruction, &instruction->operands[0]);
-						_nmd_decode_operand_Qq(instruction, &instruction->operands[1]);
-					}
-					else if (NMD_R(op) == 1)
-					{
-						_nmd_decode_memory_operand(instruction, &instruction->operands[0], NMD_X86_REG_EAX);
-						_nmd_decode_operand_Vdq(instruction, &instruction->operands[1]);
-					}
-					else if (NMD_R(op) == 2)
-					{
-						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
-						_nmd_decode_memory_operand(instruction, &instruction->operands[1], (uint8_t)(NMD_C(op) == 1 ? NMD_X86_REG_XMM0 : NMD_X86_REG_EAX));
-					}
-					else if (op == 0xcc || op == 0xdf || NMD_R(op) == 4 || NMD_R(op) == 6 || NMD_R(op) == 0)
-					{
-						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
-						_nmd_decode_operand_Wdq(instruction, &instruction->operands[1]);
-					}
-				}
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
-			}
+	if (instruction->encoding != NMD_X86_ENCODING_LEGACY)
+		return NMD_X86_FLOW_FALLTHROUGH;
+
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
+	{
+		if (NMD_R(op) == 7 || (op >= 0xe0 && op <= 0xe3))
+			return NMD_X86_FLOW_JCC;
+		else if (op == 0xe9 || op == 0xeb)
+			return NMD_X86_FLOW_JMP_DIRECT;
+		else if (op == 0xe8)
+			return NMD_X86_FLOW_CALL_DIRECT;
+		else if (op == 0xea)
+			return NMD_X86_FLOW_JMP_INDIRECT;
+		else if (op == 0x9a)
+			return NMD_X86_FLOW_CALL_INDIRECT;
+		else if (op == 0xff)
+		{
+			if (instruction->modrm.fields.reg == 0b010 || instruction->modrm.fields.reg == 0b011)
+				return NMD_X86_FLOW_CALL_INDIRECT;
+			else if (instruction->modrm.fields.reg == 0b100 || instruction->modrm.fields.reg == 0b101)
+				return NMD_X86_FLOW_JMP_INDIRECT;
+		}
+		else if (op == 0xc2 || op == 0xc3 || op == 0xca || op == 0xcb || op == 0xcf)
+			return NMD_X86_FLOW_RET;
+		else if (op == 0xcc || op == 0xcd || op == 0xce || op == 0xf1)
+			return NMD_X86_FLOW_INT;
+		else if (op == 0xf4)
+			return NMD_X86_FLOW_TRAP;
+	}
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+	{
+		if (NMD_R(op) == 8)
+			return NMD_X86_FLOW_JCC;
+		else if (op == 0x05 || op == 0x34)
+			return NMD_X86_FLOW_INT;
+		else if (op == 0x07 || op == 0x35)
+			return NMD_X86_FLOW_RET;
+		else if (op == 0x0b || op == 0xb9 || op == 0xff)
+			return NMD_X86_FLOW_TRAP;
+	}
+
+	return NMD_X86_FLOW_FALLTHROUGH;
+}
+
+/* Returns the sign-extended relative immediate of a direct branch plus the instruction's length. */
+int64_t _nmd_get_relative_target(const nmd_x86_instruction* instruction)
+{
+	int64_t rel = 0;
+	if (instruction->immMask == NMD_X86_IMM8)
+		rel = (int8_t)instruction->immediate;
+	else if (instruction->immMask == NMD_X86_IMM16)
+		rel = (int16_t)instruction->immediate;
+	else if (instruction->immMask == NMD_X86_IMM32)
+		rel = (int32_t)instruction->immediate;
+
+	return rel + instruction->length;
+}
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS
+/*
+Adds an access to the general-purpose register 'reg'(0-15, numbered as in the encoding) to 'regsRead' and 'regsWritten'.
+If 'partial' is true only part of the register is written(e.g. 'al' or 'ax'), so the rest of it is read as well.
+*/
+void _nmd_add_gpr_access(nmd_x86_instruction* instruction, size_t reg, uint8_t action, bool partial)
+{
+	const uint32_t mask = (uint32_t)1 << reg;
+
+	if ((action & NMD_X86_OPERAND_ACTION_READ) || ((action & NMD_X86_OPERAND_ACTION_WRITE) && partial))
+		instruction->regsRead |= mask;
+
+	if (action & NMD_X86_OPERAND_ACTION_WRITE)
+		instruction->regsWritten |= mask;
+}
+
+/* Returns the register that a byte register encoded as 'reg' is part of. Without a REX prefix 4-7 encode 'ah', 'ch', 'dh' and 'bh'. */
+size_t _nmd_get_byte_gpr(const nmd_x86_instruction* instruction, size_t reg)
+{
+	return !instruction->hasRex && reg >= 4 && reg < 8 ? reg - 4 : reg;
+}
+
+/* Returns the mask of the segment register used by a memory access whose default segment is 'defaultSegment'. Only 'fs' and 'gs' are used in 64 bit mode. */
+uint32_t _nmd_get_segment_mask(const nmd_x86_instruction* instruction, uint32_t defaultSegment)
+{
+	const uint32_t segment = instruction->segmentOverride ? (uint32_t)NMD_X86_REGISTER_MASK_ES << _nmd_get_bit_index(instruction->segmentOverride) : defaultSegment;
+	return instruction->mode == NMD_X86_MODE_64 && !(segment & (NMD_X86_REGISTER_MASK_FS | NMD_X86_REGISTER_MASK_GS)) ? 0 : segment;
+}
+
+/* Adds the registers read to compute the address of the ModR/M memory operand, and its segment if 'accessesMemory' is true. */
+void _nmd_add_memory_operand_registers(nmd_x86_instruction* instruction, bool accessesMemory)
+{
+	const nmd_x86_modrm modrm = instruction->modrm;
+	uint32_t segment = NMD_X86_REGISTER_MASK_DS;
+
+	if (instruction->mode == NMD_X86_MODE_16 || (instruction->mode == NMD_X86_MODE_32 && instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE))
+	{
+		/* [bx+si], [bx+di], [bp+si], [bp+di], [si], [di], [bp], [bx] */
+		const uint8_t bases[8] = { 3, 3, 5, 5, 6, 7, 5, 3 };
+		if (modrm.fields.rm < 4)
+			_nmd_add_gpr_access(instruction, 6 + (modrm.fields.rm & 1), NMD_X86_OPERAND_ACTION_READ, false);
+		if (!(modrm.fields.mod == 0b00 && modrm.fields.rm == 0b110))
+		{
+			_nmd_add_gpr_access(instruction, bases[modrm.fields.rm], NMD_X86_OPERAND_ACTION_READ, false);
+			if (bases[modrm.fields.rm] == 5)
+				segment = NMD_X86_REGISTER_MASK_SS;
 		}
-		else if (*b == 0x0f) /* 3DNow! opcode map*/
+	}
+	else if (instruction->hasSIB)
+	{
+		const size_t base = instruction->sib.fields.base | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0);
+		const size_t index = instruction->sib.fields.index | (instruction->prefixes & NMD_X86_PREFIXES_REX_X ? 8 : 0);
+		if (!(modrm.fields.mod == 0b00 && instruction->sib.fields.base == 0b101))
 		{
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_3DNOW
-			if (flags & NMD_X86_DECODER_FLAGS_3DNOW)
-			{
-				if (remainingSize < 5)
-					return false;
-			
-				if (!_nmd_decode_modrm(&b, instruction, remainingSize - 2))
-					return false;
+			_nmd_add_gpr_access(instruction, base, NMD_X86_OPERAND_ACTION_READ, false);
+			if (base == 4 || base == 5)
+				segment = NMD_X86_REGISTER_MASK_SS;
+		}
 
-				instruction->encoding = NMD_X86_ENCODING_3DNOW;
-				instruction->opcode = 0x0f;
-				instruction->immMask = NMD_X86_IMM8; /* The real opcode is encoded as the immediate byte. */
-				instruction->immediate = *(b + 1);
+		/* An index of 100b means no index. The index of a gather or scatter(VSIB) is a vector register. */
+		if (index != 4 && !(instruction->encoding != NMD_X86_ENCODING_LEGACY && instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38 && ((instruction->opcode >= 0x90 && instruction->opcode <= 0x93) || (instruction->opcode >= 0xa0 && instruction->opcode <= 0xa3))))
+			_nmd_add_gpr_access(instruction, index, NMD_X86_OPERAND_ACTION_READ, false);
+	}
+	else if (modrm.fields.mod == 0b00 && modrm.fields.rm == 0b101)
+	{
+		if (instruction->mode == NMD_X86_MODE_64)
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_RIP;
+	}
+	else
+	{
+		const size_t base = modrm.fields.rm | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0);
+		_nmd_add_gpr_access(instruction, base, NMD_X86_OPERAND_ACTION_READ, false);
+		if (base == 5)
+			segment = NMD_X86_REGISTER_MASK_SS;
+	}
 
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
-				if (!_nmd_findByte(_nmd_valid3DNowOpcodes, sizeof(_nmd_valid3DNowOpcodes), (uint8_t)instruction->immediate))
-					return false;
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+	if (accessesMemory)
+		instruction->regsRead |= _nmd_get_segment_mask(instruction, segment);
+}
+
+/*
+Fills 'regsRead' and 'regsWritten' from the instruction's explicit operands and the registers it uses implicitly(e.g. 'rsp' for push,
+'rax' and 'rdx' for mul, 'rcx', 'rsi' and 'rdi' for string instructions). Vector, x87, mask, control and debug registers are not tracked,
+and only the registers of the memory operand are reported for VEX and EVEX instructions. The flags register is taken from the cpu flags.
+*/
+void _nmd_decode_registers(nmd_x86_instruction* instruction)
+{
+	const uint8_t op = instruction->opcode;
+	const nmd_x86_modrm modrm = instruction->modrm;
+	const size_t reg = modrm.fields.reg | (instruction->prefixes & NMD_X86_PREFIXES_REX_R ? 8 : 0);
+	const size_t rm = modrm.fields.rm | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0);
+	const bool operandSize16 = !instruction->operandSize64 && ((instruction->mode == NMD_X86_MODE_16) != (bool)(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE));
+	uint8_t regAction = 0; /* The access to the register in the 'reg' field of the ModR/M byte. */
+	uint8_t rmAction = 0;  /* The access to the register in the 'rm' field of the ModR/M byte, if 'mod' is 11b. */
+	bool regByte = false, rmByte = false;
+	bool partial = operandSize16; /* Writes to the registers of the ModR/M byte only modify their lower 16 bits. */
+	bool usesModrm = instruction->hasModrm, accessesMemory = true;
+
+	if (instruction->encoding == NMD_X86_ENCODING_LEGACY && instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
+	{
+		if (op < 0x40 && (op & 7) < 6) /* add,or,adc,sbb,and,sub,xor,cmp */
+		{
+			const uint8_t destination = (uint8_t)(op >= 0x38 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_READ_WRITE);
+			if ((op & 7) >= 4)
+				_nmd_add_gpr_access(instruction, 0, destination, (op & 7) == 4 || operandSize16);
+			else
+			{
+				regByte = rmByte = !(op & 1);
+				regAction = op & 2 ? destination : (uint8_t)NMD_X86_OPERAND_ACTION_READ;
+				rmAction = op & 2 ? (uint8_t)NMD_X86_OPERAND_ACTION_READ : destination;
+
+				/* 'sub' and 'xor' of a register with itself do not depend on its value. */
+				if (op >= 0x28 && op < 0x34 && modrm.fields.mod == 0b11 && reg == rm)
+					regAction = rmAction = NMD_X86_OPERAND_ACTION_WRITE;
 			}
+		}
+		else if (op < 0x40) /* push,pop segment register and daa,das,aaa,aas */
+		{
+			if (op >= 0x20)
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, true);
 			else
-				return false;
-#else /* NMD_ASSEMBLY_DISABLE_DECODER_3DNOW */
-		return false;
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_3DNOW */
+			{
+				if (op & 1)
+					instruction->regsWritten |= (uint32_t)NMD_X86_REGISTER_MASK_ES << (op >> 3);
+				else
+					instruction->regsRead |= (uint32_t)NMD_X86_REGISTER_MASK_ES << (op >> 3);
+				_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			}
 		}
-		else /* 2 byte opcode. */
+		else if (op < 0x50) /* inc,dec */
+			_nmd_add_gpr_access(instruction, op & 7, NMD_X86_OPERAND_ACTION_READ_WRITE, operandSize16);
+		else if (op < 0x60) /* push,pop */
 		{
-			instruction->opcodeSize = 2;
-			instruction->opcode = *b;
-			instruction->opcodeMap = NMD_X86_OPCODE_MAP_0F;
+			_nmd_add_gpr_access(instruction, (op & 7) | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0), (uint8_t)(op < 0x58 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_WRITE), operandSize16);
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0x60 || op == 0x61) /* pusha,popa */
+		{
+			size_t i = 0;
+			for (; i < 8; i++)
+			{
+				if (op == 0x60)
+					_nmd_add_gpr_access(instruction, i, NMD_X86_OPERAND_ACTION_READ, false);
+				else if (i != 4)
+					_nmd_add_gpr_access(instruction, i, NMD_X86_OPERAND_ACTION_WRITE, operandSize16);
+			}
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0x62) /* bound */
+			regAction = NMD_X86_OPERAND_ACTION_READ;
+		else if (op == 0x63)
+		{
+			if (instruction->mode == NMD_X86_MODE_64) /* movsxd */
+			{
+				regAction = NMD_X86_OPERAND_ACTION_WRITE;
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			}
+			else /* arpl */
+			{
+				regAction = NMD_X86_OPERAND_ACTION_READ;
+				rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+				partial = true;
+			}
+		}
+		else if (op == 0x68 || op == 0x6a || op == 0xc2 || op == 0xc3 || op == 0xe8) /* push imm,ret,call */
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		else if (op == 0x69 || op == 0x6b) /* imul */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			rmAction = NMD_X86_OPERAND_ACTION_READ;
+		}
+		else if ((op >= 0x6c && op <= 0x6f) || (op >= 0xa4 && op <= 0xa7) || (op >= 0xaa && op <= 0xaf)) /* ins,outs,movs,cmps,stos,lods,scas */
+		{
+			if (instruction->prefixes & (NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO))
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
 
-			op = instruction->opcode;
+			if (op == 0x6e || op == 0x6f || (op >= 0xa4 && op <= 0xa7) || op == 0xac || op == 0xad) /* Source at [ds:rsi] */
+			{
+				_nmd_add_gpr_access(instruction, 6, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+				instruction->regsRead |= _nmd_get_segment_mask(instruction, NMD_X86_REGISTER_MASK_DS);
+			}
 
-			/* Check for ModR/M, SIB and displacement. */
-			if (op >= 0x20 && op <= 0x23 && remainingSize == 2)
-				instruction->hasModrm = true, instruction->modrm.modrm = *++b;
-			else if (op < 4 || (NMD_R(op) != 3 && NMD_R(op) > 0 && NMD_R(op) < 7) || (op >= 0xD0 && op != 0xFF) || (NMD_R(op) == 7 && NMD_C(op) != 7) || NMD_R(op) == 9 || NMD_R(op) == 0xB || (NMD_R(op) == 0xC && NMD_C(op) < 8) || (NMD_R(op) == 0xA && (op % 8) >= 3) || op == 0x0ff || op == 0x00 || op == 0x0d)
+			if (op < 0x6e || (op >= 0xa4 && op <= 0xa7) || op >= 0xae || op == 0xaa || op == 0xab) /* Destination at [es:rdi] */
 			{
-				if (!_nmd_decode_modrm(&b, instruction, remainingSize - 2))
-					return false;
+				_nmd_add_gpr_access(instruction, 7, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+				if (instruction->mode != NMD_X86_MODE_64)
+					instruction->regsRead |= NMD_X86_REGISTER_MASK_ES;
 			}
 
-			const nmd_x86_modrm modrm = instruction->modrm;
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
-			if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
+			if (op < 0x70)
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+			else if (op == 0xac || op == 0xad)
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, op == 0xac || operandSize16);
+			else if (op >= 0xaa)
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+
+			/* The direction flag. */
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op >= 0x80 && op <= 0x83)
+		{
+			rmByte = op == 0x80 || op == 0x82;
+			rmAction = (uint8_t)(modrm.fields.reg == 0b111 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_READ_WRITE);
+		}
+		else if (op >= 0x84 && op <= 0x8b) /* test,xchg,mov */
+		{
+			regByte = rmByte = !(op & 1);
+			if (op < 0x86)
+				regAction = rmAction = NMD_X86_OPERAND_ACTION_READ;
+			else if (op < 0x88)
+				regAction = rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+			else
 			{
-				/* Check if the instruction is invalid. */
-				if (_nmd_findByte(_nmd_invalid2op, sizeof(_nmd_invalid2op), op))
-					return false;
-				else if (op == 0xc7)
-				{
-					if ((!instruction->simdPrefix && (modrm.fields.mod == 0b11 ? modrm.fields.reg <= 0b101 : modrm.fields.reg == 0b000 || modrm.fields.reg == 0b010)) || (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO && (modrm.fields.mod == 0b11 || modrm.fields.reg != 0b001)) || ((instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT) && (modrm.fields.mod == 0b11 ? modrm.fields.reg <= (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? 0b110 : 0b101) : (modrm.fields.reg != 0b001 && modrm.fields.reg != 0b110))))
-						return false;
-				}
-				else if (op == 0x00)
+				regAction = (uint8_t)(op & 2 ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ);
+				rmAction = (uint8_t)(op & 2 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_WRITE);
+			}
+		}
+		else if (op == 0x8c || op == 0x8e) /* mov Ev,Sw and mov Sw,Ew */
+		{
+			if (modrm.fields.reg < 6)
+			{
+				if (op == 0x8c)
+					instruction->regsRead |= (uint32_t)NMD_X86_REGISTER_MASK_ES << modrm.fields.reg;
+				else
+					instruction->regsWritten |= (uint32_t)NMD_X86_REGISTER_MASK_ES << modrm.fields.reg;
+			}
+			rmAction = (uint8_t)(op == 0x8c ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ);
+		}
+		else if (op == 0x8d) /* lea */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			accessesMemory = false;
+		}
+		else if (op == 0x8f) /* pop */
+		{
+			rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op >= 0x90 && op <= 0x97) /* xchg */
+		{
+			if (!(op == 0x90 && !(instruction->prefixes & NMD_X86_PREFIXES_REX_B)))
+			{
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, operandSize16);
+				_nmd_add_gpr_access(instruction, (op & 7) | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0), NMD_X86_OPERAND_ACTION_READ_WRITE, operandSize16);
+			}
+		}
+		else if (op == 0x98) /* cbw,cwde,cdqe */
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		else if (op == 0x99) /* cwd,cdq,cqo */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+			_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_WRITE, operandSize16);
+		}
+		else if (op == 0x9a) /* call far */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_CS;
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS;
+		}
+		else if (op == 0x9c || op == 0x9d) /* pushf,popf */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			if (op == 0x9c)
+				instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+			else
+				instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op == 0x9e) /* sahf */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op == 0x9f) /* lahf */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, true);
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op >= 0xa0 && op <= 0xa3) /* mov with a memory offset */
+		{
+			_nmd_add_gpr_access(instruction, 0, (uint8_t)(op < 0xa2 ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ), op == 0xa0 || operandSize16);
+			instruction->regsRead |= _nmd_get_segment_mask(instruction, NMD_X86_REGISTER_MASK_DS);
+		}
+		else if (op == 0xa8 || op == 0xa9) /* test */
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+		else if (op >= 0xb0 && op <= 0xbf) /* mov */
+		{
+			const size_t r = (op & 7) | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0);
+			if (op < 0xb8)
+				_nmd_add_gpr_access(instruction, _nmd_get_byte_gpr(instruction, r), NMD_X86_OPERAND_ACTION_WRITE, true);
+			else
+				_nmd_add_gpr_access(instruction, r, NMD_X86_OPERAND_ACTION_WRITE, operandSize16);
+		}
+		else if (op == 0xc0 || op == 0xc1 || (op >= 0xd0 && op <= 0xd3)) /* rol,ror,rcl,rcr,shl,shr,sal,sar */
+		{
+			rmByte = !(op & 1);
+			rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+			if (op >= 0xd2)
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+		}
+		else if (op == 0xc4 || op == 0xc5) /* les,lds */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			instruction->regsWritten |= op == 0xc4 ? NMD_X86_REGISTER_MASK_ES : NMD_X86_REGISTER_MASK_DS;
+		}
+		else if (op == 0xc6 || op == 0xc7) /* mov */
+		{
+			rmByte = op == 0xc6;
+			rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+		}
+		else if (op == 0xc8) /* enter */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			_nmd_add_gpr_access(instruction, 5, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0xc9) /* leave */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_WRITE, false);
+			_nmd_add_gpr_access(instruction, 5, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0xca || op == 0xcb || op == 0xcf) /* retf,iret */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS;
+			if (op == 0xcf)
+				instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS | (instruction->mode == NMD_X86_MODE_64 ? NMD_X86_REGISTER_MASK_SS : 0);
+		}
+		else if ((op >= 0xcc && op <= 0xce) || op == 0xf1) /* int3,int,into,int1 */
+		{
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_CS | NMD_X86_REGISTER_MASK_FLAGS;
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS | NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op >= 0xd4 && op <= 0xd6) /* aam,aad,salc */
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, true);
+		else if (op == 0xd7) /* xlat */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, true);
+			_nmd_add_gpr_access(instruction, 3, NMD_X86_OPERAND_ACTION_READ, false);
+			instruction->regsRead |= _nmd_get_segment_mask(instruction, NMD_X86_REGISTER_MASK_DS);
+		}
+		else if (op >= 0xd8 && op <= 0xdf && modrm.fields.mod == 0b11)
+		{
+			if (modrm.modrm == 0xe0 && op == 0xdf) /* fnstsw ax */
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, true);
+			else if ((op == 0xda || op == 0xdb) && modrm.fields.reg < 4) /* fcmovcc */
+				instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+			else if ((op == 0xdb || op == 0xdf) && (modrm.fields.reg == 0b101 || modrm.fields.reg == 0b110)) /* fucomi,fcomi */
+				instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS;
+		}
+		else if (op >= 0xe0 && op <= 0xe3) /* loopne,loope,loop,jcxz */
+			_nmd_add_gpr_access(instruction, 1, (uint8_t)(op == 0xe3 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_READ_WRITE), false);
+		else if ((op >= 0xe4 && op <= 0xe7) || (op >= 0xec && op <= 0xef)) /* in,out */
+		{
+			if (op & 2)
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+			else
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, !(op & 1) || operandSize16);
+
+			if (op >= 0xec)
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+		}
+		else if (op == 0xea) /* jmp far */
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS;
+		else if (op == 0xf6 || op == 0xf7)
+		{
+			rmByte = op == 0xf6;
+			if (modrm.fields.reg == 0b010 || modrm.fields.reg == 0b011) /* not,neg */
+				rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+			else
+			{
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+				if (modrm.fields.reg >= 0b100) /* mul,imul,div,idiv */
 				{
-					if (modrm.fields.reg >= 0b110)
-						return false;
+					_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+					if (op == 0xf7)
+						_nmd_add_gpr_access(instruction, 2, (uint8_t)(modrm.fields.reg >= 0b110 ? NMD_X86_OPERAND_ACTION_READ_WRITE : NMD_X86_OPERAND_ACTION_WRITE), operandSize16);
 				}
-				else if (op == 0x01)
-				{
+			}
+		}
+		else if (op == 0xfe)
+		{
+			rmByte = true;
+			rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+		}
+		else if (op == 0xff)
+		{
+			rmAction = (uint8_t)(modrm.fields.reg < 0b010 ? NMD_X86_OPERAND_ACTION_READ_WRITE : NMD_X86_OPERAND_ACTION_READ);
+			if (modrm.fields.reg == 0b010 || modrm.fields.reg == 0b011 || modrm.fields.reg == 0b110) /* call,call far,push */
+				_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			if (modrm.fields.reg == 0b011 || modrm.fields.reg == 0b101) /* call far,jmp far */
+			{
+				instruction->regsRead |= modrm.fields.reg == 0b011 ? NMD_X86_REGISTER_MASK_CS : 0;
+				instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS;
+			}
+		}
+	}
+	else if (instruction->encoding == NMD_X86_ENCODING_LEGACY && instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+	{
+		const bool f3 = instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT, f2 = instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO;
+
+		if (op == 0x00) /* sldt,str,lldt,ltr,verr,verw */
+			rmAction = (uint8_t)(modrm.fields.reg < 0b010 ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ);
+		else if (op == 0x01)
+		{
+			if (modrm.fields.reg == 0b100) /* smsw */
+				rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			else if (modrm.fields.reg == 0b110) /* lmsw */
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			else if (modrm.modrm == 0xd0) /* xgetbv */
+			{
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, false);
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_WRITE, false);
+			}
+			else if (modrm.modrm == 0xd1 || modrm.modrm == 0xc8 || modrm.modrm == 0xc9) /* xsetbv,monitor,mwait */
+			{
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+				if (modrm.modrm != 0xc9)
+					_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+			}
+			else if (modrm.modrm == 0xf8) /* swapgs */
+			{
+				instruction->regsRead |= NMD_X86_REGISTER_MASK_GS;
+				instruction->regsWritten |= NMD_X86_REGISTER_MASK_GS;
+			}
+			else if (modrm.modrm == 0xf9) /* rdtscp */
+			{
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, false);
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_WRITE, false);
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_WRITE, false);
+			}
+		}
+		else if (op == 0x02 || op == 0x03 || (NMD_R(op) == 4) || op == 0xaf || (op == 0xb8 && f3) || op == 0xbc || op == 0xbd) /* lar,lsl,cmovcc,imul,popcnt,bsf,bsr,tzcnt,lzcnt */
+		{
+			regAction = (uint8_t)(NMD_R(op) == 4 || op == 0xaf ? NMD_X86_OPERAND_ACTION_READ_WRITE : NMD_X86_OPERAND_ACTION_WRITE);
+			rmAction = NMD_X86_OPERAND_ACTION_READ;
+		}
+		else if (op == 0x05) /* syscall */
+		{
+			_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_WRITE, false);
+			_nmd_add_gpr_access(instruction, 11, NMD_X86_OPERAND_ACTION_WRITE, false);
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS | NMD_X86_REGISTER_MASK_CS | NMD_X86_REGISTER_MASK_SS;
+		}
+		else if (op == 0x07) /* sysret */
+		{
+			_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+			_nmd_add_gpr_access(instruction, 11, NMD_X86_OPERAND_ACTION_READ, false);
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS | NMD_X86_REGISTER_MASK_CS | NMD_X86_REGISTER_MASK_SS;
+		}
+		else if (op == 0x34 || op == 0x35) /* sysenter,sysexit */
+		{
+			if (op == 0x35)
+			{
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+			}
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_WRITE, false);
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_CS | NMD_X86_REGISTER_MASK_SS;
+		}
+		else if (op >= 0x19 && op <= 0x1f) /* Hint nops do not use their operands. */
+			usesModrm = false;
+		else if (op >= 0x20 && op <= 0x23) /* mov to and from control and debug registers */
+		{
+			rmAction = (uint8_t)(op & 2 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_WRITE);
+			partial = false;
+		}
+		else if ((op == 0x2a && (f3 || f2)) || op == 0x6e || op == 0xc4) /* cvtsi2ss,cvtsi2sd,movd,movq,pinsrw */
+			rmAction = NMD_X86_OPERAND_ACTION_READ;
+		else if (op == 0x7e && !f3) /* movd,movq */
+		{
+			rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			partial = false;
+		}
+		else if (((op == 0x2c || op == 0x2d) && (f3 || f2)) || op == 0x50 || op == 0xc5 || op == 0xd7) /* cvttss2si,cvtss2si,cvttsd2si,cvtsd2si,movmskps,movmskpd,pextrw,pmovmskb */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			partial = false;
+		}
+		else if (op == 0x30) /* wrmsr */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ, false);
+			_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+			_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+		}
+		else if (op >= 0x31 && op <= 0x33) /* rdtsc,rdmsr,rdpmc */
+		{
+			if (op != 0x31)
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_WRITE, false);
+			_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_WRITE, false);
+		}
+		else if (NMD_R(op) == 9) /* setcc */
+		{
+			rmByte = true;
+			rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+		}
+		else if (op == 0xa0 || op == 0xa1 || op == 0xa8 || op == 0xa9) /* push fs,pop fs,push gs,pop gs */
+		{
+			const uint32_t segment = op < 0xa8 ? NMD_X86_REGISTER_MASK_FS : NMD_X86_REGISTER_MASK_GS;
+			if (op & 1)
+				instruction->regsWritten |= segment;
+			else
+				instruction->regsRead |= segment;
+			_nmd_add_gpr_access(instruction, 4, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0xa2) /* cpuid */
+		{
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+			_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_WRITE, false);
+			_nmd_add_gpr_access(instruction, 3, NMD_X86_OPERAND_ACTION_WRITE, false);
+		}
+		else if (op == 0xa3 || op == 0xab || op == 0xb3 || op == 0xbb || op == 0xa4 || op == 0xa5 || op == 0xac || op == 0xad) /* bt,bts,btr,btc,shld,shrd */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_READ;
+			rmAction = (uint8_t)(op == 0xa3 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_READ_WRITE);
+			if (op == 0xa5 || op == 0xad)
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+		}
+		else if (op == 0xb0 || op == 0xb1) /* cmpxchg */
+		{
+			regByte = rmByte = op == 0xb0;
+			regAction = NMD_X86_OPERAND_ACTION_READ;
+			rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+			_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+		}
+		else if (op == 0xb2 || op == 0xb4 || op == 0xb5) /* lss,lfs,lgs */
+		{
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			instruction->regsWritten |= op == 0xb2 ? NMD_X86_REGISTER_MASK_SS : (op == 0xb4 ? NMD_X86_REGISTER_MASK_FS : NMD_X86_REGISTER_MASK_GS);
+		}
+		else if (op == 0xb6 || op == 0xb7 || op == 0xbe || op == 0xbf) /* movzx,movsx */
+		{
+			rmByte = op == 0xb6 || op == 0xbe;
+			regAction = NMD_X86_OPERAND_ACTION_WRITE;
+			rmAction = NMD_X86_OPERAND_ACTION_READ;
+		}
+		else if (op == 0xba) /* bt,bts,btr,btc */
+			rmAction = (uint8_t)(modrm.fields.reg == 0b100 ? NMD_X86_OPERAND_ACTION_READ : NMD_X86_OPERAND_ACTION_READ_WRITE);
+		else if (op == 0xc0 || op == 0xc1) /* xadd */
+		{
+			regByte = rmByte = op == 0xc0;
+			regAction = rmAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+		}
+		else if (op == 0xc3) /* movnti */
+			regAction = NMD_X86_OPERAND_ACTION_READ;
+		else if (op == 0xc7)
+		{
+			if (modrm.fields.reg == 0b001) /* cmpxchg8b,cmpxchg16b */
+			{
+				_nmd_add_gpr_access(instruction, 0, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+				_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+				_nmd_add_gpr_access(instruction, 1, NMD_X86_OPERAND_ACTION_READ, false);
+				_nmd_add_gpr_access(instruction, 3, NMD_X86_OPERAND_ACTION_READ, false);
+			}
+			else if (modrm.fields.reg >= 0b110) /* rdrand,rdseed */
+				rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+		}
+		else if (op >= 0xc8) /* bswap */
+			_nmd_add_gpr_access(instruction, (op & 7) | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0), NMD_X86_OPERAND_ACTION_READ_WRITE, false);
+	}
+	else if (instruction->encoding == NMD_X86_ENCODING_LEGACY && instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+	{
+		if (op == 0xf0 || op == 0xf1)
+		{
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO) /* crc32 */
+			{
+				rmByte = op == 0xf0;
+				regAction = NMD_X86_OPERAND_ACTION_READ_WRITE;
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+				partial = false;
+			}
+			else /* movbe */
+				regAction = (uint8_t)(op == 0xf0 ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ);
+		}
+	}
+	else if (instruction->encoding == NMD_X86_ENCODING_LEGACY && instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F3A)
+	{
+		if (op >= 0x14 && op <= 0x17) /* pextrb,pextrw,pextrd,pextrq,extractps */
+		{
+			rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			partial = false;
+		}
+		else if (op == 0x20 || op == 0x22) /* pinsrb,pinsrd,pinsrq */
+			rmAction = NMD_X86_OPERAND_ACTION_READ;
+	}
+	else if (instruction->encoding == NMD_X86_ENCODING_VEX || instruction->encoding == NMD_X86_ENCODING_EVEX)
+	{
+		/* Only general purpose registers are tracked, so only the instructions that access them are listed. */
+		const uint8_t pp = instruction->encoding == NMD_X86_ENCODING_VEX ? instruction->vex.pp : instruction->evex.pp;
+		const size_t vvvv = (size_t)(15 - (instruction->encoding == NMD_X86_ENCODING_VEX ? instruction->vex.vvvv : instruction->evex.vvvv)) & (instruction->mode == NMD_X86_MODE_64 ? 15 : 7);
+		partial = false;
+
+		if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+		{
+			if (((op == 0x2a || op == 0x7b) && pp >= 0b10) || (op == 0x6e && pp == 0b01) || op == 0x92 || op == 0xc4) /* cvtsi2ss,cvtsi2sd,cvtusi2ss,cvtusi2sd,movd,movq,kmov,pinsrw */
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			else if (op == 0x7e && pp == 0b01) /* movd,movq */
+				rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			else if (((op == 0x2c || op == 0x2d || op == 0x78 || op == 0x79) && pp >= 0b10) || op == 0x50 || op == 0x93 || op == 0xc5 || op == 0xd7) /* cvt(t)ss2(u)si,cvt(t)sd2(u)si,movmskps,movmskpd,kmov,pextrw,pmovmskb */
+				regAction = NMD_X86_OPERAND_ACTION_WRITE;
+		}
+		else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+		{
+			if (op >= 0x7a && op <= 0x7c) /* pbroadcastb,pbroadcastw,pbroadcastd,pbroadcastq */
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			else if (op == 0xf2 || op == 0xf5 || op == 0xf6 || op == 0xf7) /* andn,bzhi,pext,pdep,mulx,bextr,shlx,sarx,shrx */
+			{
+				regAction = NMD_X86_OPERAND_ACTION_WRITE;
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+
+				/* 'mulx' writes the low half of the product to the register in 'vvvv' and multiplies by 'edx'/'rdx'. */
+				_nmd_add_gpr_access(instruction, vvvv, (uint8_t)(op == 0xf6 ? NMD_X86_OPERAND_ACTION_WRITE : NMD_X86_OPERAND_ACTION_READ), false);
+				if (op == 0xf6)
+					_nmd_add_gpr_access(instruction, 2, NMD_X86_OPERAND_ACTION_READ, false);
+			}
+			else if (op == 0xf3) /* blsr,blsmsk,blsi */
+			{
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+				_nmd_add_gpr_access(instruction, vvvv, NMD_X86_OPERAND_ACTION_WRITE, false);
+			}
+		}
+		else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F3A)
+		{
+			if (op >= 0x14 && op <= 0x17) /* pextrb,pextrw,pextrd,pextrq,extractps */
+				rmAction = NMD_X86_OPERAND_ACTION_WRITE;
+			else if (op == 0x20 || op == 0x22) /* pinsrb,pinsrd,pinsrq */
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			else if (op == 0xf0) /* rorx */
+			{
+				regAction = NMD_X86_OPERAND_ACTION_WRITE;
+				rmAction = NMD_X86_OPERAND_ACTION_READ;
+			}
+		}
+	}
+
+	if (usesModrm)
+	{
+		if (regAction)
+			_nmd_add_gpr_access(instruction, regByte ? _nmd_get_byte_gpr(instruction, reg) : reg, regAction, regByte || partial);
+
+		if (modrm.fields.mod != 0b11)
+			_nmd_add_memory_operand_registers(instruction, accessesMemory);
+		else if (rmAction)
+			_nmd_add_gpr_access(instruction, rmByte ? _nmd_get_byte_gpr(instruction, rm) : rm, rmAction, rmByte || partial);
+	}
+
+	/* Branches write the instruction pointer, and read it if their target is relative to it or they save a return address. */
+	if (instruction->flow != NMD_X86_FLOW_FALLTHROUGH)
+	{
+		instruction->regsWritten |= NMD_X86_REGISTER_MASK_RIP;
+		if (instruction->flow != NMD_X86_FLOW_JMP_INDIRECT && instruction->flow != NMD_X86_FLOW_RET && instruction->flow != NMD_X86_FLOW_TRAP)
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_RIP;
+	}
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS
+	/* The cpu flags of x87 instructions describe the FPU status word, not the flags register. */
+	if (!(instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT && ((op >= 0xd8 && op <= 0xdf) || op == 0x9b)))
+	{
+		if (instruction->testedFlags.eflags)
+			instruction->regsRead |= NMD_X86_REGISTER_MASK_FLAGS;
+		if (instruction->modifiedFlags.eflags | instruction->setFlags.eflags | instruction->clearedFlags.eflags | instruction->undefinedFlags.eflags)
+			instruction->regsWritten |= NMD_X86_REGISTER_MASK_FLAGS;
+	}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS */
+}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS */
+
+/*
+The decoder's implementation. 'instruction' must be cleared and have its 'mode' member set to 'mode', and 'flags' must include the flags it
+implies(see _nmd_get_implied_decoder_flags()), so that callers decoding many instructions do this setup once. It is always inlined so that
+the decoders generated by NMD_X86_DEFINE_DECODER() and nmd_x86_decode_buffer_lite() get their own copy, in which checks on a constant 'mode'
+or 'flags' are resolved at compile time. The other entry points share the copy in _nmd_decode_cleared_buffer_any(). If 'lite' is not zero, 'instruction' only holds the decoder's state: the results are written to 'lite'
+and the members of 'instruction' that 'lite' does not have(e.g. 'buffer' and 'target') are not filled.
+*/
+static _NMD_FORCEINLINE bool _nmd_decode_cleared_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress, nmd_x86_instruction_lite* lite)
+{
+	if (bufferSize == 0)
+		return false;
+
+	const uint8_t* b = (const uint8_t*)(buffer);
+
+	/* Parse legacy prefixes & REX prefixes. */
+	size_t i = 0;
+	size_t numMaxBytes = bufferSize < NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ? bufferSize : NMD_X86_MAXIMUM_INSTRUCTION_LENGTH;
+#ifdef _NMD_SSE2
+	/* Find where the prefixes end up front so the loop below only visits prefix bytes. */
+	if (bufferSize >= 16)
+	{
+		const size_t numPrefixes = _nmd_sse2_count_prefixes(b, mode);
+		if (numPrefixes < numMaxBytes)
+			numMaxBytes = numPrefixes;
+	}
+#endif /* _NMD_SSE2 */
+	for (; i < numMaxBytes; i++, b++)
+	{
+		switch (*b)
+		{
+		case 0xF0: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_LOCK)); continue;
+		case 0xF2: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_REPEAT_NOT_ZERO)), instruction->repeatPrefix = false; continue;
+		case 0xF3: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_REPEAT)), instruction->repeatPrefix = true; continue;
+		case 0x2E: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_CS_SEGMENT_OVERRIDE)); continue;
+		case 0x36: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_SS_SEGMENT_OVERRIDE)); continue;
+		case 0x3E: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_DS_SEGMENT_OVERRIDE)); continue;
+		case 0x26: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_ES_SEGMENT_OVERRIDE)); continue;
+		case 0x64: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_FS_SEGMENT_OVERRIDE)); continue;
+		case 0x65: instruction->prefixes = (instruction->prefixes | (instruction->segmentOverride = NMD_X86_PREFIXES_GS_SEGMENT_OVERRIDE)); continue;
+		case 0x66: instruction->prefixes = (instruction->prefixes | (instruction->simdPrefix = NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)), instruction->operandSize64 = false; continue;
+		case 0x67: instruction->prefixes = (instruction->prefixes | NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE); continue;
+		default:
+			if ((mode == NMD_X86_MODE_64) && NMD_R(*b) == 4) /* 0x40 */
+			{
+				instruction->hasRex = true;
+				instruction->rex = *b;
+				instruction->prefixes = (instruction->prefixes & ~(NMD_X86_PREFIXES_REX_B | NMD_X86_PREFIXES_REX_X | NMD_X86_PREFIXES_REX_R | NMD_X86_PREFIXES_REX_W));
+
+				if (*b & 0b0001) /* Bit position 0. */
+					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_B;
+				if (*b & 0b0010) /* Bit position 1. */
+					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_X;
+				if (*b & 0b0100) /* Bit position 2. */
+					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_R;
+				if (*b & 0b1000) /* Bit position 3. */
+				{
+					instruction->prefixes = instruction->prefixes | NMD_X86_PREFIXES_REX_W;
+					instruction->operandSize64 = true;
+				}
+
+				continue;
+			}
+		}
+
+		break;
+	}
+
+	instruction->numPrefixes = (uint8_t)((ptrdiff_t)(b)-(ptrdiff_t)(buffer));
+
+	const size_t remainingValidBytes = (NMD_X86_MAXIMUM_INSTRUCTION_LENGTH - instruction->numPrefixes);
+	if (remainingValidBytes == 0)
+		return false;
+
+	const size_t remainingBufferSize = bufferSize - instruction->numPrefixes;
+	if (remainingBufferSize == 0)
+		return false;
+
+	const size_t remainingSize = remainingValidBytes < remainingBufferSize ? remainingValidBytes : remainingBufferSize;
+
+	/* Assume NMD_X86_INSTRUCTION_ENCODING_LEGACY. */
+	instruction->encoding = NMD_X86_ENCODING_LEGACY;
+
+	/* Opcode byte. This variable is used because it's easier to write 'op' than 'instruction->opcode'. */
+	uint8_t op = 0;
+
+	/* Parse opcode. */
+	if (*b == 0x0F) /* 2 or 3 byte opcode. */
+	{
+		if (remainingSize < 2)
+			return false;
+
+		b++;
+
+		if (*b == 0x38 || *b == 0x3A) /* 3 byte opcode. */
+		{
+			if (remainingSize < 4)
+				return false;
+
+			instruction->opcodeMap = (uint8_t)(*b == 0x38 ? NMD_X86_OPCODE_MAP_0F38 : NMD_X86_OPCODE_MAP_0F3A);
+			instruction->opcodeSize = 3;
+			instruction->opcode = *++b;
+
+			op = instruction->opcode;
+
+			if (!_nmd_decode_modrm(&b, instruction, remainingSize - 3))
+				return false;
+
+			const nmd_x86_modrm modrm = instruction->modrm;
+			if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+			{
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+				if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
+				{
+					/* Check if the instruction is invalid. */
+					if (op == 0x36)
+					{
+						return false;
+					}
+					else if (op <= 0xb || (op >= 0x1c && op <= 0x1e))
+					{
+						if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT || instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+							return false;
+					}
+					else if (op >= 0xc8 && op <= 0xcd)
+					{
+						if (instruction->simdPrefix)
+							return false;
+					}
+					else if (op == 0x10 || op == 0x14 || op == 0x15 || op == 0x17 || (op >= 0x20 && op <= 0x25) || op == 0x28 || op == 0x29 || op == 0x2b || NMD_R(op) == 3 || op == 0x40 || op == 0x41 || op == 0xcf || (op >= 0xdb && op <= 0xdf))
+					{
+						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+							return false;
+					}
+					else if (op == 0x2a || (op >= 0x80 && op <= 0x82))
+					{
+						if (modrm.fields.mod == 0b11 || instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+							return false;
+					}
+					else if (op == 0xf0 || op == 0xf1)
+					{
+						if (modrm.fields.mod == 0b11 && (instruction->simdPrefix == NMD_X86_PREFIXES_NONE || instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE))
+							return false;
+						else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+							return false;
+					}
+					else if (op == 0xf5 || op == 0xf8)
+					{
+						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || modrm.fields.mod == 0b11)
+							return false;
+					}
+					else if (op == 0xf6)
+					{
+						if (instruction->simdPrefix == NMD_X86_PREFIXES_NONE && modrm.fields.mod == 0b11)
+							return false;
+						else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+							return false;
+					}
+					else if (op == 0xf9)
+					{
+						if (instruction->simdPrefix != NMD_X86_PREFIXES_NONE || modrm.fields.mod == 0b11)
+							return false;
+					}
+					else
+						return false;
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
+				if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
+				{
+					if (NMD_R(op) == 0x00)
+						instruction->id = NMD_X86_INSTRUCTION_PSHUFB + op;
+					else if (op >= 0x1c && op <= 0x1e)
+						instruction->id = NMD_X86_INSTRUCTION_PABSB + (op - 0x1c);
+					else if (NMD_R(op) == 2)
+						instruction->id = NMD_X86_INSTRUCTION_PMOVSXBW + NMD_C(op);
+					else if (NMD_R(op) == 3)
+						instruction->id = NMD_X86_INSTRUCTION_PMOVZXBW + NMD_C(op);
+					else if (NMD_R(op) == 8)
+						instruction->id = NMD_X86_INSTRUCTION_INVEPT + NMD_C(op);
+					else if (NMD_R(op) == 0xc)
+						instruction->id = NMD_X86_INSTRUCTION_SHA1NEXTE + (NMD_C(op) - 8);
+					else if (NMD_R(op) == 0xd)
+						instruction->id = NMD_X86_INSTRUCTION_AESIMC + (NMD_C(op) - 0xb);
+					else
+					{
+						switch (op)
+						{
+						case 0x10: instruction->id = NMD_X86_INSTRUCTION_PBLENDVB; break;
+						case 0x14: instruction->id = NMD_X86_INSTRUCTION_BLENDVPS; break;
+						case 0x15: instruction->id = NMD_X86_INSTRUCTION_BLENDVPD; break;
+						case 0x17: instruction->id = NMD_X86_INSTRUCTION_PTEST; break;
+						case 0x40: instruction->id = NMD_X86_INSTRUCTION_PMULLD; break;
+						case 0x41: instruction->id = NMD_X86_INSTRUCTION_PHMINPOSUW; break;
+						case 0xf0: case 0xf1: instruction->id = (uint16_t)((instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->simdPrefix == 0x00) ? NMD_X86_INSTRUCTION_MOVBE : NMD_X86_INSTRUCTION_CRC32); break;
+						case 0xf6: instruction->id = (uint16_t)(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_INSTRUCTION_ADCX : NMD_X86_INSTRUCTION_ADOX); break;
+						}
+					}
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID */
+				
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS
+				if (flags & NMD_X86_DECODER_FLAGS_CPU_FLAGS)
+				{
+					if (op == 0x80 || op == 0x81) /* invept,invvpid */
+					{
+						instruction->modifiedFlags.eflags = NMD_X86_EFLAGS_CF | NMD_X86_EFLAGS_ZF;
+						instruction->clearedFlags.eflags = NMD_X86_EFLAGS_PF | NMD_X86_EFLAGS_AF | NMD_X86_EFLAGS_SF | NMD_X86_EFLAGS_OF;
+					}
+					else if (op == 0xf6)
+					{
+						if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) /* adcx */
+							instruction->modifiedFlags.eflags = instruction->testedFlags.eflags = NMD_X86_EFLAGS_CF;
+						if (instruction->prefixes & NMD_X86_PREFIXES_REPEAT) /* adox */
+							instruction->modifiedFlags.eflags = instruction->testedFlags.eflags = NMD_X86_EFLAGS_OF;
+					}
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS */
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS
+				if (flags & NMD_X86_DECODER_FLAGS_OPERANDS)
+				{
+					instruction->numOperands = 2;
+					instruction->operands[0].action = NMD_X86_OPERAND_ACTION_READ_WRITE;
+					instruction->operands[1].action = NMD_X86_OPERAND_ACTION_READ;
+
+					if (NMD_R(op) == 0 || (op >= 0x1c && op <= 0x1e))
+					{
+						_nmd_decode_operand_Pq(instruction, &instruction->operands[0]);
+						_nmd_decode_operand_Qq(instruction, &instruction->operands[1]);
+					}
+					else if (NMD_R(op) == 8)
+					{
+						_nmd_decode_operand_Gy(instruction, &instruction->operands[0]);
+						_nmd_decode_modrm_upper32(instruction, &instruction->operands[1]);
+					}
+					else if (NMD_R(op) >= 1 && NMD_R(op) <= 0xe)
+					{
+						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
+						_nmd_decode_operand_Wdq(instruction, &instruction->operands[1]);
+					}
+					else if (op == 0xf6)
+					{
+						_nmd_decode_operand_Gy(instruction, &instruction->operands[!instruction->simdPrefix ? 1 : 0]);
+						_nmd_decode_operand_Ey(instruction, &instruction->operands[!instruction->simdPrefix ? 0 : 1]);
+					}
+					else if (op == 0xf0 || op == 0xf1)
+					{
+						if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO || (instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)) == (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT_NOT_ZERO))
+						{
+							_nmd_decode_operand_Gd(instruction, &instruction->operands[0]);
+							if (op == 0xf0)
+								_nmd_decode_operand_Eb(instruction, &instruction->operands[1]);
+							else if (instruction->prefixes == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+								_nmd_decode_operand_Ey(instruction, &instruction->operands[1]);
+							else
+								_nmd_decode_operand_Ew(instruction, &instruction->operands[1]);
+						}
+						else
+						{
+							if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+								_nmd_decode_operand_Gw(instruction, &instruction->operands[op == 0xf0 ? 0 : 1]);
+							else
+								_nmd_decode_operand_Gy(instruction, &instruction->operands[op == 0xf0 ? 0 : 1]);
+
+							_nmd_decode_memory_operand(instruction, &instruction->operands[op == 0xf0 ? 1 : 0], (uint8_t)(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_REG_AX : (instruction->operandSize64 ? NMD_X86_REG_RAX : NMD_X86_REG_EAX)));
+						}
+					}
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
+			}
+			else /* 0x3a */
+			{
+				if (remainingSize < 5)
+					return false;
+
+				instruction->immMask = NMD_X86_IMM8;
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+				if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
+				{
+					/* Check if the instruction is invalid. */
+					if ((op >= 0x8 && op <= 0xe) || (op >= 0x14 && op <= 0x17) || (op >= 0x20 && op <= 0x22) || (op >= 0x40 && op <= 0x42) || op == 0x44 || (op >= 0x60 && op <= 0x63) || op == 0xdf || op == 0xce || op == 0xcf)
+					{
+						if (instruction->simdPrefix != NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+							return false;
+					}
+					else if (op == 0x0f || op == 0xcc)
+					{
+						if (instruction->simdPrefix)
+							return false;
+					}
+					else
+						return false;
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
+				if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
+				{
+					if (NMD_R(op) == 0)
+						instruction->id = NMD_X86_INSTRUCTION_ROUNDPS + (op - 8);
+					else if (NMD_R(op) == 4)
+						instruction->id = NMD_X86_INSTRUCTION_DPPS + NMD_C(op);
+					else if (NMD_R(op) == 6)
+						instruction->id = NMD_X86_INSTRUCTION_PCMPESTRM + NMD_C(op);
+					else
+					{
+						switch (op)
+						{
+						case 0x14: instruction->id = NMD_X86_INSTRUCTION_PEXTRB; break;
+						case 0x15: instruction->id = NMD_X86_INSTRUCTION_PEXTRW; break;
+						case 0x16: instruction->id = (uint16_t)(instruction->prefixes & NMD_X86_PREFIXES_REX_W ? NMD_X86_INSTRUCTION_PEXTRQ : NMD_X86_INSTRUCTION_PEXTRD); break;
+						case 0x17: instruction->id = NMD_X86_INSTRUCTION_EXTRACTPS; break;
+						case 0x20: instruction->id = NMD_X86_INSTRUCTION_PINSRB; break;
+						case 0x21: instruction->id = NMD_X86_INSTRUCTION_INSERTPS; break;
+						case 0x22: instruction->id = (uint16_t)(instruction->prefixes & NMD_X86_PREFIXES_REX_W ? NMD_X86_INSTRUCTION_PINSRQ : NMD_X86_INSTRUCTION_PINSRD); break;
+						case 0xcc: instruction->id = NMD_X86_INSTRUCTION_SHA1RNDS4; break;
+						case 0xdf: instruction->id = NMD_X86_INSTRUCTION_AESKEYGENASSIST; break;
+						}
+					}
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID */
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS
+				if (flags & NMD_X86_DECODER_FLAGS_OPERANDS)
+				{
+					instruction->numOperands = 3;
+					instruction->operands[0].action = NMD_X86_OPERAND_ACTION_READ_WRITE;
+					instruction->operands[1].action = instruction->operands[2].action = NMD_X86_OPERAND_ACTION_READ;
+					instruction->operands[2].type = NMD_X86_OPERAND_TYPE_IMMEDIATE;
+
+					if (op == 0x0f && !instruction->simdPrefix)
+					{
+						_nmd_decode_operand_Pq(instruction, &instruction->operands[0]);
+						_nmd_decode_operand_Qq(instruction, &instruction->operands[1]);
+					}
+					else if (NMD_R(op) == 1)
+					{
+						_nmd_decode_memory_operand(instruction, &instruction->operands[0], NMD_X86_REG_EAX);
+						_nmd_decode_operand_Vdq(instruction, &instruction->operands[1]);
+					}
+					else if (NMD_R(op) == 2)
+					{
+						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
+						_nmd_decode_memory_operand(instruction, &instruction->operands[1], (uint8_t)(NMD_C(op) == 1 ? NMD_X86_REG_XMM0 : NMD_X86_REG_EAX));
+					}
+					else if (op == 0xcc || op == 0xdf || NMD_R(op) == 4 || NMD_R(op) == 6 || NMD_R(op) == 0)
+					{
+						_nmd_decode_operand_Vdq(instruction, &instruction->operands[0]);
+						_nmd_decode_operand_Wdq(instruction, &instruction->operands[1]);
+					}
+				}
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
+			}
+		}
+		else if (*b == 0x0f) /* 3DNow! opcode map*/
+		{
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_3DNOW
+			if (flags & NMD_X86_DECODER_FLAGS_3DNOW)
+			{
+				if (remainingSize < 5)
+					return false;
+			
+				if (!_nmd_decode_modrm(&b, instruction, remainingSize - 2))
+					return false;
+
+				instruction->encoding = NMD_X86_ENCODING_3DNOW;
+				instruction->opcode = 0x0f;
+				instruction->immMask = NMD_X86_IMM8; /* The real opcode is encoded as the immediate byte. */
+				instruction->immediate = *(b + 1);
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+				if (!_nmd_findByte(_nmd_valid3DNowOpcodes, sizeof(_nmd_valid3DNowOpcodes), (uint8_t)instruction->immediate))
+					return false;
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+			}
+			else
+				return false;
+#else /* NMD_ASSEMBLY_DISABLE_DECODER_3DNOW */
+		return false;
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_3DNOW */
+		}
+		else /* 2 byte opcode. */
+		{
+			instruction->opcodeSize = 2;
+			instruction->opcode = *b;
+			instruction->opcodeMap = NMD_X86_OPCODE_MAP_0F;
+
+			op = instruction->opcode;
+
+			/* Check for ModR/M, SIB and displacement. */
+			if (op >= 0x20 && op <= 0x23 && remainingSize == 2)
+				instruction->hasModrm = true, instruction->modrm.modrm = *++b;
+			else if (_nmd_op2Properties[op] & _NMD_PROPERTY_MODRM)
+			{
+				if (!_nmd_decode_modrm(&b, instruction, remainingSize - 2))
+					return false;
+			}
+
+			const nmd_x86_modrm modrm = instruction->modrm;
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+			if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK)
+			{
+				/* Check if the instruction is invalid. */
+				if (_nmd_op2Properties[op] & _NMD_PROPERTY_INVALID)
+					return false;
+				else if (op == 0xc7)
+				{
+					if ((!instruction->simdPrefix && (modrm.fields.mod == 0b11 ? modrm.fields.reg <= 0b101 : modrm.fields.reg == 0b000 || modrm.fields.reg == 0b010)) || (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO && (modrm.fields.mod == 0b11 || modrm.fields.reg != 0b001)) || ((instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT) && (modrm.fields.mod == 0b11 ? modrm.fields.reg <= (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? 0b110 : 0b101) : (modrm.fields.reg != 0b001 && modrm.fields.reg != 0b110))))
+						return false;
+				}
+				else if (op == 0x00)
+				{
+					if (modrm.fields.reg >= 0b110)
+						return false;
+				}
+				else if (op == 0x01)
+				{
 					if ((modrm.fields.mod == 0b11 ? ((instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT_NOT_ZERO | NMD_X86_PREFIXES_REPEAT) && ((modrm.modrm >= 0xc0 && modrm.modrm <= 0xc5) || (modrm.modrm >= 0xc8 && modrm.modrm <= 0xcb) || (modrm.modrm >= 0xcf && modrm.modrm <= 0xd1) || (modrm.modrm >= 0xd4 && modrm.modrm <= 0xd7) || modrm.modrm == 0xee || modrm.modrm == 0xef || modrm.modrm == 0xfa || modrm.modrm == 0xfb)) || (modrm.fields.reg == 0b000 && modrm.fields.rm >= 0b110) || (modrm.fields.reg == 0b001 && modrm.fields.rm >= 0b100 && modrm.fields.rm <= 0b110) || (modrm.fields.reg == 0b010 && (modrm.fields.rm == 0b010 || modrm.fields.rm == 0b011)) || (modrm.fields.reg == 0b101 && modrm.fields.rm < 0b110 && (!(instruction->prefixes & NMD_X86_PREFIXES_REPEAT) || (instruction->prefixes & NMD_X86_PREFIXES_REPEAT && (modrm.fields.rm != 0b000 && modrm.fields.rm != 0b010)))) || (modrm.fields.reg == 0b111 && (modrm.fields.rm > 0b101 || (mode != NMD_X86_MODE_64 && modrm.fields.rm == 0b000)))) : (!(instruction->prefixes & NMD_X86_PREFIXES_REPEAT) && modrm.fields.reg == 0b101)))
 						return false;
 				}
@@ -4762,10 +7955,8 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 			}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_CPU_FLAGS */
 
-			if (NMD_R(op) == 8) /* imm32 */
-				instruction->immMask = (uint8_t)(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_IMM16 : NMD_X86_IMM32);
-			else if ((NMD_R(op) == 7 && NMD_C(op) < 4) || op == 0xA4 || op == 0xC2 || (op > 0xC3 && op <= 0xC6) || op == 0xBA || op == 0xAC) /* imm8 */
-				instruction->immMask = NMD_X86_IMM8;
+			if (_NMD_GET_IMM_CLASS(_nmd_op2Properties[op]))
+				instruction->immMask = (uint8_t)_nmd_get_immediate_size(_nmd_op2Properties[op], op, modrm, mode, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE, instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE, instruction->prefixes & NMD_X86_PREFIXES_REX_W);
 			else if (op == 0x78 && (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO || instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) /* imm8 + imm8 = "imm16" */
 				instruction->immMask = NMD_X86_IMM16;
 
@@ -5170,8 +8361,11 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 
 		op = instruction->opcode;
 
+		/* C4h, C5h and 62h start a VEX or EVEX prefix in 64-bit mode. In the other modes they do only if the next byte's mod field is 11b, which 'les', 'lds' and 'bound' cannot encode. */
+		const bool isVexOrEvex = (op == 0xc4 || op == 0xc5 || op == 0x62) && remainingSize > 1 && (mode == NMD_X86_MODE_64 || b[1] >= 0xc0);
+
 		/* Check for ModR/M, SIB and displacement. */
-		if (NMD_R(op) == 8 || _nmd_findByte(_nmd_op1modrm, sizeof(_nmd_op1modrm), op) || (NMD_R(op) < 4 && (NMD_C(op) < 4 || (NMD_C(op) >= 8 && NMD_C(op) < 0xC))) || (NMD_R(op) == 0xD && NMD_C(op) >= 8) || (remainingSize > 1 && ((nmd_x86_modrm*)(b + 1))->fields.mod != 0b11 && (op == 0xc4 || op == 0xc5 || op == 0x62)))
+		if (_nmd_op1Properties[op] & _NMD_PROPERTY_MODRM || (remainingSize > 1 && !isVexOrEvex && (op == 0xc4 || op == 0xc5 || op == 0x62)))
 		{
 			if (!_nmd_decode_modrm(&b, instruction, remainingSize - 1))
 				return false;
@@ -5179,9 +8373,46 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 
 #ifndef NMD_ASSEMBLY_DISABLE_DECODER_EVEX
 		/* Check if instruction is EVEX. */
-		if (flags & NMD_X86_DECODER_FLAGS_EVEX && op == 0x62 && !instruction->hasModrm)
+		if (flags & NMD_X86_DECODER_FLAGS_EVEX && op == 0x62 && isVexOrEvex)
 		{
 			instruction->encoding = NMD_X86_ENCODING_EVEX;
+
+			if (remainingSize < 4)
+				return false;
+
+			nmd_x86_evex* const evex = &instruction->evex;
+			evex->evex[0] = 0x62;
+			const uint8_t p0 = evex->evex[1] = *++b;
+			const uint8_t p1 = evex->evex[2] = *++b;
+			const uint8_t p2 = evex->evex[3] = *++b;
+
+			evex->R = (p0 & 0b10000000) == 0b10000000;
+			evex->X = (p0 & 0b01000000) == 0b01000000;
+			evex->B = (p0 & 0b00100000) == 0b00100000;
+			evex->R1 = (p0 & 0b00010000) == 0b00010000;
+			evex->mmm = (uint8_t)(p0 & 0b00000111);
+			evex->W = (p1 & 0b10000000) == 0b10000000;
+			evex->vvvv = (uint8_t)((p1 & 0b01111000) >> 3);
+			evex->pp = (uint8_t)(p1 & 0b00000011);
+			evex->z = (p2 & 0b10000000) == 0b10000000;
+			evex->LL = (uint8_t)((p2 & 0b01100000) >> 5);
+			evex->b = (p2 & 0b00010000) == 0b00010000;
+			evex->V1 = (p2 & 0b00001000) == 0b00001000;
+			evex->aaa = (uint8_t)(p2 & 0b00000111);
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+			/* Legacy and REX prefixes cannot precede EVEX, bit 3 of P0 must be zero and bit 2 of P1 must be one. */
+			if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK && (instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_LOCK | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO) || instruction->hasRex || p0 & 0b00001000 || !(p1 & 0b00000100)))
+				return false;
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+
+			if (mode == NMD_X86_MODE_64)
+				instruction->prefixes |= (uint16_t)((evex->R ? 0 : NMD_X86_PREFIXES_REX_R) | (evex->X ? 0 : NMD_X86_PREFIXES_REX_X) | (evex->B ? 0 : NMD_X86_PREFIXES_REX_B) | (evex->W ? NMD_X86_PREFIXES_REX_W : 0));
+
+			if (!_nmd_decode_vex_evex_opcode(&b, instruction, remainingSize - 4, evex->mmm, flags))
+				return false;
+
+			op = instruction->opcode;
 		}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_EVEX */
 #if !defined(NMD_ASSEMBLY_DISABLE_DECODER_EVEX) && !defined(NMD_ASSEMBLY_DISABLE_DECODER_VEX)
@@ -5189,61 +8420,52 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 #endif
 #ifndef NMD_ASSEMBLY_DISABLE_DECODER_VEX
 			/* Check if instruction is VEX. */
-			if (flags & NMD_X86_DECODER_FLAGS_VEX && (op == 0xc4 || op == 0xc5) && !instruction->hasModrm)
+			if (flags & NMD_X86_DECODER_FLAGS_VEX && (op == 0xc4 || op == 0xc5) && isVexOrEvex)
 			{
 				instruction->encoding = NMD_X86_ENCODING_VEX;
 
 				instruction->vex.vex[0] = op;
-				if (remainingSize < 4)
+				if (remainingSize < (size_t)(op == 0xc4 ? 3 : 2))
 					return false;
 
-				const uint8_t byte1 = *++b;
+				const uint8_t byte1 = instruction->vex.vex[1] = *++b;
 
-				instruction->vex.R = byte1 & 0b10000000;
+				instruction->vex.R = (byte1 & 0b10000000) == 0b10000000;
 				if (instruction->vex.vex[0] == 0xc4)
 				{
 					instruction->vex.X = (byte1 & 0b01000000) == 0b01000000;
 					instruction->vex.B = (byte1 & 0b00100000) == 0b00100000;
 					instruction->vex.m_mmmm = (uint8_t)(byte1 & 0b00011111);
 
-					const uint8_t byte2 = *++b;
+					const uint8_t byte2 = instruction->vex.vex[2] = *++b;
 					instruction->vex.W = (byte2 & 0b10000000) == 0b10000000;
 					instruction->vex.vvvv = (uint8_t)((byte2 & 0b01111000) >> 3);
 					instruction->vex.L = (byte2 & 0b00000100) == 0b00000100;
 					instruction->vex.pp = (uint8_t)(byte2 & 0b00000011);
-
-					instruction->opcode = *++b;
-					op = instruction->opcode;
-
-					if (op == 0x0c || op == 0x0d || op == 0x40 || op == 0x41 || op == 0x17 || op == 0x21 || op == 0x42)
-						instruction->immMask = NMD_X86_IMM8;
-
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
-					/* Check if the instruction is invalid. */
-					if (op == 0x0c && instruction->vex.m_mmmm != 3)
-						return false;
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
-
-
-#ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
-					/*if(op == 0x0c)
-						instruction->id = NMD_X86_INSTR
-						*/
-#endif /* NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID */
 				}
 				else /* 0xc5 */
 				{
-					instruction->vex.vvvv = (uint8_t)(byte1 & 0b01111000);
-					instruction->vex.L = byte1 & 0b00000100;
+					/* The two byte form implies the 0F map and inverted X and B bits of one. */
+					instruction->vex.X = instruction->vex.B = true;
+					instruction->vex.m_mmmm = 0b00001;
+					instruction->vex.vvvv = (uint8_t)((byte1 & 0b01111000) >> 3);
+					instruction->vex.L = (byte1 & 0b00000100) == 0b00000100;
 					instruction->vex.pp = (uint8_t)(byte1 & 0b00000011);
-
-					b++;
-					instruction->opcode = *b;
-					op = instruction->opcode;
 				}
 
-				if (!_nmd_decode_modrm(&b, instruction, remainingSize - (instruction->vex.vex[0] == 0xc4 ? 4 : 3)))
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK
+				/* Legacy and REX prefixes cannot precede VEX. */
+				if (flags & NMD_X86_DECODER_FLAGS_VALIDITY_CHECK && (instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_LOCK | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO) || instruction->hasRex))
+					return false;
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
+
+				if (mode == NMD_X86_MODE_64)
+					instruction->prefixes |= (uint16_t)((instruction->vex.R ? 0 : NMD_X86_PREFIXES_REX_R) | (instruction->vex.X ? 0 : NMD_X86_PREFIXES_REX_X) | (instruction->vex.B ? 0 : NMD_X86_PREFIXES_REX_B) | (instruction->vex.W ? NMD_X86_PREFIXES_REX_W : 0));
+
+				if (!_nmd_decode_vex_evex_opcode(&b, instruction, remainingSize - (op == 0xc4 ? 3 : 2), instruction->vex.m_mmmm, flags))
 					return false;
+
+				op = instruction->opcode;
 			}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_VEX */
 #if !(defined(NMD_ASSEMBLY_DISABLE_DECODER_EVEX) && defined(NMD_ASSEMBLY_DISABLE_DECODER_VEX))
@@ -5285,9 +8507,10 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 						if (modrm.fields.reg == 0b001 || modrm.fields.reg >= 0b110)
 							return false;
 					}
-					else if (op == 0x62)
+					else if (op == 0x62 || op == 0xc4 || op == 0xc5)
 					{
-						if (mode == NMD_X86_MODE_64)
+						/* 'bound', 'les' and 'lds' need a memory operand and are not available in 64-bit mode. */
+						if (mode == NMD_X86_MODE_64 || !instruction->hasModrm)
 							return false;
 					}
 					else if (op == 0x8d)
@@ -5295,11 +8518,6 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 						if (modrm.fields.mod == 0b11)
 							return false;
 					}
-					else if (op == 0xc4 || op == 0xc5)
-					{
-						if (mode == NMD_X86_MODE_64 && instruction->hasModrm && modrm.fields.mod != 0b11)
-							return false;
-					}
 					else if (op >= 0xd8 && op <= 0xdf)
 					{
 						switch (op)
@@ -5338,34 +8556,12 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 				}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_VALIDITY_CHECK */
 
-				/* Check for immediate */		
-				if (_nmd_findByte(_nmd_op1imm32, sizeof(_nmd_op1imm32), op) || (NMD_R(op) < 4 && (NMD_C(op) == 5 || NMD_C(op) == 0xD)) || (NMD_R(op) == 0xB && NMD_C(op) >= 8) || (op == 0xF7 && modrm.fields.reg == 0b000)) /* imm32,16 */
-				{
-					if (NMD_R(op) == 0xB && NMD_C(op) >= 8)
-						instruction->immMask = (uint8_t)(instruction->prefixes & NMD_X86_PREFIXES_REX_W ? NMD_X86_IMM64 : (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || (mode == NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? NMD_X86_IMM16 : NMD_X86_IMM32));
-					else
-					{
-						if (mode == NMD_X86_MODE_16 && instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || mode != NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE))
-							instruction->immMask = NMD_X86_IMM32;
-						else
-							instruction->immMask = NMD_X86_IMM16;
-					}
-				}
-				else if (NMD_R(op) == 7 || (NMD_R(op) == 0xE && NMD_C(op) < 8) || (NMD_R(op) == 0xB && NMD_C(op) < 8) || (NMD_R(op) < 4 && (NMD_C(op) == 4 || NMD_C(op) == 0xC)) || (op == 0xF6 && modrm.fields.reg <= 0b001) || _nmd_findByte(_nmd_op1imm8, sizeof(_nmd_op1imm8), op)) /* imm8 */
-					instruction->immMask = NMD_X86_IMM8;
-				else if (NMD_R(op) == 0xA && NMD_C(op) < 4)
-					instruction->immMask = (uint8_t)(mode == NMD_X86_MODE_64 ? (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE ? NMD_X86_IMM32 : NMD_X86_IMM64) : (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE ? NMD_X86_IMM16 : NMD_X86_IMM32));
-				else if (op == 0xEA || op == 0x9A) /* imm32,48 */
-				{
-					if (mode == NMD_X86_MODE_64)
-						return false;
-					instruction->immMask = (uint8_t)(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? NMD_X86_IMM32 : NMD_X86_IMM48);
-				}
-				else if (op == 0xC2 || op == 0xCA) /* imm16 */
-					instruction->immMask = NMD_X86_IMM16;
-				else if (op == 0xC8) /* imm16 + imm8 */
-					instruction->immMask = NMD_X86_IMM16 | NMD_X86_IMM8;
-							
+				/* Check for immediate. The immediate's size in bytes is also its mask(e.g. imm16 + imm8 = 3). */
+				const int immSize = _nmd_get_immediate_size(_nmd_op1Properties[op], op, modrm, mode, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE, instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE, instruction->prefixes & NMD_X86_PREFIXES_REX_W);
+				if (immSize < 0)
+					return false;
+				instruction->immMask = (uint8_t)immSize;
+
 
 #ifndef NMD_ASSEMBLY_DISABLE_DECODER_INSTRUCTION_ID
 				if (flags & NMD_X86_DECODER_FLAGS_INSTRUCTION_ID)
@@ -6123,8 +9319,11 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 	}
 
 	instruction->length = (uint8_t)((ptrdiff_t)(++b + (size_t)instruction->immMask) - (ptrdiff_t)(buffer));
-	for (i = 0; i < instruction->length; i++)
-		instruction->buffer[i] = ((const uint8_t*)(buffer))[i];
+	if (!lite)
+	{
+		for (i = 0; i < instruction->length; i++)
+			instruction->buffer[i] = ((const uint8_t*)(buffer))[i];
+	}
 
 	for (i = 0; i < (size_t)instruction->immMask; i++)
 		((uint8_t*)(&instruction->immediate))[i] = b[i];
@@ -6146,11 +9345,155 @@ bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instru
 	}
 #endif /* NMD_ASSEMBLY_DISABLE_DECODER_OPERANDS */
 
+	instruction->flow = _nmd_get_flow(instruction);
+	if (instruction->flow == NMD_X86_FLOW_JCC || instruction->flow == NMD_X86_FLOW_JMP_DIRECT || instruction->flow == NMD_X86_FLOW_CALL_DIRECT)
+	{
+		instruction->relativeTarget = (int32_t)_nmd_get_relative_target(instruction);
+		if (!lite && runtimeAddress != (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS)
+		{
+			/* The instruction pointer wraps around at the mode's width. */
+			instruction->target = runtimeAddress + (uint64_t)(int64_t)instruction->relativeTarget;
+			if (mode == NMD_X86_MODE_32)
+				instruction->target &= 0xFFFFFFFF;
+			else if (mode == NMD_X86_MODE_16)
+				instruction->target &= 0xFFFF;
+		}
+	}
+
+#ifndef NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS
+	if (flags & NMD_X86_DECODER_FLAGS_REGISTERS)
+		_nmd_decode_registers(instruction);
+#endif /* NMD_ASSEMBLY_DISABLE_DECODER_REGISTERS */
+
+	if (lite)
+	{
+		lite->id = instruction->id;
+		lite->prefixes = instruction->prefixes;
+		lite->length = instruction->length;
+		lite->opcode = instruction->opcode;
+		lite->opcodeMap = instruction->opcodeMap;
+		lite->flow = instruction->flow;
+		lite->encoding = instruction->encoding;
+		lite->numPrefixes = instruction->numPrefixes;
+		lite->modrm = instruction->modrm;
+		lite->reserved = 0;
+		lite->relativeTarget = instruction->relativeTarget;
+
+		return true;
+	}
+
 	instruction->valid = true;
 
 	return true;
 }
 
+/* Prepares 'instruction' and 'flags' for _nmd_decode_cleared_buffer() and decodes a single instruction. Only used by the decoders generated by NMD_X86_DEFINE_DECODER(). */
+static _NMD_FORCEINLINE bool _nmd_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress)
+{
+	_nmd_clear_instructions(instruction, 1);
+	instruction->mode = (uint8_t)mode;
+
+	return _nmd_decode_cleared_buffer(buffer, bufferSize, instruction, mode, _nmd_get_implied_decoder_flags(flags), runtimeAddress, 0);
+}
+
+/* The decoder for any 'mode' and 'flags'. nmd_x86_decode_buffer(), nmd_x86_decode_buffer_at() and nmd_x86_decode_buffer_batch() share this copy. */
+bool _nmd_decode_cleared_buffer_any(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress)
+{
+	return _nmd_decode_cleared_buffer(buffer, bufferSize, instruction, mode, flags, runtimeAddress, 0);
+}
+
+/*
+Decodes an instruction. Returns true if the instruction is valid, false otherwise.
+Parameters:
+ - buffer      [in]  A pointer to a buffer containing an encoded instruction.
+ - bufferSize  [in]  The size of the buffer in bytes.
+ - instruction [out] A pointer to a variable of type 'nmd_x86_instruction' that receives information about the instruction.
+ - mode        [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+*/
+bool nmd_x86_decode_buffer(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags)
+{
+	return nmd_x86_decode_buffer_at(buffer, bufferSize, instruction, mode, flags, (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS);
+}
+
+/*
+Decodes an instruction located at 'runtimeAddress' and fills 'target' with the absolute target of direct branches. Returns true if the instruction is valid, false otherwise.
+Parameters:
+ - buffer         [in]  A pointer to a buffer containing an encoded instruction.
+ - bufferSize     [in]  The size of the buffer in bytes.
+ - instruction    [out] A pointer to a variable of type 'nmd_x86_instruction' that receives information about the instruction.
+ - mode           [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags          [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+ - runtimeAddress [in]  The instruction's runtime address.
+*/
+bool nmd_x86_decode_buffer_at(const void* buffer, size_t bufferSize, nmd_x86_instruction* instruction, NMD_X86_MODE mode, uint32_t flags, uint64_t runtimeAddress)
+{
+	_nmd_clear_instructions(instruction, 1);
+	instruction->mode = (uint8_t)mode;
+
+	return _nmd_decode_cleared_buffer_any(buffer, bufferSize, instruction, mode, _nmd_get_implied_decoder_flags(flags), runtimeAddress);
+}
+
+/*
+Decodes consecutive instructions. Returns the number of instructions decoded. Decoding stops after 'maxCount' instructions, at the end of the buffer or at the first invalid instruction.
+Parameters:
+ - buffer         [in]      A pointer to a buffer containing one or more encoded instructions.
+ - bufferSize     [in]      The size of the buffer in bytes.
+ - runtimeAddress [in]      The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS', in which case 'target' is not filled.
+ - instructions   [out]     A pointer to an array of at least 'maxCount' elements of type 'nmd_x86_instruction' that receives the decoded instructions.
+ - maxCount       [in]      The maximum number of instructions to decode.
+ - mode           [in]      The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags          [in]      A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. If uncertain, use 'NMD_X86_DECODER_FLAGS_MINIMAL'.
+ - numBytes       [out/opt] A pointer to a variable that receives the number of bytes decoded, i.e. the offset where decoding stopped. This parameter may be zero.
+*/
+size_t nmd_x86_decode_buffer_batch(const void* buffer, size_t bufferSize, uint64_t runtimeAddress, nmd_x86_instruction* instructions, size_t maxCount, NMD_X86_MODE mode, uint32_t flags, size_t* numBytes)
+{
+	const uint8_t* b = (const uint8_t*)(buffer);
+	size_t offset = 0;
+	size_t count = 0;
+
+	/* Every instruction is at least one byte long, so no more than 'bufferSize' records are written. */
+	if (maxCount > bufferSize)
+		maxCount = bufferSize;
+
+	flags = _nmd_get_implied_decoder_flags(flags);
+
+	for (; count < maxCount && offset < bufferSize; count++)
+	{
+		/* Records are cleared one at a time, so a batch that stops early does not pay for clearing the ones it never reaches. */
+		_nmd_clear_instructions(instructions + count, 1);
+		instructions[count].mode = (uint8_t)mode;
+		if (!_nmd_decode_cleared_buffer_any(b + offset, bufferSize - offset, instructions + count, mode, flags, runtimeAddress == (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS ? runtimeAddress : runtimeAddress + offset))
+			break;
+
+		offset += instructions[count].length;
+	}
+
+	if (numBytes)
+		*numBytes = offset;
+
+	return count;
+}
+
+/*
+Decodes an instruction into a compact 16 byte record. Returns true if the instruction is valid, false otherwise.
+Parameters:
+ - buffer      [in]  A pointer to a buffer containing an encoded instruction.
+ - bufferSize  [in]  The size of the buffer in bytes.
+ - instruction [out] A pointer to a variable of type 'nmd_x86_instruction_lite' that receives information about the instruction.
+ - mode        [in]  The architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
+ - flags       [in]  A mask of 'NMD_X86_DECODER_FLAGS_XXX' that specifies which features the decoder is allowed to use. Only the validity check, instruction id, VEX, EVEX and 3DNow! features are used.
+*/
+bool nmd_x86_decode_buffer_lite(const void* buffer, size_t bufferSize, nmd_x86_instruction_lite* instruction, NMD_X86_MODE mode, uint32_t flags)
+{
+	/* The decoder's state. Masking 'flags' lets the compiler remove the code of every other feature from this copy of the decoder. */
+	nmd_x86_instruction state;
+	_nmd_clear_instructions(&state, 1);
+	state.mode = (uint8_t)mode;
+
+	return _nmd_decode_cleared_buffer(buffer, bufferSize, &state, mode, flags & (NMD_X86_DECODER_FLAGS_VALIDITY_CHECK | NMD_X86_DECODER_FLAGS_INSTRUCTION_ID | NMD_X86_DECODER_FLAGS_VEX | NMD_X86_DECODER_FLAGS_EVEX | NMD_X86_DECODER_FLAGS_3DNOW), (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS, instruction);
+}
+
 bool _nmd_ldisasm_parse_modrm(const uint8_t** b, bool addressPrefix, NMD_X86_MODE mode, nmd_x86_modrm* const pModrm, size_t remainingSize)
 {
 	if (remainingSize == 0)
@@ -6226,6 +9569,7 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 	bool repeatPrefix = false;
 	bool repeatNotZeroPrefix = false;
 	bool rexW = false;
+	bool rexPrefix = false;
 	bool lockPrefix = false;
 	uint16_t simdPrefix = NMD_X86_PREFIXES_NONE;
 	uint8_t op = 0;
@@ -6238,24 +9582,30 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 
 	/* Parse legacy prefixes & REX prefixes. */
 	size_t i = 0;
-	for (; i < NMD_X86_MAXIMUM_INSTRUCTION_LENGTH; i++, b++)
+	size_t numMaxBytes = NMD_X86_MAXIMUM_INSTRUCTION_LENGTH;
+#ifdef _NMD_SSE2
+	/* Find where the prefixes end up front so the loop below only visits prefix bytes. */
+	if (bufferSize >= 16)
 	{
-		switch (*b)
-		{
-		case 0xF0: lockPrefix = true; continue;
-		case 0xF2: repeatNotZeroPrefix = true, simdPrefix = NMD_X86_PREFIXES_REPEAT_NOT_ZERO; continue;
-		case 0xF3: repeatPrefix = true, simdPrefix = NMD_X86_PREFIXES_REPEAT; continue;
-		case 0x2E: continue;
-		case 0x36: continue;
-		case 0x3E: continue;
-		case 0x26: continue;
-		case 0x64: continue;
-		case 0x65: continue;
-		case 0x66: operandPrefix = true, simdPrefix = NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE; continue;
-		case 0x67: addressPrefix = true; continue;
-		default:
-			if (mode == NMD_X86_MODE_64 && NMD_R(*b) == 4) /* [40,4f[ */
-			{
+		const size_t numPrefixBytes = _nmd_sse2_count_prefixes(b, mode);
+		if (numPrefixBytes < numMaxBytes)
+			numMaxBytes = numPrefixBytes;
+	}
+#endif /* _NMD_SSE2 */
+	for (; i < numMaxBytes; i++, b++)
+	{
+		switch (_NMD_GET_PREFIX_CLASS(_nmd_op1Properties[*b]))
+		{
+		case _NMD_PREFIX_SEGMENT: continue;
+		case _NMD_PREFIX_OPERAND_SIZE: operandPrefix = true, simdPrefix = NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE; continue;
+		case _NMD_PREFIX_ADDRESS_SIZE: addressPrefix = true; continue;
+		case _NMD_PREFIX_LOCK: lockPrefix = true; continue;
+		case _NMD_PREFIX_REPEAT_NOT_ZERO: repeatNotZeroPrefix = true, simdPrefix = NMD_X86_PREFIXES_REPEAT_NOT_ZERO; continue;
+		case _NMD_PREFIX_REPEAT: repeatPrefix = true, simdPrefix = NMD_X86_PREFIXES_REPEAT; continue;
+		case _NMD_PREFIX_REX:
+			if (mode == NMD_X86_MODE_64) /* [40,4f[ */
+			{
+				rexPrefix = true;
 				if(NMD_C(*b) & 0b1000)
 					rexW = true;
 				continue;
@@ -6411,7 +9761,7 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 			/* Check for ModR/M, SIB and displacement. */
 			if (op >= 0x20 && op <= 0x23 && remainingSize == 2)
 				hasModrm = true, modrm.modrm = *++b;
-			else if (op < 4 || (NMD_R(op) != 3 && NMD_R(op) > 0 && NMD_R(op) < 7) || (op >= 0xD0 && op != 0xFF) || (NMD_R(op) == 7 && NMD_C(op) != 7) || NMD_R(op) == 9 || NMD_R(op) == 0xB || (NMD_R(op) == 0xC && NMD_C(op) < 8) || (NMD_R(op) == 0xA && (op % 8) >= 3) || op == 0x0ff || op == 0x00 || op == 0x0d)
+			else if (_nmd_op2Properties[op] & _NMD_PROPERTY_MODRM)
 			{
 				if (!_nmd_ldisasm_parse_modrm(&b, addressPrefix, mode, &modrm, remainingSize - 2))
 					return 0;
@@ -6420,7 +9770,7 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 
 #ifndef NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK
 			/* Check if the instruction is invalid. */
-			if (_nmd_findByte(_nmd_invalid2op, sizeof(_nmd_invalid2op), op))
+			if (_nmd_op2Properties[op] & _NMD_PROPERTY_INVALID)
 				return 0;
 			else if (op == 0xc7)
 			{
@@ -6550,10 +9900,8 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 			}
 #endif /* NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK */
 
-			if (NMD_R(op) == 8) /* imm32 */
-				offset += (operandPrefix ? 2 : 4);
-			else if ((NMD_R(op) == 7 && NMD_C(op) < 4) || op == 0xA4 || op == 0xC2 || (op > 0xC3 && op <= 0xC6) || op == 0xBA || op == 0xAC) /* imm8 */
-				offset++;
+			if (_NMD_GET_IMM_CLASS(_nmd_op2Properties[op]))
+				offset += (size_t)_nmd_get_immediate_size(_nmd_op2Properties[op], op, modrm, mode, operandPrefix, addressPrefix, rexW);
 			else if (op == 0x78 && (repeatNotZeroPrefix || operandPrefix)) /* imm8 + imm8 = "imm16" */
 				offset += 2;
 		}
@@ -6563,8 +9911,11 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 		op = *b;
 		opcodeSize = 1;
 
+		/* C4h, C5h and 62h start a VEX or EVEX prefix in 64-bit mode. In the other modes they do only if the next byte's mod field is 11b, which 'les', 'lds' and 'bound' cannot encode. */
+		const bool isVexOrEvex = (op == 0xc4 || op == 0xc5 || op == 0x62) && remainingSize > 1 && (mode == NMD_X86_MODE_64 || b[1] >= 0xc0);
+
 		/* Check for ModR/M, SIB and displacement. */
-		if (NMD_R(op) == 8 || _nmd_findByte(_nmd_op1modrm, sizeof(_nmd_op1modrm), op) || (NMD_R(op) < 4 && (NMD_C(op) < 4 || (NMD_C(op) >= 8 && NMD_C(op) < 0xC))) || (NMD_R(op) == 0xD && NMD_C(op) >= 8) || ((op == 0xc4 || op == 0xc5) && remainingSize > 1 && ((nmd_x86_modrm*)(b + 1))->fields.mod != 0b11))
+		if (_nmd_op1Properties[op] & _NMD_PROPERTY_MODRM || (remainingSize > 1 && !isVexOrEvex && (op == 0xc4 || op == 0xc5 || op == 0x62)))
 		{
 			if (!_nmd_ldisasm_parse_modrm(&b, addressPrefix, mode, &modrm, remainingSize - 1))
 				return 0;
@@ -6602,9 +9953,10 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 			if (modrm.fields.reg == 0b001 || modrm.fields.reg >= 0b110)
 				return 0;
 		}
-		else if (op == 0x62)
+		else if (op == 0x62 || op == 0xc4 || op == 0xc5)
 		{
-			if (mode == NMD_X86_MODE_64)
+			/* 'bound', 'les' and 'lds' need a memory operand and are not available in 64-bit mode. */
+			if (!isVexOrEvex && (mode == NMD_X86_MODE_64 || !hasModrm))
 				return 0;
 		}
 		else if (op == 0x8d)
@@ -6612,11 +9964,6 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 			if (modrm.fields.mod == 0b11)
 				return 0;
 		}
-		else if (op == 0xc4 || op == 0xc5)
-		{
-			if (mode == NMD_X86_MODE_64 && hasModrm && modrm.fields.mod != 0b11)
-				return 0;
-		}
 		else if (op >= 0xd8 && op <= 0xdf)
 		{
 			switch (op)
@@ -6654,63 +10001,69 @@ size_t nmd_x86_ldisasm(const void* buffer, size_t bufferSize, NMD_X86_MODE mode)
 		}
 #endif /* NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK */
 
-#ifndef NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX
-		/* Check if instruction is VEX. */
-		if ((op == 0xc4 || op == 0xc5) && !hasModrm)
+#if !defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_EVEX)
+		/* Check if instruction is VEX or EVEX. */
+#if defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX)
+		if (isVexOrEvex && op == 0x62)
+#elif defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_EVEX)
+		if (isVexOrEvex && op != 0x62)
+#else
+		if (isVexOrEvex)
+#endif
 		{
-			const uint8_t byte0 = op;
-			if (remainingSize < 4)
+			/* The prefix is four(62h), three(C4h) or two(C5h) bytes long. C5h implies the 0F opcode map. */
+			const uint8_t encoding = (uint8_t)(op == 0x62 ? NMD_X86_ENCODING_EVEX : NMD_X86_ENCODING_VEX);
+			const size_t prefixSize = op == 0x62 ? 4 : (op == 0xc4 ? 3 : 2);
+			if (remainingSize < prefixSize + 1)
 				return 0;
 
-			if (byte0 == 0xc4)
-			{
-				b += 3;
-				op = *b;
+			const uint8_t* const prefix = b;
+			const uint8_t map = (uint8_t)(op == 0xc5 ? 1 : b[1] & (op == 0x62 ? 0b00000111 : 0b00011111));
 
-				if (op == 0x0c || op == 0x0d || op == 0x40 || op == 0x41 || op == 0x17 || op == 0x21 || op == 0x42)
-					offset++;
-			}
-			else /* 0xc5 */
+#ifndef NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK
+			/* Legacy and REX prefixes cannot precede VEX or EVEX. Bit 3 of EVEX's P0 must be zero and bit 2 of P1 must be one. */
+			if (operandPrefix || repeatPrefix || repeatNotZeroPrefix || lockPrefix || rexPrefix || (op == 0x62 && (b[1] & 0b00001000 || !(b[2] & 0b00000100))))
+				return 0;
+#endif /* NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK */
+
+			/* Only the 0F, 0F38 and 0F3A maps are defined. */
+			if (map < 1 || map > 3)
+				return 0;
+			const uint8_t opcodeMap = (uint8_t)(NMD_X86_OPCODE_MAP_0F + (map - 1));
+
+			b += prefixSize;
+			op = *b;
+
+			/* Every instruction has a Mod/RM byte except 'vzeroupper' and 'vzeroall'. */
+			if (!(encoding == NMD_X86_ENCODING_VEX && opcodeMap == NMD_X86_OPCODE_MAP_0F && op == 0x77))
 			{
-				b += 2;
-				op = *b;
+				if (!_nmd_ldisasm_parse_modrm(&b, addressPrefix, mode, &modrm, remainingSize - prefixSize - 1))
+					return 0;
+				hasModrm = true;
 			}
 
-			if (!_nmd_ldisasm_parse_modrm(&b, addressPrefix, mode, &modrm, remainingSize - (byte0 == 0xc4 ? 4 : 3)))
-				return false;
-			hasModrm = true;
+#ifndef NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK
+			const _nmd_avx_entry* const entry = _nmd_find_avx_entry(prefix, op, modrm, mode);
+			if (!entry || !_nmd_is_avx_instruction_valid(entry, prefix, modrm, mode))
+				return 0;
+
+			/* EVEX's L'L = 11b is reserved unless it encodes a rounding mode. */
+			if (encoding == NMD_X86_ENCODING_EVEX && (prefix[3] & 0b01100000) == 0b01100000 && !(prefix[3] & 0b00010000 && modrm.fields.mod == 0b11))
+				return 0;
+#endif /* NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VALIDITY_CHECK */
+
+			if (_nmd_vex_has_imm8(opcodeMap, op))
+				offset++;
 		}
 		else
-#endif /* NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX */
+#endif /* !defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_LENGTH_DISASSEMBLER_EVEX) */
 
 		{
 			/* Check for immediate */
-			if (_nmd_findByte(_nmd_op1imm32, sizeof(_nmd_op1imm32), op) || (NMD_R(op) < 4 && (NMD_C(op) == 5 || NMD_C(op) == 0xD)) || (NMD_R(op) == 0xB && NMD_C(op) >= 8) || (op == 0xF7 && modrm.fields.reg == 0b000)) /* imm32,16 */
-			{
-				if (NMD_R(op) == 0xB && NMD_C(op) >= 8)
-					offset += rexW ? 8 : (operandPrefix || (mode == NMD_X86_MODE_16 && !operandPrefix) ? 2 : 4);
-				else
-				{
-					if ((mode == NMD_X86_MODE_16 && operandPrefix) || (mode != NMD_X86_MODE_16 && !operandPrefix))
-						offset += NMD_X86_IMM32;
-					else
-						offset += NMD_X86_IMM16;
-				}
-			}
-			else if (NMD_R(op) == 7 || (NMD_R(op) == 0xE && NMD_C(op) < 8) || (NMD_R(op) == 0xB && NMD_C(op) < 8) || (NMD_R(op) < 4 && (NMD_C(op) == 4 || NMD_C(op) == 0xC)) || (op == 0xF6 && modrm.fields.reg <= 0b001) || _nmd_findByte(_nmd_op1imm8, sizeof(_nmd_op1imm8), op)) /* imm8 */
-				offset++;
-			else if (NMD_R(op) == 0xA && NMD_C(op) < 4)
-				offset += (mode == NMD_X86_MODE_64) ? (addressPrefix ? 4 : 8) : (addressPrefix ? 2 : 4);
-			else if (op == 0xEA || op == 0x9A) /* imm32,48 */
-			{
-				if (mode == NMD_X86_MODE_64)
-					return 0;
-				offset += (operandPrefix ? 4 : 6);
-			}
-			else if (op == 0xC2 || op == 0xCA) /* imm16 */
-				offset += 2;
-			else if (op == 0xC8) /* imm16 + imm8 */
-				offset += 3;
+			const int immSize = _nmd_get_immediate_size(_nmd_op1Properties[op], op, modrm, mode, operandPrefix, addressPrefix, rexW);
+			if (immSize < 0)
+				return 0;
+			offset += (size_t)immSize;
 		}
 	}
 
@@ -6731,6 +10084,14 @@ typedef struct
 	const nmd_x86_instruction* instruction;
 	uint64_t runtimeAddress;
 	uint32_t formatFlags;
+	const char* bufferStart;
+	uint8_t* numberStarts; /* A bitmap of the offsets from 'bufferStart' where numbers begin, or zero. */
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+	/* AT&T syntax lists the operands in reverse order, so the place where each one begins is kept. */
+	char* operands; /* The first operand, or zero if the instruction has none. */
+	char* separators[_NMD_MAX_OPERAND_SEPARATORS]; /* The commas between the operands. */
+	size_t numSeparators;
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
 } _nmd_string_info;
 
 void _nmd_append_string(_nmd_string_info* const si, const char* source)
@@ -6739,19 +10100,120 @@ void _nmd_append_string(_nmd_string_info* const si, const char* source)
 		*si->buffer++ = *source++;
 }
 
+/* Marks the beginning of an operand. Only the first call of an instruction has an effect. */
+void _nmd_begin_operand(_nmd_string_info* const si)
+{
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+	if (!si->operands)
+		si->operands = si->buffer;
+#else
+	(void)si;
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+}
+
+/* Appends the comma between two operands. */
+void _nmd_append_separator(_nmd_string_info* const si)
+{
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+	if (si->numSeparators < _NMD_MAX_OPERAND_SEPARATORS)
+		si->separators[si->numSeparators++] = si->buffer;
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+	*si->buffer++ = ',';
+}
+
+/* Appends a register, which has the '%' prefix in AT&T syntax. */
+void _nmd_append_register(_nmd_string_info* const si, const char* name)
+{
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
+		*si->buffer++ = '%';
+	_nmd_append_string(si, name);
+}
+
+/* Appends the x87 register 'st(index)'. */
+void _nmd_append_st(_nmd_string_info* const si, size_t index)
+{
+	_nmd_append_register(si, "st(");
+	*si->buffer++ = (char)('0' + index);
+	*si->buffer++ = ')';
+}
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+/* Declared here rather than through <intrin.h>, which would be a dependency. */
+unsigned char _BitScanReverse64(unsigned long* index, unsigned __int64 mask);
+#pragma intrinsic(_BitScanReverse64)
+#endif
+
+/* Returns the number of significant bits in 'n', zero if 'n' is zero. */
+size_t _nmd_get_bit_length(uint64_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return n ? 64 - (size_t)__builtin_clzll(n) : 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	return _BitScanReverse64(&index, n) ? (size_t)index + 1 : 0;
+#else
+	size_t length = 0;
+	if (n >> 32) n >>= 32, length += 32;
+	if (n >> 16) n >>= 16, length += 16;
+	if (n >> 8) n >>= 8, length += 8;
+	if (n >> 4) n >>= 4, length += 4;
+	if (n >> 2) n >>= 2, length += 2;
+	if (n >> 1) n >>= 1, length += 1;
+	return length + (size_t)n;
+#endif
+}
+
+/* Returns 'n' / 100 using multiplications by the reciprocal. Values that fit in 32 bits take a single multiplication. */
+uint64_t _nmd_divide_by_100(uint64_t n)
+{
+	if (n <= 0xffffffff)
+		return (n * 0x51eb851f) >> 37; /* 0x51eb851f = ceil(2^37 / 100) */
+
+	/* The high 64 bits of (n / 4) * 0x28f5c28f5c28f5c3 = ceil(2^66 / 100) computed from 32-bit halves, then divided by 4. */
+	const uint64_t a = n >> 2;
+	const uint64_t aLow = a & 0xffffffff, aHigh = a >> 32;
+	const uint64_t bLow = 0x5c28f5c3, bHigh = 0x28f5c28f;
+	const uint64_t low = aLow * bLow;
+	const uint64_t middle1 = aHigh * bLow + (low >> 32);
+	const uint64_t middle2 = aLow * bHigh + (middle1 & 0xffffffff);
+	return (aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32)) >> 2;
+}
+
+const uint64_t _nmd_powersOf10[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL };
+
+/* "00" to "99", used to emit two decimal digits at a time. */
+const char _nmd_decimalPairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/* Returns the number of digits needed to represent 'n'. No division is performed. */
 size_t _nmd_get_num_digits(uint64_t n, bool hex)
 {
-	size_t numDigits = 0;
-	while ((n /= (hex ? 16 : 10)) > 0)
-		numDigits++;
+	const size_t bitLength = _nmd_get_bit_length(n);
 
-	return numDigits;
+	if (hex)
+		return bitLength ? (bitLength + 3) / 4 : 1;
+
+	if (n < 10)
+		return 1;
+
+	/* floor(bitLength * log10(2)) is either the number of digits or one less. 1233/4096 ~= log10(2) */
+	const size_t t = (bitLength * 1233) >> 12;
+	return t + (n >= _nmd_powersOf10[t]);
 }
 
 void _nmd_append_number(_nmd_string_info* const si, uint64_t n)
 {
-	size_t numDigits = _nmd_get_num_digits(n, si->formatFlags & NMD_X86_FORMAT_FLAGS_HEX);
-	size_t bufferOffset = numDigits + 1;
+	if (si->numberStarts)
+	{
+		const size_t offset = (size_t)(si->buffer - si->bufferStart);
+		if (offset < NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH)
+			si->numberStarts[offset / 8] |= (uint8_t)(1 << (offset % 8));
+	}
 
 	if (si->formatFlags & NMD_X86_FORMAT_FLAGS_HEX)
 	{
@@ -6759,23 +10221,43 @@ void _nmd_append_number(_nmd_string_info* const si, uint64_t n)
 		if (si->formatFlags & NMD_X86_FORMAT_FLAGS_0X_PREFIX && condition)
 			*si->buffer++ = '0', *si->buffer++ = 'x';
 
-		const uint8_t baseChar = (uint8_t)(si->formatFlags & NMD_X86_FORMAT_FLAGS_HEX_LOWERCASE ? 0x57 : 0x37);
+		/* Digits are written backwards from the end, one nibble at a time */
+		const char* const digits = si->formatFlags & NMD_X86_FORMAT_FLAGS_HEX_LOWERCASE ? "0123456789abcdef" : "0123456789ABCDEF";
+		char* const end = si->buffer + _nmd_get_num_digits(n, true);
+		char* p = end;
 		do {
-			size_t num = n % 16;
-			*(si->buffer + numDigits--) = (char)((num > 9 ? baseChar : '0') + num);
-		} while ((n /= 16) > 0);
+			*--p = digits[n & 0xf];
+			n >>= 4;
+		} while (p > si->buffer);
+		si->buffer = end;
 
 		if (si->formatFlags & NMD_X86_FORMAT_FLAGS_H_SUFFIX && condition)
-			*(si->buffer + bufferOffset++) = 'h';
+			*si->buffer++ = 'h';
 	}
 	else
 	{
-		do {
-			*(si->buffer + numDigits--) = (char)('0' + n % 10);
-		} while ((n /= 10) > 0);
-	}
+		/* Digits are written backwards from the end, two at a time */
+		char* const end = si->buffer + _nmd_get_num_digits(n, false);
+		char* p = end;
+		while (n >= 100)
+		{
+			const uint64_t q = _nmd_divide_by_100(n);
+			const size_t i = (size_t)(n - q * 100) * 2;
+			n = q;
+			*--p = _nmd_decimalPairs[i + 1];
+			*--p = _nmd_decimalPairs[i];
+		}
+
+		if (n >= 10)
+		{
+			*--p = _nmd_decimalPairs[n * 2 + 1];
+			*--p = _nmd_decimalPairs[n * 2];
+		}
+		else
+			*--p = (char)('0' + n);
 
-	si->buffer += bufferOffset;
+		si->buffer = end;
+	}
 }
 
 void _nmd_append_signed_number(_nmd_string_info* const si, int64_t n, bool showPositiveSign)
@@ -6794,9 +10276,26 @@ void _nmd_append_signed_number(_nmd_string_info* const si, int64_t n, bool showP
 	}
 }
 
+/* Appends an immediate operand, which has the '$' prefix in AT&T syntax. */
+void _nmd_append_immediate(_nmd_string_info* const si, uint64_t n)
+{
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
+		*si->buffer++ = '$';
+	_nmd_append_number(si, n);
+}
+
+void _nmd_append_signed_immediate(_nmd_string_info* const si, int64_t n)
+{
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
+		*si->buffer++ = '$';
+	_nmd_append_signed_number(si, n, false);
+}
+
 void _nmd_append_signed_number_memory_view(_nmd_string_info* const si)
 {
-	_nmd_append_number(si, (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 0xFF00 : (si->instruction->mode == NMD_X86_MODE_64 ? 0xFFFFFFFFFFFFFF00 : 0xFFFFFF00)) | si->instruction->immediate);
+	_nmd_append_immediate(si, (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 0xFF00 : (si->instruction->mode == NMD_X86_MODE_64 ? 0xFFFFFFFFFFFFFF00 : 0xFFFFFF00)) | si->instruction->immediate);
 	if (si->formatFlags & NMD_X86_FORMAT_FLAGS_SIGNED_NUMBER_HINT_HEX)
 	{
 		*si->buffer++ = '(';
@@ -6816,9 +10315,12 @@ void _nmd_append_signed_number_memory_view(_nmd_string_info* const si)
 
 void _nmd_append_relative_address8(_nmd_string_info* const si)
 {
+	_nmd_begin_operand(si);
 	if (si->runtimeAddress == (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS)
 	{
-		/* *si->buffer++ = '$'; */
+		/* AT&T syntax writes targets relative to the location counter('.'). */
+		if (_NMD_IS_ATT_SYNTAX(si))
+			*si->buffer++ = '.';
 		_nmd_append_signed_number(si, (int64_t)((int8_t)(si->instruction->immediate) + (int8_t)(si->instruction->length)), true);
 	}
 	else
@@ -6836,9 +10338,12 @@ void _nmd_append_relative_address8(_nmd_string_info* const si)
 
 void _nmd_append_relative_address16_32(_nmd_string_info* const si)
 {
+	_nmd_begin_operand(si);
 	if (si->runtimeAddress == (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS)
 	{
-		/* *si->buffer++ = '$'; */
+		/* AT&T syntax writes targets relative to the location counter('.'). */
+		if (_NMD_IS_ATT_SYNTAX(si))
+			*si->buffer++ = '.';
 		_nmd_append_signed_number(si, (int64_t)((int32_t)(si->instruction->immediate) + (int32_t)(si->instruction->length)), true);
 	}
 	else
@@ -6848,10 +10353,29 @@ void _nmd_append_relative_address16_32(_nmd_string_info* const si)
 		));
 }
 
+/*
+Appends the ptr16:16 or ptr16:32 operand of a far call or jump as 'selector:offset', or '$selector,$offset' in AT&T syntax.
+The selector follows the offset, whose size is the operand size.
+*/
+void _nmd_append_far_pointer(_nmd_string_info* const si)
+{
+	const bool operandSize16 = (si->instruction->mode == NMD_X86_MODE_16) != ((si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) != 0);
+
+	_nmd_append_immediate(si, (uint64_t)(uint16_t)(si->instruction->immediate >> (operandSize16 ? 16 : 32)));
+	if (_NMD_IS_ATT_SYNTAX(si))
+		*si->buffer++ = ',', *si->buffer++ = '$';
+	else
+		*si->buffer++ = ':';
+	_nmd_append_number(si, operandSize16 ? (uint64_t)(uint16_t)si->instruction->immediate : (uint64_t)(uint32_t)si->instruction->immediate);
+}
+
 void _nmd_append_modrm_memory_prefix(_nmd_string_info* const si, const char* addrSpecifierReg)
 {
+	_nmd_begin_operand(si);
+
 #ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_POINTER_SIZE
-	if (si->formatFlags & NMD_X86_FORMAT_FLAGS_POINTER_SIZE)
+	/* AT&T syntax tells the size by the mnemonic's suffix instead. */
+	if (si->formatFlags & NMD_X86_FORMAT_FLAGS_POINTER_SIZE && !_NMD_IS_ATT_SYNTAX(si))
 	{
 		_nmd_append_string(si, addrSpecifierReg);
 		_nmd_append_string(si, " ptr ");
@@ -6864,114 +10388,198 @@ void _nmd_append_modrm_memory_prefix(_nmd_string_info* const si, const char* add
 		if (si->instruction->segmentOverride)
 			i = _nmd_get_bit_index(si->instruction->segmentOverride);
 
-		_nmd_append_string(si, si->instruction->segmentOverride ? _nmd_segmentReg[i] : (!(si->instruction->prefixes & NMD_X86_PREFIXES_REX_B) && (si->instruction->modrm.fields.rm == 0b100 || si->instruction->modrm.fields.rm == 0b101) ? "ss" : "ds"));
+		_nmd_append_register(si, si->instruction->segmentOverride ? _nmd_segmentReg[i] : (!(si->instruction->prefixes & NMD_X86_PREFIXES_REX_B) && (si->instruction->modrm.fields.rm == 0b100 || si->instruction->modrm.fields.rm == 0b101) ? "ss" : "ds"));
 		*si->buffer++ = ':';
 	}
 }
 
-void _nmd_append_modrm16_upper(_nmd_string_info* const si)
+/* Appends the memory operand of 'mov' with a direct offset(a0-a3), which is '[offset]', or just 'offset' in AT&T syntax. */
+void _nmd_append_moffs(_nmd_string_info* const si, const char* addrSpecifierReg)
 {
-	*si->buffer++ = '[';
-
-	if (!(si->instruction->modrm.fields.mod == 0b00 && si->instruction->modrm.fields.rm == 0b110))
+	_nmd_append_modrm_memory_prefix(si, addrSpecifierReg);
+	const uint64_t offset = (si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE || si->instruction->mode == NMD_X86_MODE_16 ? 0xFFFF : 0xFFFFFFFFFFFFFFFF) & si->instruction->immediate;
+	if (_NMD_IS_ATT_SYNTAX(si))
+		_nmd_append_number(si, offset);
+	else
 	{
-		const char* addresses[] = { "bx+si", "bx+di", "bp+si", "bp+di", "si", "di", "bp", "bx" };
-		_nmd_append_string(si, addresses[si->instruction->modrm.fields.rm]);
+		*si->buffer++ = '[';
+		_nmd_append_number(si, offset);
+		*si->buffer++ = ']';
 	}
+}
 
-	if (si->instruction->dispMask != NMD_X86_DISP_NONE && (si->instruction->displacement != 0 || *(si->buffer - 1) == '['))
+/* Appends a memory operand that uses 16-bit addressing as '[base+index+displacement]', or 'displacement(base,index)' in AT&T syntax. */
+void _nmd_append_modrm16_upper(_nmd_string_info* const si)
+{
+	const bool hasRegisters = !(si->instruction->modrm.fields.mod == 0b00 && si->instruction->modrm.fields.rm == 0b110);
+	const bool hasDisplacement = si->instruction->dispMask != NMD_X86_DISP_NONE && (si->instruction->displacement != 0 || !hasRegisters);
+	const bool isNegative = hasRegisters && hasDisplacement && si->instruction->displacement & ((uint32_t)1 << (si->instruction->dispMask * 8 - 1));
+	const uint64_t displacement = isNegative ? (uint64_t)(~si->instruction->displacement & (uint16_t)(si->instruction->dispMask == 2 ? 0xFFFF : 0xFF)) + 1 : si->instruction->displacement;
+
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
 	{
-		if (si->instruction->modrm.fields.mod == 0b00 && si->instruction->modrm.fields.rm == 0b110)
-			_nmd_append_number(si, si->instruction->displacement);
-		else
+		if (hasDisplacement)
 		{
-			const bool isNegative = si->instruction->displacement & (1 << (si->instruction->dispMask * 8 - 1));
-			if (*(si->buffer - 1) != '[')
-				*si->buffer++ = isNegative ? '-' : '+';
-
 			if (isNegative)
+				*si->buffer++ = '-';
+			_nmd_append_number(si, displacement);
+		}
+
+		if (hasRegisters)
+		{
+			const char* const bases[] = { "bx", "bx", "bp", "bp", "si", "di", "bp", "bx" };
+			*si->buffer++ = '(';
+			_nmd_append_register(si, bases[si->instruction->modrm.fields.rm]);
+			if (si->instruction->modrm.fields.rm < 0b100)
 			{
-				const uint16_t mask = (uint16_t)(si->instruction->dispMask == 2 ? 0xFFFF : 0xFF);
-				_nmd_append_number(si, (uint64_t)(~si->instruction->displacement & mask) + 1);
+				*si->buffer++ = ',';
+				_nmd_append_register(si, si->instruction->modrm.fields.rm % 2 ? "di" : "si");
 			}
-			else
-				_nmd_append_number(si, si->instruction->displacement);
+			*si->buffer++ = ')';
 		}
+		return;
+	}
+
+	*si->buffer++ = '[';
+
+	if (hasRegisters)
+	{
+		const char* addresses[] = { "bx+si", "bx+di", "bp+si", "bp+di", "si", "di", "bp", "bx" };
+		_nmd_append_string(si, addresses[si->instruction->modrm.fields.rm]);
+	}
+
+	if (hasDisplacement)
+	{
+		if (hasRegisters)
+			*si->buffer++ = isNegative ? '-' : '+';
+		_nmd_append_number(si, displacement);
 	}
 
 	*si->buffer++ = ']';
 }
 
+/* Appends a memory operand that uses 32 or 64-bit addressing as '[base+index*scale+displacement]', or 'displacement(base,index,scale)' in AT&T syntax. */
 void _nmd_append_modrm32_upper(_nmd_string_info* const si)
 {
-	*si->buffer++ = '[';
+	const nmd_x86_instruction* const instruction = si->instruction;
+	const bool is64 = instruction->mode == NMD_X86_MODE_64 && !(instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE);
+	const char* base = 0;
+	const char* index = 0;
+	const char* rip = 0;
 
-	if (si->instruction->hasSIB)
+	if (instruction->hasSIB)
 	{
-		if (si->instruction->sib.fields.base == 0b101)
+		if (instruction->sib.fields.base == 0b101)
 		{
-			if (si->instruction->modrm.fields.mod != 0b00)
-				_nmd_append_string(si, si->instruction->mode == NMD_X86_MODE_64 && !(si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE) ? (si->instruction->prefixes & NMD_X86_PREFIXES_REX_B ? "r13" : "rbp") : "ebp");
+			if (instruction->modrm.fields.mod != 0b00)
+				base = is64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? "r13" : "rbp") : "ebp";
 		}
 		else
-			_nmd_append_string(si, (si->instruction->mode == NMD_X86_MODE_64 && !(si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE) ? (si->instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[si->instruction->sib.fields.base]);
-
-		if (si->instruction->sib.fields.index != 0b100)
-		{
-			if (!(si->instruction->sib.fields.base == 0b101 && si->instruction->modrm.fields.mod == 0b00))
-				*si->buffer++ = '+';
-			_nmd_append_string(si, (si->instruction->mode == NMD_X86_MODE_64 && !(si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE) ? (si->instruction->prefixes & NMD_X86_PREFIXES_REX_X ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[si->instruction->sib.fields.index]);
-			if (!(si->instruction->sib.fields.scale == 0b00 && !(si->formatFlags & NMD_X86_FORMAT_FLAGS_SCALE_ONE)))
-				*si->buffer++ = '*', *si->buffer++ = (char)('0' + (1 << si->instruction->sib.fields.scale));
-		}
+			base = (is64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[instruction->sib.fields.base];
 
-		if (si->instruction->prefixes & NMD_X86_PREFIXES_REX_X && si->instruction->sib.fields.index == 0b100)
-		{
-			if (*(si->buffer - 1) != '[')
-				*si->buffer++ = '+';
-			_nmd_append_string(si, "r12");
-			if (!(si->instruction->sib.fields.scale == 0b00 && !(si->formatFlags & NMD_X86_FORMAT_FLAGS_SCALE_ONE)))
-				*si->buffer++ = '*', *si->buffer++ = (char)('0' + (1 << si->instruction->sib.fields.scale));
-		}
+		if (instruction->sib.fields.index != 0b100)
+			index = (is64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_X ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[instruction->sib.fields.index];
+		else if (instruction->prefixes & NMD_X86_PREFIXES_REX_X)
+			index = "r12";
 	}
-	else if (!(si->instruction->modrm.fields.mod == 0b00 && si->instruction->modrm.fields.rm == 0b101))
+	else if (!(instruction->modrm.fields.mod == 0b00 && instruction->modrm.fields.rm == 0b101))
 	{
-		if ((si->instruction->prefixes & (NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE | NMD_X86_PREFIXES_REX_B)) == (NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE | NMD_X86_PREFIXES_REX_B) && si->instruction->mode == NMD_X86_MODE_64)
-			_nmd_append_string(si, _nmd_regrx[si->instruction->modrm.fields.rm]), *si->buffer++ = 'd';
+		if ((instruction->prefixes & (NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE | NMD_X86_PREFIXES_REX_B)) == (NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE | NMD_X86_PREFIXES_REX_B) && instruction->mode == NMD_X86_MODE_64)
+			base = _nmd_regrxd[instruction->modrm.fields.rm];
 		else
-			_nmd_append_string(si, (si->instruction->mode == NMD_X86_MODE_64 && !(si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE) ? (si->instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[si->instruction->modrm.fields.rm]);
+			base = (is64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[instruction->modrm.fields.rm];
 	}
 
-	/* Handle displacement. */
-	if (si->instruction->dispMask != NMD_X86_DISP_NONE && (si->instruction->displacement != 0 || *(si->buffer - 1) == '['))
+	/* The displacement is either an absolute address or added to the registers. */
+	const bool hasDisplacement = instruction->dispMask != NMD_X86_DISP_NONE && (instruction->displacement != 0 || (!base && !index));
+	bool isAbsolute = false, isNegative = false;
+	uint64_t displacement = 0;
+	if (hasDisplacement)
 	{
 		/* Relative address. */
-		if (si->instruction->modrm.fields.rm == 0b101 && si->instruction->mode == NMD_X86_MODE_64 && si->instruction->modrm.fields.mod == 0b00 && si->runtimeAddress != NMD_X86_INVALID_RUNTIME_ADDRESS)
+		if (instruction->modrm.fields.rm == 0b101 && instruction->mode == NMD_X86_MODE_64 && instruction->modrm.fields.mod == 0b00 && si->runtimeAddress != (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS)
 		{
-			if (si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE)
-				_nmd_append_number(si, (uint32_t)((int32_t)(si->runtimeAddress + si->instruction->length) + (int32_t)si->instruction->displacement));
+			isAbsolute = true;
+			if (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE)
+				displacement = (uint32_t)((int32_t)(si->runtimeAddress + instruction->length) + (int32_t)instruction->displacement);
 			else
-				_nmd_append_number(si, (uint64_t)((int64_t)(si->runtimeAddress + si->instruction->length) + (int64_t)((int32_t)si->instruction->displacement)));
+				displacement = (uint64_t)((int64_t)(si->runtimeAddress + instruction->length) + (int64_t)((int32_t)instruction->displacement));
+		}
+		else if (instruction->modrm.fields.mod == 0b00 && ((instruction->sib.fields.base == 0b101 && instruction->sib.fields.index == 0b100) || instruction->modrm.fields.rm == 0b101) && !base && !index)
+		{
+			isAbsolute = true;
+			displacement = instruction->mode == NMD_X86_MODE_64 ? 0xFFFFFFFF00000000 | instruction->displacement : instruction->displacement;
 		}
-		else if (si->instruction->modrm.fields.mod == 0b00 && ((si->instruction->sib.fields.base == 0b101 && si->instruction->sib.fields.index == 0b100) || si->instruction->modrm.fields.rm == 0b101) && *(si->buffer - 1) == '[')
-			_nmd_append_number(si, si->instruction->mode == NMD_X86_MODE_64 ? 0xFFFFFFFF00000000 | si->instruction->displacement : si->instruction->displacement);
 		else
 		{
-			if (si->instruction->modrm.fields.rm == 0b101 && si->instruction->mode == NMD_X86_MODE_64 && si->instruction->modrm.fields.mod == 0b00)
-				_nmd_append_string(si, si->instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE ? "eip" : "rip");
+			if (instruction->modrm.fields.rm == 0b101 && instruction->mode == NMD_X86_MODE_64 && instruction->modrm.fields.mod == 0b00)
+				rip = instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE ? "eip" : "rip";
 
-			const bool isNegative = si->instruction->displacement & (1 << (si->instruction->dispMask * 8 - 1));
-			if (*(si->buffer - 1) != '[')
-				*si->buffer++ = isNegative ? '-' : '+';
+			isNegative = instruction->displacement & ((uint32_t)1 << (instruction->dispMask * 8 - 1));
+			if (isNegative)
+				displacement = (uint64_t)(~instruction->displacement & (uint32_t)(instruction->dispMask == 4 ? -1 : (1 << (instruction->dispMask * 8)) - 1)) + 1;
+			else
+				displacement = instruction->displacement;
+		}
+	}
 
+	const bool hasScale = !(instruction->sib.fields.scale == 0b00 && !(si->formatFlags & NMD_X86_FORMAT_FLAGS_SCALE_ONE));
+	const char scale = (char)('0' + (1 << instruction->sib.fields.scale));
+
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
+	{
+		if (hasDisplacement)
+		{
 			if (isNegative)
+				*si->buffer++ = '-';
+			_nmd_append_number(si, displacement);
+		}
+
+		if (base || index || rip)
+		{
+			*si->buffer++ = '(';
+			if (base || rip)
+				_nmd_append_register(si, base ? base : rip);
+			if (index)
 			{
-				const uint32_t mask = (uint32_t)(si->instruction->dispMask == 4 ? -1 : (1 << (si->instruction->dispMask * 8)) - 1);
-				_nmd_append_number(si, (uint64_t)(~si->instruction->displacement & mask) + 1);
+				*si->buffer++ = ',';
+				_nmd_append_register(si, index);
+
+				/* An index without a base always has its scale, '(,index)' is not read as an index by every assembler. */
+				if (hasScale || !base)
+					*si->buffer++ = ',', *si->buffer++ = scale;
 			}
-			else
-				_nmd_append_number(si, si->instruction->displacement);
+			*si->buffer++ = ')';
+		}
+		return;
+	}
+
+	*si->buffer++ = '[';
+
+	if (base)
+		_nmd_append_string(si, base);
+
+	if (index)
+	{
+		if (base)
+			*si->buffer++ = '+';
+		_nmd_append_string(si, index);
+		if (hasScale)
+			*si->buffer++ = '*', *si->buffer++ = scale;
+	}
+
+	if (hasDisplacement)
+	{
+		if (!isAbsolute)
+		{
+			if (rip)
+				_nmd_append_string(si, rip);
+			if (base || index || rip)
+				*si->buffer++ = isNegative ? '-' : '+';
 		}
+		_nmd_append_number(si, displacement);
 	}
 
 	*si->buffer++ = ']';
@@ -6997,42 +10605,26 @@ void _nmd_append_modrm_upper_without_address_specifier(_nmd_string_info* const s
 
 void _nmd_append_Nq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'm', *si->buffer++ = 'm';
+	_nmd_append_register(si, "mm");
 	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.rm);
 }
 
 void _nmd_append_Pq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'm', *si->buffer++ = 'm';
+	_nmd_append_register(si, "mm");
 	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.reg);
 }
 
-void _nmd_append_avx_register_reg(_nmd_string_info* const si)
-{
-	*si->buffer++ = si->instruction->vex.L ? 'y' : 'x';
-	_nmd_append_Pq(si);
-}
-
-void _nmd_append_avx_vvvv_register(_nmd_string_info* const si)
-{
-	*si->buffer++ = si->instruction->vex.L ? 'y' : 'x';
-	*si->buffer++ = 'm', *si->buffer++ = 'm';
-	if ((15 - si->instruction->vex.vvvv) > 9)
-		*si->buffer++ = '1', *si->buffer++ = (char)(0x26 + (15 - si->instruction->vex.vvvv));
-	else
-		*si->buffer++ = (char)('0' + (15 - si->instruction->vex.vvvv));
-}
-
 void _nmd_append_Vdq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'x';
-	_nmd_append_Pq(si);
+	_nmd_append_register(si, "xmm");
+	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.reg);
 }
 
 void _nmd_append_Vqq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'y';
-	_nmd_append_Pq(si);
+	_nmd_append_register(si, "ymm");
+	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.reg);
 }
 
 void _nmd_append_Vx(_nmd_string_info* const si)
@@ -7045,14 +10637,14 @@ void _nmd_append_Vx(_nmd_string_info* const si)
 
 void _nmd_append_Udq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'x';
-	_nmd_append_Nq(si);
+	_nmd_append_register(si, "xmm");
+	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.rm);
 }
 
 void _nmd_append_Uqq(_nmd_string_info* const si)
 {
-	*si->buffer++ = 'y';
-	_nmd_append_Nq(si);
+	_nmd_append_register(si, "ymm");
+	*si->buffer++ = (char)('0' + si->instruction->modrm.fields.rm);
 }
 
 void _nmd_append_Ux(_nmd_string_info* const si)
@@ -7077,12 +10669,12 @@ void _nmd_append_Ev(_nmd_string_info* const si)
 	{
 		if (si->instruction->prefixes & NMD_X86_PREFIXES_REX_B)
 		{
-			_nmd_append_string(si, _nmd_regrx[si->instruction->modrm.fields.rm]);
+			_nmd_append_register(si, _nmd_regrx[si->instruction->modrm.fields.rm]);
 			if (!(si->instruction->prefixes & NMD_X86_PREFIXES_REX_W))
 				*si->buffer++ = 'd';
 		}
 		else
-			_nmd_append_string(si, ((si->instruction->operandSize64 ? _nmd_reg64 : (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && si->instruction->mode != NMD_X86_MODE_16) || (si->instruction->mode == NMD_X86_MODE_16 && !(si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.rm]);
+			_nmd_append_register(si, ((si->instruction->operandSize64 ? _nmd_reg64 : (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && si->instruction->mode != NMD_X86_MODE_16) || (si->instruction->mode == NMD_X86_MODE_16 && !(si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.rm]);
 	}
 	else
 		_nmd_append_modrm_upper(si, (si->instruction->operandSize64) ? "qword" : ((si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && si->instruction->mode != NMD_X86_MODE_16) || (si->instruction->mode == NMD_X86_MODE_16 && !(si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? "word" : "dword"));
@@ -7091,7 +10683,7 @@ void _nmd_append_Ev(_nmd_string_info* const si)
 void _nmd_append_Ey(_nmd_string_info* const si)
 {
 	if (si->instruction->modrm.fields.mod == 0b11)
-		_nmd_append_string(si, (si->instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[si->instruction->modrm.fields.rm]);
+		_nmd_append_register(si, (si->instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[si->instruction->modrm.fields.rm]);
 	else
 		_nmd_append_modrm_upper(si, si->instruction->operandSize64 ? "qword" : "dword");
 }
@@ -7101,9 +10693,9 @@ void _nmd_append_Eb(_nmd_string_info* const si)
 	if (si->instruction->modrm.fields.mod == 0b11)
 	{
 		if (si->instruction->prefixes & NMD_X86_PREFIXES_REX_B)
-			_nmd_append_string(si, _nmd_regrx[si->instruction->modrm.fields.rm]), *si->buffer++ = 'b';
+			_nmd_append_register(si, _nmd_regrx[si->instruction->modrm.fields.rm]), *si->buffer++ = 'b';
 		else
-			_nmd_append_string(si, (si->instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8)[si->instruction->modrm.fields.rm]);
+			_nmd_append_register(si, (si->instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8)[si->instruction->modrm.fields.rm]);
 	}
 	else
 		_nmd_append_modrm_upper(si, "byte");
@@ -7112,7 +10704,7 @@ void _nmd_append_Eb(_nmd_string_info* const si)
 void _nmd_append_Ew(_nmd_string_info* const si)
 {
 	if (si->instruction->modrm.fields.mod == 0b11)
-		_nmd_append_string(si, _nmd_reg16[si->instruction->modrm.fields.rm]);
+		_nmd_append_register(si, _nmd_reg16[si->instruction->modrm.fields.rm]);
 	else
 		_nmd_append_modrm_upper(si, "word");
 }
@@ -7120,7 +10712,7 @@ void _nmd_append_Ew(_nmd_string_info* const si)
 void _nmd_append_Ed(_nmd_string_info* const si)
 {
 	if (si->instruction->modrm.fields.mod == 0b11)
-		_nmd_append_string(si, _nmd_reg32[si->instruction->modrm.fields.rm]);
+		_nmd_append_register(si, _nmd_reg32[si->instruction->modrm.fields.rm]);
 	else
 		_nmd_append_modrm_upper(si, "dword");
 }
@@ -7128,172 +10720,405 @@ void _nmd_append_Ed(_nmd_string_info* const si)
 void _nmd_append_Eq(_nmd_string_info* const si)
 {
 	if (si->instruction->modrm.fields.mod == 0b11)
-		_nmd_append_string(si, _nmd_reg64[si->instruction->modrm.fields.rm]);
+		_nmd_append_register(si, _nmd_reg64[si->instruction->modrm.fields.rm]);
 	else
 		_nmd_append_modrm_upper(si, "qword");
 }
 
 void _nmd_append_Rv(_nmd_string_info* const si)
 {
-	_nmd_append_string(si, (si->instruction->operandSize64 ? _nmd_reg64 : (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.rm]);
+	_nmd_append_register(si, (si->instruction->operandSize64 ? _nmd_reg64 : (si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.rm]);
 }
 
 void _nmd_append_Gv(_nmd_string_info* const si)
 {
 	if (si->instruction->prefixes & NMD_X86_PREFIXES_REX_R)
 	{
-		_nmd_append_string(si, _nmd_regrx[si->instruction->modrm.fields.reg]);
+		_nmd_append_register(si, _nmd_regrx[si->instruction->modrm.fields.reg]);
 		if (!(si->instruction->prefixes & NMD_X86_PREFIXES_REX_W))
 			*si->buffer++ = 'd';
 	}
 	else
-		_nmd_append_string(si, ((si->instruction->operandSize64) ? _nmd_reg64 : ((si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && si->instruction->mode != NMD_X86_MODE_16) || (si->instruction->mode == NMD_X86_MODE_16 && !(si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.reg]);
+		_nmd_append_register(si, ((si->instruction->operandSize64) ? _nmd_reg64 : ((si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && si->instruction->mode != NMD_X86_MODE_16) || (si->instruction->mode == NMD_X86_MODE_16 && !(si->instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32))[si->instruction->modrm.fields.reg]);
 }
 
 void _nmd_append_Gy(_nmd_string_info* const si)
 {
-	_nmd_append_string(si, (si->instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[si->instruction->modrm.fields.reg]);
+	_nmd_append_register(si, (si->instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[si->instruction->modrm.fields.reg]);
 }
 
 void _nmd_append_Gb(_nmd_string_info* const si)
 {
 	if (si->instruction->prefixes & NMD_X86_PREFIXES_REX_R)
-		_nmd_append_string(si, _nmd_regrx[si->instruction->modrm.fields.reg]), *si->buffer++ = 'b';
+		_nmd_append_register(si, _nmd_regrx[si->instruction->modrm.fields.reg]), *si->buffer++ = 'b';
 	else
-		_nmd_append_string(si, (si->instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8)[si->instruction->modrm.fields.reg]);
+		_nmd_append_register(si, (si->instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8)[si->instruction->modrm.fields.reg]);
 }
 
 void _nmd_append_Gw(_nmd_string_info* const si)
 {
-	_nmd_append_string(si, _nmd_reg16[si->instruction->modrm.fields.reg]);
+	_nmd_append_register(si, _nmd_reg16[si->instruction->modrm.fields.reg]);
 }
 
 void _nmd_append_W(_nmd_string_info* const si)
 {
 	if (si->instruction->modrm.fields.mod == 0b11)
-		_nmd_append_string(si, "xmm"), *si->buffer++ = (char)('0' + si->instruction->modrm.fields.rm);
+		_nmd_append_Udq(si);
 	else
 		_nmd_append_modrm_upper(si, "xmmword");
 }
 
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
-char* _nmd_format_operand_to_att(char* operand, _nmd_string_info* si)
+#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX)
+void _nmd_append_vector_register(_nmd_string_info* const si, size_t size, uint8_t index)
 {
-	char* nextOperand = (char*)_nmd_strchr(operand, ',');
-	const char* operandEnd = nextOperand ? nextOperand : si->buffer;
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
+		*si->buffer++ = '%';
+	*si->buffer++ = size == 64 ? 'z' : (size == 32 ? 'y' : 'x');
+	*si->buffer++ = 'm', *si->buffer++ = 'm';
+	if (index > 9)
+		*si->buffer++ = (char)('0' + index / 10);
+	*si->buffer++ = (char)('0' + index % 10);
+}
 
-	/* Memory operand. */
-	const char* memoryOperand = _nmd_strchr(operand, '[');
-	if (memoryOperand && memoryOperand < operandEnd)
+/* Appends a memory operand that uses a vector register of 'indexSize' bytes as its index(VSIB addressing). */
+void _nmd_append_vsib_upper(_nmd_string_info* const si, size_t indexSize)
+{
+	const nmd_x86_instruction* const instruction = si->instruction;
+	const bool hasBase = !(instruction->sib.fields.base == 0b101 && instruction->modrm.fields.mod == 0b00);
+	const bool hasScale = !(instruction->sib.fields.scale == 0b00 && !(si->formatFlags & NMD_X86_FORMAT_FLAGS_SCALE_ONE));
+	const bool hasDisplacement = instruction->dispMask != NMD_X86_DISP_NONE && instruction->displacement != 0;
+	const bool isNegative = hasDisplacement && instruction->displacement & ((uint32_t)1 << (instruction->dispMask * 8 - 1));
+	const uint64_t displacement = isNegative ? (uint64_t)(~instruction->displacement & (uint32_t)(instruction->dispMask == 4 ? -1 : (1 << (instruction->dispMask * 8)) - 1)) + 1 : instruction->displacement;
+	const char* const base = (instruction->mode == NMD_X86_MODE_64 && !(instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE) ? (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : _nmd_reg64) : _nmd_reg32)[instruction->sib.fields.base];
+	const char scale = (char)('0' + (1 << instruction->sib.fields.scale));
+
+	uint8_t index = instruction->sib.fields.index;
+	if (instruction->mode == NMD_X86_MODE_64)
+		index |= (uint8_t)((instruction->prefixes & NMD_X86_PREFIXES_REX_X ? 8 : 0) | (instruction->encoding == NMD_X86_ENCODING_EVEX && !instruction->evex.V1 ? 16 : 0));
+
+	_nmd_begin_operand(si);
+	if (_NMD_IS_ATT_SYNTAX(si))
 	{
-		memoryOperand++;
-		const char* segReg = _nmd_strchr(operand, ':');
-		if (segReg)
+		if (hasDisplacement)
 		{
-			if (segReg == operand + 2)
-				_nmd_insert_char(operand, '%'), si->buffer++, operand += 4;
-			else
-			{
-				*operand++ = '%';
-				*operand++ = *(segReg - 2);
-				*operand++ = 's';
-				*operand++ = ':';
-			}
+			if (isNegative)
+				*si->buffer++ = '-';
+			_nmd_append_number(si, displacement);
 		}
 
-		/* Handle displacement. */
-		char* displacement = operand;
-		do
-		{
-			displacement++;
-			displacement = (char*)_nmd_find_number(displacement, operandEnd);
-		} while (displacement && ((*(displacement - 1) != '+' && *(displacement - 1) != '-' && *(displacement - 1) != '[') || !_nmd_is_number(displacement, operandEnd - 2)));
+		*si->buffer++ = '(';
+		if (hasBase)
+			_nmd_append_register(si, base);
+		*si->buffer++ = ',';
+		_nmd_append_vector_register(si, indexSize, index);
+		if (hasScale || !hasBase)
+			*si->buffer++ = ',', *si->buffer++ = scale;
+		*si->buffer++ = ')';
+		return;
+	}
 
-		bool isThereBaseOrIndex = true;
-		char memoryOperandBuffer[96];
+	*si->buffer++ = '[';
 
-		if (displacement)
-		{
-			if (*(displacement - 1) != '[')
-				displacement--;
-			else
-				isThereBaseOrIndex = false;
+	if (hasBase)
+	{
+		_nmd_append_string(si, base);
+		*si->buffer++ = '+';
+	}
+
+	_nmd_append_vector_register(si, indexSize, index);
+	if (hasScale)
+		*si->buffer++ = '*', *si->buffer++ = scale;
 
-			char* i = (char*)memoryOperand;
-			char* j = memoryOperandBuffer;
-			for (; i < displacement; i++, j++)
-				*j = *i;
-			*j = '\0';
+	if (hasDisplacement)
+	{
+		*si->buffer++ = isNegative ? '-' : '+';
+		_nmd_append_number(si, displacement);
+	}
 
-			if (*displacement == '+')
-				displacement++;
+	*si->buffer++ = ']';
+}
 
-			for (; *displacement != ']'; displacement++, operand++)
-				*operand = *displacement;
-		}
+/*
+Appends the memory operand of a VEX or EVEX instruction. 'size' is the size of the operand in bytes, 'indexSize' is the size of
+the index register if VSIB addressing is used or zero otherwise.
+*/
+void _nmd_append_avx_memory_operand(_nmd_string_info* const si, size_t size, size_t indexSize)
+{
+	const nmd_x86_instruction* const instruction = si->instruction;
+	const bool broadcast = instruction->encoding == NMD_X86_ENCODING_EVEX && instruction->evex.b && !indexSize;
+	const size_t elementSize = broadcast ? (instruction->evex.W ? 8 : 4) : size;
+	const char* const sizeNames[] = { "byte", "word", "dword", "qword", "xmmword", "ymmword", "zmmword" };
+
+	/* The 8-bit displacement of EVEX instructions is scaled by 'disp8Scale'(disp8*N compression). */
+	nmd_x86_instruction scaled;
+	if (instruction->encoding == NMD_X86_ENCODING_EVEX && instruction->dispMask == NMD_X86_DISP8 && instruction->evex.disp8Scale > 1)
+	{
+		const bool is16bitAddressing = (instruction->mode == NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE)) || (instruction->mode == NMD_X86_MODE_32 && instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE);
+		scaled = *instruction;
+		scaled.displacement = (uint32_t)((int32_t)(int8_t)instruction->displacement * instruction->evex.disp8Scale);
+		if (is16bitAddressing)
+			scaled.displacement &= 0xffff, scaled.dispMask = NMD_X86_DISP16;
+		else
+			scaled.dispMask = NMD_X86_DISP32;
+		si->instruction = &scaled;
+	}
+
+	_nmd_append_modrm_memory_prefix(si, sizeNames[_nmd_get_bit_index((uint32_t)elementSize)]);
+	if (indexSize)
+		_nmd_append_vsib_upper(si, indexSize);
+	else
+		_nmd_append_modrm_upper_without_address_specifier(si);
+
+	if (broadcast)
+	{
+		const size_t numElements = size / elementSize;
+		_nmd_append_string(si, "{1to");
+		if (numElements > 9)
+			*si->buffer++ = (char)('0' + numElements / 10);
+		*si->buffer++ = (char)('0' + numElements % 10);
+		*si->buffer++ = '}';
+	}
 
-		/* Handle base, index and scale. */
-		if (isThereBaseOrIndex)
+	si->instruction = instruction;
+}
+
+/* Appends the mnemonic and operands of a VEX or EVEX instruction. Returns false if the instruction is not known. */
+bool _nmd_append_avx_instruction(_nmd_string_info* const si)
+{
+	const nmd_x86_instruction* const instruction = si->instruction;
+	const bool isEvex = instruction->encoding == NMD_X86_ENCODING_EVEX;
+	const bool is64 = instruction->mode == NMD_X86_MODE_64;
+	const bool W = isEvex ? instruction->evex.W : instruction->vex.W;
+	const uint8_t L = isEvex ? instruction->evex.LL : instruction->vex.L;
+	const _nmd_avx_entry* const entry = _nmd_find_avx_entry(isEvex ? instruction->evex.evex : instruction->vex.vex, instruction->opcode, instruction->modrm, (NMD_X86_MODE)instruction->mode);
+	if (!entry)
+		return false;
+
+	const bool isRegister = instruction->modrm.fields.mod == 0b11;
+
+	/* With a register operand EVEX.b selects embedded rounding or SAE, which imply a vector length of 64 bytes. */
+	const bool hasRounding = isEvex && instruction->evex.b && isRegister && entry->flags & (_NMD_AVX_ER | _NMD_AVX_SAE);
+	const size_t vectorLength = hasRounding || L > 2 ? 64 : (size_t)16 << L;
+
+	/* The register indices. 'R', 'X', 'B', 'R1', 'V1' and 'vvvv' are stored inverted. */
+	uint8_t reg = instruction->modrm.fields.reg, rm = instruction->modrm.fields.rm, vvvv;
+	if (isEvex)
+	{
+		vvvv = (uint8_t)(15 - instruction->evex.vvvv);
+		if (is64)
 		{
-			*operand++ = '(';
+			reg |= (uint8_t)((instruction->evex.R ? 0 : 8) | (instruction->evex.R1 ? 0 : 16));
+			rm |= (uint8_t)((instruction->evex.B ? 0 : 8) | (instruction->evex.X || !isRegister ? 0 : 16));
+			vvvv |= (uint8_t)(instruction->evex.V1 ? 0 : 16);
+		}
+	}
+	else
+	{
+		vvvv = (uint8_t)(15 - instruction->vex.vvvv);
+		if (is64)
+		{
+			reg |= (uint8_t)(instruction->vex.R ? 0 : 8);
+			rm |= (uint8_t)(instruction->vex.B ? 0 : 8);
+		}
+	}
+	if (!is64)
+		vvvv &= 0b111;
+
+	_nmd_append_string(si, entry->mnemonic);
+	if (*entry->operands)
+		*si->buffer++ = ' ';
 
-			char* baseOrIndex = operand;
-			if (displacement)
+	const char* descriptor = entry->operands;
+	bool isFirstOperand = true;
+	while (*descriptor)
+	{
+		const char kind = *descriptor++;
+		char suffix = 0;
+		size_t memorySize = 0;
+		if (*descriptor >= 'a' && *descriptor <= 'z' && *descriptor != 's')
+			suffix = *descriptor++;
+		if (*descriptor == 's')
+			memorySize = W ? 8 : 4, descriptor++;
+		else if (_NMD_IS_DECIMAL_NUMBER(*descriptor))
+			memorySize = (size_t)(*descriptor++ - '0');
+
+		size_t size = vectorLength;
+		switch (suffix)
+		{
+		case 'x': size = 16; break;
+		case 'y': size = 32; break;
+		case 'h': size = vectorLength / 2; break;
+		case 'q': size = vectorLength / 4; break;
+		case 'o': size = vectorLength / 8; break;
+		}
+		const size_t registerSize = size < 16 ? 16 : size;
+		const bool isGpr64 = is64 && W && suffix != 'd';
+		if (!memorySize)
+			memorySize = kind == 'E' ? (isGpr64 ? 8 : 4) : (suffix == 'd' && vectorLength == 16 ? 8 : size);
+
+		switch (kind)
+		{
+		case 'V': _nmd_append_vector_register(si, registerSize, reg); break;
+		case 'H': _nmd_append_vector_register(si, registerSize, vvvv); break;
+		case 'L': _nmd_append_vector_register(si, registerSize, (uint8_t)((instruction->immediate >> 4) & (is64 ? 0b1111 : 0b111))); break;
+		case 'S': _nmd_append_avx_memory_operand(si, W ? 8 : 4, registerSize); break;
+		case 'K': _nmd_append_register(si, "k"), *si->buffer++ = (char)('0' + (reg & 0b111)); break;
+		case 'J': _nmd_append_register(si, "k"), *si->buffer++ = (char)('0' + (vvvv & 0b111)); break;
+		case 'G': _nmd_append_register(si, reg & 0b1000 ? (isGpr64 ? _nmd_regrx : _nmd_regrxd)[reg & 0b111] : (isGpr64 ? _nmd_reg64 : _nmd_reg32)[reg & 0b111]); break;
+		case 'B': _nmd_append_register(si, vvvv & 0b1000 ? (isGpr64 ? _nmd_regrx : _nmd_regrxd)[vvvv & 0b111] : (isGpr64 ? _nmd_reg64 : _nmd_reg32)[vvvv & 0b111]); break;
+		case 'I': _nmd_append_immediate(si, instruction->immediate); break;
+		case 'W':
+		case 'k':
+		case 'E':
+			if (!isRegister)
+				_nmd_append_avx_memory_operand(si, memorySize, 0);
+			else
 			{
-				char* s = memoryOperandBuffer;
-				for (; *s; s++, operand++)
-					*operand = *s;
+				if (kind == 'W')
+					_nmd_append_vector_register(si, registerSize, rm);
+				else if (kind == 'k')
+					_nmd_append_register(si, "k"), *si->buffer++ = (char)('0' + (rm & 0b111));
+				else
+					_nmd_append_register(si, rm & 0b1000 ? (isGpr64 ? _nmd_regrx : _nmd_regrxd)[rm & 0b111] : (isGpr64 ? _nmd_reg64 : _nmd_reg32)[rm & 0b111]);
 			}
-			else
+			break;
+		}
+
+		/* The opmask and zeroing-masking decorate the first operand. */
+		if (isFirstOperand && isEvex)
+		{
+			if (instruction->evex.aaa)
 			{
-				for (; *memoryOperand != ']'; operand++, memoryOperand++)
-					*operand = *memoryOperand;
+				*si->buffer++ = '{';
+				_nmd_append_register(si, "k");
+				*si->buffer++ = (char)('0' + instruction->evex.aaa), *si->buffer++ = '}';
 			}
+			if (instruction->evex.z)
+				_nmd_append_string(si, "{z}");
+		}
+		isFirstOperand = false;
 
-			_nmd_insert_char(baseOrIndex, '%');
-			operand++;
-			*operand++ = ')';
+		/* Embedded rounding and SAE decorate the last operand that is not the immediate. They are an operand of their own in AT&T syntax. */
+		if (hasRounding && kind != 'I' && (!*descriptor || (descriptor[0] == ',' && descriptor[1] == 'I')))
+		{
+			if (_NMD_IS_ATT_SYNTAX(si))
+				_nmd_append_separator(si);
 
-			for (; *baseOrIndex != ')'; baseOrIndex++)
+			if (entry->flags & _NMD_AVX_ER)
 			{
-				if (*baseOrIndex == '+' || *baseOrIndex == '*')
-				{
-					if (*baseOrIndex == '+')
-						_nmd_insert_char(baseOrIndex + 1, '%'), operand++;
-					*baseOrIndex = ',';
-				}
+				const char* const roundingModes[] = { "{rn-sae}", "{rd-sae}", "{ru-sae}", "{rz-sae}" };
+				_nmd_append_string(si, roundingModes[instruction->evex.LL]);
 			}
-
-			operand = baseOrIndex;
-			operand++;
+			else
+				_nmd_append_string(si, "{sae}");
 		}
 
-		if (nextOperand)
-		{
-			/* Move second operand to the left until the comma. */
-			operandEnd = _nmd_strchr(operand, ',');
-			for (; *operandEnd != '\0'; operand++, operandEnd++)
-				*operand = *operandEnd;
+		if (*descriptor == ',')
+			_nmd_append_separator(si), descriptor++;
+	}
 
-			*operand = '\0';
+	return true;
+}
+#endif /* !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX) */
 
-			operandEnd = operand;
-			while (*operandEnd != ',')
-				operandEnd--;
-		}
-		else
-			*operand = '\0', operandEnd = operand;
+bool _nmd_is_word_char(char c)
+{
+	return _NMD_IS_LOWERCASE(c) || _NMD_IS_UPPERCASE(c) || _NMD_IS_DECIMAL_NUMBER(c) || c == '_';
+}
+
+/* Returns the length of the word that starts at 's'. */
+size_t _nmd_get_word_length(const char* s)
+{
+	size_t length = 0;
+	while (_nmd_is_word_char(s[length]))
+		length++;
 
-		si->buffer = operand;
+	return length;
+}
+
+/* Returns true if the 'length' characters at 's' are 'word', which must be lowercase. The comparison ignores case. */
+bool _nmd_word_equals(const char* s, size_t length, const char* word)
+{
+	for (; length; s++, word++, length--)
+	{
+		if (!*word || _NMD_TOLOWER(*s) != *word)
+			return false;
+	}
+
+	return !*word;
+}
+
+bool _nmd_is_prefix_word(const char* s, size_t length)
+{
+	return _nmd_word_equals(s, length, "lock") || _nmd_word_equals(s, length, "rep") || _nmd_word_equals(s, length, "repe") || _nmd_word_equals(s, length, "repz") ||
+		_nmd_word_equals(s, length, "repne") || _nmd_word_equals(s, length, "repnz") || _nmd_word_equals(s, length, "bnd") || _nmd_word_equals(s, length, "xacquire") ||
+		_nmd_word_equals(s, length, "xrelease");
+}
+
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+/*
+Returns the suffix of the instruction's mnemonic in AT&T syntax. Only the instructions whose memory operand's size is not told by
+another operand have one(e.g. 'addl $1,(%eax)', 'incb (%eax)', 'flds (%eax)'), others such as 'lea', 'prefetcht0' or 'fxsave' do not.
+*/
+const char* _nmd_get_att_suffix(const nmd_x86_instruction* instruction)
+{
+	if (!instruction->hasModrm || instruction->modrm.fields.mod == 0b11 || instruction->encoding != NMD_X86_ENCODING_LEGACY)
+		return "";
 
-		return (char*)operandEnd;
+	const uint8_t op = instruction->opcode;
+	const uint8_t reg = instruction->modrm.fields.reg;
+	const bool operandSize16 = (instruction->mode == NMD_X86_MODE_16) != ((instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) != 0);
+	const char* const operandSizeSuffix = instruction->operandSize64 ? "q" : (operandSize16 ? "w" : "l");
+
+	/* 'push' and 'pop' default to 64-bit operands in 64-bit mode. */
+	const char* const stackSuffix = instruction->mode == NMD_X86_MODE_64 ? (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "w" : "q") : operandSizeSuffix;
+
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
+	{
+		/* x87 memory operands are single('s'), double('l') or extended('t') reals, or word('s'), dword('l') or qword('ll') integers. */
+		if (op >= 0xd8 && op <= 0xdf)
+		{
+			const char* const suffixes[8][8] = {
+				/* d8 */ { "s", "s", "s", "s", "s", "s", "s", "s" },
+				/* d9 */ { "s", "", "s", "s", "", "", "", "" },
+				/* da */ { "l", "l", "l", "l", "l", "l", "l", "l" },
+				/* db */ { "l", "l", "l", "l", "", "t", "", "t" },
+				/* dc */ { "l", "l", "l", "l", "l", "l", "l", "l" },
+				/* dd */ { "l", "ll", "l", "l", "", "", "", "" },
+				/* de */ { "s", "s", "s", "s", "s", "s", "s", "s" },
+				/* df */ { "s", "s", "s", "s", "", "ll", "", "ll" }
+			};
+			return suffixes[op - 0xd8][reg];
+		}
+
+		switch (op)
+		{
+		case 0x80: case 0x82: case 0xc0: case 0xd0: case 0xd2: case 0xf6:
+			return "b";
+		case 0x81: case 0x83: case 0xc1: case 0xd1: case 0xd3: case 0xf7:
+			return operandSizeSuffix;
+		case 0xc6: return reg == 0b000 ? "b" : "";
+		case 0xc7: return reg == 0b000 ? operandSizeSuffix : "";
+		case 0xfe: return reg <= 0b001 ? "b" : "";
+		case 0xff: return reg <= 0b001 ? operandSizeSuffix : (reg == 0b110 ? stackSuffix : "");
+		case 0x8f: return reg == 0b000 ? stackSuffix : "";
+		default: return "";
+		}
 	}
-	else /* Immediate or register operand. */
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
 	{
-		_nmd_insert_char(operand, _nmd_is_number(operand, operandEnd) ? '$' : '%');
-		si->buffer++;
-		return (char*)operandEnd + 1;
+		if (op == 0xba || (op == 0x18 && reg >= 0b100))
+			return operandSizeSuffix; /* 'bt', 'bts', 'btr', 'btc' and the one operand 'nop' */
+		else if (op == 0x2a && (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT || instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO))
+			return instruction->operandSize64 ? "q" : "l"; /* 'cvtsi2ss' and 'cvtsi2sd' */
+		else if (op == 0xae && reg == 0b100 && instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+			return instruction->operandSize64 ? "q" : "l"; /* 'ptwrite' */
 	}
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38 && (op == 0xf0 || op == 0xf1) && instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+		return op == 0xf0 ? "b" : operandSizeSuffix; /* 'crc32' */
+
+	return "";
 }
 #endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
 
@@ -7301,20 +11126,44 @@ char* _nmd_format_operand_to_att(char* operand, _nmd_string_info* si)
 Formats an instruction. This function may cause a crash if you modify 'instruction' manually.
 Parameters:
  - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
- - buffer         [out] A pointer to buffer that receives the string. The buffer's recommended size is 128 bytes.
+ - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
  - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
  - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
 */
-void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags)
+/* 'numberStarts' is either zero or a bitmap of 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bits that receives the offsets where numbers begin in 'buffer'. */
+void _nmd_format_instruction(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags, uint8_t* numberStarts)
 {
 	if (!instruction->valid)
 		return;
 
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+	/* AT&T syntax has no operator expressions or number hints in parentheses. */
+	if (formatFlags & NMD_X86_FORMAT_FLAGS_ATT_SYNTAX)
+		formatFlags &= ~(uint32_t)(NMD_X86_FORMAT_FLAGS_OPERATOR_SPACES | NMD_X86_FORMAT_FLAGS_SIGNED_NUMBER_HINT_HEX | NMD_X86_FORMAT_FLAGS_SIGNED_NUMBER_HINT_DEC);
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+
+#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX)
+	/*
+	If uppercase, comma spaces, operator spaces or AT&T syntax are used, the string is built in 'tmpBuffer' and then copied to 'output' applying them.
+	AT&T syntax reverses the order of the operands and adds the mnemonic's suffix while copying.
+	*/
+	char tmpBuffer[NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH];
+	char* const output = buffer;
+	if (formatFlags & (NMD_X86_FORMAT_FLAGS_UPPERCASE | NMD_X86_FORMAT_FLAGS_COMMA_SPACES | NMD_X86_FORMAT_FLAGS_OPERATOR_SPACES | NMD_X86_FORMAT_FLAGS_ATT_SYNTAX))
+		buffer = tmpBuffer;
+#endif
+
 	_nmd_string_info si;
 	si.buffer = buffer;
 	si.instruction = instruction;
 	si.runtimeAddress = runtimeAddress;
 	si.formatFlags = formatFlags;
+	si.bufferStart = buffer;
+	si.numberStarts = numberStarts;
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+	si.operands = 0;
+	si.numSeparators = 0;
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
 
 #ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_BYTES
 	if (formatFlags & NMD_X86_FORMAT_FLAGS_BYTES)
@@ -7347,122 +11196,22 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 
 	const bool operandSize = instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE;
 
-	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
-	{
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX
-		if (instruction->encoding == NMD_X86_ENCODING_EVEX)
-		{
-
-		}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX */
-
-#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX) && !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX)
-		else
-#endif
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_VEX
-			if (instruction->encoding == NMD_X86_ENCODING_VEX)
-			{
-				if (instruction->vex.vex[0] == 0xc4)
-				{
-					if (instruction->opcode == 0x0c || instruction->opcode == 0x0d || instruction->opcode == 0x4a || instruction->opcode == 0x4b)
-					{
-						_nmd_append_string(&si, instruction->opcode == 0x0c ? "vblendps" : (instruction->opcode == 0x0c ? "vblendpd" : (instruction->opcode == 0x4a ? "vblendvps" : "vblendvpd")));
-						*si.buffer++ = ' ';
-
-						_nmd_append_avx_register_reg(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_avx_vvvv_register(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_W(&si);
-						*si.buffer++ = ',';
-
-						if(instruction->opcode <= 0x0d)
-							_nmd_append_number(&si, instruction->immediate);
-						else
-						{
-							_nmd_append_string(&si, "xmm");
-							*si.buffer++ = (char)('0' + ((instruction->immediate & 0xf0) >> 4) % 8);
-						}
-					}
-					else if (instruction->opcode == 0x40 || instruction->opcode == 0x41)
-					{
-						_nmd_append_string(&si, instruction->opcode == 0x40 ? "vdpps" : "vdppd");
-						*si.buffer++ = ' ';
-
-						_nmd_append_avx_register_reg(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_avx_vvvv_register(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_W(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_number(&si, instruction->immediate);
-					}
-					else if (instruction->opcode == 0x17)
-					{
-						_nmd_append_string(&si, "vextractps ");
-
-						_nmd_append_Ev(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_Vdq(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_number(&si, instruction->immediate);
-					}
-					else if (instruction->opcode == 0x21)
-					{
-						_nmd_append_string(&si, "vinsertps ");
-
-						_nmd_append_Vdq(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_avx_vvvv_register(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_W(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_number(&si, instruction->immediate);
-					}
-					else if (instruction->opcode == 0x2a)
-					{
-						_nmd_append_string(&si, "vmovntdqa ");
-
-						_nmd_append_Vdq(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_modrm_upper_without_address_specifier(&si);
-					}
-					else if (instruction->opcode == 0x42)
-					{
-						_nmd_append_string(&si, "vmpsadbw ");
-
-						_nmd_append_Vdq(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_avx_vvvv_register(&si);
-						*si.buffer++ = ',';
-
-						if (si.instruction->modrm.fields.mod == 0b11)
-							_nmd_append_string(&si, "xmm"), *si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
-						else
-							_nmd_append_modrm_upper_without_address_specifier(&si);
-						*si.buffer++ = ',';
-
-						_nmd_append_number(&si, instruction->immediate);
-					}
-				}
-			}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_VEX */
-			
-#if (!defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX)) && !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_3DNOW)
-		else
+#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX)
+#if defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX)
+	if (instruction->encoding == NMD_X86_ENCODING_EVEX)
+#elif defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX)
+	if (instruction->encoding == NMD_X86_ENCODING_VEX)
+#else
+	if (instruction->encoding == NMD_X86_ENCODING_VEX || instruction->encoding == NMD_X86_ENCODING_EVEX)
 #endif
+	{
+		if (!_nmd_append_avx_instruction(&si))
+			return;
+	}
+	else
+#endif /* !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX) */
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
+	{
 #ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_3DNOW
 		if (instruction->encoding == NMD_X86_ENCODING_3DNOW)
 		{
@@ -7499,12 +11248,12 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			*si.buffer++ = ' ';
 
 			_nmd_append_Pq(&si);
-			*si.buffer++ = ',';
+			_nmd_append_separator(&si);
 			_nmd_append_Qq(&si);
 		}
 #endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_3DNOW */
 
-#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_EVEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_VEX) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_3DNOW)
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_3DNOW
 			else /*if (instruction->encoding == INSTRUCTION_ENCODING_LEGACY) */
 #endif
 			{
@@ -7514,36 +11263,36 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					if (op == 0x8b)
 					{
 						_nmd_append_Gv(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Ev(&si);
 					}
 					else if (op == 0x89)
 					{
 						_nmd_append_Ev(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gv(&si);
 					}
 					else if (op == 0x88)
 					{
 						_nmd_append_Eb(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gb(&si);
 					}
 					else if (op == 0x8a)
 					{
 						_nmd_append_Gb(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Eb(&si);
 					}
 					else if (op == 0x8c)
 					{
 						if (si.instruction->modrm.fields.mod == 0b11)
-							_nmd_append_string(&si, (si.instruction->operandSize64 ? _nmd_reg64 : (si.instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? _nmd_reg16 : _nmd_reg32))[si.instruction->modrm.fields.rm]);
+							_nmd_append_register(&si, (si.instruction->operandSize64 ? _nmd_reg64 : (si.instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? _nmd_reg16 : _nmd_reg32))[si.instruction->modrm.fields.rm]);
 						else
 							_nmd_append_modrm_upper(&si, "word");
 
-						*si.buffer++ = ',';
-						_nmd_append_string(&si, _nmd_segmentReg[instruction->modrm.fields.reg]);
+						_nmd_append_separator(&si);
+						_nmd_append_register(&si, _nmd_segmentReg[instruction->modrm.fields.reg]);
 					}
 				}
 				else if (op == 0x68 || op == 0x6A) /* push */
@@ -7554,17 +11303,26 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						if (formatFlags & NMD_X86_FORMAT_FLAGS_SIGNED_NUMBER_MEMORY_VIEW && instruction->immediate >= 0x80)
 							_nmd_append_signed_number_memory_view(&si);
 						else
-							_nmd_append_signed_number(&si, (int8_t)instruction->immediate, false);
+							_nmd_append_signed_immediate(&si, (int8_t)instruction->immediate);
 					}
 					else
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xff) /* Opcode extensions Group 5 */
 				{
-					_nmd_append_string(&si, _nmd_opcodeExtensionsGrp5[instruction->modrm.fields.reg]);
+					/* AT&T syntax marks indirect branches with '*' and far ones with the 'l' prefix, e.g. 'call *%eax', 'ljmp *(%eax)'. */
+					if (_NMD_IS_ATT_SYNTAX(&si) && (instruction->modrm.fields.reg == 0b011 || instruction->modrm.fields.reg == 0b101))
+						_nmd_append_string(&si, instruction->modrm.fields.reg == 0b011 ? "lcall" : "ljmp");
+					else
+						_nmd_append_string(&si, _nmd_opcodeExtensionsGrp5[instruction->modrm.fields.reg]);
 					*si.buffer++ = ' ';
+					if (_NMD_IS_ATT_SYNTAX(&si) && instruction->modrm.fields.reg >= 0b010 && instruction->modrm.fields.reg <= 0b101)
+					{
+						_nmd_begin_operand(&si);
+						*si.buffer++ = '*';
+					}
 					if (instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, (si.instruction->operandSize64 ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32))[si.instruction->modrm.fields.rm]);
+						_nmd_append_register(&si, (si.instruction->operandSize64 ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32))[si.instruction->modrm.fields.rm]);
 					else
 						_nmd_append_modrm_upper(&si, (instruction->modrm.fields.reg == 0b011 || instruction->modrm.fields.reg == 0b101) ? "fword" : (instruction->mode == NMD_X86_MODE_64 && ((instruction->modrm.fields.reg >= 0b010 && instruction->modrm.fields.reg <= 0b110) || (instruction->prefixes & NMD_X86_PREFIXES_REX_W && instruction->modrm.fields.reg <= 0b010)) ? "qword" : (operandSize ? "word" : "dword")));
 				}
@@ -7577,39 +11335,40 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					{
 					case 0:
 						_nmd_append_Eb(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gb(&si);
 						break;
 					case 1:
 						_nmd_append_Ev(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gv(&si);
 						break;
 					case 2:
 						_nmd_append_Gb(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Eb(&si);
 						break;
 					case 3:
 						_nmd_append_Gv(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Ev(&si);
 						break;
 					case 4:
-						_nmd_append_string(&si, "al,");
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_register(&si, "al");
+						_nmd_append_separator(&si);
+						_nmd_append_immediate(&si, instruction->immediate);
 						break;
 					case 5:
-						_nmd_append_string(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
-						*si.buffer++ = ',';
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_register(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
+						_nmd_append_separator(&si);
+						_nmd_append_immediate(&si, instruction->immediate);
 						break;
 					}
 				}
 				else if (NMD_R(op) == 4 || NMD_R(op) == 5) /* inc,dec,push,pop [0x40, 0x5f] */
 				{
 					_nmd_append_string(&si, NMD_C(op) < 8 ? (NMD_R(op) == 4 ? "inc " : "push ") : (NMD_R(op) == 4 ? "dec " : "pop "));
-					_nmd_append_string(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : (instruction->mode == NMD_X86_MODE_64 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32)))[op % 8]);
+					_nmd_append_register(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? _nmd_regrx : (instruction->mode == NMD_X86_MODE_64 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32)))[op % 8]);
 				}
 				else if (op >= 0x80 && op < 0x84) /* add,adc,and,xor,or,sbb,sub,cmp [80,83] */
 				{
@@ -7619,16 +11378,16 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						_nmd_append_Eb(&si);
 					else
 						_nmd_append_Ev(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (op == 0x83)
 					{
 						if ((instruction->modrm.fields.reg == 0b001 || instruction->modrm.fields.reg == 0b100 || instruction->modrm.fields.reg == 0b110) && instruction->immediate >= 0x80)
-							_nmd_append_number(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? 0xFFFFFFFFFFFFFF00 : (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFF00 : 0xFFFFFF00)) | instruction->immediate);
+							_nmd_append_immediate(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? 0xFFFFFFFFFFFFFF00 : (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFF00 : 0xFFFFFF00)) | instruction->immediate);
 						else
-							_nmd_append_signed_number(&si, (int8_t)(instruction->immediate), false);
+							_nmd_append_signed_immediate(&si, (int8_t)instruction->immediate);
 					}
 					else
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xe8 || op == 0xe9 || op == 0xeb) /* call,jmp */
 				{
@@ -7643,34 +11402,27 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					_nmd_append_string(&si, "mov ");
 					if (op == 0xa0)
 					{
-						_nmd_append_string(&si, "al,");
-						_nmd_append_modrm_memory_prefix(&si, "byte");
-						*si.buffer++ = '[';
-						_nmd_append_number(&si, (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFFFF : 0xFFFFFFFFFFFFFFFF) & instruction->immediate);
-						*si.buffer++ = ']';
+						_nmd_append_register(&si, "al");
+						_nmd_append_separator(&si);
+						_nmd_append_moffs(&si, "byte");
 					}
 					else if (op == 0xa1)
 					{
-						_nmd_append_string(&si, instruction->operandSize64 ? "rax," : (operandSize ? "ax," : "eax,"));
-						_nmd_append_modrm_memory_prefix(&si, instruction->operandSize64 ? "qword" : (operandSize ? "word" : "dword"));
-						*si.buffer++ = '[';
-						_nmd_append_number(&si, (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFFFF : 0xFFFFFFFFFFFFFFFF) & instruction->immediate);
-						*si.buffer++ = ']';
+						_nmd_append_register(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
+						_nmd_append_separator(&si);
+						_nmd_append_moffs(&si, instruction->operandSize64 ? "qword" : (operandSize ? "word" : "dword"));
 					}
 					else if (op == 0xa2)
 					{
-						_nmd_append_modrm_memory_prefix(&si, "byte");
-						*si.buffer++ = '[';
-						_nmd_append_number(&si, (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFFFF : 0xFFFFFFFFFFFFFFFF) & instruction->immediate);
-						_nmd_append_string(&si, "],al");
+						_nmd_append_moffs(&si, "byte");
+						_nmd_append_separator(&si);
+						_nmd_append_register(&si, "al");
 					}
 					else if (op == 0xa3)
 					{
-						_nmd_append_modrm_memory_prefix(&si, instruction->operandSize64 ? "qword" : (operandSize ? "word" : "dword"));
-						*si.buffer++ = '[';
-						_nmd_append_number(&si, (instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE || instruction->mode == NMD_X86_MODE_16 ? 0xFFFF : 0xFFFFFFFFFFFFFFFF) & instruction->immediate);
-						_nmd_append_string(&si, "],");
-						_nmd_append_string(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
+						_nmd_append_moffs(&si, instruction->operandSize64 ? "qword" : (operandSize ? "word" : "dword"));
+						_nmd_append_separator(&si);
+						_nmd_append_register(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
 					}
 				}
 				else if(op == 0xcc) /* int3 */
@@ -7679,14 +11431,14 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 					_nmd_append_string(&si, "lea ");
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_modrm_upper_without_address_specifier(&si);
 				}
 				else if (op == 0x8f) /* pop */
 				{
 					_nmd_append_string(&si, "pop ");
 					if (instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
+						_nmd_append_register(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
 					else
 						_nmd_append_modrm_upper(&si, instruction->mode == NMD_X86_MODE_64 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE) ? "qword" : (operandSize ? "word" : "dword"));
 				}
@@ -7699,21 +11451,29 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				}
 				else if (op == 0xa8) /* test */
 				{
-					_nmd_append_string(&si, "test al,");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_string(&si, "test ");
+					_nmd_append_register(&si, "al");
+					_nmd_append_separator(&si);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xa9) /* test */
 				{
-					_nmd_append_string(&si, instruction->operandSize64 ? "test rax" : (operandSize ? "test ax" : "test eax"));
-					*si.buffer++ = ',';
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_string(&si, "test ");
+					_nmd_append_register(&si, instruction->operandSize64 ? "rax" : (operandSize ? "ax" : "eax"));
+					_nmd_append_separator(&si);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0x90)
 				{
 					if (instruction->prefixes & NMD_X86_PREFIXES_REPEAT)
 						_nmd_append_string(&si, "pause");
 					else if (instruction->prefixes & NMD_X86_PREFIXES_REX_B)
-						_nmd_append_string(&si, instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "xchg r8,rax" : "xchg r8d,eax");
+					{
+						_nmd_append_string(&si, "xchg ");
+						_nmd_append_register(&si, instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "r8" : "r8d");
+						_nmd_append_separator(&si);
+						_nmd_append_register(&si, instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "rax" : "eax");
+					}
 					else
 						_nmd_append_string(&si, "nop");
 				}
@@ -7723,11 +11483,11 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 					_nmd_append_string(&si, "mov ");
 					if (instruction->prefixes & NMD_X86_PREFIXES_REX_B)
-						_nmd_append_string(&si, _nmd_regrx[op % 8]), * si.buffer++ = NMD_C(op) < 8 ? 'b' : 'd';
+						_nmd_append_register(&si, _nmd_regrx[op % 8]), * si.buffer++ = NMD_C(op) < 8 ? 'b' : 'd';
 					else
-						_nmd_append_string(&si, (NMD_C(op) < 8 ? (instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8) : (instruction->operandSize64 ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32)))[op % 8]);
-					*si.buffer++ = ',';
-					_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_register(&si, (NMD_C(op) < 8 ? (instruction->hasRex ? _nmd_reg8_x64 : _nmd_reg8) : (instruction->operandSize64 ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32)))[op % 8]);
+					_nmd_append_separator(&si);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xfe) /* inc,dec */
 				{
@@ -7745,26 +11505,26 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 
 					if (instruction->modrm.fields.reg <= 0b001)
 					{
-						*si.buffer++ = ',';
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_separator(&si);
+						_nmd_append_immediate(&si, instruction->immediate);
 					}
 				}				
 				else if (op == 0x69 || op == 0x6B)
 				{
 					_nmd_append_string(&si, "imul ");
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Ev(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (op == 0x6b)
 					{
 						if (si.formatFlags & NMD_X86_FORMAT_FLAGS_SIGNED_NUMBER_MEMORY_VIEW && instruction->immediate >= 0x80)
 							_nmd_append_signed_number_memory_view(&si);
 						else
-							_nmd_append_signed_number(&si, (int8_t)instruction->immediate, false);
+							_nmd_append_signed_immediate(&si, (int8_t)instruction->immediate);
 					}
 					else
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op >= 0x84 && op <= 0x87)
 				{
@@ -7772,21 +11532,21 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					if (op % 2 == 0)
 					{
 						_nmd_append_Eb(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gb(&si);
 					}
 					else
 					{
 						_nmd_append_Ev(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gv(&si);
 					}
 				}
 				else if (op == 0x8e)
 				{
 					_nmd_append_string(&si, "mov ");
-					_nmd_append_string(&si, _nmd_segmentReg[instruction->modrm.fields.reg]);
-					*si.buffer++ = ',';
+					_nmd_append_register(&si, _nmd_segmentReg[instruction->modrm.fields.reg]);
+					_nmd_append_separator(&si);
 					_nmd_append_Ew(&si);
 				}
 				else if (op >= 0x91 && op <= 0x97)
@@ -7794,20 +11554,19 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					_nmd_append_string(&si, "xchg ");
 					if (instruction->prefixes & NMD_X86_PREFIXES_REX_B)
 					{
-						_nmd_append_string(&si, _nmd_regrx[NMD_C(op)]);
+						_nmd_append_register(&si, _nmd_regrx[NMD_C(op)]);
 						if (!(instruction->prefixes & NMD_X86_PREFIXES_REX_W))
 							*si.buffer++ = 'd';
 					}
 					else
-						_nmd_append_string(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32))[NMD_C(op)]);
-					_nmd_append_string(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? ",rax" : (operandSize ? ",ax" : ",eax")));
+						_nmd_append_register(&si, (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? _nmd_reg64 : (operandSize ? _nmd_reg16 : _nmd_reg32))[NMD_C(op)]);
+					_nmd_append_separator(&si);
+					_nmd_append_register(&si, instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "rax" : (operandSize ? "ax" : "eax"));
 				}
 				else if (op == 0x9A)
 				{
-					_nmd_append_string(&si, "call far ");
-					_nmd_append_number(&si, (uint64_t)(*(uint16_t*)((char*)(&instruction->immediate) + (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 2 : 4))));
-					*si.buffer++ = ':';
-					_nmd_append_number(&si, (uint64_t)(operandSize ? *((uint16_t*)(&instruction->immediate)) : *((uint32_t*)(&instruction->immediate))));
+					_nmd_append_string(&si, _NMD_IS_ATT_SYNTAX(&si) ? "lcall " : "call far ");
+					_nmd_append_far_pointer(&si);
 				}
 				else if ((op >= 0x6c && op <= 0x6f) || (op >= 0xa4 && op <= 0xa7) || (op >= 0xaa && op <= 0xaf))
 				{
@@ -7828,7 +11587,10 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					case 0xae: case 0xaf: str = "scas"; break;
 					}
 					_nmd_append_string(&si, str);
-					*si.buffer++ = (op % 2 == 0) ? 'b' : (operandSize ? 'w' : 'd');
+					if (_NMD_IS_ATT_SYNTAX(&si))
+						*si.buffer++ = (op % 2 == 0) ? 'b' : (instruction->operandSize64 ? 'q' : (operandSize ? 'w' : 'l'));
+					else
+						*si.buffer++ = (op % 2 == 0) ? 'b' : (operandSize ? 'w' : 'd');
 				}
 				else if (op == 0xC0 || op == 0xC1 || (NMD_R(op) == 0xd && NMD_C(op) < 4))
 				{
@@ -7838,18 +11600,22 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						_nmd_append_Eb(&si);
 					else
 						_nmd_append_Ev(&si);
-					*si.buffer++ = ',';
-					if (NMD_R(op) == 0xc)
-						_nmd_append_number(&si, instruction->immediate);
-					else if (NMD_C(op) < 2)
-						_nmd_append_number(&si, 1);
-					else
-						_nmd_append_string(&si, "cl");
+					/* AT&T syntax omits the count of one, e.g. 'shll (%eax)'. */
+					if (!(_NMD_IS_ATT_SYNTAX(&si) && NMD_R(op) == 0xd && NMD_C(op) < 2))
+					{
+						_nmd_append_separator(&si);
+						if (NMD_R(op) == 0xc)
+							_nmd_append_immediate(&si, instruction->immediate);
+						else if (NMD_C(op) < 2)
+							_nmd_append_number(&si, 1);
+						else
+							_nmd_append_register(&si, "cl");
+					}
 				}
 				else if (op == 0xc2)
 				{
 					_nmd_append_string(&si, "ret ");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op >= 0xe0 && op <= 0xe3)
 				{
@@ -7860,34 +11626,32 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				}
 				else if (op == 0xea)
 				{
-					_nmd_append_string(&si, "jmp far ");
-					_nmd_append_number(&si, (uint64_t)(*(uint16_t*)(((uint8_t*)(&instruction->immediate) + 4))));
-					*si.buffer++ = ':';
-					_nmd_append_number(&si, (uint64_t)(*(uint32_t*)(&instruction->immediate)));
+					_nmd_append_string(&si, _NMD_IS_ATT_SYNTAX(&si) ? "ljmp " : "jmp far ");
+					_nmd_append_far_pointer(&si);
 				}
 				else if (op == 0xca)
 				{
-					_nmd_append_string(&si, "ret far");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_string(&si, _NMD_IS_ATT_SYNTAX(&si) ? "lret " : "ret far ");
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xcd)
 				{
 					_nmd_append_string(&si, "int ");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0x63)
 				{
 					if (instruction->mode == NMD_X86_MODE_64)
 					{
-						_nmd_append_string(&si, "movsxd ");
-						_nmd_append_string(&si, (instruction->mode == NMD_X86_MODE_64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_R ? _nmd_regrx : _nmd_reg64) : (operandSize ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.reg]);
-						*si.buffer++ = ',';
+						_nmd_append_string(&si, _NMD_IS_ATT_SYNTAX(&si) && instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "movslq " : "movsxd ");
+						_nmd_append_register(&si, (instruction->mode == NMD_X86_MODE_64 ? (instruction->prefixes & NMD_X86_PREFIXES_REX_R ? _nmd_regrx : _nmd_reg64) : (operandSize ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.reg]);
+						_nmd_append_separator(&si);
 						if (instruction->modrm.fields.mod == 0b11)
 						{
 							if (instruction->prefixes & NMD_X86_PREFIXES_REX_B)
-								_nmd_append_string(&si, _nmd_regrx[instruction->modrm.fields.rm]), * si.buffer++ = 'd';
+								_nmd_append_register(&si, _nmd_regrx[instruction->modrm.fields.rm]), * si.buffer++ = 'd';
 							else
-								_nmd_append_string(&si, ((instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && instruction->mode == NMD_X86_MODE_32) || (instruction->mode == NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
+								_nmd_append_register(&si, ((instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && instruction->mode == NMD_X86_MODE_32) || (instruction->mode == NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
 						}
 						else
 							_nmd_append_modrm_upper(&si, (instruction->operandSize64 && !(instruction->prefixes & NMD_X86_PREFIXES_REX_W)) ? "qword" : ((instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && instruction->mode == NMD_X86_MODE_32) || (instruction->mode == NMD_X86_MODE_16 && !(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)) ? "word" : "dword"));
@@ -7896,7 +11660,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					{
 						_nmd_append_string(&si, "arpl ");
 						_nmd_append_Ew(&si);
-						*si.buffer++ = ',';
+						_nmd_append_separator(&si);
 						_nmd_append_Gw(&si);
 					}
 				}
@@ -7905,9 +11669,9 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					_nmd_append_string(&si, op == 0xc4 ? "les" : "lds");
 					*si.buffer++ = ' ';
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, (si.instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[si.instruction->modrm.fields.rm]);
+						_nmd_append_register(&si, (si.instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[si.instruction->modrm.fields.rm]);
 					else
 						_nmd_append_modrm_upper(&si, si.instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "dword" : "fword");
 				}
@@ -7917,7 +11681,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					if (instruction->modrm.fields.reg == 0b111)
 					{
 						if (op == 0xc6)
-							_nmd_append_number(&si, instruction->immediate);
+							_nmd_append_immediate(&si, instruction->immediate);
 						else
 							_nmd_append_relative_address16_32(&si);
 					}
@@ -7927,26 +11691,26 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 							_nmd_append_Eb(&si);
 						else
 							_nmd_append_Ev(&si);
-						*si.buffer++ = ',';
-						_nmd_append_number(&si, instruction->immediate);
+						_nmd_append_separator(&si);
+						_nmd_append_immediate(&si, instruction->immediate);
 					}
 				}
 				else if (op == 0xc8)
 				{
 					_nmd_append_string(&si, "enter ");
-					_nmd_append_number(&si, (uint64_t)(*(uint16_t*)(&instruction->immediate)));
-					*si.buffer++ = ',';
-					_nmd_append_number(&si, (uint64_t)(*((uint8_t*)(&instruction->immediate) + 2)));
+					_nmd_append_immediate(&si, (uint64_t)(uint16_t)instruction->immediate);
+					_nmd_append_separator(&si);
+					_nmd_append_immediate(&si, (uint64_t)(*((uint8_t*)(&instruction->immediate) + 2)));
 				}				
 				else if (op == 0xd4)
 				{
 					_nmd_append_string(&si, "aam ");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xd5)
 				{
 					_nmd_append_string(&si, "aad ");
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op >= 0xd8 && op <= 0xdf)
 				{
@@ -7973,21 +11737,26 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						{
 						case 0xd8:
 							_nmd_append_string(&si, _nmd_escapeOpcodesD8[(NMD_R(instruction->modrm.modrm) - 0xc) * 2 + (NMD_C(instruction->modrm.modrm) > 7 ? 1 : 0)]);
-							_nmd_append_string(&si, " st(0),st(");
-							*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8), * si.buffer++ = ')';
+							*si.buffer++ = ' ';
+							_nmd_append_st(&si, 0);
+							_nmd_append_separator(&si);
+							_nmd_append_st(&si, instruction->modrm.modrm % 8);
 							break;
 						case 0xd9:
 							if (NMD_R(instruction->modrm.modrm) == 0xc)
 							{
 								_nmd_append_string(&si, NMD_C(instruction->modrm.modrm) < 8 ? "ld" : "xch");
-								_nmd_append_string(&si, " st(0),st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8), * si.buffer++ = ')';
+								*si.buffer++ = ' ';
+								_nmd_append_st(&si, 0);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
 							}
 							else if (instruction->modrm.modrm >= 0xd8 && instruction->modrm.modrm <= 0xdf)
 							{
-								_nmd_append_string(&si, "stpnce st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-								_nmd_append_string(&si, "),st(0)");
+								_nmd_append_string(&si, "stpnce ");
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, 0);
 							}
 							else
 							{
@@ -8033,9 +11802,10 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 							{
 								const char* mnemonics[4] = { "cmovb", "cmovbe", "cmove", "cmovu" };
 								_nmd_append_string(&si, mnemonics[(NMD_R(instruction->modrm.modrm) - 0xc) + (NMD_C(instruction->modrm.modrm) > 7 ? 2 : 0)]);
-								_nmd_append_string(&si, " st(0),st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-								*si.buffer++ = ')';
+								*si.buffer++ = ' ';
+								_nmd_append_st(&si, 0);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
 							}
 							break;
 						case 0xdb:
@@ -8060,9 +11830,10 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 									else
 										_nmd_append_string(&si, "be");
 								}
-								_nmd_append_string(&si, " st(0),st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-								*si.buffer++ = ')';
+								*si.buffer++ = ' ';
+								_nmd_append_st(&si, 0);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
 							}
 							break;
 						case 0xdc:
@@ -8085,15 +11856,17 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 
 							if (NMD_R(instruction->modrm.modrm) == 0xd)
 							{
-								_nmd_append_string(&si, " st(0),st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-								*si.buffer++ = ')';
+								*si.buffer++ = ' ';
+								_nmd_append_st(&si, 0);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
 							}
 							else
 							{
-								_nmd_append_string(&si, " st(");
-								*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-								_nmd_append_string(&si, "),st(0)");
+								*si.buffer++ = ' ';
+								_nmd_append_st(&si, instruction->modrm.modrm % 8);
+								_nmd_append_separator(&si);
+								_nmd_append_st(&si, 0);
 							}
 							break;
 						case 0xdd:
@@ -8106,9 +11879,8 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 									*si.buffer++ = 'p';
 							}
 
-							_nmd_append_string(&si, " st(");
-							*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-							*si.buffer++ = ')';
+							*si.buffer++ = ' ';
+							_nmd_append_st(&si, instruction->modrm.modrm % 8);
 
 							break;
 						case 0xde:
@@ -8118,9 +11890,10 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 							{
 								if (instruction->modrm.modrm >= 0xd0 && instruction->modrm.modrm <= 0xd7)
 								{
-									_nmd_append_string(&si, "comp st(0),st(");
-									*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-									*si.buffer++ = ')';
+									_nmd_append_string(&si, "comp ");
+									_nmd_append_st(&si, 0);
+									_nmd_append_separator(&si);
+									_nmd_append_st(&si, instruction->modrm.modrm % 8);
 								}
 								else
 								{
@@ -8132,15 +11905,19 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 										if (NMD_R(instruction->modrm.modrm) < 8 || (NMD_R(instruction->modrm.modrm) >= 0xe && NMD_C(instruction->modrm.modrm) < 8))
 											*si.buffer++ = 'r';
 									}
-									_nmd_append_string(&si, "p st(");
-									*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-									_nmd_append_string(&si, "),st(0)");
+									_nmd_append_string(&si, "p ");
+									_nmd_append_st(&si, instruction->modrm.modrm % 8);
+									_nmd_append_separator(&si);
+									_nmd_append_st(&si, 0);
 								}
 							}
 							break;
 						case 0xdf:
 							if (instruction->modrm.modrm == 0xe0)
-								_nmd_append_string(&si, "nstsw ax");
+							{
+								_nmd_append_string(&si, "nstsw ");
+								_nmd_append_register(&si, "ax");
+							}
 							else
 							{
 								if (instruction->modrm.modrm >= 0xe8)
@@ -8148,16 +11925,16 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 									if (instruction->modrm.modrm < 0xf0)
 										*si.buffer++ = 'u';
 									_nmd_append_string(&si, "comip");
-									_nmd_append_string(&si, " st(0),st(");
-									*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-									*si.buffer++ = ')';
+									*si.buffer++ = ' ';
+									_nmd_append_st(&si, 0);
+									_nmd_append_separator(&si);
+									_nmd_append_st(&si, instruction->modrm.modrm % 8);
 								}
 								else
 								{
 									_nmd_append_string(&si, instruction->modrm.modrm < 0xc8 ? "freep" : (instruction->modrm.modrm >= 0xd0 ? "stp" : "xch"));
-									_nmd_append_string(&si, " st(");
-									*si.buffer++ = (char)('0' + instruction->modrm.modrm % 8);
-									*si.buffer++ = ')';
+									*si.buffer++ = ' ';
+									_nmd_append_st(&si, instruction->modrm.modrm % 8);
 								}
 							}
 
@@ -8168,33 +11945,41 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				else if (op == 0xe4 || op == 0xe5)
 				{
 					_nmd_append_string(&si, "in ");
-					_nmd_append_string(&si, op == 0xe4 ? "al" : (operandSize ? "ax" : "eax"));
-					*si.buffer++ = ',';
-					_nmd_append_number(&si, instruction->immediate);
+					_nmd_append_register(&si, op == 0xe4 ? "al" : (operandSize ? "ax" : "eax"));
+					_nmd_append_separator(&si);
+					_nmd_append_immediate(&si, instruction->immediate);
 				}
 				else if (op == 0xe6 || op == 0xe7)
 				{
 					_nmd_append_string(&si, "out ");
-					_nmd_append_number(&si, instruction->immediate);
-					*si.buffer++ = ',';
-					_nmd_append_string(&si, op == 0xe6 ? "al" : (operandSize ? "ax" : "eax"));
+					_nmd_append_immediate(&si, instruction->immediate);
+					_nmd_append_separator(&si);
+					_nmd_append_register(&si, op == 0xe6 ? "al" : (operandSize ? "ax" : "eax"));
 				}				
 				else if (op == 0xec || op == 0xed)
 				{
 					_nmd_append_string(&si, "in ");
-					_nmd_append_string(&si, op == 0xec ? "al" : (operandSize ? "ax" : "eax"));
-					_nmd_append_string(&si, ",dx");
+					_nmd_append_register(&si, op == 0xec ? "al" : (operandSize ? "ax" : "eax"));
+					_nmd_append_separator(&si);
+					_nmd_append_register(&si, "dx");
 				}
 				else if (op == 0xee || op == 0xef)
 				{
-					_nmd_append_string(&si, "out dx,");
-					_nmd_append_string(&si, op == 0xee ? "al" : (operandSize ? "ax" : "eax"));
+					_nmd_append_string(&si, "out ");
+					_nmd_append_register(&si, "dx");
+					_nmd_append_separator(&si);
+					_nmd_append_register(&si, op == 0xee ? "al" : (operandSize ? "ax" : "eax"));
+				}
+				else if (op < 0x20 && (op % 8 == 6 || op % 8 == 7)) /* push,pop [es,cs,ss,ds] */
+				{
+					_nmd_append_string(&si, op % 8 == 6 ? "push " : "pop ");
+					_nmd_append_register(&si, _nmd_segmentReg[op >> 3]);
 				}
 				else if (op == 0x62)
 				{
 					_nmd_append_string(&si, "bound ");
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_modrm_upper(&si, operandSize ? "dword" : "qword");
 				}
 				else /* Try to parse all opcodes not parsed by the checks above. */
@@ -8222,16 +12007,9 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					case 0x61:
 						str = operandSize ? (instruction->opcode == 0x60 ? "pusha" : "popa") : (instruction->opcode == 0x60 ? "pushad" : "popad");
 						break;
-					case 0xcb: str = "retf"; break;
+					case 0xcb: str = _NMD_IS_ATT_SYNTAX(&si) ? "lret" : "retf"; break;
 					case 0xc9: str = "leave"; break;
 					case 0xf1: str = "int1"; break;
-					case 0x06: str = "push es"; break;
-					case 0x16: str = "push ss"; break;
-					case 0x1e: str = "push ds"; break;
-					case 0x0e: str = "push cs"; break;
-					case 0x07: str = "pop es"; break;
-					case 0x17: str = "pop ss"; break;
-					case 0x1f: str = "pop ds"; break;
 					case 0x27: str = "daa"; break;
 					case 0x37: str = "aaa"; break;
 					case 0x2f: str = "das"; break;
@@ -8251,8 +12029,18 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						else
 							str = operandSize ? "iret" : "iretd";
 						break;
-					case 0x98: str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cdqe" : (operandSize ? "cbw" : "cwde")); break;
-					case 0x99: str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cqo" : (operandSize ? "cwd" : "cdq")); break;
+					case 0x98:
+						if (_NMD_IS_ATT_SYNTAX(&si))
+							str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cltq" : (operandSize ? "cbtw" : "cwtl"));
+						else
+							str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cdqe" : (operandSize ? "cbw" : "cwde"));
+						break;
+					case 0x99:
+						if (_NMD_IS_ATT_SYNTAX(&si))
+							str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cqto" : (operandSize ? "cwtd" : "cltd"));
+						else
+							str = (instruction->prefixes & NMD_X86_PREFIXES_REX_W ? "cqo" : (operandSize ? "cwd" : "cdq"));
+						break;
 					case 0xd6: str = "salc"; break;
 					case 0xf8: str = "clc"; break;
 					case 0xf9: str = "stc"; break;
@@ -8285,7 +12073,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			_nmd_append_string(&si, _nmd_conditionSuffixes[NMD_C(op)]);
 			*si.buffer++ = ' ';
 			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
+			_nmd_append_separator(&si);
 			_nmd_append_Ev(&si);
 		}
 		else if (op >= 0x10 && op <= 0x17)
@@ -8301,20 +12089,20 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 0:
 					_nmd_append_Vx(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				case 1:
 					_nmd_append_W(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vx(&si);
 					break;
 				case 2:
 				case 6:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
@@ -8333,24 +12121,24 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 0:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "dword");
 					break;
 				case 1:
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "dword");
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				case 2:
 				case 6:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				}
@@ -8367,18 +12155,18 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				case 0:
 				case 2:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
 				case 1:
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				}
@@ -8399,20 +12187,20 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 0:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				case 1:
 					_nmd_append_W(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				case 2:
 				case 6:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
@@ -8427,16 +12215,16 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			case 3:
 			case 7:
 				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+					_nmd_append_Udq(&si);
 				else
 					_nmd_append_modrm_upper(&si, "qword");
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				_nmd_append_Vdq(&si);
 				break;
 			case 4:
 			case 5:
 				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				_nmd_append_W(&si);
 				break;
 			};
@@ -8447,11 +12235,12 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			{
 				_nmd_append_string(&si, "movd ");
 				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-					*si.buffer++ = 'x';
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
+					_nmd_append_Vdq(&si);
+				else
+					_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
 				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, _nmd_reg32[si.instruction->modrm.fields.rm]);
+					_nmd_append_register(&si, _nmd_reg32[si.instruction->modrm.fields.rm]);
 				else
 					_nmd_append_modrm_upper(&si, "dword");
 			}
@@ -8464,14 +12253,14 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					_nmd_append_string(&si, op == 0x74 ? "pcmpeqb" : (op == 0x75 ? "pcmpeqw" : (op == 0x76 ? "pcmpeqd" : prefix66Mnemonics[op % 0x10])));
 					*si.buffer++ = ' ';
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 				}
 				else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
 				{
 					_nmd_append_string(&si, "movdqu ");
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 				}
 				else
@@ -8481,7 +12270,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 					_nmd_append_string(&si, op == 0x74 ? "pcmpeqb" : (op == 0x75 ? "pcmpeqw" : (op == 0x76 ? "pcmpeqd" : noPrefixMnemonics[op % 0x10])));
 					*si.buffer++ = ' ';
 					_nmd_append_Pq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Qq(&si);
 				}
 			}
@@ -8508,14 +12297,17 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				else if (instruction->modrm.fields.reg == 0b011)
 				{
 					_nmd_append_string(&si, _nmd_opcodeExtensionsGrp7reg3[instruction->modrm.fields.rm]);
-					if (instruction->modrm.fields.rm == 0b000 || instruction->modrm.fields.rm == 0b010 || instruction->modrm.fields.rm == 0b111)
-						_nmd_append_string(&si, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "ax" : "eax");
+					if (instruction->modrm.fields.rm == 0b000 || instruction->modrm.fields.rm == 0b010 || instruction->modrm.fields.rm == 0b110 || instruction->modrm.fields.rm == 0b111)
+						_nmd_append_register(&si, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE && instruction->modrm.fields.rm != 0b110 ? "ax" : "eax");
 
 					if (instruction->modrm.fields.rm == 0b111)
-						_nmd_append_string(&si, ",ecx");
+					{
+						_nmd_append_separator(&si);
+						_nmd_append_register(&si, "ecx");
+					}
 				}
 				else if (instruction->modrm.fields.reg == 0b100)
-					_nmd_append_string(&si, "smsw "), _nmd_append_string(&si, (instruction->operandSize64 ? _nmd_reg64 : (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.rm]);
+					_nmd_append_string(&si, "smsw "), _nmd_append_register(&si, (instruction->operandSize64 ? _nmd_reg64 : (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.rm]);
 				else if (instruction->modrm.fields.reg == 0b101)
 				{
 					if (instruction->prefixes & NMD_X86_PREFIXES_REPEAT)
@@ -8524,12 +12316,12 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 						_nmd_append_string(&si, instruction->modrm.fields.rm == 0b111 ? "wrpkru" : "rdpkru");
 				}
 				else if (instruction->modrm.fields.reg == 0b110)
-					_nmd_append_string(&si, "lmsw "), _nmd_append_string(&si, _nmd_reg16[instruction->modrm.fields.rm]);
+					_nmd_append_string(&si, "lmsw "), _nmd_append_register(&si, _nmd_reg16[instruction->modrm.fields.rm]);
 				else if (instruction->modrm.fields.reg == 0b111)
 				{
 					_nmd_append_string(&si, _nmd_opcodeExtensionsGrp7reg7[instruction->modrm.fields.rm]);
 					if (instruction->modrm.fields.rm == 0b100)
-						_nmd_append_string(&si, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "ax" : "eax");
+						_nmd_append_register(&si, instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "ax" : "eax");
 				}
 			}
 			else
@@ -8555,9 +12347,9 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			_nmd_append_string(&si, op == 0x02 ? "lar" : "lsl");
 			*si.buffer++ = ' ';
 			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
+			_nmd_append_separator(&si);
 			if (si.instruction->modrm.fields.mod == 0b11)
-				_nmd_append_string(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[si.instruction->modrm.fields.rm]);
+				_nmd_append_register(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[si.instruction->modrm.fields.rm]);
 			else
 				_nmd_append_modrm_upper(&si, "word");
 		}
@@ -8566,9 +12358,9 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			if (instruction->modrm.fields.mod == 0b11)
 			{
 				_nmd_append_string(&si, "nop ");
-				_nmd_append_string(&si, (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
-				*si.buffer++ = ',';
-				_nmd_append_string(&si, (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.reg]);
+				_nmd_append_register(&si, (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.rm]);
+				_nmd_append_separator(&si);
+				_nmd_append_register(&si, (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? _nmd_reg16 : _nmd_reg32)[instruction->modrm.fields.reg]);
 			}
 			else
 			{
@@ -8608,7 +12400,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 		{
 			_nmd_append_string(&si, "nop ");
 			_nmd_append_Ev(&si);
-			*si.buffer++ = ',';
+			_nmd_append_separator(&si);
 			_nmd_append_Gv(&si);
 		}
 		else if (op == 0x1A)
@@ -8617,7 +12409,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			{
 				_nmd_append_string(&si, "nop ");
 				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				_nmd_append_Gv(&si);
 			}
 			else
@@ -8631,12 +12423,14 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				else
 					_nmd_append_string(&si, "bndldx");
 
-				_nmd_append_string(&si, " bnd");
+				*si.buffer++ = ' ';
+				_nmd_append_register(&si, "bnd");
 				*si.buffer++ = (char)('0' + instruction->modrm.fields.reg);
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-					*si.buffer++ = 'q';
-				_nmd_append_Ev(&si);
+					_nmd_append_modrm_upper(&si, "qword");
+				else
+					_nmd_append_Ev(&si);
 			}
 		}
 		else if (op == 0x1B)
@@ -8645,7 +12439,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			{
 				_nmd_append_string(&si, "nop ");
 				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				_nmd_append_Gv(&si);
 			}
 			else
@@ -8661,8 +12455,8 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 
 				*si.buffer++ = ' ';
 				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
-				_nmd_append_string(&si, "bnd");
+				_nmd_append_separator(&si);
+				_nmd_append_register(&si, "bnd");
 				*si.buffer++ = (char)('0' + instruction->modrm.fields.reg);
 			}
 		}
@@ -8676,7 +12470,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			{
 				_nmd_append_string(&si, "nop ");
 				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
 				_nmd_append_Gv(&si);
 			}
 		}
@@ -8685,16 +12479,17 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			_nmd_append_string(&si, "mov ");
 			if (op < 0x22)
 			{
-				_nmd_append_string(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
-				_nmd_append_string(&si, op == 0x20 ? ",cr" : ",dr");
+				_nmd_append_register(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
+				_nmd_append_separator(&si);
+				_nmd_append_register(&si, op == 0x20 ? "cr" : "dr");
 				*si.buffer++ = (char)('0' + instruction->modrm.fields.reg);
 			}
 			else
 			{
-				_nmd_append_string(&si, op == 0x22 ? "cr" : "dr");
+				_nmd_append_register(&si, op == 0x22 ? "cr" : "dr");
 				*si.buffer++ = (char)('0' + instruction->modrm.fields.reg);
-				*si.buffer++ = ',';
-				_nmd_append_string(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
+				_nmd_append_separator(&si);
+				_nmd_append_register(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
 			}
 		}
 		else if (op >= 0x28 && op <= 0x2f)
@@ -8710,38 +12505,38 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 0:
 					_nmd_append_Vx(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				case 1:
 					_nmd_append_W(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vx(&si);
 					break;
 				case 2:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Qq(&si);
 					break;
 				case 4:
 				case 5:
 					_nmd_append_Pq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				case 6:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
 				case 7:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 				default:
@@ -8759,13 +12554,13 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 3:
 					_nmd_append_modrm_upper(&si, "dword");
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				case 4:
 				case 5:
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (instruction->modrm.fields.mod == 0b11)
 						_nmd_append_Udq(&si);
 					else
@@ -8774,7 +12569,7 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				case 2:
 				case 6:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Ev(&si);
 					break;
 				}
@@ -8790,20 +12585,20 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 2:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Ev(&si);
 					break;
 				case 3:
 					_nmd_append_modrm_upper(&si, "qword");
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				case 4:
 				case 5:
 					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
@@ -8820,34 +12615,34 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 				{
 				case 0:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_W(&si);
 					break;
 				case 1:
 					_nmd_append_W(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Vdq(&si);
 					break;
 				case 4:
 				case 5:
 					_nmd_append_Pq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "qword");
 					break;
 				case 2:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					_nmd_append_Qq(&si);
 					break;
 				case 6:
 				case 7:
 					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+					_nmd_append_separator(&si);
 					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+						_nmd_append_Udq(&si);
 					else
 						_nmd_append_modrm_upper(&si, "dword");
 					break;
@@ -8860,1165 +12655,2709 @@ void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* bu
 			if (!(instruction->prefixes & (NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)) && (op % 8) == 3)
 			{
 				_nmd_append_modrm_upper(&si, "xmmword");
-				*si.buffer++ = ',';
+				_nmd_append_separator(&si);
+				_nmd_append_Vdq(&si);
+			}
+		}
+		else if (NMD_R(op) == 5)
+		{
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+			{
+				const char* prefix66Mnemonics[] = { "movmskpd", "sqrtpd", 0, 0, "andpd", "andnpd", "orpd", "xorpd", "addpd", "mulpd", "cvtpd2ps",  "cvtps2dq", "subpd", "minpd", "divpd", "maxpd" };
+
+				_nmd_append_string(&si, prefix66Mnemonics[op % 0x10]);
+				*si.buffer++ = ' ';
+				if (op == 0x50)
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+				else
+					_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_W(&si);
+			}
+			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+			{
+				const char* prefixF3Mnemonics[] = { 0, "sqrtss", "rsqrtss", "rcpss", 0, 0, 0, 0, "addss", "mulss", "cvtss2sd", "cvttps2dq", "subss", "minss", "divss", "maxss" };
+
+				_nmd_append_string(&si, prefixF3Mnemonics[op % 0x10]);
+				*si.buffer++ = ' ';
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Udq(&si);
+				else
+					_nmd_append_modrm_upper(&si, op == 0x5b ? "xmmword" : "dword");
+			}
+			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+			{
+				const char* prefixF2Mnemonics[] = { 0, "sqrtsd", 0, 0, 0, 0, 0, 0, "addsd", "mulsd", "cvtsd2ss", 0, "subsd", "minsd", "divsd", "maxsd" };
+
+				_nmd_append_string(&si, prefixF2Mnemonics[op % 0x10]);
+				*si.buffer++ = ' ';
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Udq(&si);
+				else
+					_nmd_append_modrm_upper(&si, "qword");
+			}
+			else
+			{
+				const char* noPrefixMnemonics[] = { "movmskps", "sqrtps", "rsqrtps", "rcpps", "andps", "andnps", "orps", "xorps", "addps", "mulps", "cvtps2pd",  "cvtdq2ps", "subps", "minps", "divps", "maxps" };
+
+				_nmd_append_string(&si, noPrefixMnemonics[op % 0x10]);
+				*si.buffer++ = ' ';
+				if (op == 0x50)
+				{
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+					_nmd_append_separator(&si);
+					_nmd_append_Udq(&si);
+				}
+				else
+				{
+					_nmd_append_Vdq(&si);
+					_nmd_append_separator(&si);
+					if (si.instruction->modrm.fields.mod == 0b11)
+						_nmd_append_Udq(&si);
+					else
+						_nmd_append_modrm_upper(&si, op == 0x5a ? "qword" : "xmmword");
+				}
+			}
+		}		
+		else if (op == 0x70)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "pshufd" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "pshufhw" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "pshuflw" : "pshufw")));
+			*si.buffer++ = ' ';
+			if (!(instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)))
+			{
+				_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Qq(&si);
+			}
+			else
+			{
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_W(&si);
+			}
+
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op >= 0x71 && op <= 0x73)
+		{
+			if (instruction->modrm.fields.reg % 2 == 1)
+				_nmd_append_string(&si, instruction->modrm.fields.reg == 0b111 ? "pslldq" : "psrldq");
+			else
+			{
+				const char* mnemonics[] = { "psrl", "psra", "psll" };
+				_nmd_append_string(&si, mnemonics[(instruction->modrm.fields.reg >> 1) - 1]);
+				*si.buffer++ = op == 0x71 ? 'w' : (op == 0x72 ? 'd' : 'q');
+			}
+
+			*si.buffer++ = ' ';
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+				_nmd_append_Udq(&si);
+			else
+				_nmd_append_Nq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op == 0x78)
+		{
+			if (!instruction->simdPrefix)
+			{
+				_nmd_append_string(&si, "vmread ");
+				_nmd_append_Ey(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gy(&si);
+			}
+			else
+			{
+				if(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+					_nmd_append_string(&si, "extrq ");
+				else
+				{ 
+					_nmd_append_string(&si, "insertq ");
+					_nmd_append_Vdq(&si);
+					_nmd_append_separator(&si);
+				}
+				_nmd_append_Udq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_immediate(&si, instruction->immediate & 0x00FF);
+				_nmd_append_separator(&si);
+				_nmd_append_immediate(&si, (instruction->immediate & 0xFF00) >> 8);
+			}
+		}
+		else if (op == 0x79)
+		{
+			if (!instruction->simdPrefix)
+			{
+				_nmd_append_string(&si, "vmwrite ");
+				_nmd_append_Gy(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Ey(&si);
+			}
+			else
+			{
+				_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "extrq " : "insertq ");
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Udq(&si);
+			}
+
+		}
+		else if (op == 0x7c || op == 0x7d)
+		{
+			_nmd_append_string(&si, op == 0x7c ? "haddp" : "hsubp");
+			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
+			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_W(&si);
+		}
+		else if (op == 0x7e)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movq " : "movd ");
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+			{
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Udq(&si);
+				else
+					_nmd_append_modrm_upper(&si, "qword");
+			}
+			else
+			{
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.rm]);
+				else
+					_nmd_append_modrm_upper(&si, "dword");
+				_nmd_append_separator(&si);
+				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+					_nmd_append_Vdq(&si);
+				else
+					_nmd_append_Pq(&si);
+			}
+		}
+		else if (op == 0x7f)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movdqu" : (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movdqa" : "movq"));
+			*si.buffer++ = ' ';
+			if (instruction->prefixes & (NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE))
+			{
+				_nmd_append_W(&si);
+				_nmd_append_separator(&si);
 				_nmd_append_Vdq(&si);
 			}
+			else
+			{
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Nq(&si);
+				else
+					_nmd_append_modrm_upper(&si, "qword");
+				_nmd_append_separator(&si);
+				_nmd_append_Pq(&si);
+			}
+		}		
+		else if (NMD_R(op) == 9)
+		{
+			_nmd_append_string(&si, "set");
+			_nmd_append_string(&si, _nmd_conditionSuffixes[NMD_C(op)]);
+			*si.buffer++ = ' ';
+			_nmd_append_Eb(&si);
+		}
+		else if ((NMD_R(op) == 0xA || NMD_R(op) == 0xB) && op % 8 == 3)
+		{
+			_nmd_append_string(&si, op == 0xa3 ? "bt" : (op == 0xb3 ? "btr" : (op == 0xab ? "bts" : "btc")));
+			*si.buffer++ = ' ';
+			_nmd_append_Ev(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_Gv(&si);
+		}
+		else if (NMD_R(op) == 0xA && (op % 8 == 4 || op % 8 == 5))
+		{
+			_nmd_append_string(&si, op > 0xA8 ? "shrd" : "shld");
+			*si.buffer++ = ' ';
+			_nmd_append_Ev(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			if (op % 8 == 4)
+				_nmd_append_immediate(&si, instruction->immediate);
+			else
+				_nmd_append_register(&si, "cl");
+		}
+		else if (op == 0xb4 || op == 0xb5)
+		{
+			_nmd_append_string(&si, op == 0xb4 ? "lfs " : "lgs ");
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_modrm_upper(&si, "fword");
+		}
+		else if (op == 0xbc || op == 0xbd)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? (op == 0xbc ? "tzcnt" : "lzcnt") : (op == 0xbc ? "bsf" : "bsr"));
+			*si.buffer++ = ' ';
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_Ev(&si);
 		}
-		else if (NMD_R(op) == 5)
+		else if (op == 0xa6)
 		{
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-			{
-				const char* prefix66Mnemonics[] = { "movmskpd", "sqrtpd", 0, 0, "andpd", "andnpd", "orpd", "xorpd", "addpd", "mulpd", "cvtpd2ps",  "cvtps2dq", "subpd", "minpd", "divpd", "maxpd" };
-
-				_nmd_append_string(&si, prefix66Mnemonics[op % 0x10]);
-				*si.buffer++ = ' ';
-				if (op == 0x50)
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-				else
-					_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_W(&si);
-			}
-			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
-			{
-				const char* prefixF3Mnemonics[] = { 0, "sqrtss", "rsqrtss", "rcpss", 0, 0, 0, 0, "addss", "mulss", "cvtss2sd", "cvttps2dq", "subss", "minss", "divss", "maxss" };
-
-				_nmd_append_string(&si, prefixF3Mnemonics[op % 0x10]);
-				*si.buffer++ = ' ';
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
-				else
-					_nmd_append_modrm_upper(&si, op == 0x5b ? "xmmword" : "dword");
-			}
-			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+			const char* mnemonics[] = { "montmul", "xsha1", "xsha256" };
+			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+		}
+		else if (op == 0xa7)
+		{
+			const char* mnemonics[] = { "xstorerng", "xcryptecb", "xcryptcbc", "xcryptctr", "xcryptcfb", "xcryptofb" };
+			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+		}
+		else if (op == 0xae)
+		{
+			if (instruction->modrm.fields.mod == 0b11)
 			{
-				const char* prefixF2Mnemonics[] = { 0, "sqrtsd", 0, 0, 0, 0, 0, 0, "addsd", "mulsd", "cvtsd2ss", 0, "subsd", "minsd", "divsd", "maxsd" };
-
-				_nmd_append_string(&si, prefixF2Mnemonics[op % 0x10]);
-				*si.buffer++ = ' ';
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
+				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+					_nmd_append_string(&si, "pcommit");
+				else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+				{
+					_nmd_append_string(&si, "incsspd ");
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.rm]);
+				}
 				else
-					_nmd_append_modrm_upper(&si, "qword");
+				{
+					const char* mnemonics[] = { "rdfsbase", "rdgsbase", "wrfsbase", "wrgsbase", 0, "lfence", "mfence", "sfence" };
+					_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+				}
 			}
 			else
 			{
-				const char* noPrefixMnemonics[] = { "movmskps", "sqrtps", "rsqrtps", "rcpps", "andps", "andnps", "orps", "xorps", "addps", "mulps", "cvtps2pd",  "cvtdq2ps", "subps", "minps", "divps", "maxps" };
-
-				_nmd_append_string(&si, noPrefixMnemonics[op % 0x10]);
-				*si.buffer++ = ' ';
-				if (op == 0x50)
+				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
 				{
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-					*si.buffer++ = ',';
-					_nmd_append_Udq(&si);
+					_nmd_append_string(&si, instruction->modrm.fields.reg == 0b110 ? "clwb " : "clflushopt ");
+					_nmd_append_modrm_upper(&si, "byte");
+				}
+				else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+				{
+					_nmd_append_string(&si, instruction->modrm.fields.reg == 0b100 ? "ptwrite " : "clrssbsy ");
+					_nmd_append_modrm_upper(&si, instruction->modrm.fields.reg == 0b100 ? "dword" : "qword");
 				}
 				else
 				{
-					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
-					if (si.instruction->modrm.fields.mod == 0b11)
-						_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + si.instruction->modrm.fields.rm);
-					else
-						_nmd_append_modrm_upper(&si, op == 0x5a ? "qword" : "xmmword");
+					const char* mnemonics[] = { "fxsave", "fxrstor", "ldmxcsr", "stmxcsr", "xsave", "xrstor", "xsaveopt", "clflush" };
+					_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+					*si.buffer++ = ' ';
+					_nmd_append_modrm_upper(&si, "dword");
 				}
 			}
-		}		
-		else if (op == 0x70)
+		}
+		else if (op == 0xaf)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "pshufd" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "pshufhw" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "pshuflw" : "pshufw")));
-			*si.buffer++ = ' ';
-			if (!(instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)))
+			_nmd_append_string(&si, "imul ");
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_Ev(&si);
+		}
+		else if (op == 0xb0 || op == 0xb1)
+		{
+			_nmd_append_string(&si, "cmpxchg ");
+			if (op == 0xb0)
 			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Qq(&si);
+				_nmd_append_Eb(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gb(&si);
 			}
 			else
 			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_W(&si);
+				_nmd_append_Ev(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gv(&si);
 			}
-
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
 		}
-		else if (op >= 0x71 && op <= 0x73)
+		else if (op == 0xb2)
 		{
-			if (instruction->modrm.fields.reg % 2 == 1)
-				_nmd_append_string(&si, instruction->modrm.fields.reg == 0b111 ? "pslldq" : "psrldq");
+			_nmd_append_string(&si, "lss ");
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_modrm_upper(&si, "fword");
+		}
+		else if (NMD_R(op) == 0xb && (op % 8) >= 6)
+		{
+			if (_NMD_IS_ATT_SYNTAX(&si))
+			{
+				/* e.g. 'movzbl', 'movswq' */
+				_nmd_append_string(&si, op > 0xb8 ? "movs" : "movz");
+				*si.buffer++ = (op % 8) == 6 ? 'b' : 'w';
+				*si.buffer++ = instruction->operandSize64 ? 'q' : ((instruction->mode == NMD_X86_MODE_16) != operandSize ? 'w' : 'l');
+				*si.buffer++ = ' ';
+			}
+			else
+				_nmd_append_string(&si, op > 0xb8 ? "movsx " : "movzx ");
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			if ((op % 8) == 6)
+				_nmd_append_Eb(&si);
+			else
+				_nmd_append_Ew(&si);
+		}
+		else if (op == 0xb8)
+		{
+			_nmd_append_string(&si, "popcnt ");
+			_nmd_append_Gv(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_Ev(&si);
+		}
+		else if (op == 0xba)
+		{
+			const char* mnemonics[] = { "bt","bts","btr","btc" };
+			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg - 4]);
+			*si.buffer++ = ' ';
+			_nmd_append_Ev(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op == 0xc0 || op == 0xc1)
+		{
+			_nmd_append_string(&si, "xadd ");
+			if (op == 0xc0)
+			{
+				_nmd_append_Eb(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gb(&si);
+			}
 			else
 			{
-				const char* mnemonics[] = { "psrl", "psra", "psll" };
-				_nmd_append_string(&si, mnemonics[(instruction->modrm.fields.reg >> 1) - 1]);
-				*si.buffer++ = op == 0x71 ? 'w' : (op == 0x72 ? 'd' : 'q');
+				_nmd_append_Ev(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gv(&si);
 			}
-
+		}
+		else if (op == 0xc2)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "cmppd" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "cmpss" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "cmpsd" : "cmpps")));
 			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			if (si.instruction->modrm.fields.mod == 0b11)
+				_nmd_append_Udq(&si);
+			else
+				_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "dword" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "qword" : "xmmword"));
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op == 0xc3)
+		{
+			_nmd_append_string(&si, "movnti ");
+			_nmd_append_modrm_upper(&si, "dword");
+			_nmd_append_separator(&si);
+			_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+		}
+		else if (op == 0xc4)
+		{
+			_nmd_append_string(&si, "pinsrw ");
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+				_nmd_append_Vdq(&si);
+			else
+				_nmd_append_Pq(&si);
+			_nmd_append_separator(&si);
+			if (si.instruction->modrm.fields.mod == 0b11)
+				_nmd_append_register(&si, _nmd_reg32[si.instruction->modrm.fields.rm]);
+			else
+				_nmd_append_modrm_upper(&si, "word");
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op == 0xc5)
+		{
+			_nmd_append_string(&si, "pextrw ");
+			_nmd_append_register(&si, _nmd_reg32[si.instruction->modrm.fields.reg]);
+			_nmd_append_separator(&si);
 			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
 				_nmd_append_Udq(&si);
 			else
 				_nmd_append_Nq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
 		}
-		else if (op == 0x78)
+		else if (op == 0xc6)
 		{
-			if (!instruction->simdPrefix)
+			_nmd_append_string(&si, "shufp");
+			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
+			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_W(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_immediate(&si, instruction->immediate);
+		}
+		else if (op == 0xC7)
+		{
+			if (instruction->modrm.fields.reg == 0b001)
 			{
-				_nmd_append_string(&si, "vmread ");
-				_nmd_append_Ey(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gy(&si);
+				_nmd_append_string(&si, "cmpxchg8b ");
+				_nmd_append_modrm_upper(&si, "qword");
 			}
-			else
+			else if (instruction->modrm.fields.reg <= 0b101)
 			{
-				if(instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-					_nmd_append_string(&si, "extrq ");
+				const char* mnemonics[] = { "xrstors", "xsavec", "xsaves" };
+				_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg - 3]);
+				*si.buffer++ = ' ';
+				_nmd_append_Eb(&si);
+			}
+			else if (instruction->modrm.fields.reg == 0b110)
+			{
+				if (instruction->modrm.fields.mod == 0b11)
+				{
+					_nmd_append_string(&si, "rdrand ");
+					_nmd_append_Rv(&si);
+				}
 				else
-				{ 
-					_nmd_append_string(&si, "insertq ");
-					_nmd_append_Vdq(&si);
-					*si.buffer++ = ',';
+				{
+					_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "vmclear" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "vmxon" : "vmptrld"));
+					*si.buffer++ = ' ';
+					_nmd_append_modrm_upper(&si, "qword");
+				}
+			}
+			else /* reg == 0b111 */
+			{
+				if (instruction->modrm.fields.mod == 0b11)
+				{
+					_nmd_append_string(&si, "rdseed ");
+					_nmd_append_Rv(&si);
+				}
+				else
+				{
+					_nmd_append_string(&si, "vmptrst ");
+					_nmd_append_modrm_upper(&si, "qword");
 				}
-				_nmd_append_Udq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_number(&si, instruction->immediate & 0x00FF);
-				*si.buffer++ = ',';
-				_nmd_append_number(&si, (instruction->immediate & 0xFF00) >> 8);
 			}
 		}
-		else if (op == 0x79)
+		else if (op >= 0xc8 && op <= 0xcf)
 		{
-			if (!instruction->simdPrefix)
+			_nmd_append_string(&si, "bswap ");
+			_nmd_append_register(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[op % 8]);
+		}
+		else if (op == 0xd0)
+		{
+			_nmd_append_string(&si, "addsubp");
+			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
+			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_W(&si);
+		}
+		else if (op == 0xd6)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movq" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movq2dq" : "movdq2q"));
+			*si.buffer++ = ' ';
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
 			{
-				_nmd_append_string(&si, "vmwrite ");
-				_nmd_append_Gy(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Ey(&si);
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Nq(&si);
+			}
+			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
+			{
+				_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Udq(&si);
 			}
 			else
 			{
-				_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "extrq " : "insertq ");
+				if (si.instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Udq(&si);
+				else
+					_nmd_append_modrm_upper(&si, "qword");
+				_nmd_append_separator(&si);
 				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Udq(&si);
 			}
-
 		}
-		else if (op == 0x7c || op == 0x7d)
+		else if (op == 0xd7)
 		{
-			_nmd_append_string(&si, op == 0x7c ? "haddp" : "hsubp");
-			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
+			_nmd_append_string(&si, "pmovmskb ");
+			_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+			_nmd_append_separator(&si);
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+				_nmd_append_Udq(&si);
+			else
+				_nmd_append_Nq(&si);
+		}
+		else if (op == 0xe6)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "cvttpd2dq" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "cvtdq2pd" : "cvtpd2dq"));
 			*si.buffer++ = ' ';
 			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_W(&si);
+			_nmd_append_separator(&si);
+			if (si.instruction->modrm.fields.mod == 0b11)
+				_nmd_append_Udq(&si);
+			else
+				_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "qword" : "xmmword");
 		}
-		else if (op == 0x7e)
+		else if (op == 0xe7)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movq " : "movd ");
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movntdq" : "movntq");
+			*si.buffer++ = ' ';
+			_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "xmmword" : "qword");
+			_nmd_append_separator(&si);
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+				_nmd_append_Vdq(&si);
+			else
+				_nmd_append_Pq(&si);
+		}
+		else if (op == 0xf0)
+		{
+			_nmd_append_string(&si, "lddqu ");
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_modrm_upper(&si, "xmmword");
+		}
+		else if (op == 0xf7)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "maskmovdqu " : "maskmovq ");
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
 			{
 				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_Udq(&si);
-				else
-					_nmd_append_modrm_upper(&si, "qword");
+				_nmd_append_separator(&si);
+				_nmd_append_Udq(&si);
 			}
 			else
 			{
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.rm]);
-				else
-					_nmd_append_modrm_upper(&si, "dword");
-				*si.buffer++ = ',';
-				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-					_nmd_append_Vdq(&si);
-				else
-					_nmd_append_Pq(&si);
+				_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Nq(&si);
 			}
 		}
-		else if (op == 0x7f)
+		else if (op >= 0xd1 && op <= 0xfe)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movdqu" : (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movdqa" : "movq"));
+			const char* mnemonics[] = { "srlw", "srld", "srlq", "addq", "mullw", 0, 0, "subusb", "subusw", "minub", "and", "addusb", "addusw", "maxub", "andn", "avgb", "sraw", "srad", "avgw", "mulhuw", "mulhw", 0, 0, "subsb", "subsw", "minsw", "or", "addsb", "addsw", "maxsw", "xor", 0, "sllw", "slld", "sllq", "muludq", "maddwd", "sadbw", 0, "subb", "subw", "subd", "subq", "addb", "addw", "addd" };
+			*si.buffer++ = 'p';
+			_nmd_append_string(&si, mnemonics[op - 0xd1]);
 			*si.buffer++ = ' ';
-			if (instruction->prefixes & (NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE))
+			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
 			{
-				_nmd_append_W(&si);
-				*si.buffer++ = ',';
 				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_W(&si);
 			}
 			else
 			{
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_Nq(&si);
-				else
-					_nmd_append_modrm_upper(&si, "qword");
-				*si.buffer++ = ',';
 				_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Qq(&si);
 			}
-		}		
-		else if (NMD_R(op) == 9)
+		}
+		else if (op == 0xb9 || op == 0xff)
 		{
-			_nmd_append_string(&si, "set");
-			_nmd_append_string(&si, _nmd_conditionSuffixes[NMD_C(op)]);
-			*si.buffer++ = ' ';
-			_nmd_append_Eb(&si);
+			_nmd_append_string(&si, op == 0xb9 ? "ud1 " : "ud0 ");
+			_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+			_nmd_append_separator(&si);
+			if (instruction->modrm.fields.mod == 0b11)
+				_nmd_append_register(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
+			else
+				_nmd_append_modrm_upper(&si, "dword");
 		}
-		else if ((NMD_R(op) == 0xA || NMD_R(op) == 0xB) && op % 8 == 3)
+		else if (op == 0xa0 || op == 0xa1 || op == 0xa8 || op == 0xa9) /* push,pop [fs,gs] */
 		{
-			_nmd_append_string(&si, op == 0xa3 ? "bt" : (op == 0xb3 ? "btr" : (op == 0xab ? "bts" : "btc")));
-			*si.buffer++ = ' ';
-			_nmd_append_Ev(&si);
-			*si.buffer++ = ',';
-			_nmd_append_Gv(&si);
+			_nmd_append_string(&si, op % 2 == 0 ? "push " : "pop ");
+			_nmd_append_register(&si, op < 0xa8 ? "fs" : "gs");
 		}
-		else if (NMD_R(op) == 0xA && (op % 8 == 4 || op % 8 == 5))
+		else
 		{
-			_nmd_append_string(&si, op > 0xA8 ? "shrd" : "shld");
-			*si.buffer++ = ' ';
-			_nmd_append_Ev(&si);
-			*si.buffer++ = ',';
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			if (op % 8 == 4)
-				_nmd_append_number(&si, instruction->immediate);
-			else
-				_nmd_append_string(&si, "cl");
+			const char* str = 0;
+			switch (op)
+			{
+			case 0x31: str = "rdtsc"; break;
+			case 0x07: str = "sysret"; break;
+			case 0x06: str = "clts"; break;
+			case 0x08: str = "invd"; break;
+			case 0x09: str = "wbinvd"; break;
+			case 0x0b: str = "ud2"; break;
+			case 0x0e: str = "femms"; break;
+			case 0x30: str = "wrmsr"; break;
+			case 0x32: str = "rdmsr"; break;
+			case 0x33: str = "rdpmc"; break;
+			case 0x34: str = "sysenter"; break;
+			case 0x35: str = "sysexit"; break;
+			case 0x37: str = "getsec"; break;
+			case 0x77: str = "emms"; break;
+			case 0xaa: str = "rsm"; break;
+			default: return;
+			}
+			_nmd_append_string(&si, str);
 		}
-		else if (op == 0xb4 || op == 0xb5)
+	}
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+	{
+		if ((NMD_R(op) == 2 || NMD_R(op) == 3) && NMD_C(op) <= 5)
 		{
-			_nmd_append_string(&si, op == 0xb4 ? "lfs " : "lgs ");
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			_nmd_append_modrm_upper(&si, "fword");
+			const char* mnemonics[] = { "pmovsxbw", "pmovsxbd", "pmovsxbq", "pmovsxwd", "pmovsxwq", "pmovsxdq" };
+			_nmd_append_string(&si, mnemonics[NMD_C(op)]);
+			if (NMD_R(op) == 3)
+				*(si.buffer - 4) = 'z';
+			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			if (instruction->modrm.fields.mod == 0b11)
+				_nmd_append_Udq(&si);
+			else
+				_nmd_append_modrm_upper(&si, NMD_C(op) == 5 ? "qword" : (NMD_C(op) % 3 == 0 ? "qword" : (NMD_C(op) % 3 == 1 ? "dword" : "word")));
 		}
-		else if (op == 0xbc || op == 0xbd)
+		else if (op >= 0x80 && op <= 0x83)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? (op == 0xbc ? "tzcnt" : "lzcnt") : (op == 0xbc ? "bsf" : "bsr"));
+			_nmd_append_string(&si, op == 0x80 ? "invept" : (op == 0x81 ? "invvpid" : "invpcid"));
 			*si.buffer++ = ' ';
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			_nmd_append_Ev(&si);
+			_nmd_append_Gy(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_modrm_upper(&si, "xmmword");
 		}
-		else if (op == 0xa6)
+		else if (op >= 0xc8 && op <= 0xcd)
 		{
-			const char* mnemonics[] = { "montmul", "xsha1", "xsha256" };
-			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+			const char* mnemonics[] = { "sha1nexte", "sha1msg1", "sha1msg2", "sha256rnds2", "sha256msg1", "sha256msg2" };
+			_nmd_append_string(&si, mnemonics[op - 0xc8]);
+			*si.buffer++ = ' ';
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_W(&si);
 		}
-		else if (op == 0xa7)
+		else if (op == 0xcf)
 		{
-			const char* mnemonics[] = { "xstorerng", "xcryptecb", "xcryptcbc", "xcryptctr", "xcryptcfb", "xcryptofb" };
-			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+			_nmd_append_string(&si, "gf2p8mulb ");
+			_nmd_append_Vdq(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_W(&si);
 		}
-		else if (op == 0xae)
+		else if (op == 0xf0 || op == 0xf1)
 		{
-			if (instruction->modrm.fields.mod == 0b11)
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "crc32" : "movbe");
+			*si.buffer++ = ' ';
+			if (op == 0xf0)
 			{
-				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-					_nmd_append_string(&si, "pcommit");
-				else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+				if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
 				{
-					_nmd_append_string(&si, "incsspd ");
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.rm]);
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+					_nmd_append_separator(&si);
+					_nmd_append_Eb(&si);
 				}
 				else
 				{
-					const char* mnemonics[] = { "rdfsbase", "rdgsbase", "wrfsbase", "wrgsbase", 0, "lfence", "mfence", "sfence" };
-					_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
+					_nmd_append_Gv(&si);
+					_nmd_append_separator(&si);
+					_nmd_append_Ev(&si);
 				}
 			}
 			else
 			{
-				if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-				{
-					_nmd_append_string(&si, instruction->modrm.fields.reg == 0b110 ? "clwb " : "clflushopt ");
-					_nmd_append_modrm_upper(&si, "byte");
-				}
-				else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
+				if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
 				{
-					_nmd_append_string(&si, instruction->modrm.fields.reg == 0b100 ? "ptwrite " : "clrssbsy ");
-					_nmd_append_modrm_upper(&si, instruction->modrm.fields.reg == 0b100 ? "dword" : "qword");
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+					_nmd_append_separator(&si);
+					if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+						_nmd_append_Ew(&si);
+					else
+						_nmd_append_Ey(&si);
 				}
 				else
 				{
-					const char* mnemonics[] = { "fxsave", "fxrstor", "ldmxcsr", "stmxcsr", "xsave", "xrstor", "xsaveopt", "clflush" };
-					_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg]);
-					*si.buffer++ = ' ';
-					_nmd_append_modrm_upper(&si, "dword");
+					_nmd_append_Ev(&si);
+					_nmd_append_separator(&si);
+					_nmd_append_Gv(&si);
 				}
 			}
 		}
-		else if (op == 0xaf)
-		{
-			_nmd_append_string(&si, "imul ");
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			_nmd_append_Ev(&si);
-		}
-		else if (op == 0xb0 || op == 0xb1)
-		{
-			_nmd_append_string(&si, "cmpxchg ");
-			if (op == 0xb0)
-			{
-				_nmd_append_Eb(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gb(&si);
-			}
-			else
-			{
-				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gv(&si);
-			}
-		}
-		else if (op == 0xb2)
-		{
-			_nmd_append_string(&si, "lss ");
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			_nmd_append_modrm_upper(&si, "fword");
-		}
-		else if (NMD_R(op) == 0xb && (op % 8) >= 6)
-		{
-			_nmd_append_string(&si, op > 0xb8 ? "movsx " : "movzx ");
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			if ((op % 8) == 6)
-				_nmd_append_Eb(&si);
-			else
-				_nmd_append_Ew(&si);
-		}
-		else if (op == 0xb8)
-		{
-			_nmd_append_string(&si, "popcnt ");
-			_nmd_append_Gv(&si);
-			*si.buffer++ = ',';
-			_nmd_append_Ev(&si);
-		}
-		else if (op == 0xba)
+		else if (op == 0xf6)
 		{
-			const char* mnemonics[] = { "bt","bts","btr","btc" };
-			_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg - 4]);
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "adcx" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "adox" : (instruction->operandSize64 ? "wrssq" : "wrssd")));
 			*si.buffer++ = ' ';
-			_nmd_append_Ev(&si);
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
-		}
-		else if (op == 0xc0 || op == 0xc1)
-		{
-			_nmd_append_string(&si, "xadd ");
-			if (op == 0xc0)
+			if (!instruction->simdPrefix)
 			{
-				_nmd_append_Eb(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gb(&si);
+				_nmd_append_Ey(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Gy(&si);
 			}
 			else
 			{
-				_nmd_append_Ev(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gv(&si);
+				_nmd_append_Gy(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Ey(&si);
 			}
 		}
-		else if (op == 0xc2)
+		else if (op == 0xf5)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "cmppd" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "cmpss" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "cmpsd" : "cmpps")));
+			_nmd_append_string(&si, instruction->operandSize64 ? "wrussq " : "wrussd ");
+			_nmd_append_modrm_upper(&si, instruction->operandSize64 ? "qword" : "dword");
+			_nmd_append_separator(&si);
+			_nmd_append_register(&si, (instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.reg]);
+		}
+		else if (op == 0xf8)
+		{
+			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movdir64b" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "enqcmd" : "enqcmds"));
 			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			if (si.instruction->modrm.fields.mod == 0b11)
-				_nmd_append_Udq(&si);
-			else
-				_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "dword" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "qword" : "xmmword"));
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
+			_nmd_append_register(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : (instruction->mode == NMD_X86_MODE_16 ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.rm]);
+			_nmd_append_separator(&si);
+			_nmd_append_modrm_upper(&si, "zmmword");
 		}
-		else if (op == 0xc3)
+		else if (op == 0xf9)
 		{
-			_nmd_append_string(&si, "movnti ");
-			_nmd_append_modrm_upper(&si, "dword");
-			*si.buffer++ = ',';
-			_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
+			_nmd_append_string(&si, "movdiri ");
+			_nmd_append_modrm_upper_without_address_specifier(&si);
+			_nmd_append_separator(&si);
+			_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.rm]);
 		}
-		else if (op == 0xc4)
+		else
 		{
-			_nmd_append_string(&si, "pinsrw ");
+			if (op == 0x40)
+				_nmd_append_string(&si, "pmulld");
+			else if (op == 0x41)
+				_nmd_append_string(&si, "phminposuw");
+			else if (op >= 0xdb && op <= 0xdf)
+			{
+				const char* mnemonics[] = { "aesimc", "aesenc", "aesenclast", "aesdec", "aesdeclast" };
+				_nmd_append_string(&si, mnemonics[op - 0xdb]);
+			}
+			else if (op == 0x37)
+				_nmd_append_string(&si, "pcmpgtq");
+			else if (NMD_R(op) == 2)
+			{
+				const char* mnemonics[] = { "pmuldq", "pcmpeqq", "movntdqa", "packusdw" };
+				_nmd_append_string(&si, mnemonics[NMD_C(op) - 8]);
+			}
+			else if (NMD_R(op) == 3)
+			{
+				const char* mnemonics[] = { "pminsb", "pminsd", "pminuw", "pminud", "pmaxsb", "pmaxsd", "pmaxuw", "pmaxud" };
+				_nmd_append_string(&si, mnemonics[NMD_C(op) - 8]);
+			}
+			else if (op < 0x10)
+			{
+				const char* mnemonics[] = { "pshufb", "phaddw", "phaddd", "phaddsw", "pmaddubsw", "phsubw", "phsubd", "phsubsw", "psignb", "psignw", "psignd", "pmulhrsw", "permilpsv", "permilpdv", "testpsv", "testpdv" };
+				_nmd_append_string(&si, mnemonics[op]);
+			}
+			else if (op < 0x18)
+				_nmd_append_string(&si, op == 0x10 ? "pblendvb" : (op == 0x14 ? "blendvps" : (op == 0x15 ? "blendvpd" : "ptest")));
+			else
+			{
+				_nmd_append_string(&si, "pabs");
+				*si.buffer++ = op == 0x1c ? 'b' : (op == 0x1d ? 'w' : 'd');
+			}
+			*si.buffer++ = ' ';
 			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+			{
 				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_W(&si);
+			}
 			else
+			{
 				_nmd_append_Pq(&si);
-			*si.buffer++ = ',';
-			if (si.instruction->modrm.fields.mod == 0b11)
-				_nmd_append_string(&si, _nmd_reg32[si.instruction->modrm.fields.rm]);
-			else
-				_nmd_append_modrm_upper(&si, "word");
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
+				_nmd_append_separator(&si);
+				_nmd_append_Qq(&si);
+			}
 		}
-		else if (op == 0xc5)
+
+	}
+	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F3A)
+	{
+		if (NMD_R(op) == 1)
 		{
-			_nmd_append_string(&si, "pextrw ");
-			_nmd_append_string(&si, _nmd_reg32[si.instruction->modrm.fields.reg]);
-			*si.buffer++ = ',';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-				_nmd_append_Udq(&si);
+			const char* mnemonics[] = { "pextrb", "pextrw", "pextrd", "extractps" };
+			_nmd_append_string(&si, mnemonics[op - 0x14]);
+			*si.buffer++ = ' ';
+			if (instruction->modrm.fields.mod == 0b11)
+				_nmd_append_register(&si, (si.instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
 			else
-				_nmd_append_Nq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
+			{
+				if (op == 0x14)
+					_nmd_append_modrm_upper(&si, "byte");
+				else if (op == 0x15)
+					_nmd_append_modrm_upper(&si, "word");
+				else if (op == 0x16)
+					_nmd_append_Ey(&si);
+				else
+					_nmd_append_modrm_upper(&si, "dword");
+			}
+			_nmd_append_separator(&si);
+			_nmd_append_Vdq(&si);
 		}
-		else if (op == 0xc6)
+		else if (NMD_R(op) == 2)
 		{
-			_nmd_append_string(&si, "shufp");
-			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
+			_nmd_append_string(&si, op == 0x20 ? "pinsrb" : (op == 0x21 ? "insertps" : "pinsrd"));
 			*si.buffer++ = ' ';
 			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_W(&si);
-			*si.buffer++ = ',';
-			_nmd_append_number(&si, instruction->immediate);
+			_nmd_append_separator(&si);
+			if (op == 0x20)
+			{
+				if (instruction->modrm.fields.mod == 0b11)
+					_nmd_append_register(&si, _nmd_reg32[instruction->modrm.fields.rm]);
+				else
+					_nmd_append_modrm_upper(&si, "byte");
+			}
+			else if (op == 0x21)
+			{
+				if (instruction->modrm.fields.mod == 0b11)
+					_nmd_append_Udq(&si);
+				else
+					_nmd_append_modrm_upper(&si, "dword");
+			}
+			else
+				_nmd_append_Ey(&si);
 		}
-		else if (op == 0xC7)
+		else
 		{
-			if (instruction->modrm.fields.reg == 0b001)
+			if (op < 0x10)
 			{
-				_nmd_append_string(&si, "cmpxchg8b ");
-				_nmd_append_modrm_upper(&si, "qword");
+				const char* mnemonics[] = { "roundps", "roundpd", "roundss", "roundsd", "blendps", "blendpd", "pblendw", "palignr" };
+				_nmd_append_string(&si, mnemonics[op - 8]);
 			}
-			else if (instruction->modrm.fields.reg <= 0b101)
+			else if (NMD_R(op) == 4)
 			{
-				const char* mnemonics[] = { "xrstors", "xsavec", "xsaves" };
-				_nmd_append_string(&si, mnemonics[instruction->modrm.fields.reg - 3]);
-				*si.buffer++ = ' ';
-				_nmd_append_Eb(&si);
+				const char* mnemonics[] = { "dpps", "dppd", "mpsadbw", 0, "pclmulqdq" };
+				_nmd_append_string(&si, mnemonics[NMD_C(op)]);
 			}
-			else if (instruction->modrm.fields.reg == 0b110)
+			else if (NMD_R(op) == 6)
+			{
+				const char* mnemonics[] = { "pcmpestrm", "pcmpestri", "pcmpistrm", "pcmpistri" };
+				_nmd_append_string(&si, mnemonics[NMD_C(op)]);
+			}
+			else if (op > 0x80)
+				_nmd_append_string(&si, op == 0xcc ? "sha1rnds4" : (op == 0xce ? "gf2p8affineqb" : (op == 0xcf ? "gf2p8affineinvqb" : "aeskeygenassist")));
+			*si.buffer++ = ' ';
+			if (op == 0xf && !(instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)))
+			{
+				_nmd_append_Pq(&si);
+				_nmd_append_separator(&si);
+				_nmd_append_Qq(&si);
+			}
+			else
 			{
+				_nmd_append_Vdq(&si);
+				_nmd_append_separator(&si);
 				if (instruction->modrm.fields.mod == 0b11)
-				{
-					_nmd_append_string(&si, "rdrand ");
-					_nmd_append_Rv(&si);
-				}
+					_nmd_append_Udq(&si);
 				else
-				{
-					_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "vmclear" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "vmxon" : "vmptrld"));
-					*si.buffer++ = ' ';
-					_nmd_append_modrm_upper(&si, "qword");
-				}
+					_nmd_append_modrm_upper(&si, op == 0xa ? "dword" : (op == 0xb ? "qword" : "xmmword"));
 			}
-			else /* reg == 0b111 */
+		}
+		_nmd_append_separator(&si);
+		_nmd_append_immediate(&si, instruction->immediate);
+	}
+
+	*si.buffer = '\0';
+
+#if !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES) || !defined(NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX)
+	/* Copy the string to the caller's buffer applying uppercase, comma spaces and operator spaces in a single forward pass. */
+	if (buffer != output)
+	{
+		/* The string is copied in pieces, which are the whole string unless AT&T syntax is used. */
+		const char* pieces[4 + 2 * _NMD_MAX_OPERAND_SEPARATORS][2];
+		size_t numPieces = 0;
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
+		if (formatFlags & NMD_X86_FORMAT_FLAGS_ATT_SYNTAX && si.operands)
+		{
+			/* The mnemonic's suffix is written after the string's terminator, so it is copied like any other piece. */
+			const char* suffix = _nmd_get_att_suffix(instruction);
+			char* suffixEnd = si.buffer + 1;
+			while (*suffix)
+				*suffixEnd++ = *suffix++;
+
+			pieces[0][0] = buffer, pieces[0][1] = si.operands - 1;
+			pieces[1][0] = si.buffer + 1, pieces[1][1] = suffixEnd;
+			pieces[2][0] = si.operands - 1, pieces[2][1] = si.operands;
+			numPieces = 3;
+
+			/* The operands are in reverse order, except those of 'enter'. */
+			const bool reverse = !(instruction->opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT && op == 0xc8 && instruction->encoding == NMD_X86_ENCODING_LEGACY);
+			size_t i = 0;
+			for (; i <= si.numSeparators; i++)
 			{
-				if (instruction->modrm.fields.mod == 0b11)
+				const size_t operand = reverse ? si.numSeparators - i : i;
+				if (i > 0)
+					pieces[numPieces][0] = si.separators[i - 1], pieces[numPieces++][1] = si.separators[i - 1] + 1;
+				pieces[numPieces][0] = operand ? si.separators[operand - 1] + 1 : si.operands;
+				pieces[numPieces++][1] = operand < si.numSeparators ? si.separators[operand] : si.buffer;
+			}
+		}
+		else
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+			pieces[0][0] = buffer, pieces[0][1] = si.buffer, numPieces = 1;
+
+		/* Inserted spaces move the numbers, so their offsets are recomputed while copying. */
+		uint8_t sourceNumberStarts[NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH / 8];
+		if (numberStarts)
+		{
+			size_t i = 0;
+			for (; i < sizeof(sourceNumberStarts); i++)
+				sourceNumberStarts[i] = numberStarts[i], numberStarts[i] = 0;
+		}
+
+		char* destination = output;
+		size_t piece = 0;
+		for (; piece < numPieces; piece++)
+		{
+			const char* source = pieces[piece][0];
+			for (; source < pieces[piece][1]; source++)
+			{
+				char c = *source;
+
+				if (numberStarts)
 				{
-					_nmd_append_string(&si, "rdseed ");
-					_nmd_append_Rv(&si);
+					const size_t sourceOffset = (size_t)(source - buffer), destinationOffset = (size_t)(destination - output);
+					if (sourceNumberStarts[sourceOffset / 8] & (1 << (sourceOffset % 8)) && destinationOffset < NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH)
+						numberStarts[destinationOffset / 8] |= (uint8_t)(1 << (destinationOffset % 8));
 				}
-				else
+
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE
+				if (formatFlags & NMD_X86_FORMAT_FLAGS_UPPERCASE && _NMD_IS_LOWERCASE(c))
+					c -= 0x20; /* Capitalize letter. */
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE */
+
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES
+				if (formatFlags & NMD_X86_FORMAT_FLAGS_OPERATOR_SPACES && (c == '+' || (c == '-' && destination > output && *(destination - 1) != ' ' && *(destination - 1) != '(')))
 				{
-					_nmd_append_string(&si, "vmptrst ");
-					_nmd_append_modrm_upper(&si, "qword");
+					*destination++ = ' ';
+					*destination++ = c;
+					*destination++ = ' ';
+					continue;
 				}
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES */
+
+				*destination++ = c;
+
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES
+				if (formatFlags & NMD_X86_FORMAT_FLAGS_COMMA_SPACES && c == ',')
+					*destination++ = ' ';
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES */
 			}
 		}
-		else if (op >= 0xc8 && op <= 0xcf)
+
+		*destination = '\0';
+	}
+#endif
+}
+
+void nmd_x86_format_instruction(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags)
+{
+	_nmd_format_instruction(instruction, buffer, runtimeAddress, formatFlags, 0);
+}
+
+/* Returns the length of 'st' followed by '(i)', or zero if 's' is not a x87 register. */
+size_t _nmd_get_x87_register_length(const char* s, size_t length)
+{
+	return _nmd_word_equals(s, length, "st") && s[2] == '(' && _NMD_IS_DECIMAL_NUMBER(s[3]) && s[4] == ')' ? 5 : 0;
+}
+
+/*
+Splits a string formatted by _nmd_format_instruction() into tokens. Intel syntax does not distinguish some hexadecimal numbers from
+registers(e.g. 'Dh' and 'dh'), 'numberStarts' tells them apart. AT&T syntax marks registers and immediates, so it is not used.
+*/
+size_t _nmd_tokenize(const char* string, const nmd_x86_instruction* instruction, uint32_t formatFlags, const uint8_t* numberStarts, nmd_x86_token* tokens, size_t maxTokens)
+{
+	const bool att = formatFlags & NMD_X86_FORMAT_FLAGS_ATT_SYNTAX;
+	bool foundMnemonic = false;
+	size_t numTokens = 0, depth = 0, i = 0;
+
+#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_BYTES
+	if (formatFlags & NMD_X86_FORMAT_FLAGS_BYTES && maxTokens)
+	{
+		tokens[numTokens].type = NMD_X86_TOKEN_TYPE_BYTES;
+		tokens[numTokens].offset = 0;
+		tokens[numTokens].length = (uint8_t)(instruction->length * 3 - 1);
+		numTokens++;
+		i = instruction->length * 3;
+	}
+#else
+	(void)instruction;
+#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_BYTES */
+
+	while (string[i] && numTokens < maxTokens)
+	{
+		const char c = string[i];
+		size_t length = 1;
+		uint8_t type = NMD_X86_TOKEN_TYPE_NONE;
+
+		if (_nmd_is_word_char(c))
 		{
-			_nmd_append_string(&si, "bswap ");
-			_nmd_append_string(&si, (operandSize ? _nmd_reg16 : _nmd_reg32)[op % 8]);
+			length = _nmd_get_word_length(string + i);
+
+			if (!foundMnemonic)
+			{
+				foundMnemonic = !_nmd_is_prefix_word(string + i, length);
+				type = (uint8_t)(foundMnemonic ? NMD_X86_TOKEN_TYPE_MNEMONIC : NMD_X86_TOKEN_TYPE_PREFIX);
+			}
+			else if (_nmd_word_equals(string + i, length, "ptr") || _nmd_word_equals(string + i, length, "far") || _nmd_word_equals(string + i + length, 4, " ptr"))
+				type = NMD_X86_TOKEN_TYPE_KEYWORD;
+			else if (att || _NMD_IS_DECIMAL_NUMBER(c) || numberStarts[i / 8] & (1 << (i % 8)))
+				type = NMD_X86_TOKEN_TYPE_IMMEDIATE;
+			else
+			{
+				type = NMD_X86_TOKEN_TYPE_REGISTER;
+				if (_nmd_get_x87_register_length(string + i, length))
+					length = 5;
+			}
 		}
-		else if (op == 0xd0)
+		else if (c == '%' || c == '$')
 		{
-			_nmd_append_string(&si, "addsubp");
-			*si.buffer++ = instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 'd' : 's';
-			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_W(&si);
+			/* AT&T registers and immediates, e.g. '%st(1)' and '$-0x1'. */
+			const size_t sign = c == '$' && string[i + 1] == '-';
+			length += sign + _nmd_get_word_length(string + i + 1 + sign);
+			if (c == '%' && _nmd_get_x87_register_length(string + i + 1, length - 1))
+				length = 6;
+			type = (uint8_t)(c == '%' ? NMD_X86_TOKEN_TYPE_REGISTER : NMD_X86_TOKEN_TYPE_IMMEDIATE);
 		}
-		else if (op == 0xd6)
+		else if (c == '[' || (c == '(' && att))
+			type = NMD_X86_TOKEN_TYPE_MEMORY_BEGIN, depth++;
+		else if ((c == ']' || (c == ')' && att)) && depth)
+			type = NMD_X86_TOKEN_TYPE_MEMORY_END, depth--;
+		else if (c == ',')
+			type = (uint8_t)(depth ? NMD_X86_TOKEN_TYPE_OPERATOR : NMD_X86_TOKEN_TYPE_SEPARATOR);
+		else if (c == '+' || c == '-' || c == '*' || c == ':' || c == '(' || c == ')')
+			type = NMD_X86_TOKEN_TYPE_OPERATOR;
+
+		if (type != NMD_X86_TOKEN_TYPE_NONE)
+		{
+			tokens[numTokens].type = type;
+			tokens[numTokens].offset = (uint8_t)i;
+			tokens[numTokens].length = (uint8_t)length;
+			numTokens++;
+		}
+
+		i += length;
+	}
+
+	return numTokens;
+}
+
+/*
+Formats an instruction like nmd_x86_format_instruction() and splits the string into tokens, so the text does not have to be parsed again.
+Returns the number of tokens. Tokens that do not fit in 'tokens' are dropped.
+Parameters:
+ - instruction    [in]  A pointer to a variable of type 'nmd_x86_instruction' describing the instruction to be formatted.
+ - buffer         [out] A pointer to buffer that receives the string. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' bytes long.
+ - runtimeAddress [in]  The instruction's runtime address. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+ - formatFlags    [in]  A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instruction. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+ - tokens         [out] A pointer to an array of 'maxTokens' tokens that receives the tokens in the order they appear in the string.
+ - maxTokens      [in]  The number of elements of 'tokens'.
+*/
+size_t nmd_x86_format_instruction_tokens(const nmd_x86_instruction* instruction, char* buffer, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_token* tokens, size_t maxTokens)
+{
+	if (!instruction->valid)
+		return 0;
+
+	uint8_t numberStarts[NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH / 8] = { 0 };
+	_nmd_format_instruction(instruction, buffer, runtimeAddress, formatFlags, numberStarts);
+
+	return _nmd_tokenize(buffer, instruction, formatFlags, numberStarts, tokens, maxTokens);
+}
+
+/*
+Formats consecutive instructions as a listing, one instruction per line. Returns the number of lines formatted, not counting the lines of a call to 'flush' that returned false.
+Parameters:
+ - instructions   [in]     A pointer to an array of 'count' decoded instructions(e.g. filled by nmd_x86_decode_buffer_batch()). Formatting stops at the first invalid instruction, since the runtime addresses of the instructions after it are unknown.
+ - count          [in]     The number of instructions.
+ - buffer         [out]    A pointer to a buffer that receives the lines.
+ - bufferSize     [in]     The size of the buffer in bytes. It must be at least 'NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH' + 1 bytes.
+ - runtimeAddress [in]     The runtime address of the first instruction. You may use 'NMD_X86_INVALID_RUNTIME_ADDRESS'.
+ - formatFlags    [in]     A mask of 'NMD_X86_FORMAT_FLAGS_XXX' that specifies how the function should format the instructions. If uncertain, use 'NMD_X86_FORMAT_FLAGS_DEFAULT'.
+ - flush          [in/opt] A callback that receives the text in 'buffer' whenever the next line does not fit and once at the end, then 'buffer' is reused.
+                           Formatting stops if it returns false. If this parameter is zero, formatting stops when 'buffer' is full and 'buffer' holds the null-terminated listing.
+ - userData       [in/opt] A pointer passed to 'flush'.
+*/
+size_t nmd_x86_format_buffer(const nmd_x86_instruction* instructions, size_t count, char* buffer, size_t bufferSize, uint64_t runtimeAddress, uint32_t formatFlags, nmd_x86_format_flush_callback flush, void* userData)
+{
+	if (bufferSize < NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH + 1)
+		return 0;
+
+	/* Formats the lines near the end of 'buffer', where a line of the maximum length may not fit. */
+	char line[NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH];
+
+	/* 'numLines' counts the lines formatted, 'numPending' the ones in 'buffer' that haven't been passed to 'flush' yet. */
+	size_t length = 0;
+	size_t numLines = 0;
+	size_t numPending = 0;
+	size_t i = 0;
+	for (; i < count && instructions[i].valid; i++)
+	{
+		/*
+		While a line of the maximum length, its new line and the null terminator fit, the line is formatted in place. Otherwise it is
+		formatted in 'line' and copied if its real length fits, so 'buffer' is only flushed when the line does not fit.
+		*/
+		const bool inPlace = bufferSize - length >= NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH + 1;
+		char* const destination = inPlace ? buffer + length : line;
+		nmd_x86_format_instruction(instructions + i, destination, runtimeAddress, formatFlags);
+
+		size_t lineLength = 0;
+		while (destination[lineLength])
+			lineLength++;
+
+		if (!inPlace)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movq" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "movq2dq" : "movdq2q"));
-			*si.buffer++ = ' ';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT)
-			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Nq(&si);
-			}
-			else if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Udq(&si);
-			}
-			else
+			if (bufferSize - length < lineLength + 2)
 			{
-				if (si.instruction->modrm.fields.mod == 0b11)
-					_nmd_append_Udq(&si);
-				else
-					_nmd_append_modrm_upper(&si, "qword");
-				*si.buffer++ = ',';
-				_nmd_append_Vdq(&si);
+				if (!flush)
+					break;
+
+				if (!flush(buffer, length, userData))
+					return numLines - numPending;
+
+				length = 0;
+				numPending = 0;
 			}
+
+			size_t j = 0;
+			for (; j < lineLength; j++)
+				buffer[length + j] = line[j];
 		}
-		else if (op == 0xd7)
+
+		length += lineLength;
+		buffer[length++] = '\n';
+		numLines++;
+		numPending++;
+
+		if (runtimeAddress != (uint64_t)NMD_X86_INVALID_RUNTIME_ADDRESS)
+			runtimeAddress += instructions[i].length;
+	}
+
+	buffer[length] = '\0';
+
+	if (flush && length > 0 && !flush(buffer, length, userData))
+		return numLines - numPending;
+
+	return numLines;
+}
+
+#define NMD_EMULATOR_RESOLVE_VA(va) ((void*)((uint64_t)cpu.physicalMemory + (va - cpu.virtualAddress)))
+
+/* 
+Checks if the number of set bits in an 8-bit number is even.
+Credits: https://stackoverflow.com/questions/21617970/how-to-check-if-value-has-even-parity-of-bits-or-odd
+*/
+bool _nmd_is_parity_even8(uint8_t x)
+{
+	x ^= x >> 4;
+	x ^= x >> 2;
+	x ^= x >> 1;
+	return !(x & 1);
+}
+
+/* The operation recorded in 'cpu->lazyFlags', which determines how the arithmetic flags are computed from its operands and result. */
+enum _NMD_LAZY_FLAGS
+{
+	_NMD_LAZY_FLAGS_NONE = 0, /* 'cpu->flags' is up to date. */
+	_NMD_LAZY_FLAGS_ADD,
+	_NMD_LAZY_FLAGS_ADC,
+	_NMD_LAZY_FLAGS_SUB,
+	_NMD_LAZY_FLAGS_SBB,
+	_NMD_LAZY_FLAGS_LOGIC, /* and, or, xor: CF and OF are cleared. */
+	_NMD_LAZY_FLAGS_INC,   /* CF is preserved in 'src'. */
+	_NMD_LAZY_FLAGS_DEC,   /* CF is preserved in 'src'. */
+	_NMD_LAZY_FLAGS_SHIFT  /* shl, shr, sar, mul and imul: CF is bit 0 of 'src' and OF is bit 1. */
+};
+
+/* Records the operands and the result of an instruction so that the arithmetic flags are computed only when they are read. */
+void _nmd_set_lazy_flags(nmd_x86_cpu* cpu, uint8_t operation, uint8_t size, uint64_t dst, uint64_t src, uint64_t result)
+{
+	const uint64_t mask = size == 8 ? (uint64_t)-1 : ((uint64_t)1 << (size * 8)) - 1;
+
+	cpu->lazyFlags.operation = operation;
+	cpu->lazyFlags.size = size;
+	cpu->lazyFlags.dst = dst & mask;
+	cpu->lazyFlags.src = src & mask;
+	cpu->lazyFlags.result = result & mask;
+}
+
+/* Returns the current value of the carry flag. */
+bool _nmd_get_carry_flag(const nmd_x86_cpu* cpu)
+{
+	const nmd_x86_lazy_flags* lazy = &cpu->lazyFlags;
+
+	switch (lazy->operation)
+	{
+	case _NMD_LAZY_FLAGS_ADD: return lazy->result < lazy->dst;
+	case _NMD_LAZY_FLAGS_ADC: return lazy->result < lazy->dst || (lazy->result == lazy->dst && lazy->src != 0);
+	case _NMD_LAZY_FLAGS_SUB: return lazy->dst < lazy->src;
+	case _NMD_LAZY_FLAGS_SBB: return lazy->dst < lazy->src || (lazy->dst == lazy->src && lazy->result != 0);
+	case _NMD_LAZY_FLAGS_LOGIC: return false;
+	case _NMD_LAZY_FLAGS_INC: case _NMD_LAZY_FLAGS_DEC: return lazy->src != 0;
+	case _NMD_LAZY_FLAGS_SHIFT: return (lazy->src & 1) != 0;
+	default: return cpu->flags.fields.CF;
+	}
+}
+
+/* Computes CF, PF, AF, ZF, SF and OF in 'cpu->flags' from 'cpu->lazyFlags'. Must be called before these flags are read or written directly. */
+void _nmd_update_flags(nmd_x86_cpu* cpu)
+{
+	nmd_x86_lazy_flags* lazy = &cpu->lazyFlags;
+	if (lazy->operation == _NMD_LAZY_FLAGS_NONE)
+		return;
+
+	const uint64_t sign = (uint64_t)1 << (lazy->size * 8 - 1);
+	const uint64_t src = (lazy->operation == _NMD_LAZY_FLAGS_INC || lazy->operation == _NMD_LAZY_FLAGS_DEC) ? 1 : lazy->src;
+
+	cpu->flags.fields.CF = _nmd_get_carry_flag(cpu);
+	cpu->flags.fields.PF = _nmd_is_parity_even8((uint8_t)lazy->result);
+	cpu->flags.fields.AF = lazy->operation != _NMD_LAZY_FLAGS_LOGIC && lazy->operation != _NMD_LAZY_FLAGS_SHIFT && ((lazy->dst ^ src ^ lazy->result) & 0x10);
+	cpu->flags.fields.ZF = lazy->result == 0;
+	cpu->flags.fields.SF = (lazy->result & sign) != 0;
+
+	switch (lazy->operation)
+	{
+	case _NMD_LAZY_FLAGS_ADD: case _NMD_LAZY_FLAGS_ADC: case _NMD_LAZY_FLAGS_INC:
+		cpu->flags.fields.OF = ((lazy->dst ^ lazy->result) & (src ^ lazy->result) & sign) != 0;
+		break;
+	case _NMD_LAZY_FLAGS_SUB: case _NMD_LAZY_FLAGS_SBB: case _NMD_LAZY_FLAGS_DEC:
+		cpu->flags.fields.OF = ((lazy->dst ^ src) & (lazy->dst ^ lazy->result) & sign) != 0;
+		break;
+	case _NMD_LAZY_FLAGS_SHIFT:
+		cpu->flags.fields.OF = (lazy->src >> 1) & 1;
+		break;
+	default:
+		cpu->flags.fields.OF = 0;
+		break;
+	}
+
+	lazy->operation = _NMD_LAZY_FLAGS_NONE;
+}
+
+bool _nmd_check_jump_condition(nmd_x86_cpu* const cpu, uint8_t opcodeCondition)
+{
+	_nmd_update_flags(cpu);
+
+	switch (opcodeCondition)
+	{
+	case 0x0: return cpu->flags.fields.OF == 1;                                                 /* Jump if overflow (OF=1) */
+	case 0x1: return cpu->flags.fields.OF == 0;                                                 /* Jump if not overflow (OF=0) */
+	case 0x2: return cpu->flags.fields.CF == 1;                                                 /* Jump if not above or equal (CF=1) */
+	case 0x3: return cpu->flags.fields.CF == 0;                                                 /* Jump if not below (CF=0) */
+	case 0x4: return cpu->flags.fields.ZF == 1;                                                 /* Jump if equal (ZF=1) */
+	case 0x5: return cpu->flags.fields.ZF == 0;                                                 /* Jump if not equal (ZF=0) */
+	case 0x6: return cpu->flags.fields.CF == 1 || cpu->flags.fields.ZF == 1;                    /* Jump if not above (CF=1 or ZF=1) */
+	case 0x7: return cpu->flags.fields.CF == 0 && cpu->flags.fields.ZF == 0;                    /* Jump if not below or equal (CF=0 and ZF=0) */
+	case 0x8: return cpu->flags.fields.SF == 1;                                                 /* Jump if sign (SF=1) */
+	case 0x9: return cpu->flags.fields.SF == 0;                                                 /* Jump if not sign (SF=0) */
+	case 0xa: return cpu->flags.fields.PF == 1;                                                 /* Jump if parity/parity even (PF=1) */
+	case 0xb: return cpu->flags.fields.PF == 0;                                                 /* Jump if parity odd (PF=0) */
+	case 0xc: return cpu->flags.fields.SF != cpu->flags.fields.OF;                              /* Jump if not greater or equal (SF != OF) */
+	case 0xd: return cpu->flags.fields.SF == cpu->flags.fields.OF;                              /* Jump if not less (SF=OF) */
+	case 0xe: return cpu->flags.fields.ZF == 1 || cpu->flags.fields.SF != cpu->flags.fields.OF; /* Jump if not greater (ZF=1 or SF != OF) */
+	case 0xf: return cpu->flags.fields.ZF == 0 && cpu->flags.fields.SF == cpu->flags.fields.OF; /* Jump if not less or equal (ZF=0 and SF=OF) */
+	default: return false;
+	}
+}
+
+void _nmd_copy_by_mode(void* dst, void* src, NMD_X86_MODE mode)
+{
+	if (mode == NMD_X86_MODE_32)
+		*(int32_t*)(dst) = *(int32_t*)(src);
+	else if (mode == NMD_X86_MODE_64)
+		*(int64_t*)(dst) = *(int64_t*)(src);
+	else /* (mode == NMD_X86_MODE_16) */
+		*(int16_t*)(dst) = *(int16_t*)(src);
+}
+
+void _nmd_copy_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+{
+	if(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
+		*(int16_t*)(dst) = *(int16_t*)(src);
+	else
+		*(int32_t*)(dst) = *(int32_t*)(src);
+}
+
+/* Returns the size in bytes of the non-byte operands of 'instruction'. */
+uint8_t _nmd_get_emulator_operand_size(const nmd_x86_instruction* instruction)
+{
+	if (instruction->prefixes & NMD_X86_PREFIXES_REX_W)
+		return 8;
+	else if (instruction->mode == NMD_X86_MODE_16)
+		return instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 4 : 2;
+	else
+		return instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? 2 : 4;
+}
+
+uint64_t _nmd_read_by_size(const void* src, uint8_t size)
+{
+	switch (size)
+	{
+	case 1: return *(uint8_t*)(src);
+	case 2: return *(uint16_t*)(src);
+	case 4: return *(uint32_t*)(src);
+	default: return *(uint64_t*)(src);
+	}
+}
+
+void _nmd_write_by_size(void* dst, uint64_t value, uint8_t size)
+{
+	switch (size)
+	{
+	case 1: *(uint8_t*)(dst) = (uint8_t)value; break;
+	case 2: *(uint16_t*)(dst) = (uint16_t)value; break;
+	case 4: *(uint32_t*)(dst) = (uint32_t)value; break;
+	default: *(uint64_t*)(dst) = value; break;
+	}
+}
+
+#define _NMD_GET_GREG(index) (&cpu->rax + (index)) /* general register */
+#define _NMD_GET_RREG(index) (&cpu->r8 + (index)) /* r8,r9...r15 */
+
+/* Returns the general-purpose register 'reg'(0-15, the REX bit included) as an operand of 'size' bytes. Without a REX prefix the byte registers 4-7 are 'ah', 'ch', 'dh' and 'bh'. */
+void* _nmd_get_emulator_register(nmd_x86_cpu* cpu, const nmd_x86_instruction* instruction, uint8_t reg, uint8_t size)
+{
+	if (size == 1 && !instruction->hasRex && reg >= 4 && reg < 8)
+		return (uint8_t*)_NMD_GET_GREG(reg - 4) + 1;
+	else
+		return _NMD_GET_GREG(reg);
+}
+
+/* Returns the register operand encoded in the reg field of the ModR/M byte, extended by REX.R. */
+void* _nmd_get_emulator_modrm_reg(nmd_x86_cpu* cpu, const nmd_x86_instruction* instruction, uint8_t size)
+{
+	return _nmd_get_emulator_register(cpu, instruction, (uint8_t)(instruction->modrm.fields.reg | (instruction->prefixes & NMD_X86_PREFIXES_REX_R ? 8 : 0)), size);
+}
+
+/* Writes the result of an instruction to the register or memory operand 'dst'. A 32-bit result written to a general-purpose register in 64 bit mode clears the upper half of the register. */
+void _nmd_write_emulator_operand(nmd_x86_cpu* cpu, void* dst, uint64_t value, uint8_t size)
+{
+	if (size == 4 && cpu->mode == NMD_X86_MODE_64 && (uint8_t*)dst >= (uint8_t*)&cpu->rax && (uint8_t*)dst <= (uint8_t*)&cpu->r15)
+		*(uint64_t*)(dst) = (uint32_t)value;
+	else
+		_nmd_write_by_size(dst, value, size);
+}
+/* #define NMD_TEST(value, bit) ((value&(1<<bit))==(1<<bit)) */
+
+/* Returns the region mapped by nmd_x86_emulator_map() that contains the virtual address 'address', or null if there is none. */
+const nmd_x86_emulator_region* _nmd_find_emulator_region(const nmd_x86_cpu* cpu, uint64_t address)
+{
+	size_t i = cpu->numRegions;
+	while (i--)
+	{
+		if (address - cpu->regions[i].address < cpu->regions[i].size)
+			return &cpu->regions[i];
+	}
+
+	return 0;
+}
+
+/*
+Returns the element of 'cpu->pages' that holds the virtual address 'address'. Pages are placed with open addressing by their page number and an element is
+taken the first time an address of a mapped region is accessed. Returns null if 'address' is not mapped or 'cpu->pages' is full.
+*/
+nmd_x86_emulator_page* _nmd_get_emulator_page(nmd_x86_cpu* cpu, uint64_t address)
+{
+	const uint64_t pageNumber = address / NMD_X86_EMULATOR_PAGE_SIZE;
+	const uint64_t pageAddress = pageNumber * NMD_X86_EMULATOR_PAGE_SIZE;
+	nmd_x86_emulator_page** entry = &cpu->tlb[pageNumber % NMD_X86_EMULATOR_TLB_SIZE];
+	if (*entry && (*entry)->address == pageAddress)
+		return *entry;
+
+	if (cpu->numPages == 0)
+		return 0;
+
+	size_t index = (size_t)((pageNumber ^ (pageNumber >> 20)) % cpu->numPages);
+	size_t i = 0;
+	for (; i < cpu->numPages; i++, index = (index + 1) % cpu->numPages)
+	{
+		nmd_x86_emulator_page* page = &cpu->pages[index];
+		if (!page->present)
 		{
-			_nmd_append_string(&si, "pmovmskb ");
-			_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-			*si.buffer++ = ',';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-				_nmd_append_Udq(&si);
-			else
-				_nmd_append_Nq(&si);
+			/* The page was never accessed. */
+			const nmd_x86_emulator_region* region = _nmd_find_emulator_region(cpu, pageAddress);
+			if (!region)
+				return 0;
+
+			page->present = true;
+			page->address = pageAddress;
+			page->permissions = region->permissions;
 		}
-		else if (op == 0xe6)
+		else if (page->address != pageAddress)
+			continue;
+
+		*entry = page;
+		return page;
+	}
+
+	return 0;
+}
+
+/* Ends the block being executed if the 'size' bytes written at 'address' overlap it, since the rest of the block may have been decoded from the old bytes. */
+void _nmd_check_emulator_code_write(nmd_x86_cpu* cpu, uint64_t address, size_t size)
+{
+	if (address < cpu->blockEnd && address + size > cpu->blockStart)
+		cpu->blockModified = true;
+}
+
+/*
+Copies 'size' bytes between 'buffer' and the emulator's memory at the virtual address 'address'. Returns true on success, false if a byte is outside the
+emulator's memory or its page does not allow 'access'(a mask of 'NMD_X86_EMULATOR_PAGE_XXX', zero to ignore permissions).
+Parameters:
+ - write [in] If true, the bytes are copied from 'buffer' to the emulator's memory, otherwise from the emulator's memory to 'buffer'.
+*/
+bool _nmd_copy_emulator_memory(nmd_x86_cpu* cpu, uint64_t address, void* buffer, size_t size, uint8_t access, bool write)
+{
+	uint8_t* b = (uint8_t*)buffer;
+
+	if (write)
+		_nmd_check_emulator_code_write(cpu, address, size);
+
+	while (size > 0)
+	{
+		uint8_t* memory;
+		size_t numBytes;
+
+		if (cpu->pages)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "cvttpd2dq" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "cvtdq2pd" : "cvtpd2dq"));
-			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			if (si.instruction->modrm.fields.mod == 0b11)
-				_nmd_append_Udq(&si);
-			else
-				_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "qword" : "xmmword");
+			nmd_x86_emulator_page* page = _nmd_get_emulator_page(cpu, address);
+			if (!page || (page->permissions & access) != access)
+				return false;
+
+			const size_t offset = (size_t)(address % NMD_X86_EMULATOR_PAGE_SIZE);
+			memory = page->data + offset;
+			numBytes = NMD_X86_EMULATOR_PAGE_SIZE - offset;
 		}
-		else if (op == 0xe7)
+		else
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movntdq" : "movntq");
-			*si.buffer++ = ' ';
-			_nmd_append_modrm_upper(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "xmmword" : "qword");
-			*si.buffer++ = ',';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-				_nmd_append_Vdq(&si);
+			const uint64_t offset = address - cpu->virtualAddress;
+			if (offset >= cpu->physicalMemorySize)
+				return false;
+
+			memory = (uint8_t*)cpu->physicalMemory + offset;
+			numBytes = (size_t)(cpu->physicalMemorySize - offset);
+		}
+
+		if (numBytes > size)
+			numBytes = size;
+
+		size_t i = 0;
+		for (; i < numBytes; i++)
+		{
+			if (write)
+				memory[i] = b[i];
 			else
-				_nmd_append_Pq(&si);
+				b[i] = memory[i];
 		}
-		else if (op == 0xf0)
+
+		address += numBytes;
+		b += numBytes;
+		size -= numBytes;
+	}
+
+	return true;
+}
+
+/*
+Returns a pointer to the host memory that holds 'size' bytes at the virtual address 'address', or null if they are outside the emulator's memory or their
+pages do not allow 'access'(a mask of 'NMD_X86_EMULATOR_PAGE_XXX'). An operand that straddles two pages is copied to 'cpu->crossPageBuffer', which is written
+back after the instruction executes. Only one such operand can be accessed per instruction.
+*/
+void* _nmd_get_emulator_memory(nmd_x86_cpu* cpu, uint64_t address, size_t size, uint8_t access)
+{
+	if (access & NMD_X86_EMULATOR_PAGE_WRITE)
+		_nmd_check_emulator_code_write(cpu, address, size);
+
+	if (!cpu->pages)
+	{
+		const uint64_t offset = address - cpu->virtualAddress;
+		return (offset < cpu->physicalMemorySize && size <= cpu->physicalMemorySize - offset) ? (uint8_t*)cpu->physicalMemory + offset : 0;
+	}
+
+	const size_t offset = (size_t)(address % NMD_X86_EMULATOR_PAGE_SIZE);
+	if (offset + size <= NMD_X86_EMULATOR_PAGE_SIZE)
+	{
+		nmd_x86_emulator_page* page = _nmd_get_emulator_page(cpu, address);
+		return (page && (page->permissions & access) == access) ? page->data + offset : 0;
+	}
+
+	if (cpu->crossPageSize || size > sizeof(cpu->crossPageBuffer) || !_nmd_copy_emulator_memory(cpu, address, cpu->crossPageBuffer, size, access, false))
+		return 0;
+
+	cpu->crossPageAddress = address;
+	cpu->crossPageSize = (uint8_t)size;
+	cpu->crossPageWrite = (access & NMD_X86_EMULATOR_PAGE_WRITE) != 0;
+	return cpu->crossPageBuffer;
+}
+
+/* Returns a pointer to the code at 'cpu->rip' and the number of bytes that follow it in the same page(or buffer) in 'size', or null if 'cpu->rip' cannot be executed. */
+const uint8_t* _nmd_get_emulator_code(nmd_x86_cpu* cpu, size_t* size)
+{
+	if (!cpu->pages)
+	{
+		const uint64_t offset = cpu->rip - cpu->virtualAddress;
+		if (offset >= cpu->physicalMemorySize)
+			return 0;
+
+		*size = (size_t)(cpu->physicalMemorySize - offset);
+		return (const uint8_t*)cpu->physicalMemory + offset;
+	}
+
+	const nmd_x86_emulator_page* page = _nmd_get_emulator_page(cpu, cpu->rip);
+	if (!page || !(page->permissions & NMD_X86_EMULATOR_PAGE_EXECUTE))
+		return 0;
+
+	const size_t offset = (size_t)(cpu->rip % NMD_X86_EMULATOR_PAGE_SIZE);
+	*size = NMD_X86_EMULATOR_PAGE_SIZE - offset;
+	return page->data + offset;
+}
+
+/*
+Maps a range of the emulator's virtual address space to 'cpu->pages'. A page of the range takes an element of 'cpu->pages' only when it is first accessed.
+Mapping a range again changes its permissions. Overlapping and adjacent ranges with the same permissions are merged into one region. Returns true on success,
+false if 'cpu->pages' is null or empty or the mapping would need more than 'NMD_X86_EMULATOR_MAX_REGIONS' regions.
+Parameters:
+ - cpu         [in] A pointer to a variable of type 'nmd_x86_cpu' whose 'pages' and 'numPages' are initialized.
+ - address     [in] The virtual address of the range. It is rounded down to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+ - size        [in] The size of the range in bytes. It is rounded up to a multiple of 'NMD_X86_EMULATOR_PAGE_SIZE'.
+ - permissions [in] A mask of 'NMD_X86_EMULATOR_PAGE_XXX' that specifies how the emulated code may access the range.
+*/
+bool nmd_x86_emulator_map(nmd_x86_cpu* cpu, uint64_t address, uint64_t size, uint8_t permissions)
+{
+	if (!cpu->pages || cpu->numPages == 0)
+		return false;
+
+	const uint64_t start = address - address % NMD_X86_EMULATOR_PAGE_SIZE;
+	const uint64_t end = start + (address - start + size + NMD_X86_EMULATOR_PAGE_SIZE - 1) / NMD_X86_EMULATOR_PAGE_SIZE * NMD_X86_EMULATOR_PAGE_SIZE;
+	if (end == start)
+		return true;
+
+	/*
+	Regions never overlap, and adjacent regions have different permissions. The new range replaces the parts of the regions it overlaps and absorbs
+	regions with the same permissions that overlap or touch it. A region that contains the range with a different permission is split in two.
+	*/
+	nmd_x86_emulator_region regions[NMD_X86_EMULATOR_MAX_REGIONS + 1];
+	size_t numRegions = 0;
+	uint64_t newStart = start, newEnd = end;
+	size_t i = 0;
+	for (; i < cpu->numRegions; i++)
+	{
+		const nmd_x86_emulator_region* region = &cpu->regions[i];
+		const uint64_t regionEnd = region->address + region->size;
+		if (regionEnd < start || region->address > end || ((regionEnd == start || region->address == end) && region->permissions != permissions))
 		{
-			_nmd_append_string(&si, "lddqu ");
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_modrm_upper(&si, "xmmword");
+			regions[numRegions++] = *region;
+			continue;
 		}
-		else if (op == 0xf7)
+
+		if (region->permissions == permissions)
 		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "maskmovdqu " : "maskmovq ");
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Udq(&si);
-			}
-			else
-			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Nq(&si);
-			}
+			if (region->address < newStart)
+				newStart = region->address;
+			if (regionEnd > newEnd)
+				newEnd = regionEnd;
+			continue;
 		}
-		else if (op >= 0xd1 && op <= 0xfe)
+
+		if (region->address < start)
 		{
-			const char* mnemonics[] = { "srlw", "srld", "srlq", "addq", "mullw", 0, 0, "subusb", "subusw", "minub", "and", "addusb", "addusw", "maxub", "andn", "avgb", "sraw", "srad", "avgw", "mulhuw", "mulhw", 0, 0, "subsb", "subsw", "minsw", "or", "addsb", "addsw", "maxsw", "xor", 0, "sllw", "slld", "sllq", "muludq", "maddwd", "sadbw", 0, "subb", "subw", "subd", "subq", "addb", "addw", "addd" };
-			*si.buffer++ = 'p';
-			_nmd_append_string(&si, mnemonics[op - 0xd1]);
-			*si.buffer++ = ' ';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_W(&si);
-			}
-			else
-			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Qq(&si);
-			}
+			regions[numRegions].address = region->address;
+			regions[numRegions].size = start - region->address;
+			regions[numRegions++].permissions = region->permissions;
 		}
-		else if (op == 0xb9 || op == 0xff)
+
+		if (regionEnd > end)
 		{
-			_nmd_append_string(&si, op == 0xb9 ? "ud1 " : "ud0 ");
-			_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-			*si.buffer++ = ',';
-			if (instruction->modrm.fields.mod == 0b11)
-				_nmd_append_string(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
-			else
-				_nmd_append_modrm_upper(&si, "dword");
+			regions[numRegions].address = end;
+			regions[numRegions].size = regionEnd - end;
+			regions[numRegions++].permissions = region->permissions;
 		}
+	}
+
+	if (numRegions >= NMD_X86_EMULATOR_MAX_REGIONS)
+		return false;
+
+	regions[numRegions].address = newStart;
+	regions[numRegions].size = newEnd - newStart;
+	regions[numRegions++].permissions = permissions;
+
+	for (i = 0; i < numRegions; i++)
+		cpu->regions[i] = regions[i];
+	cpu->numRegions = numRegions;
+
+	/* Pages that were already accessed take the new permissions. */
+	for (i = 0; i < cpu->numPages; i++)
+	{
+		if (cpu->pages[i].present && cpu->pages[i].address - start < end - start)
+			cpu->pages[i].permissions = permissions;
+	}
+
+	return true;
+}
+
+/*
+Copies a buffer to the emulator's memory regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+Parameters:
+ - cpu     [in] A pointer to a variable of type 'nmd_x86_cpu'.
+ - address [in] The virtual address where the bytes are copied to.
+ - buffer  [in] A pointer to the bytes to copy.
+ - size    [in] The number of bytes to copy.
+*/
+bool nmd_x86_emulator_write(nmd_x86_cpu* cpu, uint64_t address, const void* buffer, size_t size)
+{
+	return _nmd_copy_emulator_memory(cpu, address, (void*)buffer, size, 0, true);
+}
+
+/*
+Copies the emulator's memory to a buffer regardless of the pages' permissions. Returns true on success, false if part of the range is not mapped or 'cpu->pages' is full.
+Parameters:
+ - cpu     [in]  A pointer to a variable of type 'nmd_x86_cpu'.
+ - address [in]  The virtual address where the bytes are copied from.
+ - buffer  [out] A pointer to a buffer that receives the bytes.
+ - size    [in]  The number of bytes to copy.
+*/
+bool nmd_x86_emulator_read(nmd_x86_cpu* cpu, uint64_t address, void* buffer, size_t size)
+{
+	return _nmd_copy_emulator_memory(cpu, address, buffer, size, 0, false);
+}
+
+enum _NMD_EMULATOR_STATUS
+{
+	_NMD_EMULATOR_STATUS_CONTINUE = 0, /* The instruction completed, 'cpu->rip' must be advanced past it. */
+	_NMD_EMULATOR_STATUS_HALT,         /* Emulation stops successfully at the instruction(hlt). */
+	_NMD_EMULATOR_STATUS_FAULT,        /* Emulation stops because of an exception that was reported to the callback. */
+	_NMD_EMULATOR_STATUS_LIMIT,        /* Emulation stops successfully because 'maxCount' instructions were executed. */
+	_NMD_EMULATOR_STATUS_LEAVE_BLOCK   /* The next instruction is not the next one of the block. */
+};
+
+/* Reports 'exception' to the callback and stops the emulator. */
+int _nmd_emulator_fault(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction, NMD_X86_EMULATOR_EXCEPTION exception)
+{
+	_nmd_update_flags(cpu);
+	if (cpu->callback)
+		cpu->callback(cpu, instruction, exception);
+	cpu->running = false;
+	return _NMD_EMULATOR_STATUS_FAULT;
+}
+
+/* Reports an access to memory that is not mapped or not allowed to the callback and stops the emulator. */
+int _nmd_emulator_memory_fault(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	return _nmd_emulator_fault(cpu, instruction, NMD_X86_EMULATOR_EXCEPTION_BAD_MEMORY);
+}
+
+/* Returns the virtual address of the memory operand described by the instruction's ModR/M byte, SIB byte and displacement. 16-bit addressing(bx+si...) is not implemented. */
+int64_t _nmd_resolve_memory_operand_va(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t mod = instruction->modrm.fields.mod;
+	uint64_t va_expr; /* virtual address expression */
+
+	if (instruction->hasSIB)
+	{
+		const uint8_t index = (uint8_t)(instruction->sib.fields.index | (instruction->prefixes & NMD_X86_PREFIXES_REX_X ? 8 : 0));
+
+		/* A base of 101 with mod=00 means there is no base, only a disp32. */
+		if (mod == 0b00 && instruction->sib.fields.base == 0b101)
+			va_expr = 0;
 		else
+			va_expr = (uint64_t)_NMD_GET_GREG(instruction->sib.fields.base | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0))->l64;
+
+		/* An index of 100 without REX.X means there is no index. */
+		if (index != 0b100)
+			va_expr += (uint64_t)_NMD_GET_GREG(index)->l64 << instruction->sib.fields.scale;
+	}
+	else if (mod == 0b00 && instruction->modrm.fields.rm == 0b101) /* disp32, which is relative to the next instruction in 64 bit mode. */
+		va_expr = instruction->mode == NMD_X86_MODE_64 ? cpu->rip + instruction->length : 0;
+	else
+		va_expr = (uint64_t)_NMD_GET_GREG(instruction->modrm.fields.rm | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0))->l64;
+
+	va_expr += (uint64_t)(int64_t)((instruction->dispMask == NMD_X86_DISP8) ? (int8_t)instruction->displacement : (int32_t)instruction->displacement);
+
+	/* Addresses are 64 bits wide only in 64 bit mode without the address size override prefix. */
+	if (instruction->mode != NMD_X86_MODE_64 || instruction->prefixes & NMD_X86_PREFIXES_ADDRESS_SIZE_OVERRIDE)
+		va_expr = (uint32_t)va_expr;
+
+	return (int64_t)va_expr;
+}
+
+/* Returns a pointer to the register or memory operand described by the instruction's ModR/M byte, or null if the memory does not allow 'access'. */
+void* _nmd_resolve_memory_operand(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction, size_t size, uint8_t access)
+{
+	if (instruction->modrm.fields.mod == 0b11)
+		return _nmd_get_emulator_register(cpu, instruction, (uint8_t)(instruction->modrm.fields.rm | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0)), (uint8_t)size);
+	else
+		return _nmd_get_emulator_memory(cpu, (uint64_t)_nmd_resolve_memory_operand_va(cpu, instruction), size, access);
+}
+
+/* The hint nops [0f 0d,0f 18-0f 1f] */
+int _nmd_emulate_nop(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	(void)cpu;
+	(void)instruction;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* Instructions that are not implemented yet raise an exception instead of being skipped, which would leave the cpu in a state the code doesn't expect. */
+int _nmd_emulate_unimplemented(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	return _nmd_emulator_fault(cpu, instruction, NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION);
+}
+
+/* The kind of operation recorded in 'cpu->lazyFlags' by each of the ALU instructions, indexed by 'opcode >> 3'. */
+const uint8_t _nmd_aluLazyFlags[] = { _NMD_LAZY_FLAGS_ADD, _NMD_LAZY_FLAGS_LOGIC, _NMD_LAZY_FLAGS_ADC, _NMD_LAZY_FLAGS_SBB, _NMD_LAZY_FLAGS_LOGIC, _NMD_LAZY_FLAGS_SUB, _NMD_LAZY_FLAGS_LOGIC, _NMD_LAZY_FLAGS_SUB };
+
+/* Returns the result of the ALU operation 'operation'(add, or, adc, sbb, and, sub, xor, cmp) on 'value' and 'src'. */
+uint64_t _nmd_compute_alu(const nmd_x86_cpu* cpu, uint8_t operation, uint64_t value, uint64_t src)
+{
+	switch (operation)
+	{
+	case 0: return value + src;
+	case 1: return value | src;
+	case 2: return value + src + _nmd_get_carry_flag(cpu);
+	case 3: return value - src - _nmd_get_carry_flag(cpu);
+	case 4: return value & src;
+	case 6: return value ^ src;
+	default: return value - src; /* sub, cmp */
+	}
+}
+
+/* add, or, adc, sbb, and, sub, xor, cmp [00,3d] in the forms: Eb,Gb - Ev,Gv - Gb,Eb - Gv,Ev - AL,Ib - rAX,Iz. */
+int _nmd_emulate_alu(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t operation = instruction->opcode >> 3;
+	const uint8_t size = instruction->opcode % 2 == 0 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	void* dst;
+	const void* operand;
+	uint64_t src;
+
+	switch (instruction->opcode % 8)
+	{
+	case 0: case 1:
+		dst = _nmd_resolve_memory_operand(cpu, instruction, size, operation == 7 ? NMD_X86_EMULATOR_PAGE_READ : NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE);
+		if (!dst)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+		src = _nmd_read_by_size(_nmd_get_emulator_modrm_reg(cpu, instruction, size), size);
+		break;
+	case 2: case 3:
+		operand = _nmd_resolve_memory_operand(cpu, instruction, size, NMD_X86_EMULATOR_PAGE_READ);
+		if (!operand)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+		dst = _nmd_get_emulator_modrm_reg(cpu, instruction, size);
+		src = _nmd_read_by_size(operand, size);
+		break;
+	default:
+		dst = &cpu->rax;
+		src = size == 8 ? (uint64_t)(int32_t)instruction->immediate : instruction->immediate;
+		break;
+	}
+
+	const uint64_t value = _nmd_read_by_size(dst, size);
+	const uint64_t result = _nmd_compute_alu(cpu, operation, value, src);
+
+	if (operation != 7) /* cmp only sets the flags. */
+		_nmd_write_emulator_operand(cpu, dst, result, size);
+
+	_nmd_set_lazy_flags(cpu, _nmd_aluLazyFlags[operation], size, value, src, result);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* push/pop es,cs,ss,ds [06,1f] and fs,gs [0f a0,0f a9] */
+int _nmd_emulate_push_pop_segment(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	uint16_t* segment;
+	bool push;
+
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+	{
+		segment = instruction->opcode < 0xa8 ? &cpu->fs : &cpu->gs;
+		push = instruction->opcode % 8 == 0;
+	}
+	else
+	{
+		switch (instruction->opcode >> 3)
 		{
-			const char* str = 0;
-			switch (op)
-			{
-			case 0x31: str = "rdtsc"; break;
-			case 0x07: str = "sysret"; break;
-			case 0x06: str = "clts"; break;
-			case 0x08: str = "invd"; break;
-			case 0x09: str = "wbinvd"; break;
-			case 0x0b: str = "ud2"; break;
-			case 0x0e: str = "femms"; break;
-			case 0x30: str = "wrmsr"; break;
-			case 0x32: str = "rdmsr"; break;
-			case 0x33: str = "rdpmc"; break;
-			case 0x34: str = "sysenter"; break;
-			case 0x35: str = "sysexit"; break;
-			case 0x37: str = "getsec"; break;
-			case 0x77: str = "emms"; break;
-			case 0xa0: str = "push fs"; break;
-			case 0xa1: str = "pop fs"; break;
-			case 0xa8: str = "push gs"; break;
-			case 0xa9: str = "pop gs"; break;
-			case 0xaa: str = "rsm"; break;
-			default: return;
-			}
-			_nmd_append_string(&si, str);
+		case 0: segment = &cpu->es; break;
+		case 1: segment = &cpu->cs; break;
+		case 2: segment = &cpu->ss; break;
+		default: segment = &cpu->ds; break;
 		}
+		push = instruction->opcode % 8 == 6;
+	}
+
+	if (push)
+	{
+		uint16_t* stack = (uint16_t*)_nmd_get_emulator_memory(cpu, cpu->rsp.l64 - cpu->mode, sizeof(uint16_t), NMD_X86_EMULATOR_PAGE_WRITE);
+		if (!stack)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+
+		cpu->rsp.l64 -= cpu->mode;
+		*stack = *segment;
+	}
+	else
+	{
+		const uint16_t* stack = (const uint16_t*)_nmd_get_emulator_memory(cpu, cpu->rsp.l64, sizeof(uint16_t), NMD_X86_EMULATOR_PAGE_READ);
+		if (!stack)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+
+		*segment = *stack;
+		cpu->rsp.l64 += cpu->mode;
+	}
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* inc/dec [40,4f] */
+int _nmd_emulate_inc_dec(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	nmd_x86_register* r0 = _NMD_GET_GREG(instruction->opcode % 8);
+	const uint8_t size = _nmd_get_emulator_operand_size(instruction);
+	const uint64_t value = _nmd_read_by_size(r0, size);
+	const uint64_t result = instruction->opcode < 0x48 ? value + 1 : value - 1;
+	_nmd_write_emulator_operand(cpu, r0, result, size);
+
+	/* inc and dec do not modify CF, so its current value is kept in the lazy state. */
+	_nmd_set_lazy_flags(cpu, instruction->opcode < 0x48 ? _NMD_LAZY_FLAGS_INC : _NMD_LAZY_FLAGS_DEC, size, value, _nmd_get_carry_flag(cpu), result);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* push,pop [50,5f] */
+int _nmd_emulate_push_pop(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	void* r0 = _nmd_get_emulator_register(cpu, instruction, (uint8_t)(instruction->opcode % 8 | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0)), cpu->mode);
+	void* dst, * src;
+
+	if (instruction->opcode < 0x58) /* push */
+	{
+		dst = _nmd_get_emulator_memory(cpu, cpu->rsp.l64 - (int8_t)cpu->mode, cpu->mode, NMD_X86_EMULATOR_PAGE_WRITE);
+		if (!dst)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+		cpu->rsp.l64 -= (int8_t)cpu->mode;
+		src = r0;
+	}
+	else /* pop */
+	{
+		src = _nmd_get_emulator_memory(cpu, cpu->rsp.l64, cpu->mode, NMD_X86_EMULATOR_PAGE_READ);
+		if (!src)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+		cpu->rsp.l64 += (int8_t)cpu->mode;
+		dst = r0;
+	}
+
+	_nmd_copy_by_mode(dst, src, (NMD_X86_MODE)cpu->mode);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* pusha,pushad [60] */
+int _nmd_emulate_pusha(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = instruction->mode == NMD_X86_MODE_32 ? 4 : 2;
+	uint8_t* stack = (uint8_t*)_nmd_get_emulator_memory(cpu, (uint32_t)(cpu->rsp.l32 - size * 8), size * 8, NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	/* The registers are pushed from rax to rdi, so rdi is at the lowest address. The value of rsp is the one before the instruction. */
+	size_t i = 0;
+	for (; i < 8; i++)
+		_nmd_write_by_size(stack + i * size, (uint64_t)_NMD_GET_GREG(7 - i)->l64, size);
+
+	cpu->rsp.l32 -= size * 8;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* popa,popad [61] */
+int _nmd_emulate_popa(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = instruction->mode == NMD_X86_MODE_32 ? 4 : 2;
+	const uint8_t* stack = (const uint8_t*)_nmd_get_emulator_memory(cpu, (uint32_t)cpu->rsp.l32, size * 8, NMD_X86_EMULATOR_PAGE_READ);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	/* The stored value of rsp is skipped. */
+	size_t i = 0;
+	for (; i < 8; i++)
+	{
+		if (i != 3)
+			_nmd_write_by_size(_NMD_GET_GREG(7 - i), _nmd_read_by_size(stack + i * size, size), size);
+	}
+
+	cpu->rsp.l32 += size * 8;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* Conditional jumps, rel8 [70,7f] and rel32 [0f 80,0f 8f] */
+int _nmd_emulate_jcc(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	if (_nmd_check_jump_condition(cpu, NMD_C(instruction->opcode)))
+		cpu->rip += instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F ? (int32_t)instruction->immediate : (int8_t)instruction->immediate;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* setcc [0f 90,0f 9f] */
+int _nmd_emulate_setcc(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	uint8_t* operand = (uint8_t*)_nmd_resolve_memory_operand(cpu, instruction, 1, NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!operand)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	*operand = _nmd_check_jump_condition(cpu, NMD_C(instruction->opcode));
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* add, or, adc, sbb, and, sub, xor, cmp Eb,Ib - Ev,Iz - Eb,Ib - Ev,Ib [80,83]. 82 is an alias of 80 and the imm8 of 83 is sign-extended. */
+int _nmd_emulate_group1(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t operation = instruction->modrm.fields.reg;
+	const uint8_t size = instruction->opcode % 2 == 0 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	void* dst = _nmd_resolve_memory_operand(cpu, instruction, size, operation == 7 ? NMD_X86_EMULATOR_PAGE_READ : NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!dst)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	uint64_t src;
+	if (instruction->opcode == 0x83)
+		src = (uint64_t)(int8_t)instruction->immediate;
+	else
+		src = size == 8 ? (uint64_t)(int32_t)instruction->immediate : instruction->immediate;
+
+	const uint64_t value = _nmd_read_by_size(dst, size);
+	const uint64_t result = _nmd_compute_alu(cpu, operation, value, src);
+
+	if (operation != 7) /* cmp only sets the flags. */
+		_nmd_write_emulator_operand(cpu, dst, result, size);
+
+	_nmd_set_lazy_flags(cpu, _nmd_aluLazyFlags[operation], size, value, src, result);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* test Eb,Gb - Ev,Gv [84,85] and test AL,Ib - rAX,Iz [a8,a9] */
+int _nmd_emulate_test(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = instruction->opcode % 2 == 0 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	const void* operand;
+	uint64_t src;
+
+	if (instruction->opcode >= 0xa8)
+	{
+		operand = &cpu->rax;
+		src = size == 8 ? (uint64_t)(int32_t)instruction->immediate : instruction->immediate;
+	}
+	else
+	{
+		operand = _nmd_resolve_memory_operand(cpu, instruction, size, NMD_X86_EMULATOR_PAGE_READ);
+		if (!operand)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+		src = _nmd_read_by_size(_nmd_get_emulator_modrm_reg(cpu, instruction, size), size);
+	}
+
+	const uint64_t value = _nmd_read_by_size(operand, size);
+	_nmd_set_lazy_flags(cpu, _NMD_LAZY_FLAGS_LOGIC, size, value, src, value & src);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* mov [88,8b] */
+int _nmd_emulate_mov(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = instruction->opcode % 2 == 0 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	void* r0 = _nmd_get_emulator_modrm_reg(cpu, instruction, size);
+	void* operand = _nmd_resolve_memory_operand(cpu, instruction, size, instruction->opcode < 0x8a ? NMD_X86_EMULATOR_PAGE_WRITE : NMD_X86_EMULATOR_PAGE_READ);
+	if (!operand)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	if (instruction->opcode < 0x8a) /* mov Eb,Gb - mov Ev,Gv */
+		_nmd_write_emulator_operand(cpu, operand, _nmd_read_by_size(r0, size), size);
+	else /* mov Gb,Eb - mov Gv,Ev */
+		_nmd_write_emulator_operand(cpu, r0, _nmd_read_by_size(operand, size), size);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* lea [8d] */
+int _nmd_emulate_lea(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = _nmd_get_emulator_operand_size(instruction);
+	_nmd_write_emulator_operand(cpu, _nmd_get_emulator_modrm_reg(cpu, instruction, size), (uint64_t)_nmd_resolve_memory_operand_va(cpu, instruction), size);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* xchg rAX, r [90,97]. 90 without REX.B is nop, which doesn't clear the upper half of rax in 64 bit mode. */
+int _nmd_emulate_xchg(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t reg = (uint8_t)(instruction->opcode % 8 | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0));
+	if (reg == 0)
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+
+	const uint8_t size = _nmd_get_emulator_operand_size(instruction);
+	void* r0 = _nmd_get_emulator_register(cpu, instruction, reg, size);
+	const uint64_t value = _nmd_read_by_size(r0, size);
+	_nmd_write_emulator_operand(cpu, r0, _nmd_read_by_size(&cpu->rax, size), size);
+	_nmd_write_emulator_operand(cpu, &cpu->rax, value, size);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* pushf [9c] */
+int _nmd_emulate_pushf(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	uint64_t value;
+
+	void* stack = _nmd_get_emulator_memory(cpu, cpu->rsp.l64 - (int8_t)cpu->mode, cpu->mode, NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	_nmd_update_flags(cpu);
+	value = cpu->flags.eflags;
+
+	cpu->rsp.l64 -= (int8_t)cpu->mode;
+	_nmd_copy_by_mode(stack, &value, (NMD_X86_MODE)cpu->mode);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* popf [9d] */
+int _nmd_emulate_popf(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	uint64_t value = 0;
+	void* stack = _nmd_get_emulator_memory(cpu, cpu->rsp.l64, cpu->mode, NMD_X86_EMULATOR_PAGE_READ);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	_nmd_copy_by_mode(&value, stack, (NMD_X86_MODE)cpu->mode);
+	cpu->rsp.l64 += (int8_t)cpu->mode;
+
+	cpu->flags.eflags = (uint32_t)value;
+	cpu->lazyFlags.operation = _NMD_LAZY_FLAGS_NONE;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* sahf [9e] */
+int _nmd_emulate_sahf(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	_nmd_update_flags(cpu);
+	cpu->flags.l8 = *((uint8_t*)&cpu->rax + 1); /* ah */
+	(void)instruction;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* lahf [9f] */
+int _nmd_emulate_lahf(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	_nmd_update_flags(cpu);
+	*((uint8_t*)&cpu->rax + 1) = cpu->flags.l8; /* ah */
+	(void)instruction;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* mov reg, imm [b0,bf] */
+int _nmd_emulate_mov_immediate(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t size = instruction->opcode < 0xb8 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	void* r0 = _nmd_get_emulator_register(cpu, instruction, (uint8_t)(instruction->opcode % 8 | (instruction->prefixes & NMD_X86_PREFIXES_REX_B ? 8 : 0)), size);
+	_nmd_write_emulator_operand(cpu, r0, instruction->immediate, size);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* ret [c3] and ret imm16 [c2] */
+int _nmd_emulate_ret(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	void* stack = _nmd_get_emulator_memory(cpu, cpu->rsp.l64, cpu->mode, NMD_X86_EMULATOR_PAGE_READ);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	/* pop rip. The emulator advances 'cpu->rip' past the instruction after it executes, so that is compensated. */
+	_nmd_copy_by_mode(&cpu->rip, stack, (NMD_X86_MODE)cpu->mode);
+	cpu->rip -= instruction->length;
+	cpu->rsp.l64 += cpu->mode;
+	if (instruction->opcode == 0xc2) /* ret imm16 also releases 'imm16' bytes of arguments. */
+		cpu->rsp.l64 += (uint16_t)instruction->immediate;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* int3 [cc], int n [cd], into [ce] and int1 [f1] */
+int _nmd_emulate_interrupt(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	NMD_X86_EMULATOR_EXCEPTION exception;
+	switch (instruction->opcode)
+	{
+	case 0xcc: exception = NMD_X86_EMULATOR_EXCEPTION_BREAKPOINT; break;
+	case 0xce: exception = NMD_X86_EMULATOR_EXCEPTION_OVERFLOW; break;
+	case 0xf1: exception = NMD_X86_EMULATOR_EXCEPTION_DEBUG; break;
+	default: exception = NMD_X86_EMULATOR_EXCEPTION_INTERRUPT; break;
 	}
-	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F38)
+
+	_nmd_update_flags(cpu);
+	if (exception == NMD_X86_EMULATOR_EXCEPTION_OVERFLOW && !cpu->flags.fields.OF) /* into only traps if OF is set. */
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+
+	if (cpu->callback)
+		cpu->callback(cpu, instruction, exception);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* rol, ror, rcl, rcr, shl, shr, sal, sar Eb,Ib - Ev,Ib [c0,c1], Eb,1 - Ev,1 [d0,d1] and Eb,CL - Ev,CL [d2,d3] */
+int _nmd_emulate_group2(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t reg = instruction->modrm.fields.reg;
+	const uint8_t size = instruction->opcode % 2 == 0 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	const uint8_t bits = (uint8_t)(size * 8);
+	const uint64_t mask = size == 8 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+	const uint64_t sign = (uint64_t)1 << (bits - 1);
+	void* operand = _nmd_resolve_memory_operand(cpu, instruction, size, NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!operand)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	uint8_t count = (uint8_t)(instruction->opcode <= 0xc1 ? instruction->immediate : (instruction->opcode <= 0xd1 ? 1 : (uint8_t)cpu->rcx.l8));
+	count &= size == 8 ? 0x3f : 0x1f;
+
+	const uint64_t value = _nmd_read_by_size(operand, size);
+
+	/* A count of zero leaves the operand and the flags unchanged, but a 32-bit register is still zero-extended. */
+	if (count == 0)
 	{
-		if ((NMD_R(op) == 2 || NMD_R(op) == 3) && NMD_C(op) <= 5)
-		{
-			const char* mnemonics[] = { "pmovsxbw", "pmovsxbd", "pmovsxbq", "pmovsxwd", "pmovsxwq", "pmovsxdq" };
-			_nmd_append_string(&si, mnemonics[NMD_C(op)]);
-			if (NMD_R(op) == 3)
-				*(si.buffer - 4) = 'z';
-			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			if (instruction->modrm.fields.mod == 0b11)
-				_nmd_append_Udq(&si);
-			else
-				_nmd_append_modrm_upper(&si, NMD_C(op) == 5 ? "qword" : (NMD_C(op) % 3 == 0 ? "qword" : (NMD_C(op) % 3 == 1 ? "dword" : "word")));
-		}
-		else if (op >= 0x80 && op <= 0x83)
-		{
-			_nmd_append_string(&si, op == 0x80 ? "invept" : (op == 0x81 ? "invvpid" : "invpcid"));
-			*si.buffer++ = ' ';
-			_nmd_append_Gy(&si);
-			*si.buffer++ = ',';
-			_nmd_append_modrm_upper(&si, "xmmword");
-		}
-		else if (op >= 0xc8 && op <= 0xcd)
-		{
-			const char* mnemonics[] = { "sha1nexte", "sha1msg1", "sha1msg2", "sha256rnds2", "sha256msg1", "sha256msg2" };
-			_nmd_append_string(&si, mnemonics[op - 0xc8]);
-			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_W(&si);
-		}
-		else if (op == 0xcf)
-		{
-			_nmd_append_string(&si, "gf2p8mulb ");
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			_nmd_append_W(&si);
-		}
-		else if (op == 0xf0 || op == 0xf1)
-		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO ? "crc32" : "movbe");
-			*si.buffer++ = ' ';
-			if (op == 0xf0)
-			{
-				if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-				{
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-					*si.buffer++ = ',';
-					_nmd_append_Eb(&si);
-				}
-				else
-				{
-					_nmd_append_Gv(&si);
-					*si.buffer++ = ',';
-					_nmd_append_Ev(&si);
-				}
-			}
-			else
-			{
-				if (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT_NOT_ZERO)
-				{
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.reg]);
-					*si.buffer++ = ',';
-					if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-						_nmd_append_Ew(&si);
-					else
-						_nmd_append_Ey(&si);
-				}
-				else
-				{
-					_nmd_append_Ev(&si);
-					*si.buffer++ = ',';
-					_nmd_append_Gv(&si);
-				}
-			}
-		}
-		else if (op == 0xf6)
-		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "adcx" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "adox" : (instruction->operandSize64 ? "wrssq" : "wrssd")));
-			*si.buffer++ = ' ';
-			if (!instruction->simdPrefix)
-			{
-				_nmd_append_Ey(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Gy(&si);
-			}
-			else
-			{
-				_nmd_append_Gy(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Ey(&si);
-			}
-		}
-		else if (op == 0xf5)
-		{
-			_nmd_append_string(&si, instruction->operandSize64 ? "wrussq " : "wrussd ");
-			_nmd_append_modrm_upper(&si, instruction->operandSize64 ? "qword" : "dword");
-			*si.buffer++ = ',';
-			_nmd_append_string(&si, (instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.reg]);
-		}
-		else if (op == 0xf8)
-		{
-			_nmd_append_string(&si, instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE ? "movdir64b" : (instruction->simdPrefix == NMD_X86_PREFIXES_REPEAT ? "enqcmd" : "enqcmds"));
-			*si.buffer++ = ' ';
-			_nmd_append_string(&si, (instruction->mode == NMD_X86_MODE_64 ? _nmd_reg64 : (instruction->mode == NMD_X86_MODE_16 ? _nmd_reg16 : _nmd_reg32))[instruction->modrm.fields.rm]);
-			*si.buffer++ = ',';
-			_nmd_append_modrm_upper(&si, "zmmword");
-		}
-		else if (op == 0xf9)
+		_nmd_write_emulator_operand(cpu, operand, value, size);
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+
+	uint64_t result = value;
+	bool carry, overflow;
+
+	if (reg <= 3) /* rol, ror, rcl and rcr only modify CF and OF. OF is only defined for a count of one. */
+	{
+		if (reg <= 1)
 		{
-			_nmd_append_string(&si, "movdiri ");
-			_nmd_append_modrm_upper_without_address_specifier(&si);
-			*si.buffer++ = ',';
-			_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.rm]);
+			const uint8_t n = count % bits;
+			if (n)
+				result = (reg == 0 ? (value << n) | (value >> (bits - n)) : (value >> n) | (value << (bits - n))) & mask;
+			carry = reg == 0 ? (result & 1) != 0 : (result & sign) != 0;
 		}
 		else
 		{
-			if (op == 0x40)
-				_nmd_append_string(&si, "pmulld");
-			else if (op == 0x41)
-				_nmd_append_string(&si, "phminposuw");
-			else if (op >= 0xdb && op <= 0xdf)
-			{
-				const char* mnemonics[] = { "aesimc", "aesenc", "aesenclast", "aesdec", "aesdeclast" };
-				_nmd_append_string(&si, mnemonics[op - 0xdb]);
-			}
-			else if (op == 0x37)
-				_nmd_append_string(&si, "pcmpgtq");
-			else if (NMD_R(op) == 2)
-			{
-				const char* mnemonics[] = { "pmuldq", "pcmpeqq", "movntdqa", "packusdw" };
-				_nmd_append_string(&si, mnemonics[NMD_C(op) - 8]);
-			}
-			else if (NMD_R(op) == 3)
-			{
-				const char* mnemonics[] = { "pminsb", "pminsd", "pminuw", "pminud", "pmaxsb", "pmaxsd", "pmaxuw", "pmaxud" };
-				_nmd_append_string(&si, mnemonics[NMD_C(op) - 8]);
-			}
-			else if (op < 0x10)
-			{
-				const char* mnemonics[] = { "pshufb", "phaddw", "phaddd", "phaddsw", "pmaddubsw", "phsubw", "phsubd", "phsubsw", "psignb", "psignw", "psignd", "pmulhrsw", "permilpsv", "permilpdv", "testpsv", "testpdv" };
-				_nmd_append_string(&si, mnemonics[op]);
-			}
-			else if (op < 0x18)
-				_nmd_append_string(&si, op == 0x10 ? "pblendvb" : (op == 0x14 ? "blendvps" : (op == 0x15 ? "blendvpd" : "ptest")));
-			else
-			{
-				_nmd_append_string(&si, "pabs");
-				*si.buffer++ = op == 0x1c ? 'b' : (op == 0x1d ? 'w' : 'd');
-			}
-			*si.buffer++ = ' ';
-			if (instruction->simdPrefix == NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_W(&si);
-			}
-			else
+			/* CF is rotated as an extra bit of the operand, so the count of a byte is taken modulo 9 and the count of a word modulo 17. */
+			uint8_t n = size == 1 ? count % 9 : (size == 2 ? count % 17 : count);
+			carry = _nmd_get_carry_flag(cpu);
+			for (; n; n--)
 			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Qq(&si);
+				const bool out = reg == 2 ? (result & sign) != 0 : (result & 1) != 0;
+				result = reg == 2 ? ((result << 1) | (uint64_t)carry) & mask : (result >> 1) | (carry ? sign : 0);
+				carry = out;
 			}
 		}
 
+		if (reg % 2 == 0) /* rol, rcl */
+			overflow = ((result & sign) != 0) != carry;
+		else /* ror, rcr */
+			overflow = ((result & sign) != 0) != ((result & (sign >> 1)) != 0);
+
+		_nmd_update_flags(cpu);
+		cpu->flags.fields.CF = carry;
+		cpu->flags.fields.OF = overflow;
 	}
-	else if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F3A)
+	else
 	{
-		if (NMD_R(op) == 1)
+		if (reg == 5) /* shr */
 		{
-			const char* mnemonics[] = { "pextrb", "pextrw", "pextrd", "extractps" };
-			_nmd_append_string(&si, mnemonics[op - 0x14]);
-			*si.buffer++ = ' ';
-			if (instruction->modrm.fields.mod == 0b11)
-				_nmd_append_string(&si, (si.instruction->operandSize64 ? _nmd_reg64 : _nmd_reg32)[instruction->modrm.fields.rm]);
-			else
-			{
-				if (op == 0x14)
-					_nmd_append_modrm_upper(&si, "byte");
-				else if (op == 0x15)
-					_nmd_append_modrm_upper(&si, "word");
-				else if (op == 0x16)
-					_nmd_append_Ey(&si);
-				else
-					_nmd_append_modrm_upper(&si, "dword");
-			}
-			*si.buffer++ = ',';
-			_nmd_append_Vdq(&si);
+			result = value >> count;
+			carry = ((value >> (count - 1)) & 1) != 0;
+			overflow = (value & sign) != 0;
 		}
-		else if (NMD_R(op) == 2)
+		else if (reg == 7) /* sar */
 		{
-			_nmd_append_string(&si, op == 0x20 ? "pinsrb" : (op == 0x21 ? "insertps" : "pinsrd"));
-			*si.buffer++ = ' ';
-			_nmd_append_Vdq(&si);
-			*si.buffer++ = ',';
-			if (op == 0x20)
-			{
-				if (instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, _nmd_reg32[instruction->modrm.fields.rm]);
-				else
-					_nmd_append_modrm_upper(&si, "byte");
-			}
-			else if (op == 0x21)
-			{
-				if (instruction->modrm.fields.mod == 0b11)
-					_nmd_append_Udq(&si);
-				else
-					_nmd_append_modrm_upper(&si, "dword");
-			}
-			else
-				_nmd_append_Ey(&si);
+			result = value >> count;
+			if (value & sign)
+				result |= mask & ~(mask >> count);
+			carry = count <= bits ? ((value >> (count - 1)) & 1) != 0 : (value & sign) != 0;
+			overflow = false;
 		}
-		else
+		else /* shl, sal(/6 is an alias of /4) */
 		{
-			if (op < 0x10)
-			{
-				const char* mnemonics[] = { "roundps", "roundpd", "roundss", "roundsd", "blendps", "blendpd", "pblendw", "palignr" };
-				_nmd_append_string(&si, mnemonics[op - 8]);
-			}
-			else if (NMD_R(op) == 4)
-			{
-				const char* mnemonics[] = { "dpps", "dppd", "mpsadbw", 0, "pclmulqdq" };
-				_nmd_append_string(&si, mnemonics[NMD_C(op)]);
-			}
-			else if (NMD_R(op) == 6)
-			{
-				const char* mnemonics[] = { "pcmpestrm", "pcmpestri", "pcmpistrm", "pcmpistri" };
-				_nmd_append_string(&si, mnemonics[NMD_C(op)]);
-			}
-			else if (op > 0x80)
-				_nmd_append_string(&si, op == 0xcc ? "sha1rnds4" : (op == 0xce ? "gf2p8affineqb" : (op == 0xcf ? "gf2p8affineinvqb" : "aeskeygenassist")));
-			*si.buffer++ = ' ';
-			if (op == 0xf && !(instruction->prefixes & (NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE | NMD_X86_PREFIXES_REPEAT | NMD_X86_PREFIXES_REPEAT_NOT_ZERO)))
-			{
-				_nmd_append_Pq(&si);
-				*si.buffer++ = ',';
-				_nmd_append_Qq(&si);
-			}
-			else
-			{
-				_nmd_append_Vdq(&si);
-				*si.buffer++ = ',';
-				if (instruction->modrm.fields.mod == 0b11)
-					_nmd_append_string(&si, "xmm"), * si.buffer++ = (char)('0' + instruction->modrm.fields.rm);
-				else
-					_nmd_append_modrm_upper(&si, op == 0xa ? "dword" : (op == 0xb ? "qword" : "xmmword"));
-			}
+			result = (value << count) & mask;
+			carry = count <= bits && ((value >> (bits - count)) & 1) != 0;
+			overflow = ((result & sign) != 0) != carry;
 		}
-		*si.buffer++ = ',';
-		_nmd_append_number(&si, instruction->immediate);
+
+		_nmd_set_lazy_flags(cpu, _NMD_LAZY_FLAGS_SHIFT, size, value, (uint64_t)carry | ((uint64_t)overflow << 1), result);
 	}
 
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX
-	if (formatFlags & NMD_X86_FORMAT_FLAGS_ATT_SYNTAX)
+	_nmd_write_emulator_operand(cpu, operand, result, size);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* call rel32 [e8] */
+int _nmd_emulate_call(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	void* stack = _nmd_get_emulator_memory(cpu, cpu->rsp.l64 - (int8_t)cpu->mode, cpu->mode, NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	/* push the address of the next instruction onto the stack. */
+	const uint64_t returnAddress = cpu->rip + instruction->length;
+	cpu->rsp.l64 -= (int8_t)cpu->mode;
+	_nmd_copy_by_mode(stack, (void*)&returnAddress, (NMD_X86_MODE)cpu->mode);
+
+	/* jump */
+	cpu->rip += (int32_t)instruction->immediate;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* jmp rel32 [e9] and jmp rel8 [eb] */
+int _nmd_emulate_jmp(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	cpu->rip += instruction->opcode == 0xe9 ? (int32_t)instruction->immediate : (int8_t)instruction->immediate;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
+
+/* hlt [f4] */
+int _nmd_emulate_hlt(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	(void)instruction;
+
+	cpu->running = false;
+	return _NMD_EMULATOR_STATUS_HALT;
+}
+
+/* cmc [f5], clc [f8], stc [f9], cli [fa], sti [fb], cld [fc] and std [fd] */
+int _nmd_emulate_flag(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	_nmd_update_flags(cpu);
+
+	switch (instruction->opcode)
 	{
-		*si.buffer = '\0';
-		char* operand = (char*)_nmd_reverse_strchr(buffer, ' ');
-		if (operand && *(operand - 1) != ' ') /* If the instruction has a ' '(space character) and the left character of 'operand' is not ' '(space) the instruction has operands. */
-		{
-			/* If there is a memory operand. */
-			const char* memoryOperand = _nmd_strchr(buffer, '[');
-			if (memoryOperand)
-			{
-				/* If the memory operand has pointer size. */
-				char* tmp2 = (char*)memoryOperand - (*(memoryOperand - 1) == ':' ? 7 : 4);
-				if (_nmd_strstr(tmp2, "ptr") == tmp2)
-				{
-					/* Find the ' '(space) that is after two ' '(spaces). */
-					tmp2 -= 2;
-					while (*tmp2 != ' ')
-						tmp2--;
-					operand = tmp2;
-				}
-			}
+	case 0xf5: cpu->flags.fields.CF = ~cpu->flags.fields.CF; break;
+	case 0xf8: cpu->flags.fields.CF = 0; break;
+	case 0xf9: cpu->flags.fields.CF = 1; break;
+	case 0xfa: cpu->flags.fields.IF = 0; break;
+	case 0xfb: cpu->flags.fields.IF = 1; break;
+	case 0xfc: cpu->flags.fields.DF = 0; break;
+	case 0xfd: cpu->flags.fields.DF = 1; break;
+	}
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+}
 
-			const char* const firstOperandConst = operand;
-			char* firstOperand = operand + 1;
-			char* secondOperand = 0;
-			/* Convert each operand to AT&T syntax. */
-			do
-			{
-				operand++;
-				operand = _nmd_format_operand_to_att(operand, &si);
-				if (*operand == ',')
-					secondOperand = operand;
-			} while (*operand);
+/* Multiplies the 'size'-byte numbers 'a' and 'b', as signed numbers if 'isSigned' is true. Returns the lower half of the product and stores the upper half in 'high'. */
+uint64_t _nmd_multiply(uint64_t a, uint64_t b, uint8_t size, bool isSigned, uint64_t* high)
+{
+	const uint8_t bits = (uint8_t)(size * 8);
+	const uint64_t mask = size == 8 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+	const uint64_t sign = (uint64_t)1 << (bits - 1);
 
-			/* Swap operands. */
-			if (secondOperand) /* At least two operands. */
-			{
-				/* Copy first operand to 'tmpBuffer'. */
-				char tmpBuffer[64];
-				char* i = tmpBuffer;
-				char* j = firstOperand;
-				for (; j < secondOperand; i++, j++)
-					*i = *j;
+	if (size < 8)
+	{
+		const uint64_t product = isSigned ? (uint64_t)((int64_t)(a & sign ? a | ~mask : a) * (int64_t)(b & sign ? b | ~mask : b)) : a * b;
+		*high = (product >> bits) & mask;
+		return product & mask;
+	}
 
-				*i = '\0';
+	/* The 128-bit product is the sum of the products of the 32-bit halves. */
+	const uint64_t a0 = a & 0xffffffff, a1 = a >> 32, b0 = b & 0xffffffff, b1 = b >> 32;
+	const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0;
+	const uint64_t middle = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+	*high = a1 * b1 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
 
-				/* Copy second operand to first operand. */
-				for (i = secondOperand + 1; *i; firstOperand++, i++)
-					*firstOperand = *i;
+	/* A negative operand is 2^64 less than its unsigned value, which subtracts the other operand from the upper half. */
+	if (isSigned)
+		*high -= (a & sign ? b : 0) + (b & sign ? a : 0);
 
-				*firstOperand++ = ',';
+	return (middle << 32) | (p00 & 0xffffffff);
+}
 
-				/* 'firstOperand' is now the second operand. */
-				/* Copy 'tmpBuffer' to second operand. */
-				for (i = tmpBuffer; *firstOperand; i++, firstOperand++)
-					*firstOperand = *i;
-			}
+/*
+Divides the double-size number 'high':'low' by 'divisor', which are 'size' bytes each, as signed numbers if 'isSigned' is true. Stores the quotient in 'low'
+and the remainder in 'high'. Returns false if the divisor is zero or the quotient doesn't fit in 'size' bytes.
+*/
+bool _nmd_divide(uint64_t* high, uint64_t* low, uint64_t divisor, uint8_t size, bool isSigned)
+{
+	const uint8_t bits = (uint8_t)(size * 8);
+	const uint64_t mask = size == 8 ? (uint64_t)-1 : ((uint64_t)1 << bits) - 1;
+	const uint64_t sign = (uint64_t)1 << (bits - 1);
+	const bool negativeDividend = isSigned && (*high & sign);
+	const bool negativeDivisor = isSigned && (divisor & sign);
+	uint64_t h = *high, l = *low;
+	uint8_t i = 0;
 
-			/* Memory operands change the mnemonic string(e.g. 'mov eax, dword ptr [ebx]' -> 'movl (%ebx), %eax'). */
-			if (memoryOperand && !_nmd_strstr(firstOperandConst - 4, "lea"))
-			{
-				const char* r_char = _nmd_strchr(firstOperandConst, 'r');
-				const char* e_char = _nmd_strchr(firstOperandConst, 'e');
-				const char* call_str = _nmd_strstr(firstOperandConst - 5, "call");
-				const char* jmp_str = _nmd_strstr(firstOperandConst - 4, "jmp");
-				_nmd_insert_char(firstOperandConst, (instruction->mode == NMD_X86_MODE_64 && ((r_char && *(r_char - 1) == '%') || call_str || jmp_str)) ? 'q' : (instruction->mode == NMD_X86_MODE_32 && ((e_char && *(e_char - 1) == '%') || call_str || jmp_str) ? 'l' : 'b'));
-				si.buffer++;
-			}
-		}
+	/* Signed numbers are divided by their magnitudes. */
+	if (negativeDividend)
+	{
+		l = (0 - l) & mask;
+		h = (~h + (l == 0)) & mask;
 	}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_ATT_SYNTAX */
+	if (negativeDivisor)
+		divisor = (0 - divisor) & mask;
 
-	size_t stringLength = si.buffer - buffer;
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE
-	if (formatFlags & NMD_X86_FORMAT_FLAGS_UPPERCASE)
+	/* The quotient fits in 'size' bytes only if the upper half is less than the divisor. */
+	if (divisor == 0 || h >= divisor)
+		return false;
+
+	/* Shift-and-subtract long division, one bit of the quotient at a time. */
+	for (; i < bits; i++)
 	{
-		size_t i = 0;
-		for (; i < stringLength; i++)
+		const bool carry = (h & sign) != 0;
+		h = ((h << 1) | (l >> (bits - 1))) & mask;
+		l = (l << 1) & mask;
+		if (carry || h >= divisor)
 		{
-			if (_NMD_IS_LOWERCASE(buffer[i]))
-				buffer[i] -= 0x20; /* Capitalize letter. */
+			h = (h - divisor) & mask;
+			l |= 1;
 		}
 	}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_UPPERCASE */
 
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES
-	if (formatFlags & NMD_X86_FORMAT_FLAGS_COMMA_SPACES)
+	if (isSigned)
 	{
-		size_t i = 0;
-		for (; i < stringLength; i++)
+		/* The quotient is negative if the signs differ and the remainder has the sign of the dividend. */
+		if (negativeDividend != negativeDivisor)
 		{
-			if (buffer[i] == ',')
-			{
-				/* Move all characters after the comma one position to the right. */
-				size_t j = stringLength;
-				for (; j > i; j--)
-					buffer[j] = buffer[j - 1];
-
-				buffer[i + 1] = ' ';
-				si.buffer++, stringLength++;
-			}
+			if (l > sign)
+				return false;
+			l = (0 - l) & mask;
 		}
+		else if (l >= sign)
+			return false;
+
+		if (negativeDividend)
+			h = (0 - h) & mask;
 	}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_COMMA_SPACES */
 
-#ifndef NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES
-	if (formatFlags & NMD_X86_FORMAT_FLAGS_OPERATOR_SPACES)
+	*high = h;
+	*low = l;
+	return true;
+}
+
+/* test Eb,Ib - Ev,Iz [f6 /0,/1 - f7 /0,/1] and not, neg, mul, imul, div, idiv Eb - Ev [f6 /2-/7 - f7 /2-/7]. The double-size operand of mul, imul, div and idiv is AH:AL or rDX:rAX. */
+int _nmd_emulate_group3(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+{
+	const uint8_t reg = instruction->modrm.fields.reg;
+	const uint8_t size = instruction->opcode == 0xf6 ? 1 : _nmd_get_emulator_operand_size(instruction);
+	const uint64_t mask = size == 8 ? (uint64_t)-1 : ((uint64_t)1 << (size * 8)) - 1;
+	const uint64_t sign = (uint64_t)1 << (size * 8 - 1);
+	void* operand = _nmd_resolve_memory_operand(cpu, instruction, size, reg == 2 || reg == 3 ? NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE : NMD_X86_EMULATOR_PAGE_READ);
+	if (!operand)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	const uint64_t value = _nmd_read_by_size(operand, size);
+	uint64_t low, high;
+
+	if (reg <= 1) /* test(/1 is an alias of /0) */
 	{
-		size_t i = 0;
-		for (; i < stringLength; i++)
-		{
-			if (buffer[i] == '+' || (buffer[i] == '-' && buffer[i - 1] != ' ' && buffer[i - 1] != '('))
-			{
-				/* Move all characters after the operator two positions to the right. */
-				size_t j = stringLength + 1;
-				for (; j > i; j--)
-					buffer[j] = buffer[j - 2];
+		const uint64_t src = size == 8 ? (uint64_t)(int32_t)instruction->immediate : instruction->immediate;
+		_nmd_set_lazy_flags(cpu, _NMD_LAZY_FLAGS_LOGIC, size, value, src, value & src);
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+	else if (reg == 2) /* not doesn't modify the flags. */
+	{
+		_nmd_write_emulator_operand(cpu, operand, ~value, size);
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+	else if (reg == 3) /* neg sets the flags of '0 - operand'. */
+	{
+		_nmd_write_emulator_operand(cpu, operand, 0 - value, size);
+		_nmd_set_lazy_flags(cpu, _NMD_LAZY_FLAGS_SUB, size, 0, value, 0 - value);
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+	else if (reg <= 5) /* mul, imul: CF and OF are set if the upper half is significant, SF, ZF, AF and PF are undefined. */
+	{
+		low = _nmd_multiply(_nmd_read_by_size(&cpu->rax, size), value, size, reg == 5, &high);
+		const bool overflow = high != (reg == 5 && (low & sign) ? mask : 0);
+		_nmd_set_lazy_flags(cpu, _NMD_LAZY_FLAGS_SHIFT, size, 0, overflow ? 3 : 0, low);
+	}
+	else /* div, idiv: the quotient is written to the lower half and the remainder to the upper half. The flags are undefined. */
+	{
+		high = size == 1 ? (uint8_t)((uint16_t)cpu->rax.l16 >> 8) : _nmd_read_by_size(&cpu->rdx, size);
+		low = _nmd_read_by_size(&cpu->rax, size);
+		if (!_nmd_divide(&high, &low, value, size, reg == 7))
+			return _nmd_emulator_fault(cpu, instruction, NMD_X86_EMULATOR_EXCEPTION_DIVIDE);
+	}
 
-				buffer[i + 1] = buffer[i];
-				buffer[i] = ' ';
-				buffer[i + 2] = ' ';
-				si.buffer += 2, stringLength += 2;
-				i++;
-			}
-		}
+	if (size == 1) /* AH:AL */
+		_nmd_write_by_size(&cpu->rax, low | (high << 8), 2);
+	else
+	{
+		_nmd_write_emulator_operand(cpu, &cpu->rax, low, size);
+		_nmd_write_emulator_operand(cpu, &cpu->rdx, high, size);
 	}
-#endif /* NMD_ASSEMBLY_DISABLE_FORMATTER_OPERATOR_SPACES */
 
-	*si.buffer = '\0';
+	return _NMD_EMULATOR_STATUS_CONTINUE;
 }
 
-#define NMD_EMULATOR_RESOLVE_VA(va) ((void*)((uint64_t)cpu.physicalMemory + (va - cpu.virtualAddress)))
-
-bool _nmd_check_jump_condition(nmd_x86_cpu* const cpu, uint8_t opcodeCondition)
+/* inc/dec Eb [fe /0,/1] and inc/dec, call, jmp, push Ev [ff /0,/1,/2,/4,/6]. The far forms of call and jmp are not implemented. */
+int _nmd_emulate_group5(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
 {
-	switch (opcodeCondition)
+	const uint8_t reg = instruction->modrm.fields.reg;
+
+	if (reg <= 1) /* inc, dec */
 	{
-	case 0x0: return cpu->flags.fields.OF == 1;                                                 /* Jump if overflow (OF=1) */
-	case 0x1: return cpu->flags.fields.OF == 0;                                                 /* Jump if not overflow (OF=0) */
-	case 0x2: return cpu->flags.fields.CF == 1;                                                 /* Jump if not above or equal (CF=1) */
-	case 0x3: return cpu->flags.fields.CF == 0;                                                 /* Jump if not below (CF=0) */
-	case 0x4: return cpu->flags.fields.ZF == 1;                                                 /* Jump if equal (ZF=1) */
-	case 0x5: return cpu->flags.fields.ZF == 0;                                                 /* Jump if not equal (ZF=0) */
-	case 0x6: return cpu->flags.fields.CF == 1 || cpu->flags.fields.ZF == 1;                    /* Jump if not above (CF=1 or ZF=1) */
-	case 0x7: return cpu->flags.fields.CF == 0 && cpu->flags.fields.ZF == 0;                    /* Jump if not below or equal (CF=0 and ZF=0) */
-	case 0x8: return cpu->flags.fields.SF == 1;                                                 /* Jump if sign (SF=1) */
-	case 0x9: return cpu->flags.fields.SF == 0;                                                 /* Jump if not sign (SF=0) */
-	case 0xa: return cpu->flags.fields.PF == 1;                                                 /* Jump if parity/parity even (PF=1) */
-	case 0xb: return cpu->flags.fields.PF == 0;                                                 /* Jump if parity odd (PF=0) */
-	case 0xc: return cpu->flags.fields.SF != cpu->flags.fields.OF;                              /* Jump if not greater or equal (SF != OF) */
-	case 0xd: return cpu->flags.fields.SF == cpu->flags.fields.OF;                              /* Jump if not less (SF=OF) */
-	case 0xe: return cpu->flags.fields.ZF == 1 || cpu->flags.fields.SF != cpu->flags.fields.OF; /* Jump if not greater (ZF=1 or SF != OF) */
-	case 0xf: return cpu->flags.fields.ZF == 0 && cpu->flags.fields.SF == cpu->flags.fields.OF; /* Jump if not less or equal (ZF=0 and SF=OF) */
-	default: return false;
+		const uint8_t size = instruction->opcode == 0xfe ? 1 : _nmd_get_emulator_operand_size(instruction);
+		void* operand = _nmd_resolve_memory_operand(cpu, instruction, size, NMD_X86_EMULATOR_PAGE_READ | NMD_X86_EMULATOR_PAGE_WRITE);
+		if (!operand)
+			return _nmd_emulator_memory_fault(cpu, instruction);
+
+		const uint64_t value = _nmd_read_by_size(operand, size);
+		const uint64_t result = reg == 0 ? value + 1 : value - 1;
+		_nmd_write_emulator_operand(cpu, operand, result, size);
+
+		/* inc and dec do not modify CF, so its current value is kept in the lazy state. */
+		_nmd_set_lazy_flags(cpu, reg == 0 ? _NMD_LAZY_FLAGS_INC : _NMD_LAZY_FLAGS_DEC, size, value, _nmd_get_carry_flag(cpu), result);
+
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+
+	if (instruction->opcode == 0xfe || reg == 3 || reg == 5 || reg == 7)
+		return _nmd_emulate_unimplemented(cpu, instruction);
+
+	/* call, jmp and push use the stack width of the mode. The operand is read before the stack pointer changes, it may be relative to it. */
+	void* operand = _nmd_resolve_memory_operand(cpu, instruction, cpu->mode, NMD_X86_EMULATOR_PAGE_READ);
+	if (!operand)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	uint64_t value = 0;
+	_nmd_copy_by_mode(&value, operand, (NMD_X86_MODE)cpu->mode);
+
+	if (reg == 4) /* jmp */
+	{
+		/* The emulator advances 'cpu->rip' past the instruction after it executes, so that is compensated. */
+		cpu->rip = value - instruction->length;
+		return _NMD_EMULATOR_STATUS_CONTINUE;
+	}
+
+	void* stack = _nmd_get_emulator_memory(cpu, cpu->rsp.l64 - (int8_t)cpu->mode, cpu->mode, NMD_X86_EMULATOR_PAGE_WRITE);
+	if (!stack)
+		return _nmd_emulator_memory_fault(cpu, instruction);
+
+	cpu->rsp.l64 -= (int8_t)cpu->mode;
+
+	if (reg == 2) /* call */
+	{
+		const uint64_t returnAddress = cpu->rip + instruction->length;
+		_nmd_copy_by_mode(stack, (void*)&returnAddress, (NMD_X86_MODE)cpu->mode);
+		cpu->rip = value - instruction->length;
 	}
+	else /* push */
+		_nmd_copy_by_mode(stack, &value, (NMD_X86_MODE)cpu->mode);
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
 }
 
-/* 
-Checks if the number of set bits in an 8-bit number is even.
-Credits: https://stackoverflow.com/questions/21617970/how-to-check-if-value-has-even-parity-of-bits-or-odd
+/*
+Every instruction handler. A handler executes an instruction and returns a member of '_NMD_EMULATOR_STATUS'. Handlers that change 'cpu->rip'
+set it to the target minus the instruction's length.
 */
-bool _nmd_is_parity_even8(uint8_t x)
-{
-	x ^= x >> 4;
-	x ^= x >> 2;
-	x ^= x >> 1;
-	return !(x & 1);
-}
+#define _NMD_EMULATOR_HANDLERS(X) X(unimplemented) X(nop) X(alu) X(push_pop_segment) X(inc_dec) X(push_pop) X(pusha) X(popa) X(jcc) X(setcc) X(group1) X(test) \
+	X(mov) X(lea) X(xchg) X(pushf) X(popf) X(sahf) X(lahf) X(mov_immediate) X(ret) X(interrupt) X(group2) X(call) X(jmp) X(hlt) X(flag) X(group3) X(group5)
 
-void _nmd_copy_by_mode(void* dst, void* src, NMD_X86_MODE mode)
+#define _NMD_EMULATOR_HANDLER_ENUM(name) _NMD_EMULATOR_HANDLER_##name,
+enum _NMD_EMULATOR_HANDLER
 {
-	if (mode == NMD_X86_MODE_32)
-		*(int32_t*)(dst) = *(int32_t*)(src);
-	else if (mode == NMD_X86_MODE_64)
-		*(int64_t*)(dst) = *(int64_t*)(src);
-	else /* (mode == NMD_X86_MODE_16) */
-		*(int16_t*)(dst) = *(int16_t*)(src);
-}
+	_NMD_EMULATOR_HANDLERS(_NMD_EMULATOR_HANDLER_ENUM)
+	_NMD_EMULATOR_HANDLER_COUNT
+};
+#undef _NMD_EMULATOR_HANDLER_ENUM
 
-void _nmd_copy_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
-{
-	if(instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) = *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) = *(int32_t*)(src);
-}
+/* The handler of each opcode of the default and 0F opcode maps. */
+#define _NMD_E(name) _NMD_EMULATOR_HANDLER_##name
+const uint8_t _nmd_emulatorHandlers[2][256] = {
+	{
+		/* 0 */ _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(push_pop_segment), _NMD_E(push_pop_segment), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(push_pop_segment), _NMD_E(unimplemented),
+		/* 1 */ _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(push_pop_segment), _NMD_E(push_pop_segment), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(push_pop_segment), _NMD_E(push_pop_segment),
+		/* 2 */ _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 3 */ _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(alu), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 4 */ _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec), _NMD_E(inc_dec),
+		/* 5 */ _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop), _NMD_E(push_pop),
+		/* 6 */ _NMD_E(pusha), _NMD_E(popa), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 7 */ _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc),
+		/* 8 */ _NMD_E(group1), _NMD_E(group1), _NMD_E(group1), _NMD_E(group1), _NMD_E(test), _NMD_E(test), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(mov), _NMD_E(mov), _NMD_E(mov), _NMD_E(mov), _NMD_E(unimplemented), _NMD_E(lea), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 9 */ _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(xchg), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(pushf), _NMD_E(popf), _NMD_E(sahf), _NMD_E(lahf),
+		/* A */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(test), _NMD_E(test), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* B */ _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate), _NMD_E(mov_immediate),
+		/* C */ _NMD_E(group2), _NMD_E(group2), _NMD_E(ret), _NMD_E(ret), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(interrupt), _NMD_E(interrupt), _NMD_E(interrupt), _NMD_E(unimplemented),
+		/* D */ _NMD_E(group2), _NMD_E(group2), _NMD_E(group2), _NMD_E(group2), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* E */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(call), _NMD_E(jmp), _NMD_E(unimplemented), _NMD_E(jmp), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* F */ _NMD_E(unimplemented), _NMD_E(interrupt), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(hlt), _NMD_E(flag), _NMD_E(group3), _NMD_E(group3), _NMD_E(flag), _NMD_E(flag), _NMD_E(flag), _NMD_E(flag), _NMD_E(flag), _NMD_E(flag), _NMD_E(group5), _NMD_E(group5)
+	},
+	{
+		/* 0 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(nop), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 1 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop), _NMD_E(nop),
+		/* 2 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 3 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 4 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 5 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 6 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 7 */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* 8 */ _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc), _NMD_E(jcc),
+		/* 9 */ _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc), _NMD_E(setcc),
+		/* A */ _NMD_E(push_pop_segment), _NMD_E(push_pop_segment), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(push_pop_segment), _NMD_E(push_pop_segment), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* B */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* C */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* D */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* E */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented),
+		/* F */ _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented), _NMD_E(unimplemented)
+	}
+};
+#undef _NMD_E
 
-void _nmd_add_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+/* Returns the member of '_NMD_EMULATOR_HANDLER' that executes 'instruction'. */
+static _NMD_FORCEINLINE uint8_t _nmd_get_emulator_handler(const nmd_x86_instruction* instruction)
 {
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) += *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) += *(int32_t*)(src);
+	if (instruction->opcodeMap != NMD_X86_OPCODE_MAP_DEFAULT && instruction->opcodeMap != NMD_X86_OPCODE_MAP_0F)
+		return _NMD_EMULATOR_HANDLER_unimplemented;
+
+	return _nmd_emulatorHandlers[instruction->opcodeMap - NMD_X86_OPCODE_MAP_DEFAULT][instruction->opcode];
 }
 
-void _nmd_or_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+/*
+Completes an instruction whose handler returned 'status': commits an operand that straddles two pages, reports the single-step trap, advances
+'cpu->rip' and counts the instruction. Returns 'status' if emulation stops, '_NMD_EMULATOR_STATUS_LIMIT' if 'maxCount' instructions were
+executed, '_NMD_EMULATOR_STATUS_LEAVE_BLOCK' if the instruction or a callback redirected execution, stopped the emulator or wrote to the block,
+and '_NMD_EMULATOR_STATUS_CONTINUE' otherwise.
+*/
+static _NMD_FORCEINLINE int _nmd_finish_emulated_instruction(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction, int status, uint64_t nextAddress, size_t maxCount)
 {
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) |= *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) |= *(int32_t*)(src);
-} 
+	/* Commit an operand that straddles two pages, unless the instruction faulted. */
+	if (cpu->crossPageSize)
+	{
+		if (cpu->crossPageWrite && status != _NMD_EMULATOR_STATUS_FAULT)
+			_nmd_copy_emulator_memory(cpu, cpu->crossPageAddress, cpu->crossPageBuffer, cpu->crossPageSize, 0, true);
+		cpu->crossPageSize = 0;
+	}
 
-void _nmd_adc_by_operand_size(void* dst, void* src, nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
-{
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) += *(int16_t*)(src) + cpu->flags.fields.CF;
-	else
-		*(int32_t*)(dst) += *(int32_t*)(src) + cpu->flags.fields.CF;
-}
+	if (status != _NMD_EMULATOR_STATUS_CONTINUE)
+		return status;
 
-void _nmd_sbb_by_operand_size(void* dst, void* src, nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
-{
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) -= *(int16_t*)(src) + cpu->flags.fields.CF;
-	else
-		*(int32_t*)(dst) -= *(int32_t*)(src) + cpu->flags.fields.CF;
+	if (cpu->flags.fields.TF && cpu->callback)
+	{
+		_nmd_update_flags(cpu);
+		cpu->callback(cpu, instruction, NMD_X86_EMULATOR_EXCEPTION_STEP);
+	}
+
+	cpu->rip += instruction->length;
+
+	if (maxCount > 0 && ++cpu->count >= maxCount)
+		return _NMD_EMULATOR_STATUS_LIMIT;
+
+	if (cpu->rip != nextAddress || !cpu->running || cpu->blockModified)
+		return _NMD_EMULATOR_STATUS_LEAVE_BLOCK;
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
 }
 
-void _nmd_and_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+/*
+Executes the instructions of a basic block until one of them leaves it or stops emulation. Returns '_NMD_EMULATOR_STATUS_HALT',
+'_NMD_EMULATOR_STATUS_FAULT' or '_NMD_EMULATOR_STATUS_LIMIT' if emulation stops, and '_NMD_EMULATOR_STATUS_CONTINUE' otherwise.
+With computed goto every handler ends with its own indirect jump to the next handler, which the cpu predicts better than the single
+jump of a switch statement.
+*/
+int _nmd_execute_emulator_block(nmd_x86_cpu* cpu, nmd_x86_instruction* instructions, size_t numInstructions, size_t maxCount)
 {
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) &= *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) &= *(int32_t*)(src);
+	nmd_x86_instruction* instruction = instructions;
+	nmd_x86_instruction* const end = instructions + numInstructions;
+	uint64_t nextAddress;
+	int status;
+
+#if defined(__GNUC__) && !defined(NMD_ASSEMBLY_DISABLE_COMPUTED_GOTO)
+#define _NMD_EMULATOR_HANDLER_LABEL(name) &&_nmd_handler_##name,
+	static const void* const labels[] = { _NMD_EMULATOR_HANDLERS(_NMD_EMULATOR_HANDLER_LABEL) };
+#undef _NMD_EMULATOR_HANDLER_LABEL
+
+#define _NMD_EMULATOR_DISPATCH() nextAddress = cpu->rip + instruction->length; goto *labels[_nmd_get_emulator_handler(instruction)]
+#define _NMD_EMULATOR_HANDLER_BODY(name) _nmd_handler_##name: \
+	status = _nmd_finish_emulated_instruction(cpu, instruction, _nmd_emulate_##name(cpu, instruction), nextAddress, maxCount); \
+	if (status != _NMD_EMULATOR_STATUS_CONTINUE) \
+		return status == _NMD_EMULATOR_STATUS_LEAVE_BLOCK ? _NMD_EMULATOR_STATUS_CONTINUE : status; \
+	if (++instruction == end) \
+		return _NMD_EMULATOR_STATUS_CONTINUE; \
+	_NMD_EMULATOR_DISPATCH();
+
+	_NMD_EMULATOR_DISPATCH();
+	_NMD_EMULATOR_HANDLERS(_NMD_EMULATOR_HANDLER_BODY)
+
+#undef _NMD_EMULATOR_HANDLER_BODY
+#undef _NMD_EMULATOR_DISPATCH
+#else
+	for (; instruction != end; instruction++)
+	{
+		nextAddress = cpu->rip + instruction->length;
+
+		switch (_nmd_get_emulator_handler(instruction))
+		{
+#define _NMD_EMULATOR_HANDLER_CASE(name) case _NMD_EMULATOR_HANDLER_##name: status = _nmd_emulate_##name(cpu, instruction); break;
+		_NMD_EMULATOR_HANDLERS(_NMD_EMULATOR_HANDLER_CASE)
+#undef _NMD_EMULATOR_HANDLER_CASE
+		default: status = _nmd_emulate_unimplemented(cpu, instruction); break;
+		}
+
+		status = _nmd_finish_emulated_instruction(cpu, instruction, status, nextAddress, maxCount);
+		if (status != _NMD_EMULATOR_STATUS_CONTINUE)
+			return status == _NMD_EMULATOR_STATUS_LEAVE_BLOCK ? _NMD_EMULATOR_STATUS_CONTINUE : status;
+	}
+
+	return _NMD_EMULATOR_STATUS_CONTINUE;
+#endif
 }
 
-void _nmd_sub_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+/* Returns true if 'instruction' may change the control flow or stop emulation, so it is the last instruction of its basic block. */
+bool _nmd_ends_emulator_block(const nmd_x86_instruction* instruction)
 {
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) -= *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) -= *(int32_t*)(src);
+	const uint8_t op = instruction->opcode;
+
+	if (instruction->opcodeMap == NMD_X86_OPCODE_MAP_0F)
+		return NMD_R(op) == 8 || op == 0x05 || op == 0x07 || op == 0x0b || op == 0x34 || op == 0x35;
+	else if (instruction->opcodeMap != NMD_X86_OPCODE_MAP_DEFAULT)
+		return false;
+
+	return NMD_R(op) == 7 || (op >= 0xe0 && op <= 0xe3) || (op >= 0xe8 && op <= 0xeb) || op == 0xc2 || op == 0xc3 || (op >= 0xca && op <= 0xcf) || op == 0x9a || op == 0xf1 || op == 0xf4 ||
+		(op == 0xff && instruction->modrm.fields.reg >= 0b010 && instruction->modrm.fields.reg <= 0b101);
 }
 
-void _nmd_xor_by_operand_size(void* dst, void* src, nmd_x86_instruction* instruction)
+/* Returns true if the bytes at 'buffer' are still the ones 'block' was decoded from. */
+bool _nmd_is_emulator_block_unmodified(const nmd_x86_emulator_block* block, const uint8_t* buffer)
 {
-	if (instruction->prefixes & NMD_X86_PREFIXES_OPERAND_SIZE_OVERRIDE)
-		*(int16_t*)(dst) &= *(int16_t*)(src);
-	else
-		*(int32_t*)(dst) &= *(int32_t*)(src);
-}
+	size_t i = 0;
+	for (; i < block->numInstructions; buffer += block->instructions[i++].length)
+	{
+		size_t j = 0;
+		for (; j < block->instructions[i].length; j++)
+		{
+			if (block->instructions[i].buffer[j] != buffer[j])
+				return false;
+		}
+	}
 
-#define _NMD_GET_GREG(index) (&cpu->rax + (index)) /* general register */
-#define _NMD_GET_RREG(index) (&cpu->r8 + (index)) /* r8,r9...r15 */
-#define _NMD_GET_PHYSICAL_ADDRESS(address) (uint8_t*)((uint64_t)(cpu->physicalMemory)+((address)-cpu->virtualAddress))
-#define _NMD_IN_BOUNDARIES(address) (address >= cpu->physicalMemory && address < endPhysicalMemory)
-/* #define NMD_TEST(value, bit) ((value&(1<<bit))==(1<<bit)) */
+	return true;
+}
 
-void* _nmd_resolve_memory_operand(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
+/*
+Returns the block of 'cpu->blockCache' that holds the basic block starting at 'cpu->rip', which is decoded from 'buffer' if it is not cached yet
+or if its bytes were modified since it was decoded. If the first instruction cannot be decoded the block is empty and its first instruction
+describes the failure.
+*/
+nmd_x86_emulator_block* _nmd_get_emulator_block(nmd_x86_cpu* cpu, const uint8_t* buffer, size_t bufferSize)
 {
-	if (instruction->modrm.fields.mod == 0b11)
-		return &_NMD_GET_GREG(instruction->modrm.fields.rm)->l64;
-	else
-	{
-		int64_t va_expr; /* virtual address expression */
+	nmd_x86_emulator_block* block = &cpu->blockCache[(size_t)((cpu->rip ^ (cpu->rip >> 12)) % cpu->blockCacheSize)];
 
-		if (instruction->hasSIB)
-			va_expr = _NMD_GET_GREG(instruction->sib.fields.base)->l64 + _NMD_GET_GREG(instruction->sib.fields.index)->l64;
-		else
-			va_expr = _NMD_GET_GREG(instruction->modrm.fields.rm)->l64;
+	if (block->numInstructions && block->address == cpu->rip && block->instructions[0].mode == cpu->mode && block->numBytes <= bufferSize && _nmd_is_emulator_block_unmodified(block, buffer))
+		return block;
 
-		va_expr += ((instruction->dispMask == NMD_X86_DISP8) ? (int8_t)instruction->displacement : (int32_t)instruction->displacement);
+	block->address = cpu->rip;
+	block->numInstructions = 0;
+	block->numBytes = 0;
 
-		return _NMD_GET_PHYSICAL_ADDRESS(va_expr);
-	}
-}
+	while (block->numInstructions < NMD_X86_EMULATOR_BLOCK_LENGTH)
+	{
+		nmd_x86_instruction* instruction = &block->instructions[block->numInstructions];
+		if (!nmd_x86_decode_buffer(buffer + block->numBytes, bufferSize - block->numBytes, instruction, (NMD_X86_MODE)cpu->mode, NMD_X86_DECODER_FLAGS_MINIMAL))
+			break;
 
-int64_t _nmd_resolve_memory_operand_va(nmd_x86_cpu* cpu, nmd_x86_instruction* instruction)
-{
-	int64_t va_expr; /* virtual address expression */
+		block->numInstructions++;
+		block->numBytes += instruction->length;
 
-	if (instruction->hasSIB)
-		va_expr = _NMD_GET_GREG(instruction->sib.fields.base)->l64 + _NMD_GET_GREG(instruction->sib.fields.index)->l64;
-	else
-		va_expr = _NMD_GET_GREG(instruction->modrm.fields.rm)->l64;
+		if (_nmd_ends_emulator_block(instruction))
+			break;
+	}
 
-	return va_expr + ((instruction->dispMask == NMD_X86_DISP8) ? (int8_t)instruction->displacement : (int32_t)instruction->displacement);
+	return block;
 }
 
 /*
 Emulates x86 code according to the state of the cpu. You MUST initialize the following variables before calling this
-function: 'cpu->mode', 'cpu->physicalMemory', 'cpu->physicalMemorySize', 'cpu->virtualAddress' and 'cpu->rip'.
+function: 'cpu->mode', 'cpu->rip' and either 'cpu->physicalMemory', 'cpu->physicalMemorySize' and 'cpu->virtualAddress' or 'cpu->pages' and 'cpu->numPages'.
 You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a short description of each variable:
  - 'cpu->mode': The emulator's operating architecture mode. 'NMD_X86_MODE_32', 'NMD_X86_MODE_64' or 'NMD_X86_MODE_16'.
  - 'cpu->physicalMemory': A pointer to a buffer used as the emulator's memory.
@@ -10026,420 +15365,92 @@ You may optionally initialize 'cpu->rsp' if a stack is desirable. Below is a sho
  - 'cpu->virtualAddress': The starting address of the emulator's virtual address space.
  - 'cpu->rip': The virtual address where emulation starts.
  - 'cpu->rsp': The virtual address of the bottom of the stack.
+ - 'cpu->blockCache' and 'cpu->blockCacheSize': An optional zero-initialized array of blocks and its number of elements. If present, each basic block
+   is decoded once and then executed from the cache for as long as its bytes in memory do not change. A write to the block being executed ends it
+   after the instruction that wrote to it, so the following instructions are decoded again. Keep the array between calls to reuse it.
+ - 'cpu->pages' and 'cpu->numPages': An optional zero-initialized array of pages and its number of elements that replaces 'physicalMemory'. The
+   address space is then sparse: map the ranges the code may access with nmd_x86_emulator_map() and copy the code with nmd_x86_emulator_write().
+   A page takes an element of the array when it is first accessed.
+Instructions the emulator doesn't implement yet raise 'NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION' and stop emulation, like instructions that cannot be decoded.
 Parameters:
  - cpu      [in] A pointer to a variable of type 'nmd_x86_cpu' that holds the state of the cpu.
  - maxCount [in] The maximum number of instructions that can be executed, or zero for unlimited instructions.
 */
 bool nmd_x86_emulate(nmd_x86_cpu* cpu, size_t maxCount)
 {
-	const uint64_t endVirtualAddress = cpu->virtualAddress + cpu->physicalMemorySize;
-	const void* endPhysicalMemory = (uint8_t*)cpu->physicalMemory + cpu->physicalMemorySize;
-
 	cpu->count = 0;
 	cpu->running = true;
+	cpu->lazyFlags.operation = _NMD_LAZY_FLAGS_NONE;
+	cpu->crossPageSize = 0;
+
+	/* 'cpu->pages' may have changed since the last call. */
+	size_t i = 0;
+	for (; i < NMD_X86_EMULATOR_TLB_SIZE; i++)
+		cpu->tlb[i] = 0;
 
 	while (cpu->running)
 	{
-		nmd_x86_instruction instruction;
-		const void* buffer = _NMD_GET_PHYSICAL_ADDRESS(cpu->rip);
-		const bool validBuffer = _NMD_IN_BOUNDARIES(buffer);
-		if (!validBuffer || !nmd_x86_decode_buffer(buffer, (size_t)(endVirtualAddress - cpu->rip), &instruction, (NMD_X86_MODE)cpu->mode, NMD_X86_DECODER_FLAGS_MINIMAL))
-		{
-			if (cpu->callback)
-				cpu->callback(cpu, &instruction, validBuffer ? NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION : NMD_X86_EMULATOR_EXCEPTION_BAD_MEMORY);
-			cpu->running = false;
-			return false;
-		}
+		/* Without a cache every block is a single instruction that is decoded each time it runs. */
+		nmd_x86_instruction uncachedInstruction;
+		nmd_x86_instruction* instructions = &uncachedInstruction;
+		size_t numInstructions = 0;
+		size_t numBytes = 0;
 
-		if (instruction.opcodeMap == NMD_X86_OPCODE_MAP_DEFAULT)
-		{
-			if (instruction.opcode >= 0x88 && instruction.opcode <= 0x8b) /* mov [88,8b] */
-			{
-				nmd_x86_register* r0 = _NMD_GET_GREG(instruction.modrm.fields.reg);
-				void* addr;
-				if (instruction.modrm.fields.mod == 0b11)
-					addr = _NMD_GET_GREG(instruction.modrm.fields.rm);
-				else
-				{
-					int64_t x = _NMD_GET_GREG(instruction.modrm.fields.rm)->l64 + instruction.displacement;
-					addr = _NMD_GET_PHYSICAL_ADDRESS(x);
-					if (!_NMD_IN_BOUNDARIES(addr))
-					{
-						if (cpu->callback)
-							cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_BAD_MEMORY);
-						cpu->running = false;
-						return false;
-					}
-				}
+		size_t bufferSize = 0;
+		const uint8_t* buffer = _nmd_get_emulator_code(cpu, &bufferSize);
+		const bool validBuffer = buffer != 0;
 
-				if (instruction.opcode == 0x88)
-					*(int8_t*)(addr) = r0->l8;
-				else if (instruction.opcode == 0x89)
-				{
-					_nmd_copy_by_mode(addr, r0, (NMD_X86_MODE)cpu->mode);
-				}
-				else if (instruction.opcode == 0x8a)
-					r0->l8 = *(int8_t*)(addr);
-				else /* if (instruction.opcode == 0x8b) */
-				{
-					_nmd_copy_by_mode(r0, addr, (NMD_X86_MODE)cpu->mode);
-				}
-			}
-			else if (NMD_R(instruction.opcode) == 5) /* push,pop [50,5f] */
-			{
-				nmd_x86_register* r0 = _NMD_GET_GREG(instruction.opcode % 8);
-				void* dst, * src;
-
-				if (instruction.opcode < 0x58) /* push */
-				{
-					cpu->rsp.l64 -= (int8_t)cpu->mode;
-					dst = _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l64);
-					src = r0;
-				}
-				else /* pop */
-				{
-					src = _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l64);
-					cpu->rsp.l64 += (int8_t)cpu->mode;
-					dst = r0;
-				}
-
-				_nmd_copy_by_mode(dst, src, (NMD_X86_MODE)cpu->mode);
-			}
-			else if (instruction.opcode == 0xe8) /* call */
-			{
-				/* push the instruction pointer onto the stack. */
-				cpu->rsp.l64 -= (int8_t)cpu->mode;
-				_nmd_copy_by_mode(_NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l64), &cpu->rip, (NMD_X86_MODE)cpu->mode);
-
-				/* jump */
-				cpu->rip += (int32_t)instruction.immediate;
-			}
-			else if (instruction.opcode == 0xc3) /* ret */
-			{
-				/* pop rip */
-				_nmd_copy_by_mode(&cpu->rip, _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l64), (NMD_X86_MODE)cpu->mode);
-				cpu->rsp.l64 += (int8_t)cpu->mode;
-			}
-			else if (instruction.opcode == 0xc2) /* ret imm8 */
-			{
-				/* pop rip */
-				_nmd_copy_by_mode(&cpu->rip, _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l64), (NMD_X86_MODE)cpu->mode);
-				cpu->rsp.l64 += (int8_t)(cpu->mode + instruction.immediate);
-			}
-			else if (instruction.opcode == 0x8d) /* lea */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l64 = _nmd_resolve_memory_operand_va(cpu, &instruction);
-			else if (instruction.opcode == 0xe9) /* jmp r32 */
-				cpu->rip += (int32_t)instruction.immediate;
-			else if (instruction.opcode == 0xeb) /* jmp r8 */
-				cpu->rip += (int8_t)instruction.immediate;
-
-			else if (instruction.opcode == 0x00) /* add Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) += _NMD_GET_GREG(instruction.modrm.fields.reg)->l8;
-			else if (instruction.opcode == 0x01) /* add Ev, Gv */
-				_nmd_add_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), &instruction);
-			else if (instruction.opcode == 0x02) /* add Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 += *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction);
-			else if (instruction.opcode == 0x03) /* add Gv, Ev */
-				_nmd_add_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), &instruction);
-			else if (instruction.opcode == 0x04) /* add al, bl */
-				cpu->rax.l8 += (int8_t)instruction.immediate;
-			else if (instruction.opcode == 0x05) /* add rAX, lz */
-				_nmd_add_by_operand_size(&cpu->rax, &instruction.immediate, &instruction);
-
-			else if (instruction.opcode == 0x08) /* or Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) |= _NMD_GET_GREG(instruction.modrm.fields.reg)->l8;
-			else if (instruction.opcode == 0x09) /* or Ev, Gv */
-				_nmd_or_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), &instruction);
-			else if (instruction.opcode == 0x0a) /* or Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 |= *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction);
-			else if (instruction.opcode == 0x0b) /* or Gv, Ev */
-				_nmd_or_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), &instruction);
-			else if (instruction.opcode == 0x0c) /* or al, bl */
-				cpu->rax.l8 |= (int8_t)instruction.immediate;
-			else if (instruction.opcode == 0x0d) /* or rAX, lz */
-				_nmd_or_by_operand_size(&cpu->rax, &instruction.immediate, &instruction);
-
-			else if (instruction.opcode == 0x10) /* adc Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) += _NMD_GET_GREG(instruction.modrm.fields.reg)->l8 + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x11) /* adc Ev, Gv */
-				_nmd_adc_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), cpu, &instruction);
-			else if (instruction.opcode == 0x12) /* adc Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 += *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x13) /* adc Gv, Ev */
-				_nmd_adc_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), cpu, &instruction);
-			else if (instruction.opcode == 0x14) /* adc al, bl */
-				cpu->rax.l8 += (int8_t)instruction.immediate + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x15) /* adc rAX, lz */
-				_nmd_adc_by_operand_size(&cpu->rax, &instruction.immediate, cpu, &instruction);
-
-			else if (instruction.opcode == 0x18) /* sbb Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) -= _NMD_GET_GREG(instruction.modrm.fields.reg)->l8 + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x19) /* sbb Ev, Gv */
-				_nmd_sbb_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), cpu, &instruction);
-			else if (instruction.opcode == 0x1a) /* sbb Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 -= *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x1b) /* sbb Gv, Ev */
-				_nmd_sbb_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), cpu, &instruction);
-			else if (instruction.opcode == 0x1c) /* sbb al, bl */
-				cpu->rax.l8 -= (int8_t)instruction.immediate + cpu->flags.fields.CF;
-			else if (instruction.opcode == 0x1d) /* sbb rAX, lz */
-				_nmd_sbb_by_operand_size(&cpu->rax, &instruction.immediate, cpu, &instruction);
-
-			else if (instruction.opcode == 0x20) /* and Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) &= _NMD_GET_GREG(instruction.modrm.fields.reg)->l8;
-			else if (instruction.opcode == 0x21) /* and Ev, Gv */
-				_nmd_and_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), &instruction);
-			else if (instruction.opcode == 0x22) /* and Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 &= *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction);
-			else if (instruction.opcode == 0x23) /* and Gv, Ev */
-				_nmd_and_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), &instruction);
-			else if (instruction.opcode == 0x24) /* and al, bl */
-				cpu->rax.l8 &= (int8_t)instruction.immediate;
-			else if (instruction.opcode == 0x25) /* and rAX, lz */
-				_nmd_and_by_operand_size(&cpu->rax, &instruction.immediate, &instruction);
-
-			else if (instruction.opcode == 0x28) /* sub Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) -= _NMD_GET_GREG(instruction.modrm.fields.reg)->l8;
-			else if (instruction.opcode == 0x29) /* sub Ev, Gv */
-				_nmd_sub_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), &instruction);
-			else if (instruction.opcode == 0x2a) /* sub Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 -= *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction);
-			else if (instruction.opcode == 0x2b) /* sub Gv, Ev */
-				_nmd_sub_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), &instruction);
-			else if (instruction.opcode == 0x2c) /* sub al, bl */
-				cpu->rax.l8 -= (int8_t)instruction.immediate;
-			else if (instruction.opcode == 0x2d) /* sub rAX, lz */
-				_nmd_sub_by_operand_size(&cpu->rax, &instruction.immediate, &instruction);
-
-			else if (instruction.opcode == 0x08) /* xor Eb, Gb */
-				*(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction) ^= _NMD_GET_GREG(instruction.modrm.fields.reg)->l8;
-			else if (instruction.opcode == 0x09) /* xor Ev, Gv */
-				_nmd_xor_by_operand_size(_nmd_resolve_memory_operand(cpu, &instruction), _NMD_GET_GREG(instruction.modrm.fields.reg), &instruction);
-			else if (instruction.opcode == 0x0a) /* xor Gb, Eb */
-				_NMD_GET_GREG(instruction.modrm.fields.reg)->l8 ^= *(int8_t*)_nmd_resolve_memory_operand(cpu, &instruction);
-			else if (instruction.opcode == 0x0b) /* xor Gv, Ev */
-				_nmd_xor_by_operand_size(_NMD_GET_GREG(instruction.modrm.fields.reg), _nmd_resolve_memory_operand(cpu, &instruction), &instruction);
-			else if (instruction.opcode == 0x0c) /* xor al, bl */
-				cpu->rax.l8 ^= (int8_t)instruction.immediate;
-			else if (instruction.opcode == 0x0d) /* xor rAX, lz */
-				_nmd_xor_by_operand_size(&cpu->rax, &instruction.immediate, &instruction);
-
-			else if (NMD_R(instruction.opcode) == 4) /* inc/dec [40,4f] */
-			{
-				nmd_x86_register* r0 = _NMD_GET_GREG(instruction.opcode % 8);
-				instruction.opcode < 0x48 ? r0->l64++ : r0->l64--;
-			}
-			else if (NMD_R(instruction.opcode) == 7 && _nmd_check_jump_condition(cpu, NMD_C(instruction.opcode))) /* conditional jump r8 */
-				cpu->rip += (int8_t)(instruction.immediate);
-			else if (instruction.opcode >= 0x91 && instruction.opcode <= 0x97) /* xchg rax, ... */
-			{
-				const nmd_x86_register tmp = cpu->rax;
-				nmd_x86_register* r0 = _NMD_GET_GREG(instruction.opcode - 0x91);
-				cpu->rax = *r0;
-				*r0 = tmp;
-			}
-			else if (instruction.opcode == 0x60) /* pusha,pushad */
-			{
-				void* stack = _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l32);
-				cpu->rsp.l32 -= cpu->mode * 8;
-				if (instruction.mode == NMD_X86_MODE_32) /* pushad */
-				{
-					((uint32_t*)(stack))[0] = cpu->rax.l32;
-					((uint32_t*)(stack))[1] = cpu->rcx.l32;
-					((uint32_t*)(stack))[2] = cpu->rdx.l32;
-					((uint32_t*)(stack))[3] = cpu->rbx.l32;
-					((uint32_t*)(stack))[4] = cpu->rsp.l32;
-					((uint32_t*)(stack))[5] = cpu->rbp.l32;
-					((uint32_t*)(stack))[6] = cpu->rsi.l32;
-					((uint32_t*)(stack))[7] = cpu->rdi.l32;
-				}
-				else /* if (instruction.mode == NMD_X86_MODE_16) pusha */
-				{
-					((uint16_t*)(stack))[0] = cpu->rax.l16;
-					((uint16_t*)(stack))[1] = cpu->rcx.l16;
-					((uint16_t*)(stack))[2] = cpu->rdx.l16;
-					((uint16_t*)(stack))[3] = cpu->rbx.l16;
-					((uint16_t*)(stack))[4] = cpu->rsp.l16;
-					((uint16_t*)(stack))[5] = cpu->rbp.l16;
-					((uint16_t*)(stack))[6] = cpu->rsi.l16;
-					((uint16_t*)(stack))[7] = cpu->rdi.l16;
-				}
-			}
-			else if (instruction.opcode == 0x61) /* popa,popad */
-			{
-				void* stack = _NMD_GET_PHYSICAL_ADDRESS(cpu->rsp.l32);
-				if (instruction.mode == NMD_X86_MODE_32) /* popad */
-				{
-					cpu->rax.l32 = ((uint32_t*)(stack))[0];
-					cpu->rcx.l32 = ((uint32_t*)(stack))[1];
-					cpu->rdx.l32 = ((uint32_t*)(stack))[2];
-					cpu->rbx.l32 = ((uint32_t*)(stack))[3];
-					cpu->rsp.l32 = ((uint32_t*)(stack))[4];
-					cpu->rbp.l32 = ((uint32_t*)(stack))[5];
-					cpu->rsi.l32 = ((uint32_t*)(stack))[6];
-					cpu->rdi.l32 = ((uint32_t*)(stack))[7];
-				}
-				else /* if (instruction.mode == NMD_X86_MODE_16) popa */
-				{
-					cpu->rax.l16 = ((uint16_t*)(stack))[0];
-					cpu->rcx.l16 = ((uint16_t*)(stack))[1];
-					cpu->rdx.l16 = ((uint16_t*)(stack))[2];
-					cpu->rbx.l16 = ((uint16_t*)(stack))[3];
-					cpu->rsp.l16 = ((uint16_t*)(stack))[4];
-					cpu->rbp.l16 = ((uint16_t*)(stack))[5];
-					cpu->rsi.l16 = ((uint16_t*)(stack))[6];
-					cpu->rdi.l16 = ((uint16_t*)(stack))[7];
-				}
-				cpu->rsp.l32 += cpu->mode * 8;
-			}
-			else if (NMD_R(instruction.opcode) == 0xb) /* mov reg, imm */
-			{
-				const uint8_t width = (instruction.prefixes & NMD_X86_PREFIXES_REX_W && instruction.opcode >= 0xb8) ? 8 : instruction.mode;
-				nmd_x86_register* r0 = instruction.prefixes & NMD_X86_PREFIXES_REX_B ? _NMD_GET_RREG(NMD_C(instruction.opcode)) : _NMD_GET_GREG(NMD_C(instruction.opcode));
-				_nmd_copy_by_mode(r0, &instruction.immediate, (NMD_X86_MODE)width);
-			}
-			else if (instruction.opcode == 0x90)
-			{
-				if (instruction.simdPrefix == NMD_X86_PREFIXES_REPEAT) /* pause */
-				{
-					/* spin-wait loop ahead? */
-				}
-			}
-			else if (instruction.opcode == 0x9e) /* sahf */
-				cpu->flags.l8 = cpu->rax.l8;
-			else if (instruction.opcode == 0x9f) /* lahf */
-				cpu->rax.l8 = cpu->flags.l8;
-			else if (instruction.opcode == 0xcc) /* int3 */
-			{
-				if (cpu->callback)
-					cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_BREAKPOINT);
-			}
-			else if (instruction.opcode == 0xf1) /* int1 */
-			{
-				if (cpu->callback)
-					cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_DEBUG);
-			}
-			else if (instruction.opcode == 0xce) /* into */
-			{
-				if (cpu->callback)
-					cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_OVERFLOW);
-			}
-			else if (instruction.opcode == 0xcd) /* int n */
-			{
-				if (cpu->callback)
-					cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_GENERAL_PROTECTION);
-			}
-			else if (instruction.opcode == 0xf4) /* hlt */
-			{
-				cpu->running = false;
-				return true;
-			}
-			else if (instruction.opcode == 0xf5) /* cmc */
-				cpu->flags.fields.CF = ~cpu->flags.fields.CF;
-			else if(instruction.opcode == 0xf8) /* clc */
-				cpu->flags.fields.CF = 0;
-			else if (instruction.opcode == 0xf9) /* stc */
-				cpu->flags.fields.CF = 1;
-			else if (instruction.opcode == 0xfa) /* cli */
-				cpu->flags.fields.IF = 0;
-			else if (instruction.opcode == 0xfb) /* sti */
-				cpu->flags.fields.IF = 1;
-			else if (instruction.opcode == 0xfc) /* cld */
-				cpu->flags.fields.DF = 0;
-			else if (instruction.opcode == 0xfd) /* std */
-				cpu->flags.fields.DF = 1;
+		/* An instruction at the end of a page may continue on the next one. It is copied to 'crossPageCode' and not cached. */
+		uint8_t crossPageCode[NMD_X86_MAXIMUM_INSTRUCTION_LENGTH];
+		if (validBuffer && cpu->pages && bufferSize < NMD_X86_MAXIMUM_INSTRUCTION_LENGTH)
+		{
+			for (i = 0; i < bufferSize; i++)
+				crossPageCode[i] = buffer[i];
 
-			/* Push/Pop segment registers */
-			else if (instruction.opcode == 0x06) /* push es*/
-			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->es;
-			}
-			else if (instruction.opcode == 0x07) /* pop es */
-			{
-				cpu->es = *(uint16_t*)cpu->rsp.l64;
-				cpu->rsp.l64 += cpu->mode;
-			}
-			else if (instruction.opcode == 0x16) /* push ss */
-			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->ss;
-			}
-			else if (instruction.opcode == 0x17) /* pop ss */
-			{
-				cpu->ss = *(uint16_t*)cpu->rsp.l64;
-				cpu->rsp.l64 += cpu->mode;
-			}
-			else if (instruction.opcode == 0x0e) /* push cs */
-			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->cs;
-			}
-			else if (instruction.opcode == 0x1e) /* push ds */
-			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->ds;
-			}
-			else if (instruction.opcode == 0x1f) /* pop ds */
-			{
-				cpu->ds = *(uint16_t*)cpu->rsp.l64;
-				cpu->rsp.l64 += cpu->mode;
-			}
+			if (_nmd_copy_emulator_memory(cpu, cpu->rip + bufferSize, crossPageCode + bufferSize, NMD_X86_MAXIMUM_INSTRUCTION_LENGTH - bufferSize, NMD_X86_EMULATOR_PAGE_EXECUTE, false))
+				bufferSize = NMD_X86_MAXIMUM_INSTRUCTION_LENGTH;
+			buffer = crossPageCode;
 		}
-		else if (instruction.opcodeMap == NMD_X86_OPCODE_MAP_0F)
-		{
-			if (NMD_R(instruction.opcode) == 8 && _nmd_check_jump_condition(cpu, NMD_C(instruction.opcode))) /* conditional jump r32 */
-				cpu->rip += (int32_t)(instruction.immediate);
 
-			else if (instruction.opcode == 0xa0) /* push fs */
-			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->fs;
-			}
-			else if (instruction.opcode == 0xa1) /* pop fs */
-			{
-				cpu->fs = *(uint16_t*)cpu->rsp.l64;
-				cpu->rsp.l64 += cpu->mode;
-			}
-			else if (instruction.opcode == 0xa8) /* push gs */
+		if (validBuffer)
+		{
+			if (cpu->blockCache && cpu->blockCacheSize && buffer != crossPageCode)
 			{
-				cpu->rsp.l64 -= cpu->mode;
-				*(uint16_t*)cpu->rsp.l64 = cpu->gs;
+				nmd_x86_emulator_block* block = _nmd_get_emulator_block(cpu, buffer, bufferSize);
+				instructions = block->instructions;
+				numInstructions = block->numInstructions;
+				numBytes = block->numBytes;
 			}
-			else if (instruction.opcode == 0xa9) /* pop gs */
+			else if (nmd_x86_decode_buffer(buffer, bufferSize, &uncachedInstruction, (NMD_X86_MODE)cpu->mode, NMD_X86_DECODER_FLAGS_MINIMAL))
 			{
-				cpu->gs = *(uint16_t*)cpu->rsp.l64;
-				cpu->rsp.l64 += cpu->mode;
+				numInstructions = 1;
+				numBytes = uncachedInstruction.length;
 			}
 		}
-		else if (instruction.opcodeMap == NMD_X86_OPCODE_MAP_0F38)
-		{
 
-		}
-		else /* if (instruction.opcodeMap == NMD_X86_OPCODE_MAP_0F_38) */
+		if (numInstructions == 0)
 		{
-
+			_nmd_update_flags(cpu);
+			if (cpu->callback)
+				cpu->callback(cpu, instructions, validBuffer ? NMD_X86_EMULATOR_EXCEPTION_BAD_INSTRUCTION : NMD_X86_EMULATOR_EXCEPTION_BAD_MEMORY);
+			cpu->running = false;
+			return false;
 		}
 
-		/*
-		if (r0)
+		cpu->blockStart = cpu->rip;
+		cpu->blockEnd = cpu->rip + numBytes;
+		cpu->blockModified = false;
+
+		const int status = _nmd_execute_emulator_block(cpu, instructions, numInstructions, maxCount);
+		if (status != _NMD_EMULATOR_STATUS_CONTINUE)
 		{
-			cpu->flags.fields.ZF = (r0->l64 == 0);
-			cpu->flags.fields.PF = _nmd_is_parity_even8(r0->l8);
-			
+			_nmd_update_flags(cpu);
+			return status != _NMD_EMULATOR_STATUS_FAULT;
 		}
-		*//* OF,SF,CF*/
-
-
-		if (cpu->flags.fields.TF && cpu->callback)
-			cpu->callback(cpu, &instruction, NMD_X86_EMULATOR_EXCEPTION_STEP);
-
-		cpu->rip += instruction.length;
-
-		if (maxCount > 0 && ++cpu->count >= maxCount)
-			return true;
 	}
 
+	_nmd_update_flags(cpu);
+
 	return true;
 }
 
@@ -15,5 +15,149 @@ PIMAGE_DATA_DIRECTORY pe::get_data_directory( const uintptr_t image_base, unsign
 	if ( pimage_nt_headers->Signature != IMAGE_NT_SIGNATURE )
 		return nullptr;
 
-	return &pimage_nt_headers->OptionalHeader.DataDirectory[ directory ];;
+	if ( directory >= pimage_nt_headers->OptionalHeader.NumberOfRvaAndSizes || directory >= IMAGE_NUMBEROF_DIRECTORY_ENTRIES )
+		return nullptr;
+
+	return &pimage_nt_headers->OptionalHeader.DataDirectory[ directory ];
+}
+
+pe::image_view::image_view( const uintptr_t image_base, const size_t image_size ) :
+	m_image_base( image_base ), m_image_size( image_size ), m_pnt_headers( nullptr ), m_psections{ }, m_section_count( 0 ), m_pdirectories{ }
+{
+	if ( !image_base || image_size < sizeof( IMAGE_DOS_HEADER ) )
+		return;
+
+	const auto* pimage_dos_header = reinterpret_cast< const IMAGE_DOS_HEADER* >( image_base );
+
+	if ( pimage_dos_header->e_magic != IMAGE_DOS_SIGNATURE || pimage_dos_header->e_lfanew < 0 ||
+	     static_cast< size_t >( pimage_dos_header->e_lfanew ) + sizeof( IMAGE_NT_HEADERS64 ) > image_size )
+		return;
+
+	const auto* pimage_nt_headers = reinterpret_cast< const IMAGE_NT_HEADERS64* >( image_base + pimage_dos_header->e_lfanew );
+
+	if ( pimage_nt_headers->Signature != IMAGE_NT_SIGNATURE || pimage_nt_headers->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC )
+		return;
+
+	// Section headers follow the optional header, whatever its declared size
+	const auto sections_offset = pimage_dos_header->e_lfanew + sizeof( ULONG ) + sizeof( IMAGE_FILE_HEADER ) + pimage_nt_headers->FileHeader.SizeOfOptionalHeader;
+	const auto section_count   = pimage_nt_headers->FileHeader.NumberOfSections;
+
+	if ( section_count > IMAGE_MAX_SECTIONS || sections_offset + section_count * sizeof( IMAGE_SECTION_HEADER ) > image_size )
+		return;
+
+	// Insertion sort by VirtualAddress. The linker already emits them in order, so this is a single pass in practice
+	const auto* psection_table = reinterpret_cast< const IMAGE_SECTION_HEADER* >( image_base + sections_offset );
+
+	for ( unsigned int i = 0; i < section_count; i++ )
+	{
+		auto j = i;
+
+		for ( ; j > 0 && m_psections[ j - 1 ]->VirtualAddress > psection_table[ i ].VirtualAddress; j-- )
+			m_psections[ j ] = m_psections[ j - 1 ];
+
+		m_psections[ j ] = &psection_table[ i ];
+	}
+
+	m_section_count = section_count;
+
+	// Cache the directories that fit in the image
+	const auto directory_count = pimage_nt_headers->OptionalHeader.NumberOfRvaAndSizes < IMAGE_NUMBEROF_DIRECTORY_ENTRIES ?
+	                             pimage_nt_headers->OptionalHeader.NumberOfRvaAndSizes : IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+
+	for ( unsigned int i = 0; i < directory_count; i++ )
+	{
+		const auto& directory = pimage_nt_headers->OptionalHeader.DataDirectory[ i ];
+
+		// The security directory holds a file offset, not an RVA
+		if ( i == IMAGE_DIRECTORY_ENTRY_SECURITY || !directory.VirtualAddress )
+			continue;
+
+		if ( static_cast< size_t >( directory.VirtualAddress ) + directory.Size <= image_size )
+			m_pdirectories[ i ] = &directory;
+	}
+
+	m_pnt_headers = pimage_nt_headers;
+}
+
+const IMAGE_SECTION_HEADER* pe::image_view::section_from_rva( const DWORD rva ) const
+{
+	// Find the last section that starts at or before 'rva'
+	unsigned int low = 0, high = m_section_count;
+
+	while ( low < high )
+	{
+		const auto middle = ( low + high ) / 2;
+
+		if ( m_psections[ middle ]->VirtualAddress <= rva )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if ( !low )
+		return nullptr;
+
+	const auto* psection     = m_psections[ low - 1 ];
+	const auto  section_size = psection->VirtualSize ? psection->VirtualSize : psection->SizeOfRawData;
+
+	return ( rva - psection->VirtualAddress < section_size ) ? psection : nullptr;
+}
+
+const void* pe::image_view::rva_to_pointer( const DWORD rva, const size_t size ) const
+{
+	if ( !m_pnt_headers || rva > m_image_size || size > m_image_size - rva )
+		return nullptr;
+
+	return reinterpret_cast< const void* >( m_image_base + rva );
+}
+
+const IMAGE_DATA_DIRECTORY* pe::image_view::get_data_directory( const unsigned int directory ) const
+{
+	return directory < IMAGE_NUMBEROF_DIRECTORY_ENTRIES ? m_pdirectories[ directory ] : nullptr;
+}
+
+bool pe::lookup_function( const image_view& image, const DWORD rva, function_entry& entry )
+{
+	entry = { };
+
+	size_t      entry_count = 0;
+	const auto* pfunc_table = image.get_directory_entries< RUNTIME_FUNCTION >( IMAGE_DIRECTORY_ENTRY_EXCEPTION, entry_count );
+
+	if ( !pfunc_table )
+		return false;
+
+	// Find the last function that starts at or before 'rva'
+	size_t low = 0, high = entry_count;
+
+	while ( low < high )
+	{
+		const auto middle = low + ( high - low ) / 2;
+
+		if ( pfunc_table[ middle ].BeginAddress <= rva )
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if ( !low || rva >= pfunc_table[ low - 1 ].EndAddress )
+		return false;
+
+	const auto* pruntime_function = &pfunc_table[ low - 1 ];
+
+	// Shared function fragments point to the entry holding the unwind information
+	if ( pruntime_function->u.UnwindData & RUNTIME_FUNCTION_INDIRECT )
+	{
+		pruntime_function = static_cast< const RUNTIME_FUNCTION* >( image.rva_to_pointer( pruntime_function->u.UnwindData & ~RUNTIME_FUNCTION_INDIRECT, sizeof( RUNTIME_FUNCTION ) ) );
+
+		if ( !pruntime_function )
+			return false;
+	}
+
+	const auto* punwind_info = static_cast< const UNWIND_INFO* >( image.rva_to_pointer( pruntime_function->u.UnwindInfoAddress, sizeof( UNWIND_INFO ) ) );
+
+	if ( !punwind_info || !image.rva_to_pointer( pruntime_function->u.UnwindInfoAddress, sizeof( UNWIND_INFO ) - sizeof( UNWIND_CODE ) + punwind_info->CntUnwindCodes * sizeof( UNWIND_CODE ) ) )
+		return false;
+
+	entry = { pruntime_function, punwind_info };
+	return true;
 }
\ No newline at end of file
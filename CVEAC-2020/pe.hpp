@@ -1,11 +1,25 @@
 #pragma once
 
+#ifdef _KERNEL_MODE
 #include <ntddk.h>
 #include <windef.h>
+#else
+// Lets the structures below be used outside of the driver, e.g. by pe_file.hpp
+#include <cstddef>
+#include <cstdint>
+
+typedef std::uint8_t  BYTE;
+typedef std::uint16_t WORD;
+typedef std::uint32_t DWORD;
+typedef std::int32_t  LONG;
+typedef std::uint32_t ULONG;
+typedef std::uint64_t ULONGLONG;
+#endif
 
 // Signatures and magic numbers
 #define IMAGE_DOS_SIGNATURE 0x5A4D //MZ
 #define IMAGE_NT_SIGNATURE  0x00004550 //PE00
+#define IMAGE_NT_OPTIONAL_HDR64_MAGIC 0x20B
 
 // Directory Entries
 #define IMAGE_DIRECTORY_ENTRY_EXPORT          0   // Export Directory
@@ -120,8 +134,8 @@ typedef struct _IMAGE_SECTION_HEADER
 	ULONG   PointerToRawData;
 	ULONG   PointerToRelocations;
 	ULONG   PointerToLinenumbers;
-	__int16 NumberOfRelocations;
-	__int16 NumberOfLinenumbers;
+	WORD    NumberOfRelocations;
+	WORD    NumberOfLinenumbers;
 	ULONG   Characteristics;
 } IMAGE_SECTION_HEADER, *PIMAGE_SECTION_HEADER;
 
@@ -174,7 +188,63 @@ typedef struct _UNWIND_INFO
 } UNWIND_INFO, *PUNWIND_INFO;
 
 
+#define RUNTIME_FUNCTION_INDIRECT 0x1 // UnwindData points to another RUNTIME_FUNCTION instead of an UNWIND_INFO
+
+#define IMAGE_NUMBEROF_DIRECTORY_ENTRIES 16
+#define IMAGE_MAX_SECTIONS               96 // Most sections the Windows loader accepts
+
+
 namespace pe
 {
 	PIMAGE_DATA_DIRECTORY get_data_directory ( const uintptr_t image_base, unsigned int directory );
+
+	// Image mapped by the loader (RVA == offset). The headers are validated once on construction, after that
+	// every lookup is bounds-checked against the image size and never re-parses the headers
+	class image_view
+	{
+	public:
+		image_view( uintptr_t image_base, size_t image_size );
+
+		bool                      valid      () const { return m_pnt_headers != nullptr; }
+		uintptr_t                 base       () const { return m_image_base; }
+		size_t                    size       () const { return m_image_size; }
+		const IMAGE_NT_HEADERS64* nt_headers () const { return m_pnt_headers; }
+
+		// Binary search over the sections sorted by VirtualAddress. Returns nullptr if no section contains 'rva'
+		const IMAGE_SECTION_HEADER* section_from_rva ( DWORD rva ) const;
+
+		// Returns nullptr unless [rva, rva + size) is inside the image
+		const void* rva_to_pointer ( DWORD rva, size_t size ) const;
+
+		// Returns nullptr if the directory is absent or doesn't fit in the image
+		const IMAGE_DATA_DIRECTORY* get_data_directory ( unsigned int directory ) const;
+
+		// Returns the directory as an array of 'T', e.g. RUNTIME_FUNCTION for IMAGE_DIRECTORY_ENTRY_EXCEPTION
+		template < typename T >
+		const T* get_directory_entries( unsigned int directory, size_t& count ) const
+		{
+			const auto* pdirectory = get_data_directory( directory );
+
+			count = pdirectory ? pdirectory->Size / sizeof( T ) : 0;
+			return pdirectory ? reinterpret_cast< const T* >( m_image_base + pdirectory->VirtualAddress ) : nullptr;
+		}
+
+	private:
+		uintptr_t                   m_image_base;
+		size_t                      m_image_size;
+		const IMAGE_NT_HEADERS64*   m_pnt_headers;
+		const IMAGE_SECTION_HEADER* m_psections[ IMAGE_MAX_SECTIONS ];
+		unsigned int                m_section_count;
+		const IMAGE_DATA_DIRECTORY* m_pdirectories[ IMAGE_NUMBEROF_DIRECTORY_ENTRIES ];
+	};
+
+	struct function_entry
+	{
+		const RUNTIME_FUNCTION* pruntime_function;
+		const UNWIND_INFO*      punwind_info;
+	};
+
+	// Finds the exception table entry of the function containing 'rva' in O(log n). The linker sorts .pdata by BeginAddress,
+	// so the table itself is the index. Chained entries (UNW_FLAG_CHAININFO) are returned as-is
+	bool lookup_function ( const image_view& image, DWORD rva, function_entry& entry );
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+// User-mode (POSIX) reader for PE files on disk. The file is mapped read-only and never copied, every view returned points into the mapping
+#include "pe.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pe
+{
+	struct file_view
+	{
+		const unsigned char*        pbase;
+		size_t                      size;
+		const IMAGE_NT_HEADERS64*   pnt_headers;
+		const IMAGE_SECTION_HEADER* psections;
+		WORD                        section_count;
+	};
+
+	inline void close_file( file_view& view )
+	{
+		if ( view.pbase )
+			munmap( const_cast< unsigned char* >( view.pbase ), view.size );
+
+		view = { };
+	}
+
+	// Maps the file at 'path'. Fails if it can't be mapped or isn't a PE32+ image whose headers fit in the file
+	inline bool open_file( const char* path, file_view& view )
+	{
+		view = { };
+
+		const auto fd = open( path, O_RDONLY );
+
+		if ( fd < 0 )
+			return false;
+
+		struct stat file_stat { };
+		void*       pmapping = MAP_FAILED;
+
+		if ( !fstat( fd, &file_stat ) && file_stat.st_size >= static_cast< off_t >( sizeof( IMAGE_DOS_HEADER ) ) )
+			pmapping = mmap( nullptr, static_cast< size_t >( file_stat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+
+		// The mapping stays valid after the descriptor is closed
+		close( fd );
+
+		if ( pmapping == MAP_FAILED )
+			return false;
+
+		view.pbase = static_cast< const unsigned char* >( pmapping );
+		view.size  = static_cast< size_t >( file_stat.st_size );
+
+		const auto* pimage_dos_header = reinterpret_cast< const IMAGE_DOS_HEADER* >( view.pbase );
+
+		if ( pimage_dos_header->e_magic != IMAGE_DOS_SIGNATURE || pimage_dos_header->e_lfanew < 0 ||
+		     static_cast< size_t >( pimage_dos_header->e_lfanew ) + sizeof( IMAGE_NT_HEADERS64 ) > view.size )
+		{
+			close_file( view );
+			return false;
+		}
+
+		view.pnt_headers = reinterpret_cast< const IMAGE_NT_HEADERS64* >( view.pbase + pimage_dos_header->e_lfanew );
+
+		if ( view.pnt_headers->Signature != IMAGE_NT_SIGNATURE || view.pnt_headers->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC )
+		{
+			close_file( view );
+			return false;
+		}
+
+		// Section headers follow the optional header, whatever its declared size
+		const auto sections_offset = pimage_dos_header->e_lfanew + sizeof( ULONG ) + sizeof( IMAGE_FILE_HEADER ) + view.pnt_headers->FileHeader.SizeOfOptionalHeader;
+		const auto section_count   = view.pnt_headers->FileHeader.NumberOfSections;
+
+		if ( sections_offset + section_count * sizeof( IMAGE_SECTION_HEADER ) > view.size )
+		{
+			close_file( view );
+			return false;
+		}
+
+		view.psections     = reinterpret_cast< const IMAGE_SECTION_HEADER* >( view.pbase + sections_offset );
+		view.section_count = section_count;
+
+		return true;
+	}
+
+	// Translates an RVA to a file offset. Fails if [rva, rva + size) isn't backed by the file
+	inline bool rva_to_offset( const file_view& view, const DWORD rva, const size_t size, size_t& offset )
+	{
+		// Headers are mapped at RVA 0
+		if ( rva < view.pnt_headers->OptionalHeader.SizeOfHeaders )
+		{
+			offset = rva;
+			return offset + size <= view.size;
+		}
+
+		for ( WORD i = 0; i < view.section_count; i++ )
+		{
+			const auto& section = view.psections[ i ];
+
+			if ( rva < section.VirtualAddress || rva - section.VirtualAddress >= section.SizeOfRawData )
+				continue;
+
+			// The tail of a section beyond SizeOfRawData is zero-filled by the loader and has no file data
+			if ( rva - section.VirtualAddress + size > section.SizeOfRawData )
+				return false;
+
+			offset = section.PointerToRawData + ( rva - section.VirtualAddress );
+			return offset + size <= view.size;
+		}
+
+		return false;
+	}
+
+	template < typename T >
+	const T* rva_to_pointer( const file_view& view, const DWORD rva, const size_t count = 1 )
+	{
+		size_t offset = 0;
+
+		return rva_to_offset( view, rva, count * sizeof( T ), offset ) ? reinterpret_cast< const T* >( view.pbase + offset ) : nullptr;
+	}
+
+	inline const IMAGE_DATA_DIRECTORY* get_data_directory( const file_view& view, const unsigned int directory )
+	{
+		if ( directory >= view.pnt_headers->OptionalHeader.NumberOfRvaAndSizes || directory >= IMAGE_NUMBEROF_DIRECTORY_ENTRIES )
+			return nullptr;
+
+		return &view.pnt_headers->OptionalHeader.DataDirectory[ directory ];
+	}
+
+	inline const RUNTIME_FUNCTION* get_runtime_functions( const file_view& view, size_t& count )
+	{
+		count = 0;
+
+		const auto* pexception_dir = get_data_directory( view, IMAGE_DIRECTORY_ENTRY_EXCEPTION );
+
+		if ( !pexception_dir || !pexception_dir->VirtualAddress )
+			return nullptr;
+
+		const auto  entry_count = pexception_dir->Size / sizeof( RUNTIME_FUNCTION );
+		const auto* pfunc_table = rva_to_pointer< RUNTIME_FUNCTION >( view, pexception_dir->VirtualAddress, entry_count );
+
+		if ( pfunc_table )
+			count = entry_count;
+
+		return pfunc_table;
+	}
+}
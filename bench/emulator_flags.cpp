@@ -0,0 +1,393 @@
+// Runs the ALU, shift and multiply/divide instructions of the emulator on the host CPU and in nmd_x86_emulate() with the same registers,
+// memory and flags, and reports every case whose registers, memory or defined flags differ. Needs an x86-64 host
+#define NMD_ASSEMBLY_IMPLEMENTATION
+#include "nmd_assembly.h"
+
+#include <sys/mman.h>
+
+#include <csetjmp>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+namespace
+{
+	constexpr std::uint32_t cf = 1 << 0, pf = 1 << 2, af = 1 << 4, zf = 1 << 6, sf = 1 << 7, of = 1 << 11;
+	constexpr std::uint32_t arithmetic_flags = cf | pf | af | zf | sf | of;
+
+	// One instruction that only uses the registers and the memory in 'state', with the flags the manual defines for it
+	struct test_case
+	{
+		std::vector< std::uint8_t > bytes;
+		std::uint32_t               defined_flags;
+		size_t                      size;
+		bool                        shift;
+		std::uint8_t                op;
+		int                         count; // The count of a shift or rotate, or -1 if it is CL
+		const char*                 pname;
+	};
+
+	// The state a case starts from and ends with. 'memory' is the operand of the instructions that address [rdi+0x38]
+	struct state
+	{
+		std::uint64_t rax, rcx, rdx, rbx, r8, r9, rflags, memory;
+	};
+
+	constexpr std::uint8_t memory_offset = offsetof( state, memory );
+
+	// Code that loads 'state' from rdi, executes the instruction and stores 'state' back. rdi stays the address of 'state'
+	constexpr std::uint8_t thunk_prologue[ ] = {
+		0x53,                   // push rbx
+		0x48, 0x8B, 0x07,       // mov rax, [rdi]
+		0x48, 0x8B, 0x4F, 0x08, // mov rcx, [rdi+8]
+		0x48, 0x8B, 0x57, 0x10, // mov rdx, [rdi+16]
+		0x48, 0x8B, 0x5F, 0x18, // mov rbx, [rdi+24]
+		0x4C, 0x8B, 0x47, 0x20, // mov r8, [rdi+32]
+		0x4C, 0x8B, 0x4F, 0x28, // mov r9, [rdi+40]
+		0xFF, 0x77, 0x30,       // push qword [rdi+48]
+		0x9D,                   // popfq
+	};
+
+	constexpr std::uint8_t thunk_epilogue[ ] = {
+		0x9C,                   // pushfq
+		0x8F, 0x47, 0x30,       // pop qword [rdi+48]
+		0x48, 0x89, 0x07,       // mov [rdi], rax
+		0x48, 0x89, 0x4F, 0x08, // mov [rdi+8], rcx
+		0x48, 0x89, 0x57, 0x10, // mov [rdi+16], rdx
+		0x48, 0x89, 0x5F, 0x18, // mov [rdi+24], rbx
+		0x4C, 0x89, 0x47, 0x20, // mov [rdi+32], r8
+		0x4C, 0x89, 0x4F, 0x28, // mov [rdi+40], r9
+		0x5B,                   // pop rbx
+		0xC3,                   // ret
+	};
+
+	sigjmp_buf divide_error;
+
+	void on_divide_error( int )
+	{
+		siglongjmp( divide_error, 1 );
+	}
+
+	// Returns false if the instruction raised #DE. siglongjmp() restores rbx
+	bool run_native( std::uint8_t* pcode, const test_case& c, state& s )
+	{
+		std::memcpy( pcode, thunk_prologue, sizeof( thunk_prologue ) );
+		std::memcpy( pcode + sizeof( thunk_prologue ), c.bytes.data( ), c.bytes.size( ) );
+		std::memcpy( pcode + sizeof( thunk_prologue ) + c.bytes.size( ), thunk_epilogue, sizeof( thunk_epilogue ) );
+
+		if ( sigsetjmp( divide_error, 1 ) )
+			return false;
+
+		reinterpret_cast< void ( * )( state* ) >( pcode )( &s );
+
+		return true;
+	}
+
+	NMD_X86_EMULATOR_EXCEPTION last_exception;
+
+	void on_exception( nmd_x86_cpu*, const nmd_x86_instruction*, NMD_X86_EMULATOR_EXCEPTION exception )
+	{
+		last_exception = exception;
+	}
+
+	// Returns false if the emulator raised #DE. The code is at 0x1000 and rdi points to a copy of 'state' at 0x1040
+	bool run_emulator( const test_case& c, state& s )
+	{
+		static std::uint8_t memory[ 128 ];
+		static nmd_x86_cpu  cpu;
+
+		std::memset( &cpu, 0, sizeof( cpu ) );
+		std::memcpy( memory, c.bytes.data( ), c.bytes.size( ) );
+		memory[ c.bytes.size( ) ] = 0xF4; // hlt
+		std::memcpy( memory + 64, &s, sizeof( s ) );
+
+		cpu.mode               = NMD_X86_MODE_64;
+		cpu.physicalMemory     = memory;
+		cpu.physicalMemorySize = sizeof( memory );
+		cpu.virtualAddress     = 0x1000;
+		cpu.rip                = 0x1000;
+		cpu.callback           = on_exception;
+		cpu.rax.l64            = static_cast< std::int64_t >( s.rax );
+		cpu.rcx.l64            = static_cast< std::int64_t >( s.rcx );
+		cpu.rdx.l64            = static_cast< std::int64_t >( s.rdx );
+		cpu.rbx.l64            = static_cast< std::int64_t >( s.rbx );
+		cpu.rdi.l64            = 0x1040;
+		cpu.r8.l64             = static_cast< std::int64_t >( s.r8 );
+		cpu.r9.l64             = static_cast< std::int64_t >( s.r9 );
+		cpu.flags.eflags       = static_cast< std::uint32_t >( s.rflags );
+
+		last_exception = NMD_X86_EMULATOR_EXCEPTION_NONE;
+		nmd_x86_emulate( &cpu, 2 );
+
+		s.rax    = static_cast< std::uint64_t >( cpu.rax.l64 );
+		s.rcx    = static_cast< std::uint64_t >( cpu.rcx.l64 );
+		s.rdx    = static_cast< std::uint64_t >( cpu.rdx.l64 );
+		s.rbx    = static_cast< std::uint64_t >( cpu.rbx.l64 );
+		s.r8     = static_cast< std::uint64_t >( cpu.r8.l64 );
+		s.r9     = static_cast< std::uint64_t >( cpu.r9.l64 );
+		s.rflags = cpu.flags.eflags;
+		std::memcpy( &s.memory, memory + 64 + memory_offset, sizeof( s.memory ) );
+
+		return last_exception != NMD_X86_EMULATOR_EXCEPTION_DIVIDE;
+	}
+
+	// An operand encoded in the rm field of the ModR/M byte: the REX bits it needs, the mod and rm fields, and the SIB and displacement
+	// bytes that follow. 'high_byte' operands are ah..bh, which only exist in byte instructions without a REX prefix
+	struct rm_operand
+	{
+		std::uint8_t                rex;
+		std::uint8_t                modrm;
+		std::vector< std::uint8_t > tail;
+		bool                        high_byte;
+	};
+
+	// An operand encoded in the reg field of the ModR/M byte
+	struct reg_operand
+	{
+		std::uint8_t rex;
+		std::uint8_t reg;
+		bool         high_byte;
+	};
+
+	const rm_operand rm_operands[ ] = {
+		{ 0x00, 0xC0, { }, false },                      // al/ax/eax/rax
+		{ 0x00, 0xC1, { }, false },                      // cl/cx/ecx/rcx
+		{ 0x41, 0xC0, { }, false },                      // r8
+		{ 0x00, 0xC4, { }, true },                       // ah
+		{ 0x00, 0xC7, { }, true },                       // bh
+		{ 0x00, 0x47, { memory_offset }, false },        // [rdi+0x38]
+		{ 0x00, 0x44, { 0x27, memory_offset }, false },  // [rdi+0x38] with a SIB byte without an index
+	};
+
+	const reg_operand reg_operands[ ] = {
+		{ 0x00, 1, false }, // cl/cx/ecx/rcx
+		{ 0x44, 1, false }, // r9
+		{ 0x00, 5, true },  // ch
+	};
+
+	bool fits( size_t size, bool high_byte, std::uint8_t rex )
+	{
+		return !high_byte || ( size == 1 && rex == 0 );
+	}
+
+	// 'size' selects the operand size: 66 for words and REX.W for qwords. 'rex' holds the REX.R and REX.B bits of the operands
+	std::vector< std::uint8_t > encode( size_t size, std::uint8_t rex, std::initializer_list< std::uint8_t > bytes, const std::vector< std::uint8_t >& tail = { }, std::uint64_t immediate = 0,
+										size_t immediate_size = 0 )
+	{
+		std::vector< std::uint8_t > encoded;
+
+		if ( size == 2 )
+			encoded.push_back( 0x66 );
+
+		if ( size == 8 )
+			rex |= 0x48;
+
+		if ( rex )
+			encoded.push_back( rex | 0x40 );
+
+		encoded.insert( encoded.end( ), bytes );
+		encoded.insert( encoded.end( ), tail.begin( ), tail.end( ) );
+
+		for ( size_t i = 0; i < immediate_size; i++ )
+			encoded.push_back( static_cast< std::uint8_t >( immediate >> ( i * 8 ) ) );
+
+		return encoded;
+	}
+
+	std::vector< test_case > make_cases( )
+	{
+		static const char* const alu_names[ ]    = { "add", "or", "adc", "sbb", "and", "sub", "xor", "cmp" };
+		static const char* const group2_names[ ] = { "rol", "ror", "rcl", "rcr", "shl", "shr", "sal", "sar" };
+		static const char* const group3_names[ ] = { "test", "test", "not", "neg", "mul", "imul", "div", "idiv" };
+
+		std::vector< test_case > cases;
+
+		for ( const size_t size : { 1, 2, 4, 8 } )
+		{
+			const std::uint8_t wide = size != 1;
+			const size_t       iz   = size == 1 ? 1 : ( size == 2 ? 2 : 4 );
+
+			for ( std::uint8_t op = 0; op < 8; op++ )
+			{
+				const auto flags = op == 1 || op == 4 || op == 6 ? arithmetic_flags & ~af : arithmetic_flags;
+
+				// add, or, adc, sbb, and, sub, xor, cmp AL,Ib - rAX,Iz
+				cases.push_back( { encode( size, 0, { static_cast< std::uint8_t >( op << 3 | 4 | wide ) }, { }, 0x80008080, iz ), flags, size, false, op, 0, alu_names[ op ] } );
+
+				for ( const auto& e : rm_operands )
+				{
+					// Eb,Gb - Ev,Gv and Gb,Eb - Gv,Ev
+					for ( const auto& g : reg_operands )
+					{
+						const auto rex = static_cast< std::uint8_t >( e.rex | g.rex );
+
+						if ( !fits( size, e.high_byte, rex ) || !fits( size, g.high_byte, rex ) )
+							continue;
+
+						const auto modrm = static_cast< std::uint8_t >( e.modrm | g.reg % 8 << 3 );
+
+						for ( const std::uint8_t direction : { 0, 2 } )
+							cases.push_back( { encode( size, rex, { static_cast< std::uint8_t >( op << 3 | direction | wide ), modrm }, e.tail ), flags, size, false, op, 0, alu_names[ op ] } );
+					}
+
+					if ( !fits( size, e.high_byte, e.rex ) )
+						continue;
+
+					const auto modrm = static_cast< std::uint8_t >( e.modrm | op << 3 );
+
+					// Group 1 Eb,Ib - Ev,Iz and Ev,Ib
+					for ( const std::uint64_t immediate : { 0x0ull, 0x1ull, 0x7Full, 0x80ull, 0xFFull, 0x7FFFull, 0x8000ull, 0x7FFFFFFFull, 0x80000000ull, 0xFFFFFFFFull } )
+					{
+						cases.push_back( { encode( size, e.rex, { static_cast< std::uint8_t >( 0x80 | wide ), modrm }, e.tail, immediate, iz ), flags, size, false, op, 0, alu_names[ op ] } );
+
+						if ( wide )
+							cases.push_back( { encode( size, e.rex, { 0x83, modrm }, e.tail, immediate, 1 ), flags, size, false, op, 0, alu_names[ op ] } );
+					}
+
+					// Shifts and rotates by 1, CL and imm8. The flags that depend on the count are masked when the case runs
+					cases.push_back( { encode( size, e.rex, { static_cast< std::uint8_t >( 0xD0 | wide ), modrm }, e.tail ), arithmetic_flags, size, true, op, 1, group2_names[ op ] } );
+					cases.push_back( { encode( size, e.rex, { static_cast< std::uint8_t >( 0xD2 | wide ), modrm }, e.tail ), arithmetic_flags, size, true, op, -1, group2_names[ op ] } );
+
+					for ( const std::uint8_t count : { 0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 200 } )
+						cases.push_back( { encode( size, e.rex, { static_cast< std::uint8_t >( 0xC0 | wide ), modrm }, e.tail, count, 1 ), arithmetic_flags, size, true, op, count, group2_names[ op ] } );
+
+					// test Eb,Ib - Ev,Iz and not, neg, mul, imul, div, idiv Eb - Ev
+					const auto f6 = static_cast< std::uint8_t >( 0xF6 | wide );
+
+					if ( op <= 1 )
+					{
+						for ( const std::uint64_t immediate : { 0x0ull, 0x80ull, 0xFFull, 0x8000ull, 0x80000000ull, 0xFFFFFFFFull } )
+							cases.push_back( { encode( size, e.rex, { f6, modrm }, e.tail, immediate, iz ), arithmetic_flags & ~af, size, false, op, 0, group3_names[ op ] } );
+					}
+					else
+					{
+						const std::uint32_t defined = op <= 3 ? arithmetic_flags : ( op <= 5 ? cf | of : 0 );
+						cases.push_back( { encode( size, e.rex, { f6, modrm }, e.tail ), defined, size, false, op, 0, group3_names[ op ] } );
+					}
+				}
+			}
+
+			// test Eb,Gb - Ev,Gv and test AL,Ib - rAX,Iz
+			for ( const auto& e : rm_operands )
+			{
+				for ( const auto& g : reg_operands )
+				{
+					const auto rex = static_cast< std::uint8_t >( e.rex | g.rex );
+
+					if ( fits( size, e.high_byte, rex ) && fits( size, g.high_byte, rex ) )
+						cases.push_back( { encode( size, rex, { static_cast< std::uint8_t >( 0x84 | wide ), static_cast< std::uint8_t >( e.modrm | g.reg % 8 << 3 ) }, e.tail ), arithmetic_flags & ~af, size, false, 0, 0, "test" } );
+				}
+			}
+
+			cases.push_back( { encode( size, 0, { static_cast< std::uint8_t >( 0xA8 | wide ) }, { }, 0x80008080, iz ), arithmetic_flags & ~af, size, false, 0, 0, "test" } );
+		}
+
+		return cases;
+	}
+
+	// Masks the flags the manual leaves undefined for the count of a shift or rotate
+	std::uint32_t shift_flags( const test_case& c, const state& s )
+	{
+		auto count = c.count < 0 ? static_cast< std::uint8_t >( s.rcx ) : static_cast< std::uint8_t >( c.count );
+		count &= c.size == 8 ? 0x3F : 0x1F;
+
+		if ( count == 0 )
+			return arithmetic_flags;
+
+		std::uint32_t flags = count == 1 ? arithmetic_flags : arithmetic_flags & ~of;
+
+		if ( c.op <= 3 )
+			return flags;
+
+		flags &= ~af;
+
+		// CF of shl and shr is undefined when the count is not less than the size of the operand
+		if ( ( c.op == 4 || c.op == 5 || c.op == 6 ) && count >= c.size * 8 )
+			flags &= ~cf;
+
+		return flags;
+	}
+
+	void print_state( const char* pname, const state& s, std::uint32_t flags, const char* psuffix )
+	{
+		std::printf( "  %-8s rax=%016llx rcx=%016llx rdx=%016llx rbx=%016llx r8=%016llx r9=%016llx [rdi+38]=%016llx flags=%03llx%s\n", pname,
+					 static_cast< unsigned long long >( s.rax ), static_cast< unsigned long long >( s.rcx ), static_cast< unsigned long long >( s.rdx ),
+					 static_cast< unsigned long long >( s.rbx ), static_cast< unsigned long long >( s.r8 ), static_cast< unsigned long long >( s.r9 ),
+					 static_cast< unsigned long long >( s.memory ), static_cast< unsigned long long >( s.rflags & flags ), psuffix );
+	}
+}
+
+int main( )
+{
+	auto* pcode = static_cast< std::uint8_t* >( mmap( nullptr, 4096, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+
+	if ( pcode == MAP_FAILED )
+	{
+		std::perror( "mmap" );
+		return 1;
+	}
+
+	struct sigaction action { };
+	action.sa_handler = on_divide_error;
+	sigaction( SIGFPE, &action, nullptr );
+
+	static const std::uint64_t values[ ] = {
+		0x0, 0x1, 0x2, 0x7F, 0x80, 0xFF, 0x100, 0x7FFF, 0x8000, 0xFFFF, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0x100000000,
+		0x7FFFFFFFFFFFFFFF, 0x8000000000000000, 0xFFFFFFFFFFFFFFFF, 0x123456789ABCDEF0, 0xFEDCBA9876543210, 0x00000000DEADBEEF,
+	};
+
+	const auto cases    = make_cases( );
+	size_t     runs     = 0;
+	size_t     failures = 0;
+	std::uint64_t random = 1;
+
+	for ( const auto& c : cases )
+	{
+		for ( const auto rax : values )
+		{
+			for ( const auto rcx : values )
+			{
+				// rdx gets a value that keeps most divisions from overflowing and the initial flags are pseudo-random, so flags an
+				// instruction must not modify are checked too. The other operands repeat rax and rcx, and every register is compared
+				// in full, so a 32-bit result must clear the upper half and a byte or word result must keep it
+				random = random * 6364136223846793005ull + 1442695040888963407ull;
+
+				const state initial = { rax, rcx, ( random >> 33 ) % 3 ? 0 : rax >> 1, rcx, rax, rcx, 0x202 | ( ( random >> 40 ) & arithmetic_flags ), rax };
+
+				auto native   = initial;
+				auto emulated = initial;
+
+				const bool native_completed   = run_native( pcode, c, native );
+				const bool emulated_completed = run_emulator( c, emulated );
+				const auto flags              = c.shift ? shift_flags( c, initial ) & c.defined_flags : c.defined_flags;
+
+				runs++;
+
+				if ( native_completed == emulated_completed &&
+					 ( !native_completed ||
+					   ( native.rax == emulated.rax && native.rcx == emulated.rcx && native.rdx == emulated.rdx && native.rbx == emulated.rbx && native.r8 == emulated.r8 &&
+						 native.r9 == emulated.r9 && native.memory == emulated.memory && ( ( native.rflags ^ emulated.rflags ) & flags ) == 0 ) ) )
+					continue;
+
+				if ( failures++ < 20 )
+				{
+					std::printf( "%-5s", c.pname );
+					for ( const auto byte : c.bytes )
+						std::printf( " %02x", byte );
+					std::printf( "\n" );
+					print_state( "initial", initial, arithmetic_flags, "" );
+					print_state( "native", native, flags, native_completed ? "" : " #DE" );
+					print_state( "emulated", emulated, flags, emulated_completed ? "" : " #DE" );
+				}
+			}
+		}
+	}
+
+	std::printf( "emulator_flags: %zu cases, %zu runs, %zu mismatches\n", cases.size( ), runs, failures );
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,1219 @@
+// User-mode (Linux) benchmark of nmd_assembly.h. Every case runs over the same corpora, generated from a seed, built from the code of AVX-512
+// kernels or read from PE files, so runs can be compared, and a run can be saved as JSON. Define NMD_BENCH_BASELINE to build it against an older
+// nmd_assembly.h that only has the original interface (see the 'compare' target of the Makefile)
+#define NMD_ASSEMBLY_IMPLEMENTATION
+#include "nmd_assembly.h"
+
+#include "pe_file.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr ULONG section_executable = 0x20000000; // IMAGE_SCN_MEM_EXECUTE
+
+	struct corpus
+	{
+		std::string                 name;
+		std::vector< std::uint8_t > bytes;
+	};
+
+	struct options
+	{
+		std::uint64_t              seed        = 1;
+		size_t                     corpus_size = 1 << 20;
+		double                     min_time    = 0.2;
+		int                        repeats     = 5;
+		bool                       generate    = true;
+		bool                       hashes      = false;
+		const char*                pjson_path  = nullptr;
+		std::vector< const char* > pe_paths;
+	};
+
+	// What one pass of a case processed. 'bytes' are the instruction bytes decoded, formatted, assembled or emulated
+	struct work
+	{
+		size_t instructions;
+		size_t bytes;
+	};
+
+	// Hardware counters of the calling thread, through perf_event_open(2). A counter the kernel or the machine doesn't provide (e.g. in a VM
+	// or with kernel.perf_event_paranoid > 2) is reported as missing
+	class perf_counters
+	{
+	public:
+		static constexpr size_t count = 3;
+
+		static constexpr const char* names[ count ] = { "cycles", "branch_misses", "cache_misses" };
+
+		perf_counters( )
+		{
+			static const std::uint64_t configs[ count ] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES };
+
+			for ( size_t i = 0; i < count; i++ )
+			{
+				perf_event_attr attributes { };
+				attributes.size           = sizeof( attributes );
+				attributes.type           = PERF_TYPE_HARDWARE;
+				attributes.config         = configs[ i ];
+				attributes.disabled       = 1;
+				attributes.exclude_kernel = 1;
+				attributes.exclude_hv     = 1;
+
+				fds[ i ] = static_cast< int >( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+			}
+		}
+
+		~perf_counters( )
+		{
+			for ( const auto fd : fds )
+			{
+				if ( fd >= 0 )
+					close( fd );
+			}
+		}
+
+		perf_counters( const perf_counters& )            = delete;
+		perf_counters& operator=( const perf_counters& ) = delete;
+
+		bool available( const size_t i ) const { return fds[ i ] >= 0; }
+
+		void start( )
+		{
+			for ( const auto fd : fds )
+			{
+				if ( fd < 0 )
+					continue;
+
+				ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+				ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+			}
+		}
+
+		void stop( std::uint64_t ( &values )[ count ] )
+		{
+			for ( size_t i = 0; i < count; i++ )
+			{
+				values[ i ] = 0;
+
+				if ( fds[ i ] < 0 )
+					continue;
+
+				ioctl( fds[ i ], PERF_EVENT_IOC_DISABLE, 0 );
+
+				if ( read( fds[ i ], &values[ i ], sizeof( values[ i ] ) ) != sizeof( values[ i ] ) )
+					values[ i ] = 0;
+			}
+		}
+
+	private:
+		int fds[ count ];
+	};
+
+	struct result
+	{
+		std::string case_name;
+		std::string corpus_name;
+		work        per_pass;
+		double      seconds_per_pass;
+		bool        has_counter[ perf_counters::count ];
+		double      counters_per_instruction[ perf_counters::count ];
+	};
+
+	// xorshift64, so the corpus only depends on the seed
+	struct random
+	{
+		std::uint64_t state;
+
+		explicit random( std::uint64_t seed ) : state( seed * 0x9E3779B97F4A7C15ull | 1 ) { }
+
+		std::uint32_t next( )
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return static_cast< std::uint32_t >( state >> 32 );
+		}
+	};
+
+	struct opcode_map
+	{
+		const char*  name;
+		std::uint8_t prefix[ 2 ];
+		size_t       prefix_size;
+	};
+
+	// One generated corpus per opcode map. VEX and EVEX instructions select their map in the random bytes behind the first byte
+	constexpr opcode_map opcode_maps[ ] = {
+		{ "generated_1byte", { }, 0 },
+		{ "generated_0f", { 0x0F }, 1 },
+		{ "generated_0f38", { 0x0F, 0x38 }, 2 },
+		{ "generated_0f3a", { 0x0F, 0x3A }, 2 },
+		{ "generated_vex", { 0xC4 }, 1 },
+		{ "generated_evex", { 0x62 }, 1 },
+	};
+
+	// Random bytes behind the prefix of an opcode map, kept only if they decode
+	corpus generate_corpus( const opcode_map& map, const options& opts )
+	{
+		corpus c { map.name, { } };
+
+		// Every map has its own stream of the seed
+		std::uint64_t stream = map.prefix_size;
+
+		for ( size_t i = 0; i < map.prefix_size; i++ )
+			stream = stream << 8 | map.prefix[ i ];
+
+		random rng( opts.seed + ( stream << 16 ) );
+
+		c.bytes.reserve( opts.corpus_size + NMD_X86_MAXIMUM_INSTRUCTION_LENGTH );
+
+		while ( c.bytes.size( ) < opts.corpus_size )
+		{
+			std::uint8_t candidate[ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ];
+
+			for ( auto& b : candidate )
+				b = static_cast< std::uint8_t >( rng.next( ) );
+
+			std::memcpy( candidate, map.prefix, map.prefix_size );
+
+			nmd_x86_instruction instruction;
+
+			if ( !nmd_x86_decode_buffer( candidate, sizeof( candidate ), &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL ) )
+				continue;
+
+			c.bytes.insert( c.bytes.end( ), candidate, candidate + instruction.length );
+		}
+
+		return c;
+	}
+
+	// The code of AVX-512 kernels as a compiler emits it for intrinsics(GCC 12, -O2 -mavx512f -mavx512bw -mavx512vl -mavx512dq), with
+	// their scalar loop control and padding:
+	//  saxpy:        vbroadcastss, vfmadd213ps with a memory operand, a masked tail with kmovw, vmovups{k1}{z} and vfmadd132ps
+	//  dot:          two vfmadd231ps accumulators reduced with vextractf64x4, vextractf128, vpermilps and vshufps
+	//  lookup:       kxnorw, kmovw and vgatherdps
+	//  count_byte:   vpbroadcastb, vpcmpeqb into k0, kmovq and popcnt
+	//  clamp:        vpbroadcastd, vpmaxsd, vpminsd and vmovdqu64
+	//  blend_select: vmovdqu32 and vpternlogd
+	//  interleave:   RIP-relative vmovdqa32 of the indices and vpermt2ps
+	//  scale_sqrt:   vbroadcastsd, vmulpd and vsqrtpd with embedded rounding
+	constexpr std::uint8_t avx512_kernels[ ] = {
+		0x48, 0x89, 0xD1, 0x62, 0xF2, 0x7D, 0x48, 0x18, 0xC0, 0x48, 0x83, 0xFA, 0x0F, 0x76, 0x71, 0xB8, 0x10, 0x00, 0x00, 0x00,
+		0x0F, 0x1F, 0x40, 0x00, 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x4C, 0x86, 0xFF, 0x62, 0xF2, 0x7D, 0x48, 0xA8, 0x4C, 0x87, 0xFF,
+		0x62, 0xF1, 0x7C, 0x48, 0x11, 0x4C, 0x87, 0xFF, 0x48, 0x83, 0xC0, 0x10, 0x48, 0x39, 0xC1, 0x73, 0xDF, 0x48, 0x8D, 0x41,
+		0xF0, 0x48, 0x83, 0xE0, 0xF0, 0x48, 0x83, 0xC0, 0x10, 0x89, 0xC2, 0x48, 0xC1, 0xE0, 0x02, 0x48, 0x01, 0xC7, 0x48, 0x01,
+		0xC6, 0x29, 0xD1, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xD3, 0xE0, 0x83, 0xE8, 0x01, 0xC5, 0xF8, 0x92, 0xC8, 0x62, 0xF1, 0x7C,
+		0xC9, 0x10, 0x0F, 0x62, 0xF1, 0x7C, 0xC9, 0x10, 0x16, 0x62, 0xF2, 0x75, 0x48, 0x98, 0xC2, 0x62, 0xF1, 0x7C, 0x49, 0x11,
+		0x07, 0xC5, 0xF8, 0x77, 0xC3, 0x0F, 0x1F, 0x00, 0x31, 0xD2, 0xEB, 0xCD, 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x90, 0x48, 0x83, 0xFA, 0x1F, 0x76, 0x7A, 0xC5, 0xF8, 0x57, 0xC0, 0xB8, 0x20, 0x00, 0x00, 0x00, 0x62,
+		0xF1, 0x7C, 0x48, 0x28, 0xC8, 0x0F, 0x1F, 0x00, 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x54, 0x87, 0xFE, 0x62, 0xF1, 0x7C, 0x48,
+		0x10, 0x5C, 0x87, 0xFF, 0x62, 0xF2, 0x6D, 0x48, 0xB8, 0x4C, 0x86, 0xFE, 0x62, 0xF2, 0x65, 0x48, 0xB8, 0x44, 0x86, 0xFF,
+		0x48, 0x83, 0xC0, 0x20, 0x48, 0x39, 0xC2, 0x73, 0xD7, 0x62, 0xF1, 0x7C, 0x48, 0x58, 0xC1, 0x62, 0xF3, 0xFD, 0x48, 0x1B,
+		0xC1, 0x01, 0xC5, 0xF4, 0x58, 0xC0, 0xC4, 0xE3, 0x7D, 0x19, 0xC1, 0x01, 0xC5, 0xF0, 0x58, 0xC0, 0xC4, 0xE3, 0x79, 0x04,
+		0xC8, 0x4E, 0xC5, 0xF0, 0x58, 0xC8, 0xC5, 0xF8, 0x28, 0xC1, 0xC5, 0xF0, 0xC6, 0xC9, 0x55, 0xC5, 0xFA, 0x58, 0xC1, 0xC5,
+		0xF8, 0x77, 0xC3, 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC5, 0xF9, 0x57, 0xC0, 0xEB, 0xC1, 0x66, 0x2E,
+		0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x83, 0xF9, 0x0F, 0x76, 0x31, 0xB8, 0x10, 0x00, 0x00, 0x00, 0xC5,
+		0xF4, 0x46, 0xC9, 0x90, 0x62, 0xF1, 0x7E, 0x48, 0x6F, 0x4C, 0x82, 0xFF, 0xC5, 0xF8, 0x90, 0xD1, 0x62, 0xF2, 0x7D, 0x4A,
+		0x92, 0x04, 0x8E, 0x62, 0xF1, 0x7C, 0x48, 0x11, 0x44, 0x87, 0xFF, 0x48, 0x83, 0xC0, 0x10, 0x48, 0x39, 0xC1, 0x73, 0xDC,
+		0xC5, 0xF8, 0x77, 0xC3, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x62, 0xF2, 0x7D, 0x48, 0x7A, 0xC6, 0x31, 0xF6,
+		0x48, 0x83, 0xFA, 0x3F, 0x76, 0x28, 0xB8, 0x40, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x44, 0x00, 0x00, 0x62, 0xF1, 0x7D, 0x48,
+		0x74, 0x44, 0x07, 0xFF, 0x48, 0x83, 0xC0, 0x40, 0xC4, 0xE1, 0xFB, 0x93, 0xC8, 0xF3, 0x48, 0x0F, 0xB8, 0xC9, 0x48, 0x01,
+		0xCE, 0x48, 0x39, 0xC2, 0x73, 0xE2, 0x48, 0x89, 0xF0, 0xC5, 0xF8, 0x77, 0xC3, 0x0F, 0x1F, 0x00, 0x62, 0xF2, 0x7D, 0x48,
+		0x7C, 0xCE, 0x62, 0xF2, 0x7D, 0x48, 0x7C, 0xD2, 0x48, 0x83, 0xF9, 0x0F, 0x76, 0x32, 0x48, 0x8D, 0x04, 0x8D, 0xC0, 0xFF,
+		0xFF, 0xFF, 0x48, 0x83, 0xE0, 0xC0, 0x48, 0x8D, 0x44, 0x07, 0x40, 0x0F, 0x1F, 0x44, 0x00, 0x00, 0x62, 0xF2, 0x75, 0x48,
+		0x3D, 0x07, 0x48, 0x83, 0xC7, 0x40, 0x62, 0xF2, 0x7D, 0x48, 0x39, 0xC2, 0x62, 0xF1, 0xFE, 0x48, 0x7F, 0x47, 0xFF, 0x48,
+		0x39, 0xC7, 0x75, 0xE4, 0xC5, 0xF8, 0x77, 0xC3, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x49, 0x83, 0xF8, 0x0F,
+		0x76, 0x37, 0xB8, 0x10, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x44, 0x00, 0x00, 0x62, 0xF1, 0x7E, 0x48, 0x6F, 0x44, 0x81, 0xFF,
+		0x62, 0xF1, 0x7E, 0x48, 0x6F, 0x4C, 0x86, 0xFF, 0x62, 0xF3, 0x75, 0x48, 0x25, 0x44, 0x82, 0xFF, 0xCA, 0x62, 0xF1, 0xFE,
+		0x48, 0x7F, 0x44, 0x87, 0xFF, 0x48, 0x83, 0xC0, 0x10, 0x49, 0x39, 0xC0, 0x73, 0xD6, 0xC5, 0xF8, 0x77, 0xC3, 0x66, 0x90,
+		0x48, 0x83, 0xF9, 0x0F, 0x76, 0x58, 0x62, 0xF1, 0x7D, 0x48, 0x6F, 0x25, 0x00, 0x00, 0x00, 0x00, 0xB8, 0x10, 0x00, 0x00,
+		0x00, 0x62, 0xF1, 0x7D, 0x48, 0x6F, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x90, 0x62, 0xF1, 0x7C, 0x48, 0x10, 0x44, 0x86, 0xFF,
+		0x62, 0xF1, 0x7C, 0x48, 0x10, 0x4C, 0x82, 0xFF, 0x62, 0xF1, 0x7C, 0x48, 0x28, 0xD0, 0x62, 0xF2, 0x65, 0x48, 0x7F, 0xC1,
+		0x62, 0xF2, 0x5D, 0x48, 0x7F, 0xD1, 0x62, 0xF1, 0x7C, 0x48, 0x11, 0x44, 0xC7, 0xFF, 0x62, 0xF1, 0x7C, 0x48, 0x11, 0x54,
+		0xC7, 0xFE, 0x48, 0x83, 0xC0, 0x10, 0x48, 0x39, 0xC1, 0x73, 0xC5, 0xC5, 0xF8, 0x77, 0xC3, 0x90, 0x48, 0x83, 0xFE, 0x07,
+		0x76, 0x39, 0x48, 0x8D, 0x04, 0xF5, 0xC0, 0xFF, 0xFF, 0xFF, 0x62, 0xF2, 0xFD, 0x48, 0x19, 0xC0, 0x48, 0x83, 0xE0, 0xC0,
+		0x48, 0x8D, 0x44, 0x07, 0x40, 0x0F, 0x1F, 0x00, 0x62, 0xF1, 0xFD, 0x48, 0x59, 0x0F, 0x48, 0x83, 0xC7, 0x40, 0x62, 0xF1,
+		0xFD, 0x18, 0x51, 0xC9, 0x62, 0xF1, 0xFD, 0x48, 0x11, 0x4F, 0xFF, 0x48, 0x39, 0xC7, 0x75, 0xE4, 0xC5, 0xF8, 0x77, 0xC3,
+	};
+
+	// The kernels back to back, repeated up to the corpus' size
+	corpus make_avx512_corpus( const options& opts )
+	{
+		corpus c { "avx512_kernels", { } };
+
+		c.bytes.reserve( opts.corpus_size + sizeof( avx512_kernels ) );
+
+		while ( c.bytes.size( ) < opts.corpus_size )
+			c.bytes.insert( c.bytes.end( ), avx512_kernels, avx512_kernels + sizeof( avx512_kernels ) );
+
+		return c;
+	}
+
+	// Adds two kinds of corpora of a PE32+ file:
+	//  - its executable sections (e.g. '.text') as they are stored in the file, which mix code with padding, jump tables and other data
+	//  - the bodies of the functions of its exception directory back to back, which are only code
+	bool load_pe_corpora( const char* path, std::vector< corpus >& corpora )
+	{
+		pe::file_view view;
+
+		if ( !pe::open_file( path, view ) )
+			return false;
+
+		for ( WORD i = 0; i < view.section_count; i++ )
+		{
+			const auto& section = view.psections[ i ];
+
+			if ( !( section.Characteristics & section_executable ) || !section.SizeOfRawData || section.PointerToRawData + static_cast< size_t >( section.SizeOfRawData ) > view.size )
+				continue;
+
+			const auto* pbegin = view.pbase + section.PointerToRawData;
+
+			corpora.push_back( { std::string( path ) + ":" + std::string( section.Name, strnlen( section.Name, sizeof( section.Name ) ) ), std::vector< std::uint8_t >( pbegin, pbegin + section.SizeOfRawData ) } );
+		}
+
+		size_t      function_count = 0;
+		const auto* pfunctions     = pe::get_runtime_functions( view, function_count );
+		corpus      functions { std::string( path ) + ":functions", { } };
+
+		for ( size_t i = 0; i < function_count; i++ )
+		{
+			const auto& function = pfunctions[ i ];
+
+			if ( function.EndAddress <= function.BeginAddress )
+				continue;
+
+			const auto  size   = static_cast< size_t >( function.EndAddress - function.BeginAddress );
+			const auto* pbegin = pe::rva_to_pointer< std::uint8_t >( view, function.BeginAddress, size );
+
+			if ( pbegin )
+				functions.bytes.insert( functions.bytes.end( ), pbegin, pbegin + size );
+		}
+
+		if ( !functions.bytes.empty( ) )
+			corpora.push_back( std::move( functions ) );
+
+		pe::close_file( view );
+
+		return true;
+	}
+
+	// Runs 'body' until it has run for 'min_time' seconds and keeps the fastest of 'repeats' runs, with the counters of that run
+	template < typename F >
+	result measure( const char* case_name, const std::string& corpus_name, const options& opts, perf_counters& counters, F&& body )
+	{
+		using clock = std::chrono::steady_clock;
+
+		result r { case_name, corpus_name, { }, 0, { }, { } };
+
+		for ( int repeat = 0; repeat < opts.repeats; repeat++ )
+		{
+			size_t     passes  = 0;
+			double     elapsed = 0;
+			work       w { };
+			const auto start = clock::now( );
+
+			counters.start( );
+
+			do
+			{
+				w = body( );
+				passes++;
+				elapsed = std::chrono::duration< double >( clock::now( ) - start ).count( );
+			} while ( elapsed < opts.min_time );
+
+			std::uint64_t values[ perf_counters::count ];
+			counters.stop( values );
+
+			const auto seconds = elapsed / static_cast< double >( passes );
+
+			if ( repeat && seconds >= r.seconds_per_pass )
+				continue;
+
+			r.per_pass         = w;
+			r.seconds_per_pass = seconds;
+
+			for ( size_t i = 0; i < perf_counters::count; i++ )
+			{
+				r.has_counter[ i ]              = counters.available( i );
+				r.counters_per_instruction[ i ] = static_cast< double >( values[ i ] ) / static_cast< double >( passes * w.instructions );
+			}
+		}
+
+		return r;
+	}
+
+	double ns_per_instruction( const result& r ) { return r.seconds_per_pass * 1e9 / static_cast< double >( r.per_pass.instructions ); }
+
+	double instructions_per_second( const result& r ) { return static_cast< double >( r.per_pass.instructions ) / r.seconds_per_pass; }
+
+	double bytes_per_second( const result& r ) { return static_cast< double >( r.per_pass.bytes ) / r.seconds_per_pass; }
+
+	void report( const result& r )
+	{
+		std::printf( "%-16s %-40s %8.2f ns/insn %8.2f Minsn/s %8.2f MB/s", r.case_name.c_str( ), r.corpus_name.c_str( ), ns_per_instruction( r ), instructions_per_second( r ) / 1e6, bytes_per_second( r ) / 1e6 );
+
+		if ( r.has_counter[ 0 ] )
+			std::printf( " %8.2f cycles/insn", r.counters_per_instruction[ 0 ] );
+
+		std::printf( "\n" );
+	}
+
+	void write_json_string( std::FILE* pfile, const std::string& value )
+	{
+		std::fputc( '"', pfile );
+
+		for ( const auto c : value )
+		{
+			if ( c == '"' || c == '\\' )
+				std::fprintf( pfile, "\\%c", c );
+			else if ( static_cast< unsigned char >( c ) < 0x20 )
+				std::fprintf( pfile, "\\u%04x", static_cast< unsigned char >( c ) );
+			else
+				std::fputc( c, pfile );
+		}
+
+		std::fputc( '"', pfile );
+	}
+
+	// The options of the run and one object per case and corpus. Missing counters are null
+	bool write_json( const char* path, const options& opts, const std::vector< result >& results )
+	{
+		auto* const pfile = std::fopen( path, "w" );
+
+		if ( !pfile )
+			return false;
+
+#ifdef NMD_BENCH_BASELINE
+		constexpr auto baseline = true;
+#else
+		constexpr auto baseline = false;
+#endif
+
+		std::fprintf( pfile, "{\n  \"baseline\": %s,\n  \"seed\": %llu,\n  \"corpus_size\": %zu,\n  \"min_time\": %g,\n  \"repeats\": %d,\n  \"results\": [", baseline ? "true" : "false",
+		              static_cast< unsigned long long >( opts.seed ), opts.corpus_size, opts.min_time, opts.repeats );
+
+		for ( size_t i = 0; i < results.size( ); i++ )
+		{
+			const auto& r = results[ i ];
+
+			std::fprintf( pfile, "%s\n    { \"case\": ", i ? "," : "" );
+			write_json_string( pfile, r.case_name );
+			std::fprintf( pfile, ", \"corpus\": " );
+			write_json_string( pfile, r.corpus_name );
+			std::fprintf( pfile, ", \"instructions\": %zu, \"bytes\": %zu, \"ns_per_instruction\": %.3f, \"instructions_per_second\": %.0f, \"bytes_per_second\": %.0f", r.per_pass.instructions,
+			              r.per_pass.bytes, ns_per_instruction( r ), instructions_per_second( r ), bytes_per_second( r ) );
+
+			for ( size_t j = 0; j < perf_counters::count; j++ )
+			{
+				if ( r.has_counter[ j ] )
+					std::fprintf( pfile, ", \"%s_per_instruction\": %.4f", perf_counters::names[ j ], r.counters_per_instruction[ j ] );
+				else
+					std::fprintf( pfile, ", \"%s_per_instruction\": null", perf_counters::names[ j ] );
+			}
+
+			std::fprintf( pfile, " }" );
+		}
+
+		std::fprintf( pfile, "\n  ]\n}\n" );
+
+		return std::fclose( pfile ) == 0;
+	}
+
+	// The decode cases store the instructions of the corpus window by window, like a caller that keeps them
+	constexpr size_t window_size = 256;
+
+	nmd_x86_instruction g_instructions[ window_size ];
+
+	// Runtime address of the first byte of every corpus
+	constexpr std::uint64_t corpus_address = 0x140001000;
+
+	// Decodes the corpus one instruction at a time, resynchronizing one byte later on invalid bytes
+	work run_decode( const corpus& c )
+	{
+		const auto* pbytes = c.bytes.data( );
+		const auto  size   = c.bytes.size( );
+		size_t      count  = 0;
+
+		for ( size_t offset = 0; offset < size; count++ )
+		{
+			auto& instruction = g_instructions[ count % window_size ];
+#ifdef NMD_BENCH_BASELINE
+			offset += nmd_x86_decode_buffer( pbytes + offset, size - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL ) ? instruction.length : 1;
+#else
+			offset += nmd_x86_decode_buffer_at( pbytes + offset, size - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL, corpus_address + offset ) ? instruction.length : 1;
+#endif
+		}
+
+		return { count, size };
+	}
+
+	work run_ldisasm( const corpus& c )
+	{
+		const auto* pbytes = c.bytes.data( );
+		const auto  size   = c.bytes.size( );
+		size_t      count  = 0;
+
+		for ( size_t offset = 0; offset < size; count++ )
+		{
+			const auto length = nmd_x86_ldisasm( pbytes + offset, size - offset, NMD_X86_MODE_64 );
+			offset += length ? length : 1;
+		}
+
+		return { count, size };
+	}
+
+#ifndef NMD_BENCH_BASELINE
+	work run_decode_batch( const corpus& c )
+	{
+		const auto* pbytes = c.bytes.data( );
+		const auto  size   = c.bytes.size( );
+		size_t      count  = 0;
+
+		for ( size_t offset = 0; offset < size; )
+		{
+			size_t     num_bytes = 0;
+			const auto decoded   = nmd_x86_decode_buffer_batch( pbytes + offset, size - offset, corpus_address + offset, g_instructions, window_size, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL, &num_bytes );
+
+			// Skip a byte the decoder stopped on
+			offset += decoded ? num_bytes : 1;
+			count += decoded ? decoded : 1;
+		}
+
+		return { count, size };
+	}
+
+	// Stores compact records, with the flags a control flow recovery would use
+	work run_decode_lite( const corpus& c )
+	{
+		static nmd_x86_instruction_lite instructions[ window_size ];
+
+		const auto* pbytes = c.bytes.data( );
+		const auto  size   = c.bytes.size( );
+		size_t      count  = 0;
+
+		for ( size_t offset = 0; offset < size; count++ )
+		{
+			auto& instruction = instructions[ count % window_size ];
+			offset += nmd_x86_decode_buffer_lite( pbytes + offset, size - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_MINIMAL ) ? instruction.length : 1;
+		}
+
+		return { count, size };
+	}
+#endif // NMD_BENCH_BASELINE
+
+	// The valid instructions of a corpus and their runtime addresses, decoded once so the format and assemble cases only measure those
+	struct decoded_corpus
+	{
+		std::vector< nmd_x86_instruction > instructions;
+		std::vector< std::uint64_t >       addresses;
+		size_t                             bytes = 0;
+	};
+
+	decoded_corpus decode_corpus( const corpus& c )
+	{
+		decoded_corpus decoded;
+
+		for ( size_t offset = 0; offset < c.bytes.size( ); )
+		{
+			nmd_x86_instruction instruction;
+
+			if ( !nmd_x86_decode_buffer( c.bytes.data( ) + offset, c.bytes.size( ) - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL ) )
+			{
+				offset++;
+				continue;
+			}
+
+			decoded.instructions.push_back( instruction );
+			decoded.addresses.push_back( corpus_address + offset );
+			decoded.bytes += instruction.length;
+			offset += instruction.length;
+		}
+
+		return decoded;
+	}
+
+	// Formats every instruction into the same buffer
+	work run_format( const decoded_corpus& decoded, std::uint32_t flags )
+	{
+		static char text[ NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH + 1 ];
+
+		for ( size_t i = 0; i < decoded.instructions.size( ); i++ )
+			nmd_x86_format_instruction( &decoded.instructions[ i ], text, decoded.addresses[ i ], flags );
+
+		return { decoded.instructions.size( ), decoded.bytes };
+	}
+
+	// The formatted instructions the assembler accepts, as null-terminated strings back to back
+	struct assembly_listing
+	{
+		std::string                  text;
+		std::vector< size_t >        offsets;
+		std::vector< std::uint64_t > addresses;
+	};
+
+	assembly_listing make_listing( const decoded_corpus& decoded )
+	{
+		assembly_listing listing;
+
+		for ( size_t i = 0; i < decoded.instructions.size( ); i++ )
+		{
+			char         line[ NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH + 1 ];
+			std::uint8_t encoded[ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ];
+
+			nmd_x86_format_instruction( &decoded.instructions[ i ], line, decoded.addresses[ i ], NMD_X86_FORMAT_FLAGS_DEFAULT );
+
+			if ( !nmd_x86_assemble( line, encoded, sizeof( encoded ), decoded.addresses[ i ], NMD_X86_MODE_64, nullptr ) )
+				continue;
+
+			listing.offsets.push_back( listing.text.size( ) );
+			listing.addresses.push_back( decoded.addresses[ i ] );
+			listing.text.append( line );
+			listing.text.push_back( '\0' );
+		}
+
+		return listing;
+	}
+
+	work run_assemble( const assembly_listing& listing )
+	{
+		std::uint8_t encoded[ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ];
+		size_t       bytes = 0;
+
+		for ( size_t i = 0; i < listing.offsets.size( ); i++ )
+			bytes += nmd_x86_assemble( listing.text.data( ) + listing.offsets[ i ], encoded, sizeof( encoded ), listing.addresses[ i ], NMD_X86_MODE_64, nullptr );
+
+		return { listing.offsets.size( ), bytes };
+	}
+
+	// 64-bit code that only uses instructions every revision of the emulator implements:
+	//  loop: mov eax, [rbx]; add eax, ecx; mov [rbx], eax; push rax; pop rdx; xor edx, eax; call f; sub ecx, esi; jnz loop; hlt
+	//  f:    mov edx, eax; ret
+	constexpr std::uint8_t emulator_loop[ ] = {
+		0x8B, 0x03, 0x01, 0xC8, 0x89, 0x03, 0x50, 0x5A, 0x31, 0xC2, 0xE8, 0x05, 0x00, 0x00, 0x00, 0x29, 0xF1, 0x75, 0xED, 0xF4,
+		0x89, 0xC2, 0xC3,
+	};
+
+	constexpr size_t loop_instructions = 11; // Per iteration, with the ones of 'f'
+	constexpr size_t loop_bytes        = 22;
+	constexpr size_t loop_iterations   = 10000;
+
+	constexpr std::uint64_t emulator_address     = 0x10000;
+	constexpr size_t        emulator_memory_size = 0x10000;
+
+	// Emulates 'loop_iterations' iterations of 'emulator_loop' on a copy of 'initial', which may hold a block cache
+	const nmd_x86_cpu& emulate_loop( std::vector< std::uint8_t >& memory, const nmd_x86_cpu& initial )
+	{
+		static nmd_x86_cpu cpu;
+
+		cpu                    = initial;
+		cpu.mode               = NMD_X86_MODE_64;
+		cpu.physicalMemory     = memory.data( );
+		cpu.physicalMemorySize = memory.size( );
+		cpu.virtualAddress     = emulator_address;
+		cpu.rip                = emulator_address;
+		cpu.rsp.l64            = emulator_address + memory.size( ) - 0x100;
+		cpu.rbx.l64            = emulator_address + memory.size( ) / 2;
+		cpu.rcx.l64            = loop_iterations;
+		cpu.rsi.l64            = 1;
+
+		nmd_x86_emulate( &cpu, loop_iterations * loop_instructions );
+
+		return cpu;
+	}
+
+	work run_emulate( std::vector< std::uint8_t >& memory, const nmd_x86_cpu& initial )
+	{
+		const auto& cpu = emulate_loop( memory, initial );
+
+		return { cpu.count, cpu.count / loop_instructions * loop_bytes };
+	}
+
+	// Loop-heavy 64-bit guest programs over 'guest_data_size' bytes of pseudo-random data, which needs a revision of the emulator that
+	// implements group 1, test, shifts and F6/F7. Each one leaves its result in rax:
+	//  memcpy: mov rax, [rsi]; mov [rdi], rax; add rsi, 8; add rdi, 8; sub rcx, 1; jnz memcpy; hlt
+	//  crc32:  xor al, [rsi]; mov edx, 8; bit: shr eax, 1; jnc skip; xor eax, 0xEDB88320; skip: dec edx; jnz bit; inc rsi; dec rcx; jnz crc32;
+	//          not eax; hlt
+	//  fnv1a:  mov dl, [rsi]; test dl, dl; jz done; xor al, dl; mul ecx; inc rsi; jmp fnv1a; done: hlt
+	struct guest
+	{
+		const char*         name;
+		const std::uint8_t* pcode;
+		size_t              code_size;
+	};
+
+	constexpr std::uint8_t guest_memcpy[ ] = {
+		0x48, 0x8B, 0x06, 0x48, 0x89, 0x07, 0x48, 0x83, 0xC6, 0x08, 0x48, 0x83, 0xC7, 0x08, 0x48, 0x83, 0xE9, 0x01, 0x75, 0xEC, 0xF4,
+	};
+
+	constexpr std::uint8_t guest_crc32[ ] = {
+		0x32, 0x06, 0xBA, 0x08, 0x00, 0x00, 0x00, 0xD1, 0xE8, 0x73, 0x05, 0x35, 0x20, 0x83, 0xB8, 0xED, 0xFF, 0xCA, 0x75, 0xF3, 0x48, 0xFF,
+		0xC6, 0x48, 0xFF, 0xC9, 0x75, 0xE4, 0xF7, 0xD0, 0xF4,
+	};
+
+	constexpr std::uint8_t guest_fnv1a[ ] = { 0x8A, 0x16, 0x84, 0xD2, 0x74, 0x09, 0x30, 0xD0, 0xF7, 0xE1, 0x48, 0xFF, 0xC6, 0xEB, 0xF1, 0xF4 };
+
+	constexpr guest guests[ ] = {
+		{ "memcpy", guest_memcpy, sizeof( guest_memcpy ) },
+		{ "crc32", guest_crc32, sizeof( guest_crc32 ) },
+		{ "fnv1a", guest_fnv1a, sizeof( guest_fnv1a ) },
+	};
+
+	constexpr size_t guest_data_offset        = 0x1000;
+	constexpr size_t guest_destination_offset = 0x8000;
+	constexpr size_t guest_data_size          = 0x4000;
+	constexpr size_t guest_max_instructions   = 10000000;
+
+	// The guest's code followed by NUL-terminated data that has no other zero byte
+	std::vector< std::uint8_t > make_guest_memory( const guest& g )
+	{
+		std::vector< std::uint8_t > memory( emulator_memory_size );
+		std::memcpy( memory.data( ), g.pcode, g.code_size );
+
+		std::uint64_t state = 0x9E3779B97F4A7C15ull;
+
+		for ( size_t i = 0; i < guest_data_size - 1; i++ )
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			memory[ guest_data_offset + i ] = static_cast< std::uint8_t >( 1 + state % 255 );
+		}
+
+		return memory;
+	}
+
+	// Sets up 'cpu' to run 'g' from the start on a copy of 'initial', which may hold a block cache
+	void reset_guest( const guest& g, nmd_x86_cpu& cpu, std::vector< std::uint8_t >& memory, const nmd_x86_cpu& initial )
+	{
+		cpu                    = initial;
+		cpu.mode               = NMD_X86_MODE_64;
+		cpu.physicalMemory     = memory.data( );
+		cpu.physicalMemorySize = memory.size( );
+		cpu.virtualAddress     = emulator_address;
+		cpu.rip                = emulator_address;
+		cpu.rsp.l64            = emulator_address + memory.size( ) - 0x100;
+		cpu.rsi.l64            = emulator_address + guest_data_offset;
+		cpu.rdi.l64            = emulator_address + guest_destination_offset;
+
+		if ( g.pcode == guest_memcpy )
+			cpu.rcx.l64 = guest_data_size / 8;
+		else if ( g.pcode == guest_crc32 )
+		{
+			cpu.rax.l64 = 0xFFFFFFFF;
+			cpu.rcx.l64 = guest_data_size;
+		}
+		else
+		{
+			cpu.rax.l64 = 0x811C9DC5;
+			cpu.rcx.l64 = 0x01000193;
+		}
+	}
+
+	const nmd_x86_cpu& emulate_guest( const guest& g, std::vector< std::uint8_t >& memory, const nmd_x86_cpu& initial )
+	{
+		static nmd_x86_cpu cpu;
+
+		reset_guest( g, cpu, memory, initial );
+		nmd_x86_emulate( &cpu, guest_max_instructions );
+
+		return cpu;
+	}
+
+	// The instruction bytes one run of 'g' executes, counted by decoding each instruction before stepping over it
+	size_t count_guest_bytes( const guest& g, std::vector< std::uint8_t >& memory )
+	{
+		static const nmd_x86_cpu initial { };
+		static nmd_x86_cpu       cpu;
+
+		reset_guest( g, cpu, memory, initial );
+
+		size_t bytes = 0;
+
+		for ( size_t i = 0; i < guest_max_instructions; i++ )
+		{
+			const auto          offset = static_cast< size_t >( cpu.rip - emulator_address );
+			nmd_x86_instruction instruction;
+
+			if ( offset >= memory.size( ) || !nmd_x86_decode_buffer( memory.data( ) + offset, memory.size( ) - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_MINIMAL ) )
+				break;
+
+			// hlt and faults aren't counted
+			nmd_x86_emulate( &cpu, 1 );
+
+			if ( !cpu.count )
+				break;
+
+			bytes += instruction.length;
+		}
+
+		return bytes;
+	}
+
+	work run_emulate_guest( const guest& g, std::vector< std::uint8_t >& memory, const nmd_x86_cpu& initial, size_t bytes )
+	{
+		return { emulate_guest( g, memory, initial ).count, bytes };
+	}
+
+	// 64-bit FNV-1a over everything a regression check compares
+	struct fnv1a
+	{
+		std::uint64_t value = 0xCBF29CE484222325ull;
+
+		void add( const void* pdata, size_t size )
+		{
+			const auto* pbytes = static_cast< const std::uint8_t* >( pdata );
+
+			for ( size_t i = 0; i < size; i++ )
+				value = ( value ^ pbytes[ i ] ) * 0x100000001B3ull;
+		}
+
+		template < typename T >
+		void add_value( const T value_to_add )
+		{
+			add( &value_to_add, sizeof( value_to_add ) );
+		}
+	};
+
+	void print_hash( const char* case_name, const std::string& corpus_name, size_t count, const fnv1a& hash )
+	{
+		std::printf( "%-18s %-16s %8zu %016llx\n", case_name, corpus_name.c_str( ), count, static_cast< unsigned long long >( hash.value ) );
+	}
+
+	// The fields of a decoded instruction its users depend on. Padding and the copy of the instruction's bytes are left out
+	void add_instruction( fnv1a& hash, const nmd_x86_instruction& instruction )
+	{
+		hash.add_value( instruction.length );
+		hash.add_value( instruction.id );
+		hash.add_value( instruction.opcodeMap );
+		hash.add_value( instruction.opcode );
+		hash.add_value( instruction.encoding );
+		hash.add_value( instruction.prefixes );
+		hash.add_value( instruction.numPrefixes );
+		hash.add_value( instruction.modrm.modrm );
+		hash.add_value( instruction.sib.sib );
+		hash.add_value( instruction.immMask );
+		hash.add_value( instruction.immediate );
+		hash.add_value( instruction.dispMask );
+		hash.add_value( instruction.displacement );
+		hash.add_value( instruction.group );
+		hash.add_value( instruction.modifiedFlags.eflags );
+		hash.add_value( instruction.testedFlags.eflags );
+		hash.add_value( instruction.setFlags.eflags );
+		hash.add_value( instruction.clearedFlags.eflags );
+		hash.add_value( instruction.undefinedFlags.eflags );
+		hash.add_value( instruction.numOperands );
+
+		for ( size_t i = 0; i < instruction.numOperands; i++ )
+		{
+			const auto& operand = instruction.operands[ i ];
+			hash.add_value( operand.type );
+			hash.add_value( operand.size );
+			hash.add_value( operand.action );
+			hash.add_value( operand.isImplicit );
+		}
+#ifndef NMD_BENCH_BASELINE
+		hash.add_value( instruction.regsRead );
+		hash.add_value( instruction.regsWritten );
+		hash.add_value( instruction.flow );
+		hash.add_value( instruction.target );
+#endif
+	}
+
+	// Prints one hash per case of the output of the length disassembler, the decoder, the formatter in both syntaxes and the assembler
+	// fed with the formatter's output. Instructions the assembler rejects are counted
+	void print_hashes( const corpus& c )
+	{
+		fnv1a  lengths;
+		size_t count = 0;
+
+		for ( size_t offset = 0; offset < c.bytes.size( ); count++ )
+		{
+			const auto length = nmd_x86_ldisasm( c.bytes.data( ) + offset, c.bytes.size( ) - offset, NMD_X86_MODE_64 );
+			lengths.add_value( length );
+			offset += length ? length : 1;
+		}
+
+		print_hash( "ldisasm", c.name, count, lengths );
+
+		fnv1a  decoded, intel, att, assembled;
+		size_t valid = 0, rejected = 0;
+
+		for ( size_t offset = 0; offset < c.bytes.size( ); )
+		{
+			nmd_x86_instruction instruction;
+			const auto          address = corpus_address + offset;
+#ifdef NMD_BENCH_BASELINE
+			const auto is_valid = nmd_x86_decode_buffer( c.bytes.data( ) + offset, c.bytes.size( ) - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL );
+#else
+			const auto is_valid = nmd_x86_decode_buffer_at( c.bytes.data( ) + offset, c.bytes.size( ) - offset, &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL, address );
+#endif
+			decoded.add_value( is_valid );
+
+			if ( !is_valid )
+			{
+				offset++;
+				continue;
+			}
+
+			add_instruction( decoded, instruction );
+			valid++;
+			offset += instruction.length;
+
+			char line[ NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH + 1 ];
+#ifndef NMD_BENCH_BASELINE
+			// The original AT&T formatter reads in front of the buffer for some instructions
+			nmd_x86_format_instruction( &instruction, line, address, NMD_X86_FORMAT_FLAGS_DEFAULT | NMD_X86_FORMAT_FLAGS_ATT_SYNTAX );
+			att.add( line, std::strlen( line ) + 1 );
+#endif
+
+			nmd_x86_format_instruction( &instruction, line, address, NMD_X86_FORMAT_FLAGS_DEFAULT );
+			intel.add( line, std::strlen( line ) + 1 );
+
+			std::uint8_t encoded[ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ];
+			const auto   size = nmd_x86_assemble( line, encoded, sizeof( encoded ), address, NMD_X86_MODE_64, nullptr );
+			assembled.add_value( size );
+			assembled.add( encoded, size );
+			rejected += !size;
+		}
+
+		print_hash( "decode", c.name, valid, decoded );
+		print_hash( "format_intel", c.name, valid, intel );
+#ifndef NMD_BENCH_BASELINE
+		print_hash( "format_att", c.name, valid, att );
+#endif
+		print_hash( "assemble", c.name, valid, assembled );
+		std::printf( "%-18s %-16s %8zu\n", "assemble_rejected", c.name.c_str( ), rejected );
+	}
+
+	// The registers, flags and memory after the emulator loop
+	void print_emulator_hash( std::vector< std::uint8_t >& memory )
+	{
+		static const nmd_x86_cpu initial { };
+
+		const auto& cpu = emulate_loop( memory, initial );
+		fnv1a       hash;
+
+		for ( const auto* preg : { &cpu.rax, &cpu.rcx, &cpu.rdx, &cpu.rbx, &cpu.rsp, &cpu.rbp, &cpu.rsi, &cpu.rdi, &cpu.r8, &cpu.r9, &cpu.r10, &cpu.r11, &cpu.r12, &cpu.r13, &cpu.r14, &cpu.r15 } )
+			hash.add_value( preg->l64 );
+
+		hash.add_value( cpu.rip );
+		hash.add_value( static_cast< std::uint32_t >( cpu.flags.eflags ) );
+		hash.add( memory.data( ), memory.size( ) );
+
+		print_hash( "emulate", "loop", cpu.count, hash );
+	}
+
+	// The registers, flags and copied bytes after a guest program, with and without a block cache, which must agree
+	void print_guest_hash( const guest& g, const char* case_name, const nmd_x86_cpu& initial )
+	{
+		auto        memory = make_guest_memory( g );
+		const auto& cpu    = emulate_guest( g, memory, initial );
+		fnv1a       hash;
+
+		for ( const auto* preg : { &cpu.rax, &cpu.rcx, &cpu.rdx, &cpu.rbx, &cpu.rsp, &cpu.rbp, &cpu.rsi, &cpu.rdi } )
+			hash.add_value( preg->l64 );
+
+		hash.add_value( cpu.rip );
+		hash.add_value( static_cast< std::uint32_t >( cpu.flags.eflags ) );
+		hash.add( memory.data( ) + guest_destination_offset, guest_data_size );
+
+		print_hash( case_name, g.name, cpu.count, hash );
+	}
+
+#ifndef NMD_BENCH_BASELINE
+	// Code that overwrites the immediate of a later instruction of its own basic block, run from the block cache. rax must end up 2, not
+	// the 1 of the block decoded before the store:
+	//  mov ebx, 0x1000d; mov ecx, 2; mov [rbx], cl; mov eax, 1; hlt
+	void print_self_modifying_hash( )
+	{
+		static const std::uint8_t code[ ] = { 0xBB, 0x0D, 0x00, 0x01, 0x00, 0xB9, 0x02, 0x00, 0x00, 0x00, 0x88, 0x0B, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xF4 };
+
+		static nmd_x86_emulator_block block_cache[ 4 ];
+		static nmd_x86_cpu            cpu;
+		std::uint8_t                  memory[ sizeof( code ) ];
+
+		std::memcpy( memory, code, sizeof( code ) );
+
+		cpu                    = { };
+		cpu.mode               = NMD_X86_MODE_64;
+		cpu.physicalMemory     = memory;
+		cpu.physicalMemorySize = sizeof( memory );
+		cpu.virtualAddress     = emulator_address;
+		cpu.rip                = emulator_address;
+		cpu.blockCache         = block_cache;
+		cpu.blockCacheSize     = sizeof( block_cache ) / sizeof( block_cache[ 0 ] );
+
+		nmd_x86_emulate( &cpu, 100 );
+
+		fnv1a hash;
+		hash.add_value( cpu.rax.l64 );
+		hash.add_value( cpu.rip );
+
+		print_hash( "emulate", "self_modifying", cpu.count, hash );
+	}
+
+	// 15-byte EVEX instructions with three segment prefixes, masking, broadcast and long mnemonics, which format to the longest lines
+	constexpr std::uint8_t long_lines[ ][ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ] = {
+		{ 0x2E, 0x2E, 0x2E, 0x62, 0x03, 0x2D, 0xDB, 0x54, 0xA4, 0xE5, 0x89, 0x58, 0x8C, 0x99, 0xFF },
+		{ 0x2E, 0x2E, 0x2E, 0x62, 0x03, 0xAD, 0xDB, 0xCF, 0xA4, 0xE5, 0x89, 0x58, 0x8C, 0x99, 0xFF },
+	};
+
+	// Formats the long lines with every flag in both syntaxes and prints the hash of the lines and the length of the longest one
+	void print_long_lines_hash( )
+	{
+		fnv1a  hash;
+		size_t count = 0, longest = 0;
+
+		for ( const auto& bytes : long_lines )
+		{
+			nmd_x86_instruction instruction;
+			if ( !nmd_x86_decode_buffer( bytes, sizeof( bytes ), &instruction, NMD_X86_MODE_64, NMD_X86_DECODER_FLAGS_ALL ) )
+				continue;
+
+			for ( const std::uint32_t flags : { 0x7FFFu, 0xFFFFu, 0x7FFFu & ~static_cast< std::uint32_t >( NMD_X86_FORMAT_FLAGS_OPERATOR_SPACES ) } )
+			{
+				char line[ NMD_X86_MAXIMUM_INSTRUCTION_STRING_LENGTH ];
+				nmd_x86_format_instruction( &instruction, line, corpus_address, flags );
+
+				const auto length = std::strlen( line );
+				hash.add( line, length + 1 );
+				longest = std::max( longest, length );
+				count++;
+			}
+		}
+
+		print_hash( "format_long", "evex", count, hash );
+		std::printf( "%-18s %-16s %8zu\n", "format_longest", "evex", longest );
+	}
+
+	// Instructions whose encoding depends on the mode's default operand size, with the bytes the assembler must produce
+	struct assembler_case
+	{
+		NMD_X86_MODE mode;
+		const char*  line;
+		std::uint8_t length;
+		std::uint8_t bytes[ 4 ];
+	};
+
+	constexpr assembler_case assembler_cases[ ] = {
+		{ NMD_X86_MODE_16, "pusha", 1, { 0x60 } },
+		{ NMD_X86_MODE_16, "pushad", 2, { 0x66, 0x60 } },
+		{ NMD_X86_MODE_16, "popa", 1, { 0x61 } },
+		{ NMD_X86_MODE_16, "popad", 2, { 0x66, 0x61 } },
+		{ NMD_X86_MODE_16, "cbw", 1, { 0x98 } },
+		{ NMD_X86_MODE_16, "cwde", 2, { 0x66, 0x98 } },
+		{ NMD_X86_MODE_16, "cwd", 1, { 0x99 } },
+		{ NMD_X86_MODE_16, "cdq", 2, { 0x66, 0x99 } },
+		{ NMD_X86_MODE_16, "inc word ptr [eax]", 2, { 0xff, 0x00 } },
+		{ NMD_X86_MODE_16, "dec dword ptr [eax]", 3, { 0x66, 0xff, 0x08 } },
+		{ NMD_X86_MODE_32, "pusha", 2, { 0x66, 0x60 } },
+		{ NMD_X86_MODE_32, "pushad", 1, { 0x60 } },
+		{ NMD_X86_MODE_32, "popa", 2, { 0x66, 0x61 } },
+		{ NMD_X86_MODE_32, "popad", 1, { 0x61 } },
+		{ NMD_X86_MODE_32, "cbw", 2, { 0x66, 0x98 } },
+		{ NMD_X86_MODE_32, "cwde", 1, { 0x98 } },
+		{ NMD_X86_MODE_32, "dec byte ptr [eax]", 2, { 0xfe, 0x08 } },
+		{ NMD_X86_MODE_32, "dec word ptr [eax]", 3, { 0x66, 0xff, 0x08 } },
+		{ NMD_X86_MODE_32, "inc dword ptr [eax+4]", 3, { 0xff, 0x40, 0x04 } },
+		{ NMD_X86_MODE_32, "inc qword ptr [eax]", 0, { } },
+		{ NMD_X86_MODE_64, "dec word ptr [eax]", 3, { 0x66, 0xff, 0x08 } },
+		{ NMD_X86_MODE_64, "dec qword ptr [eax]", 3, { 0x48, 0xff, 0x08 } },
+		{ NMD_X86_MODE_64, "inc qword ptr fs:[eax]", 4, { 0x64, 0x48, 0xff, 0x00 } },
+	};
+
+	// Prints the assembler cases that don't produce their bytes and how many there are
+	void print_assembler_mismatches( )
+	{
+		size_t mismatches = 0;
+
+		for ( const auto& c : assembler_cases )
+		{
+			std::uint8_t encoded[ NMD_X86_MAXIMUM_INSTRUCTION_LENGTH ];
+			const auto   size = nmd_x86_assemble( c.line, encoded, sizeof( encoded ), 0, c.mode, nullptr );
+
+			if ( size == c.length && !std::memcmp( encoded, c.bytes, size ) )
+				continue;
+
+			mismatches++;
+			std::printf( "%s(%d):", c.line, static_cast< int >( c.mode ) );
+			for ( size_t i = 0; i < size; i++ )
+				std::printf( " %02x", encoded[ i ] );
+			std::printf( "\n" );
+		}
+
+		std::printf( "%-18s %-16s %8zu\n", "assemble_mismatch", "modes", mismatches );
+	}
+#endif
+
+	bool parse_options( int argc, char** argv, options& opts )
+	{
+		for ( int i = 1; i < argc; i++ )
+		{
+			const auto has_value = i + 1 < argc;
+
+			if ( !std::strcmp( argv[ i ], "--seed" ) && has_value )
+				opts.seed = std::strtoull( argv[ ++i ], nullptr, 0 );
+			else if ( !std::strcmp( argv[ i ], "--size" ) && has_value )
+				opts.corpus_size = std::strtoull( argv[ ++i ], nullptr, 0 );
+			else if ( !std::strcmp( argv[ i ], "--min-time" ) && has_value )
+				opts.min_time = std::strtod( argv[ ++i ], nullptr );
+			else if ( !std::strcmp( argv[ i ], "--repeats" ) && has_value )
+				opts.repeats = std::atoi( argv[ ++i ] );
+			else if ( !std::strcmp( argv[ i ], "--json" ) && has_value )
+				opts.pjson_path = argv[ ++i ];
+			else if ( !std::strcmp( argv[ i ], "--hashes" ) )
+				opts.hashes = true;
+			else if ( !std::strcmp( argv[ i ], "--no-generated" ) )
+				opts.generate = false;
+			else if ( argv[ i ][ 0 ] != '-' )
+				opts.pe_paths.push_back( argv[ i ] );
+			else
+				return false;
+		}
+
+		return opts.corpus_size && opts.repeats > 0;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	options opts;
+
+	if ( !parse_options( argc, argv, opts ) )
+	{
+		std::fprintf( stderr, "usage: %s [--seed N] [--size BYTES] [--min-time SECONDS] [--repeats N] [--json PATH] [--hashes] [--no-generated] [PE files...]\n", argv[ 0 ] );
+		return 2;
+	}
+
+	std::vector< corpus > corpora;
+
+	if ( opts.generate )
+	{
+		for ( const auto& map : opcode_maps )
+			corpora.push_back( generate_corpus( map, opts ) );
+
+		corpora.push_back( make_avx512_corpus( opts ) );
+	}
+
+	for ( const auto* ppath : opts.pe_paths )
+	{
+		if ( !load_pe_corpora( ppath, corpora ) )
+		{
+			std::fprintf( stderr, "%s is not a PE32+ file\n", ppath );
+			return 1;
+		}
+	}
+
+	std::vector< std::uint8_t > memory( emulator_memory_size );
+	std::memcpy( memory.data( ), emulator_loop, sizeof( emulator_loop ) );
+
+	// Output hashes instead of timings, for the 'check' target of the Makefile
+	if ( opts.hashes )
+	{
+		for ( const auto& c : corpora )
+			print_hashes( c );
+
+		print_emulator_hash( memory );
+
+		for ( const auto& g : guests )
+			print_guest_hash( g, "emulate", { } );
+
+#ifndef NMD_BENCH_BASELINE
+		print_long_lines_hash( );
+		print_assembler_mismatches( );
+		print_self_modifying_hash( );
+
+		for ( const auto& g : guests )
+		{
+			static nmd_x86_emulator_block block_cache[ 16 ];
+			nmd_x86_cpu                   cached { };
+			cached.blockCache     = block_cache;
+			cached.blockCacheSize = sizeof( block_cache ) / sizeof( block_cache[ 0 ] );
+
+			print_guest_hash( g, "emulate_cached", cached );
+		}
+#endif
+
+		return 0;
+	}
+
+	perf_counters         counters;
+	std::vector< result > results;
+
+	const auto run = [ & ]( const char* case_name, const std::string& corpus_name, const auto& body )
+	{
+		results.push_back( measure( case_name, corpus_name, opts, counters, body ) );
+		report( results.back( ) );
+	};
+
+	for ( const auto& c : corpora )
+	{
+		run( "decode", c.name, [ & ] { return run_decode( c ); } );
+		run( "ldisasm", c.name, [ & ] { return run_ldisasm( c ); } );
+#ifndef NMD_BENCH_BASELINE
+		run( "decode_batch", c.name, [ & ] { return run_decode_batch( c ); } );
+		run( "decode_lite", c.name, [ & ] { return run_decode_lite( c ); } );
+#endif
+
+		// Hexadecimal and decimal numbers take different paths through _nmd_append_number()
+		const auto decoded = decode_corpus( c );
+		run( "format_hex", c.name, [ & ] { return run_format( decoded, NMD_X86_FORMAT_FLAGS_DEFAULT ); } );
+		run( "format_decimal", c.name, [ & ] { return run_format( decoded, NMD_X86_FORMAT_FLAGS_DEFAULT & ~NMD_X86_FORMAT_FLAGS_HEX ); } );
+
+		// The assembler parses the formatter's output, limited to the instructions it supports
+		const auto listing = make_listing( decoded );
+
+		if ( !listing.offsets.empty( ) )
+			run( "assemble", c.name, [ & ] { return run_assemble( listing ); } );
+	}
+
+	static const nmd_x86_cpu uncached { };
+
+	const auto emulated = run_emulate( memory, uncached );
+
+	if ( emulated.instructions != loop_iterations * loop_instructions )
+		std::fprintf( stderr, "the emulator stopped after %zu of %zu instructions, the emulate cases aren't comparable\n", emulated.instructions, loop_iterations * loop_instructions );
+
+	run( "emulate", "loop", [ & ] { return run_emulate( memory, uncached ); } );
+#ifndef NMD_BENCH_BASELINE
+	// The cache is kept between passes, as the emulator's documentation recommends
+	static nmd_x86_emulator_block block_cache[ 16 ];
+	static nmd_x86_cpu            cached { };
+	cached.blockCache     = block_cache;
+	cached.blockCacheSize = sizeof( block_cache ) / sizeof( block_cache[ 0 ] );
+
+	run( "emulate_cached", "loop", [ & ] { return run_emulate( memory, cached ); } );
+#endif
+
+	for ( const auto& g : guests )
+	{
+		auto       guest_memory = make_guest_memory( g );
+		const auto bytes        = count_guest_bytes( g, guest_memory );
+
+		run( "emulate", g.name, [ & ] { return run_emulate_guest( g, guest_memory, uncached, bytes ); } );
+#ifndef NMD_BENCH_BASELINE
+		run( "emulate_cached", g.name, [ & ] { return run_emulate_guest( g, guest_memory, cached, bytes ); } );
+#endif
+	}
+
+	if ( opts.pjson_path && !write_json( opts.pjson_path, opts, results ) )
+	{
+		std::fprintf( stderr, "can't write %s\n", opts.pjson_path );
+		return 1;
+	}
+
+	return 0;
+}